@@ -153,6 +153,14 @@ macro(CassUseBoost)
     set(CASS_LIBS ${CASS_LIBS} ${Boost_LIBRARIES})
   endif()
 
+  # Benchmarks only require the Boost headers
+  if(CASS_BUILD_BENCHMARKS AND NOT Boost_INCLUDE_DIR)
+    find_package(Boost ${CASS_MINIMUM_BOOST_VERSION})
+    if(NOT Boost_INCLUDE_DIR)
+      message(FATAL_ERROR "Boost headers required to build benchmarks")
+    endif()
+  endif()
+
   # Determine if additional Boost definitions are required for driver/executables
   if(NOT WIN32)
     # Handle explicit initialization warning in atomic/details/casts
@@ -244,6 +252,82 @@ macro(CassUseZlib)
   endif()
 endmacro()
 
+#------------------------
+# CassUseLz4
+#
+# Add includes and libraries required for using LZ4 frame compression.
+#
+# Input: CASS_INCLUDES and CASS_LIBS
+# Output: CASS_INCLUDES, CASS_LIBS and HAVE_LZ4
+#------------------------
+macro(CassUseLz4)
+  # Setup the paths and hints for LZ4
+  set(_LZ4_ROOT_PATHS "${PROJECT_SOURCE_DIR}/lib/lz4/")
+  set(_LZ4_ROOT_HINTS ${LZ4_ROOT_DIR} $ENV{LZ4_ROOT_DIR})
+  if(NOT WIN32)
+    set(_LZ4_ROOT_PATHS ${_LZ4_ROOT_PATHS} "/usr/" "/usr/local/")
+  endif()
+  set(_LZ4_ROOT_HINTS_AND_PATHS
+    HINTS ${_LZ4_ROOT_HINTS}
+    PATHS ${_LZ4_ROOT_PATHS})
+
+  # Ensure LZ4 was found
+  find_path(LZ4_INCLUDE_DIR
+    NAMES lz4.h
+    ${_LZ4_ROOT_HINTS_AND_PATHS}
+    PATH_SUFFIXES include)
+  find_library(LZ4_LIBRARY
+    NAMES lz4 liblz4
+    ${_LZ4_ROOT_HINTS_AND_PATHS}
+    PATH_SUFFIXES lib)
+  find_package_handle_standard_args(Lz4 "Could NOT find LZ4, try to set the path to the LZ4 root folder in the system variable LZ4_ROOT_DIR"
+    LZ4_LIBRARY
+    LZ4_INCLUDE_DIR)
+
+  # Assign LZ4 include and library
+  set(CASS_INCLUDES ${CASS_INCLUDES} ${LZ4_INCLUDE_DIR})
+  set(CASS_LIBS ${CASS_LIBS} ${LZ4_LIBRARY})
+  set(HAVE_LZ4 1)
+endmacro()
+
+#------------------------
+# CassUseSnappy
+#
+# Add includes and libraries required for using Snappy frame compression.
+#
+# Input: CASS_INCLUDES and CASS_LIBS
+# Output: CASS_INCLUDES, CASS_LIBS and HAVE_SNAPPY
+#------------------------
+macro(CassUseSnappy)
+  # Setup the paths and hints for Snappy
+  set(_SNAPPY_ROOT_PATHS "${PROJECT_SOURCE_DIR}/lib/snappy/")
+  set(_SNAPPY_ROOT_HINTS ${SNAPPY_ROOT_DIR} $ENV{SNAPPY_ROOT_DIR})
+  if(NOT WIN32)
+    set(_SNAPPY_ROOT_PATHS ${_SNAPPY_ROOT_PATHS} "/usr/" "/usr/local/")
+  endif()
+  set(_SNAPPY_ROOT_HINTS_AND_PATHS
+    HINTS ${_SNAPPY_ROOT_HINTS}
+    PATHS ${_SNAPPY_ROOT_PATHS})
+
+  # Ensure Snappy was found
+  find_path(SNAPPY_INCLUDE_DIR
+    NAMES snappy-c.h
+    ${_SNAPPY_ROOT_HINTS_AND_PATHS}
+    PATH_SUFFIXES include)
+  find_library(SNAPPY_LIBRARY
+    NAMES snappy libsnappy
+    ${_SNAPPY_ROOT_HINTS_AND_PATHS}
+    PATH_SUFFIXES lib)
+  find_package_handle_standard_args(Snappy "Could NOT find Snappy, try to set the path to the Snappy root folder in the system variable SNAPPY_ROOT_DIR"
+    SNAPPY_LIBRARY
+    SNAPPY_INCLUDE_DIR)
+
+  # Assign Snappy include and library
+  set(CASS_INCLUDES ${CASS_INCLUDES} ${SNAPPY_INCLUDE_DIR})
+  set(CASS_LIBS ${CASS_LIBS} ${SNAPPY_LIBRARY})
+  set(HAVE_SNAPPY 1)
+endmacro()
+
 #-------------------
 # Compiler Flags
 #-------------------
@@ -516,5 +600,6 @@ macro(CassConfigure)
   if (NOT WIN32 AND NOT HAVE_NOSIGPIPE AND NOT HAVE_SIGTIMEDWAIT)
     message(WARNING "Unable to handle SIGPIPE on your platform")
   endif()
+  check_symbol_exists(eventfd "sys/eventfd.h" HAVE_EVENTFD)
   configure_file(${CASS_SOURCE_DIR}/cassconfig.hpp.in ${CASS_SOURCE_DIR}/src/cassconfig.hpp)
 endmacro()
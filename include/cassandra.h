@@ -238,6 +238,15 @@ typedef struct CassBatch_ CassBatch;
  */
 typedef struct CassFuture_ CassFuture;
 
+/**
+ * A queue of completed futures. Futures attached to a completion queue are
+ * posted to it when they're set which allows many outstanding requests to be
+ * reaped by a single thread without a callback or a wait per future.
+ *
+ * @struct CassCompletionQueue
+ */
+typedef struct CassCompletionQueue_ CassCompletionQueue;
+
 /**
  * A statement that has been prepared cluster-side (It has been pre-parsed
  * and cached).
@@ -468,6 +477,35 @@ typedef struct CassMetrics_ {
 
 } CassMetrics;
 
+/**
+ * A snapshot of the session's retry budget. All zero unless a retry budget
+ * is set with cass_cluster_set_retry_budget().
+ *
+ * @struct CassRetryBudgetMetrics
+ */
+typedef struct CassRetryBudgetMetrics_ {
+  cass_double_t available_tokens; /**< Tokens available for retries and speculative executions */
+  cass_uint64_t retries; /**< Retries allowed by the budget */
+  cass_uint64_t speculative_executions; /**< Speculative executions allowed by the budget */
+  cass_uint64_t exhausted; /**< Retries and speculative executions denied because the budget was exhausted */
+} CassRetryBudgetMetrics;
+
+/**
+ * A snapshot of the memory used for socket reads and response bodies. Each
+ * IO thread (and the control connection) caches this memory in a pool that
+ * is shared by all of its connections.
+ *
+ * @struct CassBufferPoolMetrics
+ */
+typedef struct CassBufferPoolMetrics_ {
+  cass_uint64_t cached_bytes; /**< Free memory held by the pools */
+  cass_uint64_t in_use_bytes; /**< Memory in use by reads and responses that haven't been freed */
+  cass_uint64_t hits; /**< Allocations that reused a cached buffer */
+  cass_uint64_t misses; /**< Allocations that had to allocate a new buffer */
+  cass_uint64_t unpooled; /**< Allocations too large to be pooled (larger than 4 MB) */
+  cass_uint64_t trimmed_bytes; /**< Cached memory freed because a pool exceeded its high water mark */
+} CassBufferPoolMetrics;
+
 typedef enum CassConsistency_ {
   CASS_CONSISTENCY_UNKNOWN      = 0xFFFF,
   CASS_CONSISTENCY_ANY          = 0x0000,
@@ -649,6 +687,12 @@ typedef enum CassProtocolVersion_ {
   CASS_PROTOCOL_VERSION_V4    = 0x04
 } CassProtocolVersion;
 
+typedef enum CassCompression_ {
+  CASS_COMPRESSION_NONE   = 0,
+  CASS_COMPRESSION_LZ4    = 1,
+  CASS_COMPRESSION_SNAPPY = 2
+} CassCompression;
+
 typedef enum  CassErrorSource_ {
   CASS_ERROR_SOURCE_NONE,
   CASS_ERROR_SOURCE_LIB,
@@ -744,6 +788,30 @@ typedef enum CassError_ {
 typedef void (*CassFutureCallback)(CassFuture* future,
                                    void* data);
 
+/**
+ * A callback that's passed each row of a statement's result as the row
+ * arrives.
+ *
+ * @param[in] row The row. It's only valid for the duration of the callback.
+ * @param[in] data user defined data provided when the callback
+ * was registered.
+ *
+ * @see cass_statement_set_row_callback()
+ */
+typedef void (*CassRowCallback)(const CassRow* row,
+                                void* data);
+
+/**
+ * A completed future and the user defined data provided when it was
+ * attached to a completion queue.
+ *
+ * @see cass_completion_queue_next()
+ */
+typedef struct CassCompletion_ {
+  CassFuture* future;
+  void* data;
+} CassCompletion;
+
 /**
  * Maximum size of a log message
  */
@@ -776,6 +844,16 @@ typedef struct CassLogMessage_ {
 typedef void (*CassLogCallback)(const CassLogMessage* message,
                                 void* data);
 
+/**
+ * The number of log messages that were dropped.
+ *
+ * @see cass_log_get_stats()
+ */
+typedef struct CassLogStats_ {
+  cass_uint64_t dropped_queue_full; /**< Dropped because the async log queue was full */
+  cass_uint64_t dropped_rate_limited; /**< Dropped because of a log level's rate limit */
+} CassLogStats;
+
 /**
  * An authenticator.
  *
@@ -1006,6 +1084,27 @@ CASS_EXPORT CassError
 cass_cluster_set_use_beta_protocol_version(CassCluster* cluster,
                                            cass_bool_t enable);
 
+/**
+ * Sets the compression algorithm used for frame bodies. The algorithm is
+ * negotiated when each connection starts up and compression is disabled
+ * for connections to hosts that don't support it.
+ *
+ * <b>Note:</b> The driver must be built with the matching library
+ * (CASS_USE_LZ4 or CASS_USE_SNAPPY).
+ *
+ * <b>Default:</b> CASS_COMPRESSION_NONE
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] compression
+ * @return CASS_OK if successful, otherwise CASS_ERROR_LIB_NOT_IMPLEMENTED if
+ * the driver wasn't built with support for the algorithm.
+ */
+CASS_EXPORT CassError
+cass_cluster_set_compression(CassCluster* cluster,
+                             CassCompression compression);
+
 /**
  * Sets the number of IO threads. This is the number of threads
  * that will handle query requests.
@@ -1022,9 +1121,52 @@ CASS_EXPORT CassError
 cass_cluster_set_num_threads_io(CassCluster* cluster,
                                 unsigned num_threads);
 
+/**
+ * Sets the number of IO threads that maintain a connection pool to each
+ * host. Hosts are partitioned across the IO threads and each request is
+ * handled by an IO thread that owns the first host in its query plan. This
+ * reduces the number of connections and batches more requests per
+ * connection write.
+ *
+ * <b>Default:</b> 0 (every IO thread connects to every host)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] num_threads A value of 0 disables host partitioning
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_num_threads_io()
+ * @see cass_cluster_set_on_demand_pool_idle_timeout()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_num_threads_io_per_host(CassCluster* cluster,
+                                         unsigned num_threads);
+
+/**
+ * Sets how long an IO thread keeps an on demand connection pool that has no
+ * requests in flight. When hosts are partitioned across IO threads, an IO
+ * thread connects to a host it doesn't own only when a retry or speculative
+ * execution needs that host. The pool is closed once it has been idle for
+ * this long.
+ *
+ * <b>Default:</b> 10000 milliseconds
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] timeout_ms The idle timeout in milliseconds. Use 0 to keep
+ * on demand pools open until their host goes down.
+ *
+ * @see cass_cluster_set_num_threads_io_per_host()
+ */
+CASS_EXPORT void
+cass_cluster_set_on_demand_pool_idle_timeout(CassCluster* cluster,
+                                             unsigned timeout_ms);
+
 /**
  * Sets the size of the fixed size queue that stores
- * pending requests.
+ * pending requests. Each IO thread has its own queue.
  *
  * <b>Default:</b> 8192
  *
@@ -1103,7 +1245,9 @@ cass_cluster_set_max_connections_per_host(CassCluster* cluster,
                                           unsigned num_connections);
 
 /**
- * Sets the amount of time to wait before attempting to reconnect.
+ * Sets the amount of time to wait before attempting to reconnect. This
+ * doesn't apply to the control connection, which retries every 1000
+ * milliseconds when it can't connect to any host.
  *
  * <b>Default:</b> 2000 milliseconds
  *
@@ -1111,11 +1255,38 @@ cass_cluster_set_max_connections_per_host(CassCluster* cluster,
  *
  * @param[in] cluster
  * @param[in] wait_time
+ *
+ * @see cass_cluster_set_exponential_reconnect()
  */
 CASS_EXPORT void
 cass_cluster_set_reconnect_wait_time(CassCluster* cluster,
                                      unsigned wait_time);
 
+/**
+ * Sets an exponential backoff for reconnecting to hosts. The delay starts at
+ * "base_delay_ms" and doubles after each failed attempt up to "max_delay_ms".
+ * Each delay is randomly chosen between half and all of the current delay so
+ * that IO threads and clients don't all reconnect to a host at the same time.
+ * The delay is restarted once a connection to the host is established.
+ *
+ * This replaces the constant delay set by cass_cluster_set_reconnect_wait_time().
+ * The control connection also uses this backoff when it can't connect to any
+ * host. With a constant delay it retries every 1000 milliseconds instead.
+ *
+ * <b>Default:</b> Disabled (a constant 2000 millisecond delay)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] base_delay_ms The first delay in milliseconds
+ * @param[in] max_delay_ms The maximum delay in milliseconds
+ * @return CASS_OK if successful, otherwise an error occurred
+ */
+CASS_EXPORT CassError
+cass_cluster_set_exponential_reconnect(CassCluster* cluster,
+                                       cass_uint64_t base_delay_ms,
+                                       cass_uint64_t max_delay_ms);
+
 /**
  * Sets the maximum number of connections that will be created concurrently.
  * Connections are created when the current connections are unable to keep up with
@@ -1150,6 +1321,33 @@ CASS_EXPORT CassError
 cass_cluster_set_max_concurrent_requests_threshold(CassCluster* cluster,
                                                    unsigned num_requests);
 
+/**
+ * Sets the window used to resize each host's connection pool between the
+ * core and max connections per host. The pool samples its in-flight requests,
+ * stream utilization and write-queue bytes during the window and then adds
+ * connections or drains an idle connection to match the peak load. A draining
+ * connection takes no new requests and is closed once its in-flight requests
+ * finish.
+ *
+ * When resizing is disabled, connections are only added when a connection
+ * exceeds the max concurrent requests threshold and they're never removed.
+ *
+ * <b>Default:</b> 0 (Disabled)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] window_ms The window in milliseconds (e.g. 10000). Use 0 to
+ * disable resizing.
+ *
+ * @see cass_cluster_set_core_connections_per_host()
+ * @see cass_cluster_set_max_connections_per_host()
+ * @see cass_cluster_set_max_concurrent_requests_threshold()
+ */
+CASS_EXPORT void
+cass_cluster_set_connection_pool_resize_window(CassCluster* cluster,
+                                               unsigned window_ms);
+
 /**
  * Sets the maximum number of requests processed by an IO worker
  * per flush.
@@ -1278,6 +1476,27 @@ CASS_EXPORT void
 cass_cluster_set_resolve_timeout(CassCluster* cluster,
                                  unsigned timeout_ms);
 
+/**
+ * Sets the number of pages to fetch ahead of the application for statements
+ * that have a page size. When a page arrives the next page is requested
+ * right away, without waiting for the application to re-execute the
+ * statement, until this many pages are buffered ahead of the page being
+ * read. This can be overridden per statement.
+ *
+ * <b>Default:</b> 0 (Disabled)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] pages
+ *
+ * @see cass_statement_set_prefetch_pages()
+ * @see cass_iterator_from_result_pages()
+ */
+CASS_EXPORT void
+cass_cluster_set_prefetch_pages(CassCluster* cluster,
+                                unsigned pages);
+
 /**
  * Sets credentials for plain text authentication.
  *
@@ -1400,6 +1619,92 @@ CASS_EXPORT void
 cass_cluster_set_token_aware_routing(CassCluster* cluster,
                                      cass_bool_t enabled);
 
+/**
+ * Sets the number of threads used to build the token map's replicas when
+ * the session connects and when the ring changes. Replicas are built once
+ * for each unique replication strategy, keyspaces with the same replication
+ * settings share them.
+ *
+ * <b>Default:</b> 4
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] num_threads The number of threads, including the session's
+ * thread (must be greater than 0).
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_cluster_set_token_aware_routing()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_token_map_build_threads(CassCluster* cluster,
+                                         unsigned num_threads);
+
+/**
+ * Defers building a keyspace's replicas until a request for the keyspace
+ * is routed. This reduces the time it takes to connect and the memory used
+ * when there are many keyspaces that the application doesn't use. The first
+ * request for each keyspace (after the ring changes) builds its replicas.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_cluster_set_token_aware_routing()
+ */
+CASS_EXPORT void
+cass_cluster_set_token_map_lazy_replicas(CassCluster* cluster,
+                                         cass_bool_t enabled);
+
+/**
+ * Configures the cluster to use power of two choices request routing or not.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * This routing policy composes the base routing policy (and token-aware
+ * routing if it's enabled). It compares the first two hosts chosen by
+ * those policies, usually two replicas, and tries the one with fewer
+ * requests in flight first. This reduces tail latency when a replica is
+ * briefly slow.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ */
+CASS_EXPORT void
+cass_cluster_set_power_of_two_choices_routing(CassCluster* cluster,
+                                              cass_bool_t enabled);
+
+/**
+ * Ramps up the requests sent to a host after it comes back up. A host that
+ * was down is often slow right after it recovers because its caches are
+ * cold. During the window the host's share of requests grows linearly from
+ * "initial_weight" to its full share. Requests that don't pick the host
+ * try it after the other hosts in the same datacenter (the same distance).
+ *
+ * This routing policy composes the base routing policy and token-aware and
+ * power of two choices routing if they're enabled.
+ *
+ * <b>Default:</b> Disabled
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] window_ms The time it takes for a host to get its full share
+ * of requests. Use 0 to disable slow start.
+ * @param[in] initial_weight The share of requests when the host comes back up
+ * (between 0.0 and 1.0, e.g. 0.1)
+ * @return CASS_OK if successful, otherwise an error occurred
+ */
+CASS_EXPORT CassError
+cass_cluster_set_slow_start(CassCluster* cluster,
+                            cass_uint64_t window_ms,
+                            cass_double_t initial_weight);
+
 
 /**
  * Configures the cluster to use latency-aware request routing or not.
@@ -1786,6 +2091,58 @@ cass_cluster_set_constant_speculative_execution_policy(CassCluster* cluster,
                                                        cass_int64_t constant_delay_ms,
                                                        int max_speculative_executions);
 
+/**
+ * Enable speculative executions whose delay is a latency percentile of the
+ * host that's executing the request. The percentile is tracked per host over
+ * rolling windows of at least one second (and 100 requests). Requests aren't
+ * speculatively executed on a host until it has a complete window.
+ *
+ * Speculative executions are skipped if they'd add more than the budget's
+ * percentage of extra requests.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] percentile The latency percentile used as the delay (e.g. 99.0)
+ * @param[in] max_speculative_executions
+ * @param[in] budget_percent The maximum percentage of extra requests (e.g. 10.0)
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_cluster_set_constant_speculative_execution_policy()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_percentile_speculative_execution_policy(CassCluster* cluster,
+                                                         cass_double_t percentile,
+                                                         int max_speculative_executions,
+                                                         cass_double_t budget_percent);
+
+/**
+ * Limits the number of retries and speculative executions with a
+ * session-wide budget (a token bucket). Each successful request adds
+ * "ratio" tokens to the budget, up to "max_tokens", and each retry or
+ * speculative execution of a request that was already sent to a host uses
+ * a whole token. When the budget is exhausted retries fail immediately with
+ * the error that caused them and speculative executions are skipped. This
+ * prevents retry storms when the cluster is overloaded.
+ *
+ * The budget starts with "max_tokens" tokens.
+ *
+ * <b>Default:</b> Disabled (retries and speculative executions are unbounded)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] ratio The number of tokens added for each successful request (e.g. 0.1)
+ * @param[in] max_tokens The maximum number of tokens. Use 0 to disable the budget.
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_session_get_retry_budget_metrics()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_retry_budget(CassCluster* cluster,
+                              cass_double_t ratio,
+                              unsigned max_tokens);
+
 /**
  * Disable speculative executions
  *
@@ -1932,6 +2289,45 @@ cass_session_prepare_n(CassSession* session,
                        const char* query,
                        size_t query_length);
 
+/**
+ * Create a prepared statement using the session's prepared statement
+ * cache. Statements are cached by the session's current keyspace and the
+ * query string. If the statement is already cached the returned future is
+ * already set. Otherwise, the statement is prepared and, once the first host
+ * has prepared it, it's also prepared on all the other hosts that are up.
+ * Cached statements are prepared again on hosts that come back up or are
+ * added so executing them doesn't require re-preparing them.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[in] query
+ * @return A future that must be freed.
+ *
+ * @see cass_future_get_prepared()
+ */
+CASS_EXPORT CassFuture*
+cass_session_prepare_cached(CassSession* session,
+                            const char* query);
+
+/**
+ * Same as cass_session_prepare_cached(), but with lengths for string
+ * parameters.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[in] query
+ * @param[in] query_length
+ * @return same as cass_session_prepare_cached()
+ *
+ * @see cass_session_prepare_cached()
+ */
+CASS_EXPORT CassFuture*
+cass_session_prepare_cached_n(CassSession* session,
+                              const char* query,
+                              size_t query_length);
+
 /**
  * Execute a query or bound statement.
  *
@@ -1992,6 +2388,32 @@ CASS_EXPORT void
 cass_session_get_metrics(const CassSession* session,
                          CassMetrics* output);
 
+/**
+ * Gets a copy of the metrics for the session's buffer pools.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ */
+CASS_EXPORT void
+cass_session_get_buffer_pool_metrics(const CassSession* session,
+                                     CassBufferPoolMetrics* output);
+
+/**
+ * Gets a copy of the metrics for the session's retry budget.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ *
+ * @see cass_cluster_set_retry_budget()
+ */
+CASS_EXPORT void
+cass_session_get_retry_budget_metrics(const CassSession* session,
+                                      CassRetryBudgetMetrics* output);
+
 /***********************************************************************************
  *
  * Schema Metadata
@@ -3651,6 +4073,29 @@ cass_future_set_callback(CassFuture* future,
                          CassFutureCallback callback,
                          void* data);
 
+/**
+ * Attaches a future to a completion queue. The future is posted to the
+ * queue when it's set (or immediately if it's already set). A future can
+ * only be attached to a single completion queue.
+ *
+ * <b>Note:</b> The completion queue holds its own reference to the future
+ * until it's returned by cass_completion_queue_next(), so the future can
+ * be freed after it's attached.
+ *
+ * @public @memberof CassFuture
+ *
+ * @param[in] future
+ * @param[in] queue
+ * @param[in] data
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_completion_queue_next()
+ */
+CASS_EXPORT CassError
+cass_future_set_completion_queue(CassFuture* future,
+                                 CassCompletionQueue* queue,
+                                 void* data);
+
 /**
  * Gets the set status of the future.
  *
@@ -3803,6 +4248,72 @@ cass_future_custom_payload_item(CassFuture* future,
                                 const cass_byte_t** value,
                                 size_t* value_size);
 
+/***********************************************************************************
+ *
+ * Completion queue
+ *
+ ***********************************************************************************/
+
+/**
+ * Creates a new completion queue.
+ *
+ * @public @memberof CassCompletionQueue
+ *
+ * @return Returns a completion queue that must be freed. NULL is returned
+ * if the queue's notification descriptor could not be created.
+ *
+ * @see cass_completion_queue_free()
+ */
+CASS_EXPORT CassCompletionQueue*
+cass_completion_queue_new();
+
+/**
+ * Frees a completion queue instance. Futures that are still pending keep
+ * the queue alive until they're set. Futures that were posted, but not yet
+ * returned by cass_completion_queue_next(), are released when the queue is
+ * destroyed.
+ *
+ * @public @memberof CassCompletionQueue
+ *
+ * @param[in] queue
+ */
+CASS_EXPORT void
+cass_completion_queue_free(CassCompletionQueue* queue);
+
+/**
+ * Gets a file descriptor that becomes readable when futures are posted to
+ * the completion queue. It can be added to an application's event loop
+ * (select(), poll(), epoll, etc.) and cass_completion_queue_next() should
+ * be called once it's readable. The descriptor is owned by the queue and
+ * must not be read from or closed.
+ *
+ * @public @memberof CassCompletionQueue
+ *
+ * @param[in] queue
+ * @return A file descriptor or -1 if not supported on this platform.
+ */
+CASS_EXPORT int
+cass_completion_queue_fd(const CassCompletionQueue* queue);
+
+/**
+ * Removes up to "count" completed futures from the completion queue. This
+ * doesn't block. The returned futures must be freed using
+ * cass_future_free().
+ *
+ * <b>Important:</b> This should only be called by a single thread at a time.
+ *
+ * @public @memberof CassCompletionQueue
+ *
+ * @param[in] queue
+ * @param[out] completions
+ * @param[in] count The maximum number of completions to return.
+ * @return The number of completions returned.
+ */
+CASS_EXPORT size_t
+cass_completion_queue_next(CassCompletionQueue* queue,
+                           CassCompletion* completions,
+                           size_t count);
+
 /***********************************************************************************
  *
  * Statement
@@ -3972,6 +4483,60 @@ CASS_EXPORT CassError
 cass_statement_set_paging_size(CassStatement* statement,
                                int page_size);
 
+/**
+ * Sets the number of pages to fetch ahead of the application. This has no
+ * effect unless the statement has a page size. The following pages are
+ * read using the iterator returned by cass_iterator_from_result_pages().
+ *
+ * The following pages use a copy of the statement made when it's executed,
+ * so the statement can be modified or freed while its pages are iterated.
+ * If the session is freed first, the remaining pages fail with
+ * CASS_ERROR_LIB_NO_HOSTS_AVAILABLE.
+ *
+ * @cassandra{2.0+}
+ *
+ * <b>Default:</b> Use the cluster-level setting
+ *
+ * @public @memberof CassStatement
+ *
+ * @param[in] statement
+ * @param[in] pages The number of pages to fetch ahead. Use 0 to disable.
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_prefetch_pages()
+ */
+CASS_EXPORT CassError
+cass_statement_set_prefetch_pages(CassStatement* statement,
+                                  unsigned pages);
+
+/**
+ * Sets a callback that's passed the rows of the statement's result as they
+ * arrive on the socket instead of buffering the whole result. Only the
+ * partial row at the end of the data received so far is buffered, so large
+ * results can be processed using a small, fixed amount of memory. The
+ * result returned by the statement's future has the metadata and paging
+ * state, but no rows.
+ *
+ * <b>Important:</b> The callback is called on one of the driver's IO
+ * threads and it must not block. Rows are only valid for the duration of
+ * the callback. Once rows have been passed to the callback the statement
+ * isn't retried or speculatively executed on another host.
+ *
+ * This also applies to the following pages of a statement that uses
+ * cass_statement_set_prefetch_pages().
+ *
+ * @public @memberof CassStatement
+ *
+ * @param[in] statement
+ * @param[in] callback The callback or NULL to buffer the result.
+ * @param[in] data user defined data passed to the callback
+ * @return CASS_OK if successful, otherwise an error occurred.
+ */
+CASS_EXPORT CassError
+cass_statement_set_row_callback(CassStatement* statement,
+                                CassRowCallback callback,
+                                void* data);
+
 /**
  * Sets the statement's paging state. This can be used to get the next page of
  * data in a multi-page query.
@@ -8314,6 +8879,29 @@ cass_iterator_type(CassIterator* iterator);
 CASS_EXPORT CassIterator*
 cass_iterator_from_result(const CassResult* result);
 
+/**
+ * Creates a new iterator for the specified result and the pages that
+ * follow it. This can be used to iterate over the rows of every page of a
+ * statement that was executed with prefetching enabled. The iterator
+ * blocks when it reaches the end of a page that hasn't arrived yet.
+ * Iteration stops early if a page can't be fetched. Use
+ * cass_iterator_pages_error() to check for an error after
+ * cass_iterator_next() returns cass_false.
+ *
+ * If prefetching wasn't enabled for the statement then this only iterates
+ * over the rows in the result.
+ *
+ * @public @memberof CassResult
+ *
+ * @param[in] result The first page of a statement's results
+ * @return A new iterator that must be freed.
+ *
+ * @see cass_statement_set_prefetch_pages()
+ * @see cass_iterator_free()
+ */
+CASS_EXPORT CassIterator*
+cass_iterator_from_result_pages(const CassResult* result);
+
 /**
  * Creates a new iterator for the specified row. This can be
  * used to iterate over columns in a row.
@@ -8709,6 +9297,23 @@ cass_iterator_next(CassIterator* iterator);
 CASS_EXPORT const CassRow*
 cass_iterator_get_row(const CassIterator* iterator);
 
+/**
+ * Gets the error that stopped a result iterator created with
+ * cass_iterator_from_result_pages() from fetching the next page.
+ *
+ * @public @memberof CassIterator
+ *
+ * @param[in] iterator
+ * @param[out] message Empty string returned if no error occurred.
+ * @param[out] message_length
+ * @return CASS_OK if no error occurred, otherwise the error code for the
+ * page that couldn't be fetched.
+ */
+CASS_EXPORT CassError
+cass_iterator_pages_error(const CassIterator* iterator,
+                          const char** message,
+                          size_t* message_length);
+
 /**
  * Gets the column value at the row iterator's current position.
  *
@@ -9894,6 +10499,62 @@ cass_log_set_callback(CassLogCallback callback,
 CASS_EXPORT void
 CASS_DEPRECATED(cass_log_set_queue_size(size_t queue_size));
 
+/**
+ * Delivers log messages to the callback on a separate logger thread instead
+ * of the thread that logged them. Messages are formatted and added to a
+ * bounded queue without blocking. If the queue is full, the message is
+ * dropped so a slow callback never stalls the driver's threads.
+ *
+ * <b>Note:</b> This needs to be done before any call that might log, such as
+ * any of the cass_cluster_*() or cass_ssl_*() functions.
+ *
+ * <b>Default:</b> Disabled (the callback is called by the thread that logged
+ * the message)
+ *
+ * @param[in] queue_size The maximum number of messages waiting to be delivered
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_log_stop_async()
+ * @see cass_log_get_stats()
+ */
+CASS_EXPORT CassError
+cass_log_start_async(size_t queue_size);
+
+/**
+ * Delivers the remaining log messages and stops the logger thread started by
+ * cass_log_start_async(). Messages are delivered by the thread that logged them
+ * afterwards.
+ *
+ * <b>Note:</b> This must be done after all sessions are closed.
+ */
+CASS_EXPORT void
+cass_log_stop_async();
+
+/**
+ * Limits the number of messages per second that are logged for a log level.
+ * Messages over the limit are dropped.
+ *
+ * <b>Default:</b> 0 (no limit)
+ *
+ * @param[in] log_level
+ * @param[in] messages_per_second The maximum number of messages per second.
+ * Use 0 for no limit.
+ * @return CASS_OK if successful, otherwise an error occurred
+ *
+ * @see cass_log_get_stats()
+ */
+CASS_EXPORT CassError
+cass_log_set_rate_limit(CassLogLevel log_level,
+                        unsigned messages_per_second);
+
+/**
+ * Gets the number of log messages that were dropped.
+ *
+ * @param[out] stats
+ */
+CASS_EXPORT void
+cass_log_get_stats(CassLogStats* stats);
+
 /**
  * Gets the string for a log level.
  *
@@ -147,6 +147,9 @@ public:
   Buffer encode_with_length() const;
 
 protected:
+  AbstractData(const AbstractData& other)
+    : elements_(other.elements_) { }
+
   virtual size_t get_indices(StringRef name,
                              IndexVec* indices) = 0;
   virtual const DataType::ConstPtr& get_type(size_t index) const = 0;
@@ -172,7 +175,7 @@ private:
   ElementVec elements_;
 
 private:
-  DISALLOW_COPY_AND_ASSIGN(AbstractData);
+  DISALLOW_ASSIGN(AbstractData);
 };
 
 } // namespace cass
@@ -0,0 +1,172 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "buffer_pool.hpp"
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <new>
+#include <stdlib.h>
+
+namespace cass {
+
+static char* heap_allocate(size_t size) {
+  char* buffer = static_cast<char*>(malloc(size));
+  if (buffer == NULL) throw std::bad_alloc();
+  return buffer;
+}
+
+// Heap buffers are allocated here, with the same allocator as the pool,
+// so that they're always released by RefBuffer::operator delete()
+RefBuffer* RefBuffer::create(size_t size) {
+  size_t capacity = allocation_size(size);
+  return create(heap_allocate(capacity), capacity, NULL);
+}
+
+void RefBuffer::operator delete(void* ptr) {
+  Header* header = RefBuffer::header(ptr);
+  if (header->pool != NULL) {
+    BufferPool::release_ref_buffer(header);
+  } else {
+    free(header);
+  }
+}
+
+BufferPool::BufferPool(size_t high_water_mark, size_t low_water_mark)
+  : high_water_mark_(high_water_mark)
+  , low_water_mark_(std::min(low_water_mark, high_water_mark))
+  , cached_bytes_(0)
+  , in_use_bytes_(0)
+  , hits_(0)
+  , misses_(0)
+  , unpooled_(0)
+  , trimmed_bytes_(0) {
+  for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+    size_t capacity = static_cast<size_t>(1) << (MIN_SIZE_CLASS_SHIFT + i);
+    // Large size classes can't hold more than the high water mark
+    size_t max_buffers = high_water_mark_ / capacity;
+    if (max_buffers < 2) max_buffers = 2;
+    if (max_buffers > MAX_BUFFERS_PER_SIZE_CLASS) max_buffers = MAX_BUFFERS_PER_SIZE_CLASS;
+    free_buffers_[i] = new BufferQueue(max_buffers);
+  }
+}
+
+BufferPool::~BufferPool() {
+  for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+    char* buffer;
+    while (free_buffers_[i]->dequeue(buffer)) {
+      free(buffer);
+    }
+    delete free_buffers_[i];
+  }
+}
+
+size_t BufferPool::capacity_for(size_t size) {
+  size_t capacity = static_cast<size_t>(1) << MIN_SIZE_CLASS_SHIFT;
+  if (size <= capacity) return capacity;
+  if (size > (static_cast<size_t>(1) << MAX_SIZE_CLASS_SHIFT)) return size;
+  return next_pow_2(size);
+}
+
+size_t BufferPool::size_class(size_t capacity) {
+  size_t index = 0;
+  while ((static_cast<size_t>(1) << (MIN_SIZE_CLASS_SHIFT + index)) < capacity) {
+    ++index;
+  }
+  return index;
+}
+
+char* BufferPool::allocate(size_t size, size_t* capacity) {
+  *capacity = capacity_for(size);
+  in_use_bytes_.fetch_add(*capacity, MEMORY_ORDER_RELAXED);
+
+  if (*capacity > (static_cast<size_t>(1) << MAX_SIZE_CLASS_SHIFT)) {
+    unpooled_.fetch_add(1, MEMORY_ORDER_RELAXED);
+    return heap_allocate(*capacity);
+  }
+
+  char* buffer;
+  if (free_buffers_[size_class(*capacity)]->dequeue(buffer)) {
+    cached_bytes_.fetch_sub(*capacity, MEMORY_ORDER_RELAXED);
+    hits_.fetch_add(1, MEMORY_ORDER_RELAXED);
+    return buffer;
+  }
+
+  misses_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  return heap_allocate(*capacity);
+}
+
+void BufferPool::release(char* buffer, size_t capacity) {
+  if (buffer == NULL) return;
+  in_use_bytes_.fetch_sub(capacity, MEMORY_ORDER_RELAXED);
+
+  if (capacity <= (static_cast<size_t>(1) << MAX_SIZE_CLASS_SHIFT) &&
+      cached_bytes_.load(MEMORY_ORDER_RELAXED) + capacity <= high_water_mark_) {
+    // The count is updated first so that a concurrent allocation of the
+    // buffer never makes it negative
+    cached_bytes_.fetch_add(capacity, MEMORY_ORDER_RELAXED);
+    if (free_buffers_[size_class(capacity)]->enqueue(buffer)) {
+      return;
+    }
+    cached_bytes_.fetch_sub(capacity, MEMORY_ORDER_RELAXED);
+  }
+
+  free(buffer);
+  if (cached_bytes_.load(MEMORY_ORDER_RELAXED) + capacity > high_water_mark_) {
+    trim();
+  }
+}
+
+RefBuffer* BufferPool::create_ref_buffer(size_t size) {
+  size_t capacity;
+  char* memory = allocate(RefBuffer::allocation_size(size), &capacity);
+  // Buffers keep their pool alive while they're in use
+  inc_ref();
+  return RefBuffer::create(memory, capacity, this);
+}
+
+void BufferPool::release_ref_buffer(void* memory) {
+  RefBuffer::Header* header = static_cast<RefBuffer::Header*>(memory);
+  BufferPool* pool = header->pool;
+  pool->release(static_cast<char*>(memory), header->capacity);
+  pool->dec_ref();
+}
+
+void BufferPool::trim() {
+  for (size_t i = NUM_SIZE_CLASSES; i > 0 &&
+       cached_bytes_.load(MEMORY_ORDER_RELAXED) > low_water_mark_; --i) {
+    size_t capacity = static_cast<size_t>(1) << (MIN_SIZE_CLASS_SHIFT + i - 1);
+    char* buffer;
+    while (cached_bytes_.load(MEMORY_ORDER_RELAXED) > low_water_mark_ &&
+           free_buffers_[i - 1]->dequeue(buffer)) {
+      cached_bytes_.fetch_sub(capacity, MEMORY_ORDER_RELAXED);
+      trimmed_bytes_.fetch_add(capacity, MEMORY_ORDER_RELAXED);
+      free(buffer);
+    }
+  }
+}
+
+void BufferPool::stats(Stats* stats) const {
+  stats->cached_bytes = cached_bytes_.load(MEMORY_ORDER_RELAXED);
+  stats->in_use_bytes = in_use_bytes_.load(MEMORY_ORDER_RELAXED);
+  stats->hits = hits_.load(MEMORY_ORDER_RELAXED);
+  stats->misses = misses_.load(MEMORY_ORDER_RELAXED);
+  stats->unpooled = unpooled_.load(MEMORY_ORDER_RELAXED);
+  stats->trimmed_bytes = trimmed_bytes_.load(MEMORY_ORDER_RELAXED);
+}
+
+} // namespace cass
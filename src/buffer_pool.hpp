@@ -0,0 +1,108 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_BUFFER_POOL_HPP_INCLUDED__
+#define __CASS_BUFFER_POOL_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "macros.hpp"
+#include "mpmc_queue.hpp"
+#include "ref_counted.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cass {
+
+// A cache of memory shared by all the connections on an event loop. It's
+// used for socket read buffers and the bodies of responses. Sizes are
+// rounded up to a power of two size class from 256 bytes to 4 MB and each
+// class keeps a bounded lock-free list of free buffers because response
+// bodies are released on whatever thread drops the last reference.
+// Allocations larger than the largest class come from the heap.
+//
+// When the cached (free) memory grows past the high water mark the pool
+// releases buffers, starting with the largest classes, until it's back under
+// the low water mark. Buffers hold a reference to their pool so it's safe for
+// results to outlive the session.
+class BufferPool : public RefCounted<BufferPool> {
+public:
+  typedef SharedRefPtr<BufferPool> Ptr;
+
+  static const size_t MIN_SIZE_CLASS_SHIFT = 8;  // 256 bytes
+  static const size_t MAX_SIZE_CLASS_SHIFT = 22; // 4 MB
+  static const size_t NUM_SIZE_CLASSES = MAX_SIZE_CLASS_SHIFT - MIN_SIZE_CLASS_SHIFT + 1;
+  static const size_t MAX_BUFFERS_PER_SIZE_CLASS = 64;
+
+  static const size_t DEFAULT_HIGH_WATER_MARK = 8 * 1024 * 1024;
+  static const size_t DEFAULT_LOW_WATER_MARK = 4 * 1024 * 1024;
+
+  struct Stats {
+    uint64_t cached_bytes; // Free memory held by the pool
+    uint64_t in_use_bytes; // Memory allocated from the pool and not yet released
+    uint64_t hits; // Allocations served from a free buffer
+    uint64_t misses; // Allocations of a new buffer for a size class
+    uint64_t unpooled; // Allocations too large for any size class
+    uint64_t trimmed_bytes; // Free memory released because of the high water mark
+  };
+
+  BufferPool(size_t high_water_mark = DEFAULT_HIGH_WATER_MARK,
+             size_t low_water_mark = DEFAULT_LOW_WATER_MARK);
+  ~BufferPool();
+
+  // Returns the capacity of the buffer that would be used for the size
+  static size_t capacity_for(size_t size);
+
+  // Returns a buffer of at least the requested size. Its capacity is
+  // written to "capacity" and must be passed back when it's released.
+  char* allocate(size_t size, size_t* capacity);
+  void release(char* buffer, size_t capacity);
+
+  // Creates a reference counted buffer whose memory is returned to this pool
+  // when its last reference is dropped
+  RefBuffer* create_ref_buffer(size_t size);
+
+  void stats(Stats* stats) const;
+
+private:
+  friend class RefBuffer;
+
+  static void release_ref_buffer(void* memory);
+
+  static size_t size_class(size_t capacity);
+  void trim();
+
+private:
+  typedef MPMCQueue<char*> BufferQueue;
+
+  const size_t high_water_mark_;
+  const size_t low_water_mark_;
+  BufferQueue* free_buffers_[NUM_SIZE_CLASSES];
+
+  Atomic<size_t> cached_bytes_;
+  Atomic<size_t> in_use_bytes_;
+  Atomic<uint64_t> hits_;
+  Atomic<uint64_t> misses_;
+  Atomic<uint64_t> unpooled_;
+  Atomic<uint64_t> trimmed_bytes_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+} // namespace cass
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "cluster.hpp"
 
+#include "compression.hpp"
 #include "constants.hpp"
 #include "dc_aware_policy.hpp"
 #include "external.hpp"
@@ -73,6 +74,17 @@ CassError cass_cluster_set_use_beta_protocol_version(CassCluster* cluster,
   return CASS_OK;
 }
 
+CassError cass_cluster_set_compression(CassCluster* cluster,
+                                       CassCompression compression) {
+  if (!cass::Compressor::is_supported(compression)) {
+    LOG_ERROR("Compression algorithm %s is not supported by this build of the driver",
+              cass::Compressor::to_string(compression));
+    return CASS_ERROR_LIB_NOT_IMPLEMENTED;
+  }
+  cluster->config().set_compression(compression);
+  return CASS_OK;
+}
+
 CassError cass_cluster_set_num_threads_io(CassCluster* cluster,
                                           unsigned num_threads) {
   if (num_threads == 0) {
@@ -82,6 +94,17 @@ CassError cass_cluster_set_num_threads_io(CassCluster* cluster,
   return CASS_OK;
 }
 
+CassError cass_cluster_set_num_threads_io_per_host(CassCluster* cluster,
+                                                   unsigned num_threads) {
+  cluster->config().set_thread_count_io_per_host(num_threads);
+  return CASS_OK;
+}
+
+void cass_cluster_set_on_demand_pool_idle_timeout(CassCluster* cluster,
+                                                  unsigned timeout_ms) {
+  cluster->config().set_on_demand_pool_idle_timeout_ms(timeout_ms);
+}
+
 CassError cass_cluster_set_queue_size_io(CassCluster* cluster,
                                          unsigned queue_size) {
   if (queue_size == 0) {
@@ -144,6 +167,17 @@ void cass_cluster_set_reconnect_wait_time(CassCluster* cluster,
   cluster->config().set_reconnect_wait_time(wait_time_ms);
 }
 
+CassError cass_cluster_set_exponential_reconnect(CassCluster* cluster,
+                                                 cass_uint64_t base_delay_ms,
+                                                 cass_uint64_t max_delay_ms) {
+  if (base_delay_ms == 0 || max_delay_ms < base_delay_ms) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_reconnection_policy(
+        new cass::ExponentialReconnectionPolicy(base_delay_ms, max_delay_ms));
+  return CASS_OK;
+}
+
 CassError cass_cluster_set_max_concurrent_creation(CassCluster* cluster,
                                                    unsigned num_connections) {
   if (num_connections == 0) {
@@ -162,6 +196,11 @@ CassError cass_cluster_set_max_concurrent_requests_threshold(CassCluster* cluste
   return CASS_OK;
 }
 
+void cass_cluster_set_connection_pool_resize_window(CassCluster* cluster,
+                                                    unsigned window_ms) {
+  cluster->config().set_connection_pool_resize_window_ms(window_ms);
+}
+
 CassError cass_cluster_set_max_requests_per_flush(CassCluster* cluster,
                                                   unsigned num_requests) {
   if (num_requests == 0) {
@@ -226,6 +265,11 @@ void cass_cluster_set_resolve_timeout(CassCluster* cluster,
   cluster->config().set_resolve_timeout(timeout_ms);
 }
 
+void cass_cluster_set_prefetch_pages(CassCluster* cluster,
+                                     unsigned pages) {
+  cluster->config().set_prefetch_pages(pages);
+}
+
 void cass_cluster_set_credentials(CassCluster* cluster,
                                   const char* username,
                                   const char* password) {
@@ -281,6 +325,39 @@ void cass_cluster_set_token_aware_routing(CassCluster* cluster,
   cluster->config().set_token_aware_routing(enabled == cass_true);
 }
 
+CassError cass_cluster_set_token_map_build_threads(CassCluster* cluster,
+                                                   unsigned num_threads) {
+  if (num_threads == 0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_token_map_build_threads(num_threads);
+  return CASS_OK;
+}
+
+void cass_cluster_set_token_map_lazy_replicas(CassCluster* cluster,
+                                              cass_bool_t enabled) {
+  cluster->config().set_token_map_lazy_replicas(enabled == cass_true);
+}
+
+void cass_cluster_set_power_of_two_choices_routing(CassCluster* cluster,
+                                                  cass_bool_t enabled) {
+  cluster->config().set_power_of_two_choices_routing(enabled == cass_true);
+}
+
+CassError cass_cluster_set_slow_start(CassCluster* cluster,
+                                      cass_uint64_t window_ms,
+                                      cass_double_t initial_weight) {
+  if (initial_weight < 0.0 || initial_weight > 1.0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cass::SlowStartPolicy::Settings settings;
+  settings.window_ns = window_ms * 1000LL * 1000LL; // Convert to nanoseconds
+  settings.initial_weight = initial_weight;
+  cluster->config().set_slow_start_settings(settings);
+  cluster->config().set_slow_start(window_ms > 0);
+  return CASS_OK;
+}
+
 void cass_cluster_set_latency_aware_routing(CassCluster* cluster,
                                             cass_bool_t enabled) {
   cluster->config().set_latency_aware_routing(enabled == cass_true);
@@ -455,6 +532,33 @@ CassError cass_cluster_set_constant_speculative_execution_policy(CassCluster* cl
   return CASS_OK;
 }
 
+CassError cass_cluster_set_percentile_speculative_execution_policy(CassCluster* cluster,
+                                                                   cass_double_t percentile,
+                                                                   int max_speculative_executions,
+                                                                   cass_double_t budget_percent) {
+  if (percentile <= 0.0 || percentile > 100.0 ||
+      max_speculative_executions < 0 || budget_percent < 0.0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cass::PercentileSpeculativeExecutionPolicy::Settings settings;
+  settings.percentile = percentile;
+  settings.max_speculative_executions = max_speculative_executions;
+  settings.budget_percent = budget_percent;
+  cluster->config().set_speculative_execution_policy(
+        new cass::PercentileSpeculativeExecutionPolicy(settings));
+  return CASS_OK;
+}
+
+CassError cass_cluster_set_retry_budget(CassCluster* cluster,
+                                       cass_double_t ratio,
+                                       unsigned max_tokens) {
+  if (ratio < 0.0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_retry_budget(ratio, max_tokens);
+  return CASS_OK;
+}
+
 CassError cass_cluster_set_no_speculative_execution_policy(CassCluster* cluster) {
   cluster->config().set_speculative_execution_policy(
         new cass::NoSpeculativeExecutionPolicy());
@@ -0,0 +1,163 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "completion_queue.hpp"
+
+#include "cassconfig.hpp"
+
+#if defined(HAVE_EVENTFD)
+#include <errno.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+
+CassCompletionQueue* cass_completion_queue_new() {
+  cass::CompletionQueue* queue = new cass::CompletionQueue();
+  if (queue->init() != 0) {
+    delete queue;
+    return NULL;
+  }
+  queue->inc_ref();
+  return CassCompletionQueue::to(queue);
+}
+
+void cass_completion_queue_free(CassCompletionQueue* queue) {
+  queue->dec_ref();
+}
+
+int cass_completion_queue_fd(const CassCompletionQueue* queue) {
+  return queue->fd();
+}
+
+size_t cass_completion_queue_next(CassCompletionQueue* queue,
+                                  CassCompletion* completions,
+                                  size_t count) {
+  return queue->next(completions, count);
+}
+
+} // extern "C"
+
+namespace cass {
+
+CompletionQueue::CompletionQueue()
+  : is_signaled_(false)
+  , read_fd_(-1)
+  , write_fd_(-1) { }
+
+CompletionQueue::~CompletionQueue() {
+  Future* future;
+  while ((future = queue_.dequeue()) != NULL) {
+    future->dec_ref();
+  }
+
+#if !defined(_WIN32)
+  if (read_fd_ >= 0) close(read_fd_);
+  if (write_fd_ >= 0 && write_fd_ != read_fd_) close(write_fd_);
+#endif
+}
+
+int CompletionQueue::init() {
+#if defined(HAVE_EVENTFD)
+  int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd < 0) return errno;
+  read_fd_ = write_fd_ = fd;
+#elif !defined(_WIN32)
+  int fds[2];
+  if (pipe(fds) != 0) return errno;
+  read_fd_ = fds[0];
+  write_fd_ = fds[1];
+  for (int i = 0; i < 2; ++i) {
+    if (fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK) != 0 ||
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC) != 0) {
+      return errno;
+    }
+  }
+#endif
+  return 0;
+}
+
+void CompletionQueue::post(Future* future) {
+  future->inc_ref(); // Queue reference
+  queue_.enqueue(future);
+  if (!is_signaled_.exchange(true, MEMORY_ORDER_ACQ_REL)) {
+    signal();
+  }
+}
+
+size_t CompletionQueue::next(CassCompletion* completions, size_t count) {
+  // The descriptor is cleared before the flag is reset, both before draining.
+  // Otherwise a post in between would have its write cleared while the flag
+  // stays set and no later post would signal the descriptor again.
+  clear_signal();
+  is_signaled_.store(false, MEMORY_ORDER_SEQ_CST);
+
+  size_t i = 0;
+  Future* future;
+  while (i < count && (future = queue_.dequeue()) != NULL) {
+    // The queue's reference is transferred to the application
+    completions[i].future = CassFuture::to(future);
+    completions[i].data = future->completion_data();
+    ++i;
+  }
+
+  // Keep the descriptor readable if there are still completions left
+  if (i == count && !is_signaled_.exchange(true, MEMORY_ORDER_ACQ_REL)) {
+    signal();
+  }
+
+  return i;
+}
+
+void CompletionQueue::signal() {
+#if defined(HAVE_EVENTFD)
+  uint64_t value = 1;
+  ssize_t rc;
+  do {
+    rc = write(write_fd_, &value, sizeof(value));
+  } while (rc < 0 && errno == EINTR);
+#elif !defined(_WIN32)
+  char value = 1;
+  ssize_t rc;
+  do {
+    rc = write(write_fd_, &value, sizeof(value));
+  } while (rc < 0 && errno == EINTR);
+#endif
+}
+
+void CompletionQueue::clear_signal() {
+#if defined(HAVE_EVENTFD)
+  uint64_t value;
+  ssize_t rc;
+  do {
+    rc = read(read_fd_, &value, sizeof(value));
+  } while (rc < 0 && errno == EINTR);
+#elif !defined(_WIN32)
+  char buf[64];
+  ssize_t rc;
+  do {
+    rc = read(read_fd_, buf, sizeof(buf));
+  } while (rc > 0 || (rc < 0 && errno == EINTR));
+#endif
+}
+
+} // namespace cass
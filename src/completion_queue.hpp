@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_COMPLETION_QUEUE_HPP_INCLUDED__
+#define __CASS_COMPLETION_QUEUE_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "cassandra.h"
+#include "external.hpp"
+#include "future.hpp"
+#include "macros.hpp"
+#include "mpsc_queue.hpp"
+#include "ref_counted.hpp"
+
+namespace cass {
+
+// Futures are posted to a completion queue when they're set. The queue is
+// drained by a single application thread which can wait on a file
+// descriptor (an eventfd on Linux and a pipe on other POSIX systems) that
+// becomes readable when completions are available. The descriptor is only
+// written once per drain, no matter how many futures are posted.
+class CompletionQueue : public RefCounted<CompletionQueue> {
+public:
+  typedef SharedRefPtr<CompletionQueue> Ptr;
+
+  CompletionQueue();
+  virtual ~CompletionQueue();
+
+  int init();
+
+  // Returns -1 if the platform doesn't support a file descriptor
+  int fd() const { return read_fd_; }
+
+  // This can be called on any thread
+  void post(Future* future);
+
+  // This can only be called by a single thread at a time
+  size_t next(CassCompletion* completions, size_t count);
+
+protected:
+  // Virtual so that tests can post completions while a drain is running
+  virtual void clear_signal();
+
+private:
+  void signal();
+
+private:
+  MPSCQueue<Future> queue_;
+  Atomic<bool> is_signaled_;
+  int read_fd_;
+  int write_fd_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(CompletionQueue);
+};
+
+} // namespace cass
+
+EXTERNAL_TYPE(cass::CompletionQueue, CassCompletionQueue)
+
+#endif
@@ -0,0 +1,181 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "compression.hpp"
+
+#include "cassconfig.hpp"
+#include "serialization.hpp"
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef HAVE_SNAPPY
+#include <snappy-c.h>
+#endif
+
+namespace cass {
+
+#ifdef HAVE_LZ4
+// The body is prefixed with the uncompressed length as a 4 byte big-endian
+// integer followed by a raw LZ4 block.
+class Lz4Compressor : public Compressor {
+public:
+  virtual const char* name() const { return "lz4"; }
+
+  virtual bool uncompressed_length(const char* input, size_t input_size,
+                                   size_t* length) const {
+    if (input_size < sizeof(int32_t)) return false;
+    int32_t temp;
+    decode_int32(const_cast<char*>(input), temp);
+    if (temp < 0) return false;
+    *length = static_cast<size_t>(temp);
+    return true;
+  }
+
+  virtual bool decompress(const char* input, size_t input_size,
+                          char* output, size_t output_size) const {
+    if (output_size == 0) return true;
+    int result = LZ4_decompress_safe(input + sizeof(int32_t), output,
+                                     static_cast<int>(input_size - sizeof(int32_t)),
+                                     static_cast<int>(output_size));
+    return result == static_cast<int>(output_size);
+  }
+
+protected:
+  virtual size_t max_compressed_length(size_t input_size) const {
+    return sizeof(int32_t) + LZ4_compressBound(static_cast<int>(input_size));
+  }
+
+  virtual bool internal_compress(const char* input, size_t input_size,
+                                 char* output, size_t* output_size) const {
+    encode_int32(output, static_cast<int32_t>(input_size));
+    int result = LZ4_compress_default(input, output + sizeof(int32_t),
+                                      static_cast<int>(input_size),
+                                      static_cast<int>(*output_size - sizeof(int32_t)));
+    if (result <= 0) return false;
+    *output_size = sizeof(int32_t) + result;
+    return true;
+  }
+};
+#endif
+
+#ifdef HAVE_SNAPPY
+// The body is a raw Snappy buffer which already encodes its uncompressed
+// length.
+class SnappyCompressor : public Compressor {
+public:
+  virtual const char* name() const { return "snappy"; }
+
+  virtual bool uncompressed_length(const char* input, size_t input_size,
+                                   size_t* length) const {
+    return snappy_uncompressed_length(input, input_size, length) == SNAPPY_OK;
+  }
+
+  virtual bool decompress(const char* input, size_t input_size,
+                          char* output, size_t output_size) const {
+    size_t length = output_size;
+    return snappy_uncompress(input, input_size, output, &length) == SNAPPY_OK &&
+        length == output_size;
+  }
+
+protected:
+  virtual size_t max_compressed_length(size_t input_size) const {
+    return snappy_max_compressed_length(input_size);
+  }
+
+  virtual bool internal_compress(const char* input, size_t input_size,
+                                 char* output, size_t* output_size) const {
+    return snappy_compress(input, input_size, output, output_size) == SNAPPY_OK;
+  }
+};
+#endif
+
+bool Compressor::is_supported(CassCompression compression) {
+  switch (compression) {
+    case CASS_COMPRESSION_NONE:
+      return true;
+#ifdef HAVE_LZ4
+    case CASS_COMPRESSION_LZ4:
+      return true;
+#endif
+#ifdef HAVE_SNAPPY
+    case CASS_COMPRESSION_SNAPPY:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* Compressor::to_string(CassCompression compression) {
+  switch (compression) {
+    case CASS_COMPRESSION_NONE:
+      return "none";
+    case CASS_COMPRESSION_LZ4:
+      return "lz4";
+    case CASS_COMPRESSION_SNAPPY:
+      return "snappy";
+    default:
+      return "unknown";
+  }
+}
+
+Compressor* Compressor::create(CassCompression compression) {
+  switch (compression) {
+#ifdef HAVE_LZ4
+    case CASS_COMPRESSION_LZ4:
+      return new Lz4Compressor();
+#endif
+#ifdef HAVE_SNAPPY
+    case CASS_COMPRESSION_SNAPPY:
+      return new SnappyCompressor();
+#endif
+    default:
+      return NULL;
+  }
+}
+
+bool Compressor::compress(const BufferVec& bufs, size_t first, size_t size,
+                          Buffer* output) {
+  const char* input = NULL;
+
+  // Avoid copying the body if it's already contiguous
+  if (bufs.size() - first == 1) {
+    input = bufs[first].data();
+  } else {
+    input_.resize(size);
+    size_t pos = 0;
+    for (size_t i = first; i < bufs.size(); ++i) {
+      const Buffer& buf = bufs[i];
+      memcpy(&input_[pos], buf.data(), buf.size());
+      pos += buf.size();
+    }
+    assert(pos == size);
+    input = &input_[0];
+  }
+
+  size_t output_size = max_compressed_length(size);
+  output_.resize(output_size);
+  if (!internal_compress(input, size, &output_[0], &output_size)) {
+    return false;
+  }
+
+  *output = Buffer(&output_[0], output_size);
+  return true;
+}
+
+} // namespace cass
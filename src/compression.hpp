@@ -0,0 +1,73 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_COMPRESSION_HPP_INCLUDED__
+#define __CASS_COMPRESSION_HPP_INCLUDED__
+
+#include "buffer.hpp"
+#include "cassandra.h"
+#include "macros.hpp"
+
+#include <vector>
+
+namespace cass {
+
+// Compresses and decompresses frame bodies. An instance is owned by a single
+// connection so the scratch space used to build compressed frames is reused
+// without any synchronization.
+class Compressor {
+public:
+  Compressor() { }
+  virtual ~Compressor() { }
+
+  static bool is_supported(CassCompression compression);
+  static const char* to_string(CassCompression compression);
+
+  // Returns NULL if the driver wasn't built with support for the algorithm
+  static Compressor* create(CassCompression compression);
+
+  // The algorithm's name as it appears in the SUPPORTED and STARTUP messages
+  virtual const char* name() const = 0;
+
+  // Compresses the "size" bytes of the frame body stored in "bufs" starting
+  // at index "first" into a single buffer.
+  bool compress(const BufferVec& bufs, size_t first, size_t size,
+                Buffer* output);
+
+  virtual bool uncompressed_length(const char* input, size_t input_size,
+                                   size_t* length) const = 0;
+
+  // "output_size" must be the value returned by uncompressed_length()
+  virtual bool decompress(const char* input, size_t input_size,
+                          char* output, size_t output_size) const = 0;
+
+protected:
+  virtual size_t max_compressed_length(size_t input_size) const = 0;
+
+  virtual bool internal_compress(const char* input, size_t input_size,
+                                 char* output, size_t* output_size) const = 0;
+
+private:
+  std::vector<char> input_;
+  std::vector<char> output_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(Compressor);
+};
+
+} // namespace cass
+
+#endif
@@ -23,10 +23,14 @@
 #include "dc_aware_policy.hpp"
 #include "host_targeting_policy.hpp"
 #include "latency_aware_policy.hpp"
+#include "power_of_two_choices_policy.hpp"
+#include "reconnection_policy.hpp"
 #include "retry_policy.hpp"
+#include "slow_start_policy.hpp"
 #include "ssl.hpp"
 #include "timestamp_generator.hpp"
 #include "token_aware_policy.hpp"
+#include "token_map.hpp"
 #include "whitelist_policy.hpp"
 #include "blacklist_policy.hpp"
 #include "whitelist_dc_policy.hpp"
@@ -46,16 +50,20 @@ public:
       : port_(9042)
       , protocol_version_(CASS_HIGHEST_SUPPORTED_PROTOCOL_VERSION)
       , use_beta_protocol_version_(false)
+      , compression_(CASS_COMPRESSION_NONE)
       , thread_count_io_(1)
+      , thread_count_io_per_host_(0)
+      , on_demand_pool_idle_timeout_ms_(10000)
       , queue_size_io_(8192)
       , queue_size_event_(8192)
       , queue_size_log_(8192)
       , core_connections_per_host_(1)
       , max_connections_per_host_(2)
-      , reconnect_wait_time_ms_(2000)
+      , reconnection_policy_(new ConstantReconnectionPolicy(2000))
       , max_concurrent_creation_(1)
       , max_requests_per_flush_(128)
       , max_concurrent_requests_threshold_(100)
+      , connection_pool_resize_window_ms_(0) // Disabled
       , write_bytes_high_water_mark_(64 * 1024)
       , write_bytes_low_water_mark_(32 * 1024)
       , pending_requests_high_water_mark_(128 * max_connections_per_host_)
@@ -63,13 +71,18 @@ public:
       , connect_timeout_ms_(5000)
       , request_timeout_ms_(12000)
       , resolve_timeout_ms_(2000)
+      , prefetch_pages_(0)
       , log_level_(CASS_LOG_WARN)
       , log_callback_(stderr_log_callback)
       , log_data_(NULL)
       , auth_provider_(new AuthProvider())
       , load_balancing_policy_(new DCAwarePolicy())
       , speculative_execution_policy_(new NoSpeculativeExecutionPolicy())
+      , retry_budget_ratio_(0.1)
+      , retry_budget_max_tokens_(0)
       , token_aware_routing_(true)
+      , power_of_two_choices_routing_(false)
+      , slow_start_(false)
       , latency_aware_routing_(false)
       , host_targeting_(false)
       , tcp_nodelay_enable_(true)
@@ -83,12 +96,33 @@ public:
       , use_hostname_resolution_(false)
       , use_randomized_contact_points_(true) { }
 
+  CassCompression compression() const { return compression_; }
+
+  void set_compression(CassCompression compression) {
+    compression_ = compression;
+  }
+
   unsigned thread_count_io() const { return thread_count_io_; }
 
   void set_thread_count_io(unsigned num_threads) {
     thread_count_io_ = num_threads;
   }
 
+  // Zero means that every IO worker has a pool for every host
+  unsigned thread_count_io_per_host() const { return thread_count_io_per_host_; }
+
+  void set_thread_count_io_per_host(unsigned num_threads) {
+    thread_count_io_per_host_ = num_threads;
+  }
+
+  unsigned on_demand_pool_idle_timeout_ms() const {
+    return on_demand_pool_idle_timeout_ms_;
+  }
+
+  void set_on_demand_pool_idle_timeout_ms(unsigned timeout_ms) {
+    on_demand_pool_idle_timeout_ms_ = timeout_ms;
+  }
+
   unsigned queue_size_io() const { return queue_size_io_; }
 
   void set_queue_size_io(unsigned queue_size) {
@@ -161,10 +195,16 @@ public:
     pending_requests_low_water_mark_ = pending_requests_low_water_mark;
   }
 
-  unsigned reconnect_wait_time_ms() const { return reconnect_wait_time_ms_; }
+  const ReconnectionPolicy::Ptr& reconnection_policy() const {
+    return reconnection_policy_;
+  }
+
+  void set_reconnection_policy(ReconnectionPolicy* reconnection_policy) {
+    reconnection_policy_.reset(reconnection_policy);
+  }
 
   void set_reconnect_wait_time(unsigned wait_time_ms) {
-    reconnect_wait_time_ms_ = wait_time_ms;
+    reconnection_policy_.reset(new ConstantReconnectionPolicy(wait_time_ms));
   }
 
   unsigned max_requests_per_flush() const { return max_requests_per_flush_; }
@@ -181,6 +221,15 @@ public:
     max_concurrent_requests_threshold_ = num_requests;
   }
 
+  // Zero disables resizing connection pools based on their measured load
+  unsigned connection_pool_resize_window_ms() const {
+    return connection_pool_resize_window_ms_;
+  }
+
+  void set_connection_pool_resize_window_ms(unsigned window_ms) {
+    connection_pool_resize_window_ms_ = window_ms;
+  }
+
   unsigned connect_timeout_ms() const { return connect_timeout_ms_; }
 
   void set_connect_timeout(unsigned timeout_ms) {
@@ -199,6 +248,12 @@ public:
     resolve_timeout_ms_ = timeout_ms;
   }
 
+  unsigned prefetch_pages() const { return prefetch_pages_; }
+
+  void set_prefetch_pages(unsigned prefetch_pages) {
+    prefetch_pages_ = prefetch_pages;
+  }
+
   const ContactPointList& contact_points() const {
     return contact_points_;
   }
@@ -254,7 +309,7 @@ public:
 
   LoadBalancingPolicy* load_balancing_policy() const {
     // The base LBP can be augmented by special wrappers (whitelist,
-    // token aware, latency aware)
+    // token aware, power of two choices, slow start, latency aware)
     LoadBalancingPolicy* chain = load_balancing_policy_->new_instance();
     if (!blacklist_.empty()) {
       chain = new BlacklistPolicy(chain, blacklist_);
@@ -271,6 +326,12 @@ public:
     if (token_aware_routing()) {
       chain = new TokenAwarePolicy(chain);
     }
+    if (power_of_two_choices_routing()) {
+      chain = new PowerOfTwoChoicesPolicy(chain);
+    }
+    if (slow_start()) {
+      chain = new SlowStartPolicy(chain, slow_start_settings_);
+    }
     if (latency_aware()) {
       chain = new LatencyAwarePolicy(chain, latency_aware_routing_settings_);
     }
@@ -294,6 +355,15 @@ public:
     speculative_execution_policy_.reset(sep);
   }
 
+  double retry_budget_ratio() const { return retry_budget_ratio_; }
+
+  unsigned retry_budget_max_tokens() const { return retry_budget_max_tokens_; }
+
+  void set_retry_budget(double ratio, unsigned max_tokens) {
+    retry_budget_ratio_ = ratio;
+    retry_budget_max_tokens_ = max_tokens;
+  }
+
   SslContext* ssl_context() const { return ssl_context_.get(); }
 
   void set_ssl_context(SslContext* ssl_context) {
@@ -304,6 +374,30 @@ public:
 
   void set_token_aware_routing(bool is_token_aware) { token_aware_routing_ = is_token_aware; }
 
+  const TokenMap::BuildSettings& token_map_build_settings() const { return token_map_build_settings_; }
+
+  void set_token_map_build_threads(unsigned num_threads) {
+    token_map_build_settings_.num_threads = num_threads;
+  }
+
+  void set_token_map_lazy_replicas(bool is_lazy) {
+    token_map_build_settings_.is_lazy = is_lazy;
+  }
+
+  bool power_of_two_choices_routing() const { return power_of_two_choices_routing_; }
+
+  void set_power_of_two_choices_routing(bool is_power_of_two_choices) {
+    power_of_two_choices_routing_ = is_power_of_two_choices;
+  }
+
+  bool slow_start() const { return slow_start_; }
+
+  void set_slow_start(bool is_slow_start) { slow_start_ = is_slow_start; }
+
+  void set_slow_start_settings(const SlowStartPolicy::Settings& settings) {
+    slow_start_settings_ = settings;
+  }
+
   bool latency_aware() const { return latency_aware_routing_; }
 
   void set_latency_aware_routing(bool is_latency_aware) { latency_aware_routing_ = is_latency_aware; }
@@ -399,17 +493,21 @@ private:
   int port_;
   int protocol_version_;
   bool use_beta_protocol_version_;
+  CassCompression compression_;
   ContactPointList contact_points_;
   unsigned thread_count_io_;
+  unsigned thread_count_io_per_host_;
+  unsigned on_demand_pool_idle_timeout_ms_;
   unsigned queue_size_io_;
   unsigned queue_size_event_;
   unsigned queue_size_log_;
   unsigned core_connections_per_host_;
   unsigned max_connections_per_host_;
-  unsigned reconnect_wait_time_ms_;
+  ReconnectionPolicy::Ptr reconnection_policy_;
   unsigned max_concurrent_creation_;
   unsigned max_requests_per_flush_;
   unsigned max_concurrent_requests_threshold_;
+  unsigned connection_pool_resize_window_ms_;
   unsigned write_bytes_high_water_mark_;
   unsigned write_bytes_low_water_mark_;
   unsigned pending_requests_high_water_mark_;
@@ -417,14 +515,21 @@ private:
   unsigned connect_timeout_ms_;
   unsigned request_timeout_ms_;
   unsigned resolve_timeout_ms_;
+  unsigned prefetch_pages_;
   CassLogLevel log_level_;
   CassLogCallback log_callback_;
   void* log_data_;
   AuthProvider::Ptr auth_provider_;
   LoadBalancingPolicy::Ptr load_balancing_policy_;
   SharedRefPtr<SpeculativeExecutionPolicy> speculative_execution_policy_;
+  double retry_budget_ratio_;
+  unsigned retry_budget_max_tokens_;
   SslContext::Ptr ssl_context_;
   bool token_aware_routing_;
+  TokenMap::BuildSettings token_map_build_settings_;
+  bool power_of_two_choices_routing_;
+  bool slow_start_;
+  SlowStartPolicy::Settings slow_start_settings_;
   bool latency_aware_routing_;
   bool host_targeting_;
   LatencyAwarePolicy::Settings latency_aware_routing_settings_;
@@ -47,8 +47,6 @@
 #define SSL_WRITE_SIZE 8192
 #define SSL_ENCRYPTED_BUFS_COUNT 16
 
-#define MAX_BUFFER_REUSE_NO 8
-#define BUFFER_REUSE_SIZE 64 * 1024
 
 #if UV_VERSION_MAJOR == 0
 #define UV_ERRSTR(status, loop) uv_strerror(uv_last_error(loop))
@@ -212,6 +210,7 @@ void Connection::HeartbeatCallback::on_internal_timeout() {
 Connection::Connection(uv_loop_t* loop,
                        const Config& config,
                        Metrics* metrics,
+                       BufferPool* buffer_pool,
                        const Host::ConstPtr& host,
                        const std::string& keyspace,
                        int protocol_version,
@@ -220,17 +219,23 @@ Connection::Connection(uv_loop_t* loop,
     , error_code_(CONNECTION_OK)
     , ssl_error_code_(CASS_OK)
     , pending_writes_size_(0)
+    , is_host_load_enabled_(config.power_of_two_choices_routing())
+    , reported_inflight_request_count_(0)
+    , reported_pending_write_bytes_(0)
     , loop_(loop)
     , config_(config)
     , metrics_(metrics)
+    , buffer_pool_(buffer_pool)
     , host_(host)
     , keyspace_(keyspace)
     , protocol_version_(protocol_version)
     , listener_(listener)
-    , response_(new ResponseMessage())
+    , response_(new ResponseMessage(NULL, buffer_pool))
     , stream_manager_(protocol_version)
     , ssl_session_(NULL)
-    , heartbeat_outstanding_(false) {
+    , heartbeat_outstanding_(false)
+    , last_write_time_(0)
+    , last_read_time_(0) {
   socket_.data = this;
   uv_tcp_init(loop_, &socket_);
 
@@ -251,14 +256,7 @@ Connection::Connection(uv_loop_t* loop,
   }
 }
 
-Connection::~Connection()
-{
-  while (!buffer_reuse_list_.empty()) {
-    uv_buf_t buf = buffer_reuse_list_.top();
-    delete[] buf.base;
-    buffer_reuse_list_.pop();
-  }
-}
+Connection::~Connection() { }
 
 void Connection::connect() {
   if (state_ == CONNECTION_STATE_NEW) {
@@ -272,6 +270,7 @@ void Connection::connect() {
 bool Connection::write(const RequestCallback::Ptr& callback, bool flush_immediately) {
   int32_t result = internal_write(callback, flush_immediately);
   if (result > 0) {
+    update_host_load(stream_manager_.pending_streams(), pending_writes_size_);
     restart_heartbeat_timer();
   }
   return result != Request::REQUEST_ERROR_NO_AVAILABLE_STREAM_IDS;
@@ -310,6 +309,11 @@ int32_t Connection::internal_write(const RequestCallback::Ptr& callback, bool fl
         // Already handled
         break;
 
+      case Request::REQUEST_ERROR_COMPRESSION:
+        callback->on_error(CASS_ERROR_LIB_MESSAGE_ENCODE,
+                           "Unable to compress the request");
+        break;
+
       default:
         callback->on_error(CASS_ERROR_LIB_MESSAGE_ENCODE,
                            "Operation unsupported by this protocol version");
@@ -466,9 +470,22 @@ void Connection::consume(char* input, size_t size) {
       continue;
     }
 
+    if (response_->is_row_stream_pending()) {
+      // Stream the rows to the request's callback if it wants them as they
+      // arrive, otherwise the body is buffered.
+      RequestCallback* callback = NULL;
+      if (response_->stream() >= 0 &&
+          stream_manager_.get_pending(response_->stream(), callback) &&
+          callback->is_streaming_rows()) {
+        response_->start_row_stream(RequestCallback::Ptr(callback));
+      } else {
+        response_->start_row_stream(RequestCallback::Ptr());
+      }
+    }
+
     if (response_->is_body_ready()) {
       ScopedPtr<ResponseMessage> response(response_.release());
-      response_.reset(new ResponseMessage());
+      response_.reset(new ResponseMessage(compressor_.get(), buffer_pool_));
 
       LOG_TRACE("Consumed message type %s with stream %d, input %u, remaining %u on host %s",
                 opcode_to_string(response->opcode()).c_str(),
@@ -536,6 +553,8 @@ void Connection::consume(char* input, size_t size) {
     remaining -= consumed;
     buffer += consumed;
   }
+
+  update_host_load(stream_manager_.pending_streams(), pending_writes_size_);
 }
 
 void Connection::maybe_set_keyspace(ResponseMessage* response) {
@@ -625,29 +644,26 @@ void Connection::on_close(uv_handle_t* handle) {
     delete pending_schema_aggreement;
   }
 
+  // The requests that were still pending on this connection are no longer
+  // part of the host's load
+  connection->update_host_load(0, 0);
+
   connection->listener_->on_close(connection);
 
   delete connection;
 }
 
+// Read buffers are only held for the duration of a read callback so they're
+// returned to the event loop's buffer pool right away instead of being kept
+// by idle connections.
 uv_buf_t Connection::internal_alloc_buffer(size_t suggested_size) {
-  if (suggested_size <= BUFFER_REUSE_SIZE) {
-    if (!buffer_reuse_list_.empty()) {
-      uv_buf_t ret = buffer_reuse_list_.top();
-      buffer_reuse_list_.pop();
-      return ret;
-    }
-    return uv_buf_init(new char[BUFFER_REUSE_SIZE], BUFFER_REUSE_SIZE);
-  }
-  return uv_buf_init(new char[suggested_size], suggested_size);
+  size_t capacity;
+  char* base = buffer_pool_->allocate(suggested_size, &capacity);
+  return uv_buf_init(base, capacity);
 }
 
 void Connection::internal_reuse_buffer(uv_buf_t buf) {
-  if (buf.len == BUFFER_REUSE_SIZE && buffer_reuse_list_.size() < MAX_BUFFER_REUSE_NO) {
-    buffer_reuse_list_.push(buf);
-    return;
-  }
-  delete[] buf.base;
+  buffer_pool_->release(buf.base, buf.len);
 }
 
 #if UV_VERSION_MAJOR == 0
@@ -816,12 +832,24 @@ void Connection::on_supported(ResponseMessage* response) {
   SupportedResponse* supported =
       static_cast<SupportedResponse*>(response->response_body().get());
 
-  // TODO(mstump) do something with the supported info
-  (void)supported;
+  CassCompression compression = config_.compression();
+  if (compression != CASS_COMPRESSION_NONE) {
+    ScopedPtr<Compressor> compressor(Compressor::create(compression));
+    if (compressor && supported->supports_compression(compressor->name())) {
+      compressor_.reset(compressor.release());
+      // The response to the STARTUP message is decoded using the message
+      // that's already been allocated.
+      response_->set_compressor(compressor_.get());
+    } else {
+      LOG_WARN("Host %s doesn't support %s compression. Frames will be sent uncompressed",
+               host_->address_string().c_str(),
+               Compressor::to_string(compression));
+    }
+  }
 
   internal_write(RequestCallback::Ptr(
                    new StartupCallback(Request::ConstPtr(
-                                         new StartupRequest()))));
+                                         new StartupRequest(compressor_ ? compressor_->name() : "")))));
 }
 
 void Connection::on_pending_schema_agreement(Timer* timer) {
@@ -914,17 +942,46 @@ void Connection::send_initial_auth_response(const std::string& class_name) {
   }
 }
 
+// Hosts are shared by the connections of every IO worker so each connection
+// only adds the difference from what it last reported
+void Connection::update_host_load(size_t inflight_request_count,
+                                  size_t pending_write_bytes) {
+  if (!is_host_load_enabled_) return;
+
+  host_->update_load(static_cast<int64_t>(inflight_request_count) -
+                     static_cast<int64_t>(reported_inflight_request_count_),
+                     static_cast<int64_t>(pending_write_bytes) -
+                     static_cast<int64_t>(reported_pending_write_bytes_));
+  reported_inflight_request_count_ = inflight_request_count;
+  reported_pending_write_bytes_ = pending_write_bytes;
+}
+
+// The heartbeat and terminate timers are restarted on every write and read.
+// Instead of re-arming a timer each time only the time of the last activity
+// is recorded and the timers re-arm themselves for the remaining interval
+// when they expire.
 void Connection::restart_heartbeat_timer() {
   if (config_.connection_heartbeat_interval_secs() > 0) {
-    heartbeat_timer_.start(loop_,
-                           1000 * config_.connection_heartbeat_interval_secs(),
-                           this, on_heartbeat);
+    last_write_time_ = uv_now(loop_);
+    if (!heartbeat_timer_.is_running()) {
+      heartbeat_timer_.start(loop_,
+                             1000 * config_.connection_heartbeat_interval_secs(),
+                             this, on_heartbeat);
+    }
   }
 }
 
 void Connection::on_heartbeat(Timer* timer) {
   Connection* connection = static_cast<Connection*>(timer->data());
 
+  uint64_t interval = 1000 * connection->config_.connection_heartbeat_interval_secs();
+  uint64_t elapsed = uv_now(connection->loop_) - connection->last_write_time_;
+  if (elapsed < interval) {
+    connection->heartbeat_timer_.start(connection->loop_, interval - elapsed,
+                                       connection, on_heartbeat);
+    return;
+  }
+
   if (!connection->heartbeat_outstanding_) {
     if (!connection->internal_write(RequestCallback::Ptr(new HeartbeatCallback()))) {
       // Recycling only this connection with a timeout error. This is unlikely and
@@ -946,14 +1003,25 @@ void Connection::restart_terminate_timer() {
   // otherwise connections would be terminated in periods of request inactivity.
   if (config_.connection_heartbeat_interval_secs() > 0 &&
       config_.connection_idle_timeout_secs() > 0) {
-    terminate_timer_.start(loop_,
-                      1000 * config_.connection_idle_timeout_secs(),
-                      this, on_terminate);
+    last_read_time_ = uv_now(loop_);
+    if (!terminate_timer_.is_running()) {
+      terminate_timer_.start(loop_,
+                             1000 * config_.connection_idle_timeout_secs(),
+                             this, on_terminate);
+    }
   }
 }
 
 void Connection::on_terminate(Timer* timer) {
   Connection* connection = static_cast<Connection*>(timer->data());
+
+  uint64_t interval = 1000 * connection->config_.connection_idle_timeout_secs();
+  uint64_t elapsed = uv_now(connection->loop_) - connection->last_read_time_;
+  if (elapsed < interval) {
+    connection->terminate_timer_.start(connection->loop_, interval - elapsed,
+                                       connection, on_terminate);
+    return;
+  }
   connection->notify_error("Failed to send a heartbeat within connection idle interval. "
                            "Terminating connection...",
                            CONNECTION_ERROR_TIMEOUT);
@@ -969,7 +1037,8 @@ Connection::PendingWriteBase::~PendingWriteBase() {
 
 int32_t Connection::PendingWriteBase::write(RequestCallback* callback) {
   size_t last_buffer_size = buffers_.size();
-  int32_t request_size = callback->encode(connection_->protocol_version_, 0x00, &buffers_);
+  int32_t request_size = callback->encode(connection_->protocol_version_, 0x00,
+                                          connection_->compressor_.get(), &buffers_);
   if (request_size < 0) {
     buffers_.resize(last_buffer_size); // rollback
     return request_size;
@@ -1048,6 +1117,9 @@ void Connection::PendingWriteBase::on_write(uv_write_t* req, int status) {
     }
   }
 
+  connection->update_host_load(connection->stream_manager_.pending_streams(),
+                               connection->pending_writes_size_);
+
   connection->pending_writes_.remove(pending_write);
   delete pending_write;
 
@@ -18,7 +18,9 @@
 #define __CASS_CONNECTION_HPP_INCLUDED__
 
 #include "buffer.hpp"
+#include "buffer_pool.hpp"
 #include "cassandra.h"
+#include "compression.hpp"
 #include "request_callback.hpp"
 #include "hash.hpp"
 #include "host.hpp"
@@ -36,7 +38,6 @@
 
 #include <uv.h>
 
-#include <stack>
 
 namespace cass {
 
@@ -99,6 +100,7 @@ public:
   Connection(uv_loop_t* loop,
              const Config& config,
              Metrics* metrics,
+             BufferPool* buffer_pool,
              const Host::ConstPtr& host,
              const std::string& keyspace,
              int protocol_version,
@@ -150,6 +152,7 @@ public:
 
   size_t available_streams() const { return stream_manager_.available_streams(); }
   size_t pending_request_count() const { return stream_manager_.pending_streams(); }
+  size_t pending_writes_size() const { return pending_writes_size_; }
 
   static void on_timeout(Timer* timer);
 
@@ -304,6 +307,10 @@ private:
   void send_initial_auth_response(const std::string& class_name);
 
   void restart_heartbeat_timer();
+  // Publishes the change in this connection's load to its host. This is only
+  // done when the load is used to route requests (power of two choices).
+  void update_host_load(size_t inflight_request_count, size_t pending_write_bytes);
+
   static void on_heartbeat(Timer* timer);
   void restart_terminate_timer();
   static void on_terminate(Timer* timer);
@@ -315,6 +322,9 @@ private:
   CassError ssl_error_code_;
 
   size_t pending_writes_size_;
+  bool is_host_load_enabled_;
+  size_t reported_inflight_request_count_;
+  size_t reported_pending_write_bytes_;
   List<PendingWriteBase> pending_writes_;
   List<RequestCallback> pending_reads_;
   List<PendingSchemaAgreement> pending_schema_agreements_;
@@ -322,11 +332,13 @@ private:
   uv_loop_t* loop_;
   const Config& config_;
   Metrics* metrics_;
+  BufferPool* buffer_pool_;
   Host::ConstPtr host_;
   std::string keyspace_;
   const int protocol_version_;
   Listener* listener_;
 
+  ScopedPtr<Compressor> compressor_;
   ScopedPtr<ResponseMessage> response_;
   StreamManager<RequestCallback*> stream_manager_;
 
@@ -337,9 +349,10 @@ private:
   bool heartbeat_outstanding_;
   Timer heartbeat_timer_;
   Timer terminate_timer_;
+  uint64_t last_write_time_;
+  uint64_t last_read_time_;
 
   // buffer reuse for libuv
-  std::stack<uv_buf_t> buffer_reuse_list_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(Connection);
@@ -95,6 +95,8 @@
 
 #define CASS_HEADER_SIZE_V1_AND_V2 8
 #define CASS_HEADER_SIZE_V3 9
+// The server rejects frames larger than this by default
+#define CASS_MAX_FRAME_BODY_SIZE (256 * 1024 * 1024)
 
 #define CASS_HIGHEST_SUPPORTED_PROTOCOL_VERSION 4
 #define CASS_NEWEST_BETA_PROTOCOL_VERSION 5
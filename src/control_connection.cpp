@@ -136,6 +136,7 @@ void ControlConnection::clear() {
   session_ = NULL;
   connection_ = NULL;
   reconnect_timer_.stop();
+  reconnection_schedule_.reset();
   query_plan_.reset();
   protocol_version_ = 0;
   last_connection_error_.clear();
@@ -188,7 +189,25 @@ void ControlConnection::reconnect(bool retry_current_host) {
     current_host_ = query_plan_->compute_next();
     if (!current_host_) {
       if (state_ == CONTROL_STATE_READY) {
-        schedule_reconnect(1000); // TODO(mpenick): Configurable?
+        // A constant delay only applies to the pools. The control connection
+        // keeps its shorter delay.
+        uint64_t delay_ms = 1000;
+        const ReconnectionPolicy::Ptr& policy(session_->config().reconnection_policy());
+        if (policy->type() != ReconnectionPolicy::CONSTANT) {
+          if (!reconnection_schedule_) {
+            // This needs to be done on the session thread because it could
+            // pause generating a new random seed.
+            if (!session_->random_) {
+              session_->random_.reset(new Random());
+            }
+            reconnection_schedule_.reset(policy->new_schedule(session_->random_.get()));
+          }
+          delay_ms = reconnection_schedule_->next_delay_ms();
+        }
+        LOG_INFO("No hosts available for the control connection. "
+                 "Scheduling reconnect in %llu ms",
+                 static_cast<unsigned long long>(delay_ms));
+        schedule_reconnect(delay_ms);
       } else {
         session_->on_control_connection_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
                                               "No hosts available for the control connection");
@@ -204,6 +223,7 @@ void ControlConnection::reconnect(bool retry_current_host) {
   connection_ = new Connection(session_->loop(),
                                session_->config(),
                                session_->metrics(),
+                               session_->buffer_pool(),
                                current_host_,
                                "", // No keyspace
                                protocol_version_,
@@ -215,6 +235,8 @@ void ControlConnection::on_ready(Connection* connection) {
   LOG_DEBUG("Connection ready on host %s",
             connection->address().to_string().c_str());
 
+  reconnection_schedule_.reset();
+
   // The control connection has to refresh meta when there's a reconnect because
   // events could have been missed while not connected.
   query_meta_hosts();
@@ -298,7 +320,8 @@ void ControlConnection::on_event(EventResponse* response) {
           if (host) {
             session_->on_remove(host);
             if (session_->token_map_) {
-              session_->token_map_->remove_host_and_build(host);
+              session_->token_map_for_update()->remove_host_and_build(host);
+              session_->publish_token_map();
             }
           } else {
             LOG_DEBUG("Tried to remove host %s that doesn't exist", address_str.c_str());
@@ -314,7 +337,8 @@ void ControlConnection::on_event(EventResponse* response) {
           } else {
             LOG_DEBUG("Move event for host %s that doesn't exist", address_str.c_str());
             if (session_->token_map_) {
-              session_->token_map_->remove_host_and_build(host);
+              session_->token_map_for_update()->remove_host_and_build(host);
+              session_->publish_token_map();
             }
           }
           break;
@@ -431,8 +455,9 @@ void ControlConnection::on_query_hosts(ControlConnection* control_connection,
   Session* session = control_connection->session_;
 
   if (session->token_map_) {
-    // Clearing token/hosts will not invalidate the replicas
-    session->token_map_->clear_tokens_and_hosts();
+    // Clearing token/hosts will not invalidate the replicas. The cleared map
+    // isn't published until it's rebuilt.
+    session->token_map_for_update()->clear_tokens_and_hosts();
   }
 
   bool is_initial_connection = (control_connection->state_ == CONTROL_STATE_NEW);
@@ -563,12 +588,14 @@ void ControlConnection::on_query_meta_schema(ControlConnection* control_connecti
   bool is_initial_connection = (control_connection->state_ == CONTROL_STATE_NEW);
 
   if (session->token_map_) {
+    TokenMap* token_map = session->token_map_for_update();
     ResultResponse* keyspaces_result;
     if (MultipleRequestCallback::get_result_response(responses, "keyspaces", &keyspaces_result)) {
-      session->token_map_->clear_replicas_and_strategies(); // Only clear replicas once we have the new keyspaces
-      session->token_map_->add_keyspaces(cassandra_version, keyspaces_result);
+      token_map->clear_replicas_and_strategies(); // Only clear replicas once we have the new keyspaces
+      token_map->add_keyspaces(cassandra_version, keyspaces_result);
     }
-    session->token_map_->build();
+    token_map->build();
+    session->publish_token_map();
   }
 
   if (control_connection->use_schema_) {
@@ -763,11 +790,11 @@ void ControlConnection::update_node_info(Host::Ptr host, const Row* row, UpdateH
   if ((!rack.empty() && rack != host->rack()) ||
       (!dc.empty() && dc != host->dc())) {
     if (!host->was_just_added()) {
-      session_->load_balancing_policy_->on_remove(host);
+      session_->policy_on_remove(host);
     }
     host->set_rack_and_dc(rack, dc);
     if (!host->was_just_added()) {
-      session_->load_balancing_policy_->on_add(host);
+      session_->policy_on_add(host);
     }
   }
 
@@ -785,16 +812,18 @@ void ControlConnection::update_node_info(Host::Ptr host, const Row* row, UpdateH
     std::string partitioner;
     if (is_connected_host && row->get_string_by_name("partitioner", &partitioner)) {
       if (!session_->token_map_) {
-        session_->token_map_.reset(TokenMap::from_partitioner(partitioner));
+        session_->set_token_map(TokenMap::from_partitioner(partitioner,
+                                                           session_->config().token_map_build_settings()));
       }
     }
     v = row->get_by_name("tokens");
     if (v != NULL && v->is_collection()) {
       if (session_->token_map_) {
         if (type == UPDATE_HOST_AND_BUILD) {
-          session_->token_map_->update_host_and_build(host, v);
+          session_->token_map_for_update()->update_host_and_build(host, v);
+          session_->publish_token_map();
         } else {
-          session_->token_map_->add_host(host, v);
+          session_->token_map_for_update()->add_host(host, v);
         }
       }
     }
@@ -842,7 +871,8 @@ void ControlConnection::on_refresh_keyspace(ControlConnection* control_connectio
   const VersionNumber& cassandra_version = control_connection->cassandra_version_;
 
   if (session->token_map_) {
-    session->token_map_->update_keyspaces_and_build(cassandra_version, result);
+    session->token_map_for_update()->update_keyspaces_and_build(cassandra_version, result);
+    session->publish_token_map();
   }
 
   if (control_connection->use_schema_) {
@@ -24,6 +24,7 @@
 #include "host.hpp"
 #include "load_balancing.hpp"
 #include "macros.hpp"
+#include "reconnection_policy.hpp"
 #include "response.hpp"
 #include "scoped_ptr.hpp"
 #include "token_map.hpp"
@@ -250,6 +251,7 @@ private:
   Session* session_;
   Connection* connection_;
   Timer reconnect_timer_;
+  ReconnectionSchedule::Ptr reconnection_schedule_;
   ScopedPtr<QueryPlan> query_plan_;
   Host::Ptr current_host_;
   int protocol_version_;
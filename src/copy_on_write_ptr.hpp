@@ -45,6 +45,10 @@ public:
     return *this;
   }
 
+  void swap(CopyOnWritePtr<T>& cow) {
+    ptr_.swap(cow.ptr_);
+  }
+
   operator bool() const {
     return ptr_->ref != NULL;
   }
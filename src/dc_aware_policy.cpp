@@ -65,7 +65,7 @@ QueryPlan* DCAwarePolicy::new_query_plan(const std::string& connected_keyspace,
                                          RequestHandler* request_handler,
                                          const TokenMap* token_map) {
   CassConsistency cl = request_handler != NULL ? request_handler->request()->consistency() : Request::DEFAULT_CONSISTENCY;
-  return new DCAwareQueryPlan(this, cl, index_++);
+  return new (QueryPlan::block(request_handler)) DCAwareQueryPlan(this, cl, index_++);
 }
 
 void DCAwarePolicy::on_add(const Host::Ptr& host) {
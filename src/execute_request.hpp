@@ -41,6 +41,10 @@ public:
 
   const Prepared::ConstPtr& prepared() const { return prepared_; }
 
+  virtual Statement::Ptr copy() const {
+    return Statement::Ptr(new ExecuteRequest(*this));
+  }
+
   virtual int encode(int version, RequestCallback* callback, BufferVec* bufs) const;
 
   bool get_routing_key(std::string* routing_key, EncodingCache* cache)  const {
@@ -48,6 +52,10 @@ public:
   }
 
 private:
+  ExecuteRequest(const ExecuteRequest& other)
+      : Statement(other)
+      , prepared_(other.prepared_) { }
+
   virtual size_t get_indices(StringRef name, IndexVec* indices) {
     return prepared_->result()->metadata()->get_indices(name, indices);
   }
@@ -16,6 +16,7 @@
 
 #include "future.hpp"
 
+#include "completion_queue.hpp"
 #include "external.hpp"
 #include "prepared.hpp"
 #include "request_handler.hpp"
@@ -39,6 +40,15 @@ CassError cass_future_set_callback(CassFuture* future,
   return CASS_OK;
 }
 
+CassError cass_future_set_completion_queue(CassFuture* future,
+                                           CassCompletionQueue* queue,
+                                           void* data) {
+  if (!future->set_completion_queue(queue->from(), data)) {
+    return CASS_ERROR_LIB_CALLBACK_ALREADY_SET;
+  }
+  return CASS_OK;
+}
+
 cass_bool_t cass_future_ready(CassFuture* future) {
   return static_cast<cass_bool_t>(future->ready());
 }
@@ -166,6 +176,14 @@ CassError cass_future_custom_payload_item(CassFuture* future,
 
 namespace cass {
 
+Future::~Future() {
+  if (completion_queue_ != NULL) {
+    completion_queue_->dec_ref();
+  }
+  uv_mutex_destroy(&mutex_);
+  uv_cond_destroy(&cond_);
+}
+
 bool Future::set_callback(Future::Callback callback, void* data) {
   ScopedMutex lock(&mutex_);
   if (callback_) {
@@ -181,17 +199,43 @@ bool Future::set_callback(Future::Callback callback, void* data) {
   return true;
 }
 
+bool Future::set_completion_queue(CompletionQueue* completion_queue, void* data) {
+  ScopedMutex lock(&mutex_);
+  if (is_completion_queue_set_) {
+    return false; // Completion queue is already set
+  }
+  is_completion_queue_set_ = true;
+  completion_data_ = data;
+  if (is_set_) {
+    // Post immediately if the future is already set
+    lock.unlock();
+    completion_queue->post(this);
+  } else {
+    completion_queue->inc_ref();
+    completion_queue_ = completion_queue;
+  }
+  return true;
+}
+
 void Future::internal_set(ScopedMutex& lock) {
   is_set_ = true;
   uv_cond_broadcast(&cond_);
-  if (callback_) {
+  if (callback_ || completion_queue_ != NULL) {
     Callback callback = callback_;
     void* data = data_;
+    // The future's reference to the completion queue is released once it's
+    // posted so that queued futures don't keep the queue alive.
+    CompletionQueue* completion_queue = completion_queue_;
+    completion_queue_ = NULL;
     lock.unlock();
-    callback(CassFuture::to(this), data);
+    if (completion_queue != NULL) {
+      completion_queue->post(this);
+      completion_queue->dec_ref();
+    }
+    if (callback) {
+      callback(CassFuture::to(this), data);
+    }
   }
 }
 
 } // namespace cass
-
-
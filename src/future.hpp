@@ -22,6 +22,7 @@
 #include "external.hpp"
 #include "host.hpp"
 #include "macros.hpp"
+#include "mpsc_queue.hpp"
 #include "scoped_lock.hpp"
 #include "scoped_ptr.hpp"
 #include "ref_counted.hpp"
@@ -32,6 +33,7 @@
 
 namespace cass {
 
+class CompletionQueue;
 struct Error;
 
 enum FutureType {
@@ -39,7 +41,7 @@ enum FutureType {
   CASS_FUTURE_TYPE_RESPONSE
 };
 
-class Future : public RefCounted<Future> {
+class Future : public RefCounted<Future>, public MPSCQueue<Future>::Node {
 public:
   typedef SharedRefPtr<Future> Ptr;
   typedef void (*Callback)(CassFuture*, void*);
@@ -56,15 +58,15 @@ public:
   Future(FutureType type)
       : is_set_(false)
       , type_(type)
-      , callback_(NULL) {
+      , callback_(NULL)
+      , is_completion_queue_set_(false)
+      , completion_queue_(NULL)
+      , completion_data_(NULL) {
     uv_mutex_init(&mutex_);
     uv_cond_init(&cond_);
   }
 
-  virtual ~Future() {
-    uv_mutex_destroy(&mutex_);
-    uv_cond_destroy(&cond_);
-  }
+  virtual ~Future();
 
   FutureType type() const { return type_; }
 
@@ -105,6 +107,11 @@ public:
 
   bool set_callback(Callback callback, void* data);
 
+  bool set_completion_queue(CompletionQueue* completion_queue, void* data);
+
+  // Only valid after the future has been posted to its completion queue
+  void* completion_data() const { return completion_data_; }
+
 protected:
   bool is_set() const { return is_set_; }
 
@@ -139,6 +146,9 @@ private:
   ScopedPtr<Error> error_;
   Callback callback_;
   void* data_;
+  bool is_completion_queue_set_;
+  CompletionQueue* completion_queue_;
+  void* completion_data_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(Future);
@@ -16,8 +16,17 @@
 
 #include "host.hpp"
 
+#include "third_party/hdr_histogram/hdr_histogram.hpp"
+
+#include <stdlib.h>
+
 namespace cass {
 
+// Latencies are recorded in microseconds with two significant figures which
+// keeps each host's histogram small
+static const int64_t PERCENTILE_HIGHEST_TRACKABLE_US = 60LL * 1000LL * 1000LL;
+static const int PERCENTILE_SIGNIFICANT_FIGURES = 2;
+
 void add_host(CopyOnWriteHostVec& hosts, const Host::Ptr& host) {
   HostVec::iterator i;
   for (i = hosts->begin(); i != hosts->end(); ++i) {
@@ -67,6 +76,57 @@ void Host::LatencyTracker::update(uint64_t latency_ns) {
   current_.timestamp = now;
 }
 
+Host::~Host() {
+  delete percentile_tracker_.load();
+}
+
+void Host::enable_percentile_tracking(double percentile,
+                                      uint64_t window_ns,
+                                      uint64_t min_measured) {
+  if (percentile_tracker_.load(MEMORY_ORDER_ACQUIRE) != NULL) return;
+  PercentileTracker* tracker = new PercentileTracker(percentile, window_ns, min_measured);
+  PercentileTracker* expected = NULL;
+  if (!percentile_tracker_.compare_exchange_strong(expected, tracker)) {
+    delete tracker; // Another thread enabled it first
+  }
+}
+
+Host::PercentileTracker::PercentileTracker(double percentile,
+                                           uint64_t window_ns,
+                                           uint64_t min_measured)
+  : percentile_(percentile)
+  , window_ns_(window_ns)
+  , min_measured_(min_measured)
+  , window_start_ns_(uv_hrtime())
+  , percentile_ns_(-1) {
+  hdr_init(1LL, PERCENTILE_HIGHEST_TRACKABLE_US,
+           PERCENTILE_SIGNIFICANT_FIGURES, &histogram_);
+}
+
+Host::PercentileTracker::~PercentileTracker() {
+  free(histogram_);
+}
+
+void Host::PercentileTracker::update(uint64_t latency_ns) {
+  int64_t latency_us = static_cast<int64_t>(latency_ns / 1000);
+  if (latency_us < 1) latency_us = 1;
+  if (latency_us > PERCENTILE_HIGHEST_TRACKABLE_US) latency_us = PERCENTILE_HIGHEST_TRACKABLE_US;
+
+  uint64_t now = uv_hrtime();
+
+  ScopedSpinlock l(SpinlockPool<PercentileTracker>::get_spinlock(this));
+
+  hdr_record_value(histogram_, latency_us);
+
+  if (now - window_start_ns_ >= window_ns_ &&
+      static_cast<uint64_t>(histogram_->total_count) >= min_measured_) {
+    percentile_ns_.store(hdr_value_at_percentile(histogram_, percentile_) * 1000LL,
+                         MEMORY_ORDER_RELAXED);
+    hdr_reset(histogram_);
+    window_start_ns_ = now;
+  }
+}
+
 bool VersionNumber::parse(const std::string& version) {
   return sscanf(version.c_str(), "%d.%d.%d", &major_version_, &minor_version_, &patch_version_) >= 2;
 }
@@ -34,6 +34,8 @@
 #include <stdint.h>
 #include <vector>
 
+struct hdr_histogram;
+
 namespace cass {
 
 struct TimestampedAverage {
@@ -118,7 +120,13 @@ public:
       , dc_id_(0)
       , mark_(mark)
       , state_(ADDED)
-      , address_string_(address.to_string()) { }
+      , up_time_ns_(0)
+      , inflight_request_count_(0)
+      , pending_write_bytes_(0)
+      , address_string_(address.to_string())
+      , percentile_tracker_(NULL) { }
+
+  ~Host();
 
   const Address& address() const { return address_; }
   const std::string& address_string() const { return address_string_; }
@@ -163,7 +171,18 @@ public:
   bool was_just_added() const { return state() == ADDED; }
 
   bool is_up() const { return state() == UP; }
-  void set_up() { set_state(UP); }
+  void set_up() {
+    if (state() == DOWN) {
+      up_time_ns_.store(get_time_monotonic_ns(), MEMORY_ORDER_RELAXED);
+    }
+    set_state(UP);
+  }
+
+  // The time (from get_time_monotonic_ns()) when the host was last marked up
+  // after being down, or 0 if it has never been down
+  uint64_t up_time_ns() const {
+    return up_time_ns_.load(MEMORY_ORDER_RELAXED);
+  }
   bool is_down() const { return state() == DOWN; }
   void set_down() { set_state(DOWN); }
 
@@ -196,6 +215,52 @@ public:
     return TimestampedAverage();
   }
 
+  // Tracks a latency percentile over a rolling window. A window ends once
+  // it's at least "window_ns" long and has at least "min_measured"
+  // latencies. It's safe to enable from multiple threads; only the first
+  // call's settings are used.
+  void enable_percentile_tracking(double percentile,
+                                  uint64_t window_ns,
+                                  uint64_t min_measured);
+
+  void update_percentile_latency(uint64_t latency_ns) {
+    PercentileTracker* tracker = percentile_tracker_.load(MEMORY_ORDER_ACQUIRE);
+    if (tracker != NULL) {
+      tracker->update(latency_ns);
+    }
+  }
+
+  // Returns the percentile (in nanoseconds) from the last complete window
+  // or -1 if there isn't one yet
+  int64_t latency_percentile() const {
+    PercentileTracker* tracker = percentile_tracker_.load(MEMORY_ORDER_ACQUIRE);
+    if (tracker != NULL) {
+      return tracker->get();
+    }
+    return -1;
+  }
+
+  // The load on all the connections to this host: the number of requests
+  // waiting for a response and the number of bytes waiting to be written.
+  // These are updated by each connection as requests are written and
+  // completed and are read by the load balancing policies.
+  int64_t inflight_request_count() const {
+    return inflight_request_count_.load(MEMORY_ORDER_RELAXED);
+  }
+
+  int64_t pending_write_bytes() const {
+    return pending_write_bytes_.load(MEMORY_ORDER_RELAXED);
+  }
+
+  void update_load(int64_t request_count_delta, int64_t write_bytes_delta) const {
+    if (request_count_delta != 0) {
+      inflight_request_count_.fetch_add(request_count_delta, MEMORY_ORDER_RELAXED);
+    }
+    if (write_bytes_delta != 0) {
+      pending_write_bytes_.fetch_add(write_bytes_delta, MEMORY_ORDER_RELAXED);
+    }
+  }
+
 private:
   class LatencyTracker {
   public:
@@ -219,6 +284,29 @@ private:
     DISALLOW_COPY_AND_ASSIGN(LatencyTracker);
   };
 
+  class PercentileTracker {
+  public:
+    PercentileTracker(double percentile, uint64_t window_ns, uint64_t min_measured);
+    ~PercentileTracker();
+
+    void update(uint64_t latency_ns);
+
+    int64_t get() const {
+      return percentile_ns_.load(MEMORY_ORDER_RELAXED);
+    }
+
+  private:
+    const double percentile_;
+    const uint64_t window_ns_;
+    const uint64_t min_measured_;
+    uint64_t window_start_ns_;
+    hdr_histogram* histogram_;
+    Atomic<int64_t> percentile_ns_;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(PercentileTracker);
+  };
+
 private:
   HostState state() const {
     return state_.load(MEMORY_ORDER_ACQUIRE);
@@ -233,6 +321,9 @@ private:
   uint32_t dc_id_;
   bool mark_;
   Atomic<HostState> state_;
+  Atomic<uint64_t> up_time_ns_;
+  mutable Atomic<int64_t> inflight_request_count_;
+  mutable Atomic<int64_t> pending_write_bytes_;
   std::string address_string_;
   std::string listen_address_;
   VersionNumber cassandra_version_;
@@ -241,6 +332,7 @@ private:
   std::string dc_;
 
   ScopedPtr<LatencyTracker> latency_tracker_;
+  Atomic<PercentileTracker*> percentile_tracker_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(Host);
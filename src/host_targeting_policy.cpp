@@ -44,7 +44,7 @@ QueryPlan* HostTargetingPolicy::new_query_plan(const std::string& connected_keys
     return child_plan;
   }
 
-  return new HostTargetingQueryPlan(i->second, child_plan);
+  return new (QueryPlan::block(request_handler)) HostTargetingQueryPlan(i->second, child_plan);
 }
 
 void HostTargetingPolicy::on_add(const SharedRefPtr<Host>& host) {
@@ -21,7 +21,6 @@
 #include "pool.hpp"
 #include "request_handler.hpp"
 #include "session.hpp"
-#include "scoped_lock.hpp"
 #include "timer.hpp"
 
 namespace cass {
@@ -31,21 +30,23 @@ IOWorker::IOWorker(Session* session)
     , session_(session)
     , config_(session->config())
     , metrics_(session->metrics())
+    , buffer_pool_(new BufferPool())
     , protocol_version_(-1)
     , keyspace_(new std::string)
+    , load_balancing_policy_(config_.load_balancing_policy())
+    , speculative_execution_policy_(config_.speculative_execution_policy())
     , pending_request_count_(0)
     , request_queue_(config_.queue_size_io()) {
   pools_.set_empty_key(Address::EMPTY_KEY);
   pools_.set_deleted_key(Address::DELETED_KEY);
+  reconnection_schedules_.set_empty_key(Address::EMPTY_KEY);
+  reconnection_schedules_.set_deleted_key(Address::DELETED_KEY);
   unavailable_addresses_.set_empty_key(Address::EMPTY_KEY);
   unavailable_addresses_.set_deleted_key(Address::DELETED_KEY);
   prepare_.data = this;
-  uv_mutex_init(&unavailable_addresses_mutex_);
 }
 
-IOWorker::~IOWorker() {
-  uv_mutex_destroy(&unavailable_addresses_mutex_);
-}
+IOWorker::~IOWorker() { }
 
 int IOWorker::init() {
   int rc = EventThread<IOWorkerEvent>::init(config_.queue_size_event());
@@ -56,6 +57,8 @@ int IOWorker::init() {
   if (rc != 0) return rc;
   rc = uv_prepare_start(&prepare_, on_prepare);
   if (rc != 0) return rc;
+  rc = timer_wheel_.init(loop());
+  if (rc != 0) return rc;
   return rc;
 }
 
@@ -70,11 +73,19 @@ void IOWorker::broadcast_keyspace_change(const std::string& keyspace) {
 
 bool IOWorker::is_host_up(const Address& address) const {
   PoolMap::const_iterator it = pools_.find(address);
-  return it != pools_.end() && it->second->is_ready();
+  if (it != pools_.end()) {
+    return it->second->is_ready();
+  }
+
+  // This IO worker doesn't have a pool for hosts that it doesn't own
+  if (!session_->is_host_owner(this, address)) {
+    Host::Ptr host(session_->get_host(address));
+    return host && host->is_up();
+  }
+  return false;
 }
 
 void IOWorker::set_host_is_available(const Address& address, bool is_available) {
-  ScopedMutex lock(&unavailable_addresses_mutex_);
   if (is_available) {
     unavailable_addresses_.erase(address);
   } else {
@@ -82,12 +93,22 @@ void IOWorker::set_host_is_available(const Address& address, bool is_available)
   }
 }
 
-bool IOWorker::is_host_available(const Address& address) {
-  ScopedMutex lock(&unavailable_addresses_mutex_);
+bool IOWorker::is_host_available(const Address& address) const {
   return unavailable_addresses_.count(address) == 0;
 }
 
-bool IOWorker::add_pool_async(const Host::ConstPtr& host, bool is_initial_connection) {
+void IOWorker::init_load_balancing_policy(const Host::Ptr& connected_host,
+                                          const HostMap& hosts,
+                                          Random* random) {
+  load_balancing_policy_->init(connected_host, hosts, random);
+
+  // Handles (e.g. timers) need to be registered on the IO worker's loop
+  IOWorkerEvent event;
+  event.type = IOWorkerEvent::REGISTER_POLICY_HANDLES;
+  send_event_async(event);
+}
+
+bool IOWorker::add_pool_async(const Host::Ptr& host, bool is_initial_connection) {
   IOWorkerEvent event;
   event.type = IOWorkerEvent::ADD_POOL;
   event.host = host;
@@ -95,7 +116,7 @@ bool IOWorker::add_pool_async(const Host::ConstPtr& host, bool is_initial_connec
   return send_event_async(event);
 }
 
-bool IOWorker::remove_pool_async(const Host::ConstPtr& host, bool cancel_reconnect) {
+bool IOWorker::remove_pool_async(const Host::Ptr& host, bool cancel_reconnect) {
   IOWorkerEvent event;
   event.type = IOWorkerEvent::REMOVE_POOL;
   event.host = host;
@@ -103,12 +124,42 @@ bool IOWorker::remove_pool_async(const Host::ConstPtr& host, bool cancel_reconne
   return send_event_async(event);
 }
 
+bool IOWorker::notify_host_add_async(const Host::Ptr& host) {
+  return send_host_event_async(IOWorkerEvent::HOST_ADD, host);
+}
+
+bool IOWorker::notify_host_remove_async(const Host::Ptr& host) {
+  return send_host_event_async(IOWorkerEvent::HOST_REMOVE, host);
+}
+
+bool IOWorker::notify_host_up_async(const Host::Ptr& host) {
+  return send_host_event_async(IOWorkerEvent::HOST_UP, host);
+}
+
+bool IOWorker::notify_host_down_async(const Host::Ptr& host) {
+  return send_host_event_async(IOWorkerEvent::HOST_DOWN, host);
+}
+
+bool IOWorker::notify_token_map_update_async(const TokenMap::ConstPtr& token_map) {
+  IOWorkerEvent event;
+  event.type = IOWorkerEvent::TOKEN_MAP_UPDATE;
+  event.token_map = token_map;
+  return send_event_async(event);
+}
+
 void IOWorker::close_async() {
   while (!request_queue_.enqueue(NULL)) {
     // Keep trying
   }
 }
 
+bool IOWorker::send_host_event_async(IOWorkerEvent::Type type, const Host::Ptr& host) {
+  IOWorkerEvent event;
+  event.type = type;
+  event.host = host;
+  return send_event_async(event);
+}
+
 void IOWorker::add_pool(const Host::ConstPtr& host, bool is_initial_connection) {
   if (!is_ready()) return;
 
@@ -135,6 +186,24 @@ void IOWorker::add_pool(const Host::ConstPtr& host, bool is_initial_connection)
   }
 }
 
+Pool* IOWorker::add_on_demand_pool(const Host::Ptr& host) {
+  // Pools for the hosts that this IO worker owns are only added by the
+  // session
+  if (!is_ready() || !host->is_up() ||
+      session_->is_host_owner(this, host->address())) {
+    return NULL;
+  }
+
+  LOG_DEBUG("Adding on demand pool for host %s io_worker(%p)",
+            host->address_string().c_str(),
+            static_cast<void*>(this));
+
+  Pool::Ptr pool(new Pool(this, host, false, true));
+  pools_[host->address()] = pool;
+  pool->connect();
+  return pool.get();
+}
+
 bool IOWorker::execute(const RequestHandler::Ptr& request_handler) {
   request_handler->inc_ref(); // Queue reference
   if (!request_queue_.enqueue(request_handler.get())) {
@@ -146,9 +215,10 @@ bool IOWorker::execute(const RequestHandler::Ptr& request_handler) {
 
 void IOWorker::retry(const SpeculativeExecution::Ptr& speculative_execution) {
   while (speculative_execution->current_host()) {
-    PoolMap::const_iterator it = pools_.find(speculative_execution->current_host()->address());
-    if (it != pools_.end() && it->second->is_ready()) {
-      const Pool::Ptr& pool = it->second;
+    const Host::Ptr& host = speculative_execution->current_host();
+    PoolMap::const_iterator it = pools_.find(host->address());
+    Pool* pool = it != pools_.end() ? it->second.get() : add_on_demand_pool(host);
+    if (pool != NULL && pool->is_ready()) {
       Connection* connection = pool->borrow_connection();
       if (connection != NULL) {
         if (pool->write(connection, speculative_execution)) {
@@ -158,6 +228,9 @@ void IOWorker::retry(const SpeculativeExecution::Ptr& speculative_execution) {
         pool->wait_for_connection(speculative_execution);
         return; // Waiting for connection
       }
+    } else if (pool != NULL && pool->is_on_demand() && pool->is_connecting()) {
+      pool->wait_for_connection(speculative_execution);
+      return; // Waiting for the on demand pool to connect
     }
     speculative_execution->next_host();
   }
@@ -174,6 +247,8 @@ void IOWorker::request_finished() {
 }
 
 void IOWorker::notify_pool_ready(Pool* pool) {
+  if (pool->is_on_demand()) return;
+
   if (pool->is_initial_connection()) {
     if (pool->is_keyspace_error()) {
       session_->notify_keyspace_error_async();
@@ -181,6 +256,7 @@ void IOWorker::notify_pool_ready(Pool* pool) {
       session_->notify_ready_async();
     }
   } else if (is_ready() && pool->is_ready()){
+    session_->prepare_on_up_host(this, pool->host()->address());
     session_->notify_up_async(pool->host()->address());
   }
 }
@@ -201,7 +277,7 @@ void IOWorker::notify_pool_closed(Pool* pool) {
 
   if (is_closing()) {
     maybe_notify_closed();
-  } else {
+  } else if (!pool->is_on_demand()) {
     session_->notify_down_async(host->address());
     if (!is_critical_failure && !cancel_reconnect) {
       schedule_reconnect(host);
@@ -209,6 +285,25 @@ void IOWorker::notify_pool_closed(Pool* pool) {
   }
 }
 
+uint64_t IOWorker::next_reconnect_delay_ms(const Address& address) {
+  ReconnectionScheduleMap::iterator it = reconnection_schedules_.find(address);
+  if (it == reconnection_schedules_.end()) {
+    // This needs to be done on the IO worker's thread because it could pause
+    // generating a new random seed.
+    if (!random_) {
+      random_.reset(new Random());
+    }
+    ReconnectionSchedule::Ptr schedule(
+          config_.reconnection_policy()->new_schedule(random_.get()));
+    it = reconnection_schedules_.insert(std::make_pair(address, schedule)).first;
+  }
+  return it->second->next_delay_ms();
+}
+
+void IOWorker::reset_reconnect_delay(const Address& address) {
+  reconnection_schedules_.erase(address);
+}
+
 void IOWorker::add_pending_flush(Pool* pool) {
   pools_pending_flush_.push_back(Pool::Ptr(pool));
 }
@@ -244,13 +339,13 @@ void IOWorker::maybe_notify_closed() {
 void IOWorker::close_handles() {
   EventThread<IOWorkerEvent>::close_handles();
   request_queue_.close_handles();
+  load_balancing_policy_->close_handles();
   uv_prepare_stop(&prepare_);
   uv_close(reinterpret_cast<uv_handle_t*>(&prepare_), NULL);
+  timer_wheel_.close_handles();
 }
 
 void IOWorker::on_event(const IOWorkerEvent& event) {
-  const Address& address = event.host->address();
-
   switch (event.type) {
     case IOWorkerEvent::ADD_POOL: {
       add_pool(event.host, event.is_initial_connection);
@@ -258,7 +353,7 @@ void IOWorker::on_event(const IOWorkerEvent& event) {
     }
 
     case IOWorkerEvent::REMOVE_POOL: {
-      PoolMap::iterator it = pools_.find(address);
+      PoolMap::iterator it = pools_.find(event.host->address());
       if (it != pools_.end()) {
         LOG_DEBUG("Remove pool event for %s closing pool(%p) io_worker(%p)",
                   event.host->address_string().c_str(),
@@ -269,6 +364,31 @@ void IOWorker::on_event(const IOWorkerEvent& event) {
       break;
     }
 
+    case IOWorkerEvent::REGISTER_POLICY_HANDLES:
+      load_balancing_policy_->register_handles(loop());
+      break;
+
+    case IOWorkerEvent::HOST_ADD:
+      load_balancing_policy_->on_add(event.host);
+      break;
+
+    case IOWorkerEvent::HOST_REMOVE:
+      load_balancing_policy_->on_remove(event.host);
+      reconnection_schedules_.erase(event.host->address());
+      break;
+
+    case IOWorkerEvent::HOST_UP:
+      load_balancing_policy_->on_up(event.host);
+      break;
+
+    case IOWorkerEvent::HOST_DOWN:
+      load_balancing_policy_->on_down(event.host);
+      break;
+
+    case IOWorkerEvent::TOKEN_MAP_UPDATE:
+      token_map_ = event.token_map;
+      break;
+
     default:
       assert(false);
       break;
@@ -288,11 +408,7 @@ void IOWorker::on_execute(uv_async_t* async) {
     RequestHandler::Ptr request_handler(temp);
     if (request_handler) {
       request_handler->dec_ref(); // Queue reference
-      io_worker->pending_request_count_++;
-      request_handler->start_request(io_worker);
-      SpeculativeExecution::Ptr speculative_execution(new SpeculativeExecution(request_handler,
-                                                                               request_handler->current_host()));
-      speculative_execution->execute();
+      io_worker->process_request(request_handler);
     } else {
       io_worker->state_ = IO_WORKER_STATE_CLOSING;
     }
@@ -316,15 +432,75 @@ void IOWorker::on_prepare(uv_prepare_t* prepare) {
   io_worker->pools_pending_flush_.clear();
 }
 
+void IOWorker::process_request(const RequestHandler::Ptr& request_handler) {
+  // Requests that already have a query plan and a current host (e.g. a
+  // prepare for a single host) are run as is, unless they were handed off.
+  if (request_handler->is_handoff()) {
+    // The request was handed off by another IO worker. Its query plan is
+    // rebuilt with this IO worker's policies because they can only be used
+    // on this thread. The old plan's first host is kept as the current host.
+    request_handler->set_query_plan(NULL);
+    request_handler->set_query_plan(new_query_plan(request_handler.get()),
+                                    request_handler->current_host()->address());
+  } else if (!request_handler->current_host()) {
+    request_handler->set_query_plan(new_query_plan(request_handler.get()));
+
+    // Skip hosts that are currently too busy on this IO worker
+    while (request_handler->next_host() &&
+           !is_host_available(request_handler->current_host()->address())) { }
+
+    // When hosts are partitioned across IO workers the request is handed off
+    // to a worker that owns a pool for the first host. If the owners' queues
+    // are full the request continues on this worker using the hosts it owns.
+    if (request_handler->current_host()) {
+      const Address& address = request_handler->current_host()->address();
+      if (!session_->is_host_owner(this, address) &&
+          session_->execute_on_owner(request_handler, address, true)) {
+        return;
+      }
+    }
+  }
+
+  pending_request_count_++;
+  request_handler->start_request(this);
+
+  if (!request_handler->current_host()) {
+    request_handler->set_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
+                               "All connections on the I/O thread are busy");
+    return;
+  }
+
+  const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  request_handler->set_execution_plan(
+        speculative_execution_policy_->new_plan(*keyspace, request_handler->request()));
+
+  if (request_handler->timestamp() == CASS_INT64_MIN) {
+    request_handler->set_timestamp(config_.timestamp_gen()->next());
+  }
+
+  SpeculativeExecution::Ptr speculative_execution(
+        new (request_handler->block()) SpeculativeExecution(request_handler,
+                                                             request_handler->current_host()));
+  speculative_execution->execute();
+}
+
+QueryPlan* IOWorker::new_query_plan(RequestHandler* request_handler) {
+  const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  return load_balancing_policy_->new_query_plan(*keyspace,
+                                                request_handler,
+                                                token_map_.get());
+}
+
 void IOWorker::schedule_reconnect(const Host::ConstPtr& host) {
   if (pools_.count(host->address()) == 0) {
-    LOG_INFO("Scheduling reconnect for host %s in %u ms on io_worker(%p)",
+    uint64_t delay_ms = next_reconnect_delay_ms(host->address());
+    LOG_INFO("Scheduling reconnect for host %s in %llu ms on io_worker(%p)",
              host->address_string().c_str(),
-             config_.reconnect_wait_time_ms(),
+             static_cast<unsigned long long>(delay_ms),
              static_cast<void*>(this));
     Pool::Ptr pool(new Pool(this, host, false));
     pools_[host->address()] = pool;
-    pool->delayed_connect();
+    pool->delayed_connect(delay_ms);
   }
 }
 
@@ -20,16 +20,24 @@
 #include "address.hpp"
 #include "atomic.hpp"
 #include "async_queue.hpp"
+#include "buffer_pool.hpp"
 #include "copy_on_write_ptr.hpp"
 #include "constants.hpp"
 #include "event_thread.hpp"
 #include "host.hpp"
+#include "load_balancing.hpp"
 #include "logger.hpp"
 #include "metrics.hpp"
+#include "mpmc_queue.hpp"
 #include "pool.hpp"
+#include "random.hpp"
+#include "reconnection_policy.hpp"
 #include "request_handler.hpp"
-#include "spsc_queue.hpp"
+#include "scoped_ptr.hpp"
+#include "speculative_execution.hpp"
 #include "timer.hpp"
+#include "timer_wheel.hpp"
+#include "token_map.hpp"
 
 #include <sparsehash/dense_hash_map>
 
@@ -40,6 +48,7 @@ namespace cass {
 
 class Config;
 class Pool;
+class Random;
 class RequestHandler;
 class Session;
 class SSLContext;
@@ -49,7 +58,13 @@ struct IOWorkerEvent {
   enum Type {
     INVALID,
     ADD_POOL,
-    REMOVE_POOL
+    REMOVE_POOL,
+    REGISTER_POLICY_HANDLES,
+    HOST_ADD,
+    HOST_REMOVE,
+    HOST_UP,
+    HOST_DOWN,
+    TOKEN_MAP_UPDATE
   };
 
   IOWorkerEvent()
@@ -58,7 +73,8 @@ struct IOWorkerEvent {
     , cancel_reconnect(false) {}
 
   Type type;
-  Host::ConstPtr host;
+  Host::Ptr host;
+  TokenMap::ConstPtr token_map;
   bool is_initial_connection;
   bool cancel_reconnect;
 };
@@ -83,9 +99,17 @@ public:
   bool is_closing() const { return state_ == IO_WORKER_STATE_CLOSING; }
   bool is_ready() const { return state_ == IO_WORKER_STATE_READY; }
 
+  Session* session() const { return session_; }
   const Config& config() const { return config_; }
   Metrics* metrics() const { return metrics_; }
 
+  // Shared by all the connections on this IO worker's thread
+  BufferPool* buffer_pool() const { return buffer_pool_.get(); }
+
+  // Used for per-request timeouts. This MUST only be used on the IO
+  // worker's thread.
+  TimerWheel* timer_wheel() { return &timer_wheel_; }
+
   int protocol_version() const {
     return protocol_version_.load();
   }
@@ -98,12 +122,23 @@ public:
   void broadcast_keyspace_change(const std::string& keyspace);
 
   void set_host_is_available(const Address& address, bool is_available);
-  bool is_host_available(const Address& address);
+  bool is_host_available(const Address& address) const;
 
   bool is_host_up(const Address& address) const;
 
-  bool add_pool_async(const Host::ConstPtr& host, bool is_initial_connection);
-  bool remove_pool_async(const Host::ConstPtr& host, bool cancel_reconnect);
+  // This MUST be called on the session thread before any requests are
+  // executed on this IO worker.
+  void init_load_balancing_policy(const Host::Ptr& connected_host,
+                                  const HostMap& hosts,
+                                  Random* random);
+
+  bool add_pool_async(const Host::Ptr& host, bool is_initial_connection);
+  bool remove_pool_async(const Host::Ptr& host, bool cancel_reconnect);
+  bool notify_host_add_async(const Host::Ptr& host);
+  bool notify_host_remove_async(const Host::Ptr& host);
+  bool notify_host_up_async(const Host::Ptr& host);
+  bool notify_host_down_async(const Host::Ptr& host);
+  bool notify_token_map_update_async(const TokenMap::ConstPtr& token_map);
   void close_async();
 
   bool execute(const RequestHandler::Ptr& request_handler);
@@ -114,10 +149,21 @@ public:
   void notify_pool_ready(Pool* pool);
   void notify_pool_closed(Pool* pool);
 
+  // Returns the delay before the next attempt to connect to the host. Each
+  // host has its own schedule which is restarted once a connection to the
+  // host is established. These MUST only be used on the IO worker's thread.
+  uint64_t next_reconnect_delay_ms(const Address& address);
+  void reset_reconnect_delay(const Address& address);
+
   void add_pending_flush(Pool* pool);
 
 private:
+  bool send_host_event_async(IOWorkerEvent::Type type, const Host::Ptr& host);
+
   void add_pool(const Host::ConstPtr& host, bool is_initial_connection);
+  Pool* add_on_demand_pool(const Host::Ptr& host);
+  void process_request(const RequestHandler::Ptr& request_handler);
+  QueryPlan* new_query_plan(RequestHandler* request_handler);
   void maybe_close();
   void maybe_notify_closed();
   void close_handles();
@@ -137,6 +183,7 @@ private:
 private:
   typedef sparsehash::dense_hash_map<Address, Pool::Ptr, AddressHash> PoolMap;
   typedef std::vector<Pool::Ptr > PoolVec;
+  typedef sparsehash::dense_hash_map<Address, ReconnectionSchedule::Ptr, AddressHash> ReconnectionScheduleMap;
 
   void schedule_reconnect(const Host::ConstPtr& host);
 
@@ -145,20 +192,31 @@ private:
   Session* session_;
   const Config& config_;
   Metrics* metrics_;
+  BufferPool::Ptr buffer_pool_;
   Atomic<int> protocol_version_;
   uv_prepare_t prepare_;
+  TimerWheel timer_wheel_;
 
   CopyOnWritePtr<std::string> keyspace_;
+  // The last token map snapshot published by the session. It's only used on
+  // the IO worker's thread so query plans are built without locking.
+  TokenMap::ConstPtr token_map_;
+
+  LoadBalancingPolicy::Ptr load_balancing_policy_;
+  SharedRefPtr<SpeculativeExecutionPolicy> speculative_execution_policy_;
 
+  // Only accessed on the IO worker thread
   AddressSet unavailable_addresses_;
-  uv_mutex_t unavailable_addresses_mutex_;
 
   PoolMap pools_;
   PoolVec pools_pending_flush_;
+  ReconnectionScheduleMap reconnection_schedules_;
+  ScopedPtr<Random> random_; // Created on first use for reconnection jitter
   bool is_closing_;
   int pending_request_count_;
 
-  AsyncQueue<SPSCQueue<RequestHandler*> > request_queue_;
+  // Requests are enqueued directly by application threads
+  AsyncQueue<MPMCQueue<RequestHandler*> > request_queue_;
 };
 
 } // namespace cass
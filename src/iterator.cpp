@@ -41,6 +41,10 @@ CassIterator* cass_iterator_from_result(const CassResult* result) {
   return CassIterator::to(new cass::ResultIterator(result));
 }
 
+CassIterator* cass_iterator_from_result_pages(const CassResult* result) {
+  return CassIterator::to(new cass::ResultIterator(result, result->page_fetcher()));
+}
+
 CassIterator* cass_iterator_from_row(const CassRow* row) {
   return CassIterator::to(new cass::RowIterator(row));
 }
@@ -105,6 +109,21 @@ const CassRow* cass_iterator_get_row(const CassIterator* iterator) {
                        iterator->from())->row());
 }
 
+CassError cass_iterator_pages_error(const CassIterator* iterator,
+                                    const char** message,
+                                    size_t* message_length) {
+  if (iterator->type() != CASS_ITERATOR_TYPE_RESULT) {
+    *message = "";
+    *message_length = 0;
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  const cass::ResultIterator* result_iterator
+      = static_cast<const cass::ResultIterator*>(iterator->from());
+  *message = result_iterator->error_message().data();
+  *message_length = result_iterator->error_message().length();
+  return result_iterator->error_code();
+}
+
 const CassValue* cass_iterator_get_column(const CassIterator* iterator) {
   if (iterator->type() != CASS_ITERATOR_TYPE_ROW) {
     return NULL;
@@ -53,10 +53,10 @@ void LatencyAwarePolicy::close_handles() {
 QueryPlan* LatencyAwarePolicy::new_query_plan(const std::string& connected_keyspace,
                                               RequestHandler* request_handler,
                                               const TokenMap* token_map) {
-  return new LatencyAwareQueryPlan(this,
-                                   child_policy_->new_query_plan(connected_keyspace,
-                                                                 request_handler,
-                                                                 token_map));
+  QueryPlan* child_plan = child_policy_->new_query_plan(connected_keyspace,
+                                                        request_handler,
+                                                        token_map);
+  return new (QueryPlan::block(request_handler)) LatencyAwareQueryPlan(this, child_plan);
 }
 
 void LatencyAwarePolicy::on_add(const Host::Ptr& host) {
@@ -21,6 +21,7 @@
 #include "constants.hpp"
 #include "host.hpp"
 #include "request.hpp"
+#include "request_pool.hpp"
 
 #include <list>
 #include <set>
@@ -59,8 +60,20 @@ inline bool is_dc_local(CassConsistency cl) {
   return cl == CASS_CONSISTENCY_LOCAL_ONE || cl == CASS_CONSISTENCY_LOCAL_QUORUM;
 }
 
-class QueryPlan {
+// Query plans are built in their request's block (see RequestPool) so that
+// creating a plan, including the plans of chained policies, doesn't allocate.
+// Plans for requests that don't have a block, or that don't fit in the
+// remaining space, are allocated from the heap.
+class QueryPlan : public RequestBlockAllocated {
 public:
+  // The extra space reserved in each request block for its query plan. This
+  // fits the built-in policies when they're all chained together.
+  static const size_t BLOCK_SIZE = 512;
+
+  // The block to build the request's query plan in (or NULL). This is used
+  // as "new (QueryPlan::block(request_handler)) T(...)".
+  static RequestBlock* block(RequestHandler* request_handler);
+
   virtual ~QueryPlan() {}
   virtual Host::Ptr compute_next() = 0;
 
@@ -74,6 +87,23 @@ public:
   }
 };
 
+// A query plan with a single host. This is used for requests that must run
+// on a specific host.
+class SingleHostQueryPlan : public QueryPlan {
+public:
+  SingleHostQueryPlan(const Host::Ptr& host)
+    : host_(host) { }
+
+  virtual Host::Ptr compute_next() {
+    Host::Ptr temp = host_;
+    host_.reset();
+    return temp;
+  }
+
+private:
+  Host::Ptr host_;
+};
+
 class LoadBalancingPolicy : public Host::StateListener, public RefCounted<LoadBalancingPolicy> {
 public:
   typedef SharedRefPtr<LoadBalancingPolicy> Ptr;
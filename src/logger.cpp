@@ -16,6 +16,12 @@
 
 #include "logger.hpp"
 
+#include "async_queue.hpp"
+#include "atomic.hpp"
+#include "loop_thread.hpp"
+#include "mpmc_queue.hpp"
+#include "scoped_ptr.hpp"
+
 extern "C" {
 
 void cass_log_cleanup() {
@@ -35,6 +41,33 @@ void cass_log_set_queue_size(size_t queue_size) {
   // Deprecated
 }
 
+CassError cass_log_start_async(size_t queue_size) {
+  if (queue_size == 0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  if (cass::Logger::start_async(queue_size) != 0) {
+    return CASS_ERROR_LIB_UNABLE_TO_INIT;
+  }
+  return CASS_OK;
+}
+
+void cass_log_stop_async() {
+  cass::Logger::stop_async();
+}
+
+CassError cass_log_set_rate_limit(CassLogLevel log_level,
+                                  unsigned messages_per_second) {
+  if (log_level <= CASS_LOG_DISABLED || log_level >= CASS_LOG_LAST_ENTRY) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cass::Logger::set_rate_limit(log_level, messages_per_second);
+  return CASS_OK;
+}
+
+void cass_log_get_stats(CassLogStats* stats) {
+  cass::Logger::get_stats(stats);
+}
+
 } // extern "C"
 
 namespace cass {
@@ -50,15 +83,136 @@ void stderr_log_callback(const CassLogMessage* message, void* data) {
 
 void noop_log_callback(const CassLogMessage* message, void* data) { }
 
+// Allows a fixed number of messages for each one second window
+class LogRateLimiter {
+public:
+  LogRateLimiter()
+    : messages_per_second_(0)
+    , window_(0)
+    , count_(0) { }
+
+  void set_messages_per_second(unsigned messages_per_second) {
+    messages_per_second_.store(messages_per_second, MEMORY_ORDER_RELAXED);
+  }
+
+  bool try_acquire(uint64_t time_ms) {
+    unsigned messages_per_second = messages_per_second_.load(MEMORY_ORDER_RELAXED);
+    if (messages_per_second == 0) return true;
+    uint64_t window = time_ms / 1000;
+    uint64_t current = window_.load(MEMORY_ORDER_RELAXED);
+    if (window != current &&
+        window_.compare_exchange_strong(current, window, MEMORY_ORDER_RELAXED)) {
+      count_.store(0, MEMORY_ORDER_RELAXED);
+    }
+    return count_.fetch_add(1, MEMORY_ORDER_RELAXED) < messages_per_second;
+  }
+
+private:
+  Atomic<unsigned> messages_per_second_;
+  Atomic<uint64_t> window_;
+  Atomic<unsigned> count_;
+};
+
+// Delivers messages to the callback on its own thread. The messages are
+// preallocated and cycle between a free list and the delivery queue so
+// logging doesn't allocate.
+class AsyncLogger : public LoopThread {
+public:
+  AsyncLogger(size_t queue_size)
+    : free_messages_(queue_size)
+    , queue_(queue_size)
+    , messages_(new CassLogMessage[next_pow_2(queue_size)])
+    , is_closing_(false) {
+    for (size_t i = 0; i < next_pow_2(queue_size); ++i) {
+      free_messages_.enqueue(&messages_[i]);
+    }
+  }
+
+  int init() {
+    int rc = LoopThread::init();
+    if (rc != 0) return rc;
+    return queue_.init(loop(), this, on_async);
+  }
+
+  CassLogMessage* acquire() {
+    CassLogMessage* message = NULL;
+    free_messages_.dequeue(message);
+    return message;
+  }
+
+  void enqueue(CassLogMessage* message) {
+    // There's always room because the queue is the same size as the number
+    // of messages
+    queue_.enqueue(message);
+  }
+
+  // Delivers the remaining messages and stops the thread
+  void close() {
+    is_closing_.store(true, MEMORY_ORDER_RELEASE);
+    queue_.send();
+    join();
+  }
+
+private:
+#if UV_VERSION_MAJOR == 0
+  static void on_async(uv_async_t* async, int status) {
+#else
+  static void on_async(uv_async_t* async) {
+#endif
+    AsyncLogger* logger = static_cast<AsyncLogger*>(async->data);
+    CassLogMessage* message;
+    while (logger->queue_.dequeue(message)) {
+      Logger::cb_(message, Logger::data_);
+      logger->free_messages_.enqueue(message);
+    }
+    if (logger->is_closing_.load(MEMORY_ORDER_ACQUIRE)) {
+      logger->queue_.close_handles();
+      logger->close_handles();
+    }
+  }
+
+  MPMCQueue<CassLogMessage*> free_messages_;
+  AsyncQueue<MPMCQueue<CassLogMessage*> > queue_;
+  ScopedPtr<CassLogMessage[]> messages_;
+  Atomic<bool> is_closing_;
+};
+
+static LogRateLimiter rate_limiters[CASS_LOG_LAST_ENTRY];
+static Atomic<uint64_t> dropped_queue_full(0);
+static Atomic<uint64_t> dropped_rate_limited(0);
+
 CassLogLevel Logger::log_level_ = CASS_LOG_WARN;
 CassLogCallback Logger::cb_ = stderr_log_callback;
 void* Logger::data_ = NULL;
+AsyncLogger* Logger::async_logger_ = NULL;
 
 void Logger::log(CassLogLevel severity,
                  const char* file, int line, const char* function,
                  const char* format, va_list args) {
+  uint64_t time_ms = get_time_since_epoch_ms();
+  if (!rate_limiters[severity].try_acquire(time_ms)) {
+    dropped_rate_limited.fetch_add(1, MEMORY_ORDER_RELAXED);
+    return;
+  }
+
+  if (async_logger_ != NULL) {
+    CassLogMessage* message = async_logger_->acquire();
+    if (message == NULL) {
+      dropped_queue_full.fetch_add(1, MEMORY_ORDER_RELAXED);
+      return;
+    }
+    message->time_ms = time_ms;
+    message->severity = severity;
+    message->file = file;
+    message->line = line;
+    message->function = function;
+    vsnprintf(message->message, sizeof(message->message), format, args);
+    async_logger_->enqueue(message);
+    return;
+  }
+
   CassLogMessage message = {
-    get_time_since_epoch_ms(), severity,
+    time_ms, severity,
     file, line, function,
     ""
   };
@@ -75,4 +229,32 @@ void Logger::set_callback(CassLogCallback cb, void* data) {
   data_ = data;
 }
 
+int Logger::start_async(size_t queue_size) {
+  stop_async();
+  ScopedPtr<AsyncLogger> async_logger(new AsyncLogger(queue_size));
+  int rc = async_logger->init();
+  if (rc != 0) return rc;
+  rc = async_logger->run();
+  if (rc != 0) return rc;
+  async_logger_ = async_logger.release();
+  return 0;
+}
+
+void Logger::stop_async() {
+  if (async_logger_ != NULL) {
+    ScopedPtr<AsyncLogger> async_logger(async_logger_);
+    async_logger_ = NULL;
+    async_logger->close();
+  }
+}
+
+void Logger::set_rate_limit(CassLogLevel level, unsigned messages_per_second) {
+  rate_limiters[level].set_messages_per_second(messages_per_second);
+}
+
+void Logger::get_stats(CassLogStats* stats) {
+  stats->dropped_queue_full = dropped_queue_full.load(MEMORY_ORDER_RELAXED);
+  stats->dropped_rate_limited = dropped_rate_limited.load(MEMORY_ORDER_RELAXED);
+}
+
 } // namespace cass
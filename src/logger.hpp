@@ -26,11 +26,26 @@
 
 namespace cass {
 
+class AsyncLogger;
+
 class Logger {
 public:
   static void set_log_level(CassLogLevel level);
   static void set_callback(CassLogCallback cb, void* data);
 
+  // Messages are formatted on the thread that logs them and then delivered to
+  // the callback by a separate logger thread. Logging never blocks: messages
+  // are dropped when the queue is full. These MUST NOT be called while other
+  // threads are logging.
+  static int start_async(size_t queue_size);
+  static void stop_async();
+
+  // Limits the number of messages per second for a log level. Use 0 for no
+  // limit.
+  static void set_rate_limit(CassLogLevel level, unsigned messages_per_second);
+
+  static void get_stats(CassLogStats* stats);
+
 #if defined(__GNUC__) || defined(__clang__)
 #define ATTR_FORMAT(string, first) __attribute__((__format__(__printf__, string, first)))
 #else
@@ -56,9 +71,12 @@ private:
                   const char* format, va_list args);
 
 private:
+  friend class AsyncLogger;
+
   static CassLogLevel log_level_;
   static CassLogCallback cb_;
   static void* data_;
+  static AsyncLogger* async_logger_;
 
   Logger(); // Keep this object from being created
 };
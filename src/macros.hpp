@@ -23,6 +23,9 @@
   TypeName(const TypeName&);               \
   TypeName& operator=(const TypeName&)
 
+#define DISALLOW_ASSIGN(TypeName) \
+  TypeName& operator=(const TypeName&)
+
 #define UNUSED_(X) ((void)X)
 
 #define ZERO_PARAMS1_()
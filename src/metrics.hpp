@@ -469,7 +469,10 @@ public:
     , exceeded_write_bytes_water_mark(&thread_state_)
     , connection_timeouts(&thread_state_)
     , pending_request_timeouts(&thread_state_)
-    , request_timeouts(&thread_state_) {}
+    , request_timeouts(&thread_state_)
+    , retry_budget_retries(&thread_state_)
+    , retry_budget_speculative_executions(&thread_state_)
+    , retry_budget_exhausted(&thread_state_) {}
 
   void record_request(uint64_t latency_ns) {
     // Final measurement is in microseconds
@@ -493,6 +496,10 @@ public:
   Counter pending_request_timeouts;
   Counter request_timeouts;
 
+  Counter retry_budget_retries;
+  Counter retry_budget_speculative_executions;
+  Counter retry_budget_exhausted;
+
 private:
   DISALLOW_COPY_AND_ASSIGN(Metrics);
 };
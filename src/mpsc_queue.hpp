@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/*
+  Implementation of Dmitry Vyukov's intrusive MPSC algorithm
+  http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+*/
+
+#ifndef __CASS_MPSC_QUEUE_INCLUDED__
+#define __CASS_MPSC_QUEUE_INCLUDED__
+
+#include "atomic.hpp"
+#include "macros.hpp"
+
+#include <stddef.h>
+
+namespace cass {
+
+// An unbounded queue where any number of threads can enqueue, but only a
+// single thread can dequeue. Entries must derive from MPSCQueue<T>::Node and
+// can only be in a single queue at a time. Enqueueing never allocates.
+template <class T>
+class MPSCQueue {
+public:
+  class Node {
+  public:
+    Node()
+      : next_(NULL) { }
+
+  private:
+    friend class MPSCQueue;
+    Atomic<Node*> next_;
+  };
+
+  MPSCQueue()
+    : head_(&stub_)
+    , tail_(&stub_) { }
+
+  void enqueue(T* entry) {
+    push(entry);
+  }
+
+  // Returns NULL if the queue is empty or if a producer is in the middle of
+  // enqueueing the next entry.
+  T* dequeue() {
+    Node* tail = tail_;
+    Node* next = tail->next_.load(MEMORY_ORDER_ACQUIRE);
+
+    if (tail == &stub_) {
+      if (next == NULL) return NULL;
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(MEMORY_ORDER_ACQUIRE);
+    }
+
+    if (next != NULL) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+
+    if (tail != head_.load(MEMORY_ORDER_ACQUIRE)) {
+      return NULL;
+    }
+
+    push(&stub_);
+
+    next = tail->next_.load(MEMORY_ORDER_ACQUIRE);
+    if (next != NULL) {
+      tail_ = next;
+      return static_cast<T*>(tail);
+    }
+
+    return NULL;
+  }
+
+  // This can only be called from the consumer thread
+  bool is_empty() const {
+    return tail_ == &stub_ && stub_.next_.load(MEMORY_ORDER_ACQUIRE) == NULL;
+  }
+
+private:
+  void push(Node* node) {
+    node->next_.store(NULL, MEMORY_ORDER_RELAXED);
+    Node* prev = head_.exchange(node, MEMORY_ORDER_ACQ_REL);
+    prev->next_.store(node, MEMORY_ORDER_RELEASE);
+  }
+
+private:
+  // it's either 32 or 64 so 64 is good enough
+  typedef char CachePad[64];
+
+  CachePad pad0_;
+  Atomic<Node*> head_;
+  CachePad pad1_;
+  Node* tail_;
+  Node stub_;
+  CachePad pad2_;
+
+  DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+};
+
+} // namespace cass
+
+#endif
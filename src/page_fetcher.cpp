@@ -0,0 +1,96 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "page_fetcher.hpp"
+
+#include "result_response.hpp"
+#include "scoped_lock.hpp"
+
+namespace cass {
+
+PageFetcher::PageFetcher(const SessionHandle::Ptr& session,
+                         const Statement* statement,
+                         RetryPolicy* retry_policy,
+                         unsigned prefetch_pages)
+  : session_(session)
+  , statement_(statement->copy())
+  , retry_policy_(retry_policy)
+  , prefetch_pages_(prefetch_pages)
+  , has_pending_page_(false) {
+  uv_mutex_init(&mutex_);
+}
+
+PageFetcher::~PageFetcher() {
+  uv_mutex_destroy(&mutex_);
+}
+
+void PageFetcher::on_page(const ResultResponse* result) {
+  if (!result->has_more_pages()) return;
+
+  RequestHandler::Ptr request_handler;
+  {
+    ScopedMutex lock(&mutex_);
+    if (pages_.size() < prefetch_pages_) {
+      request_handler = new_request(result->paging_state().to_string());
+    } else {
+      has_pending_page_ = true;
+      pending_paging_state_ = result->paging_state().to_string();
+    }
+  }
+
+  if (request_handler) {
+    session_->execute(request_handler);
+  }
+}
+
+ResponseFuture::Ptr PageFetcher::next_page() {
+  ResponseFuture::Ptr future;
+  RequestHandler::Ptr request_handler;
+  {
+    ScopedMutex lock(&mutex_);
+    if (pages_.empty()) {
+      return ResponseFuture::Ptr();
+    }
+
+    future = pages_.front();
+    pages_.pop_front();
+
+    // There's room for the page that was deferred
+    if (has_pending_page_ && pages_.size() < prefetch_pages_) {
+      request_handler = new_request(pending_paging_state_);
+      has_pending_page_ = false;
+      pending_paging_state_.clear();
+    }
+  }
+
+  if (request_handler) {
+    session_->execute(request_handler);
+  }
+
+  return future;
+}
+
+RequestHandler::Ptr PageFetcher::new_request(const std::string& paging_state) {
+  ResponseFuture::Ptr future(new ResponseFuture());
+  RequestHandler::Ptr request_handler(new RequestHandler(statement_,
+                                                         future,
+                                                         retry_policy_.get()));
+  request_handler->set_next_page(Ptr(this), paging_state);
+  pages_.push_back(future);
+  return request_handler;
+}
+
+} // namespace cass
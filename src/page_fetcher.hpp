@@ -0,0 +1,90 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_PAGE_FETCHER_HPP_INCLUDED__
+#define __CASS_PAGE_FETCHER_HPP_INCLUDED__
+
+#include "macros.hpp"
+#include "ref_counted.hpp"
+#include "request_handler.hpp"
+#include "retry_policy.hpp"
+#include "session.hpp"
+#include "statement.hpp"
+
+#include <deque>
+#include <string>
+#include <uv.h>
+
+namespace cass {
+
+class ResultResponse;
+
+// Fetches the pages that follow the first page of a paged statement in the
+// background. When a page arrives the next page is requested right away as
+// long as fewer than "prefetch pages" pages are buffered ahead of the page
+// the application is reading. Otherwise, the request is deferred until the
+// application moves on to the next page.
+//
+// The first page's result holds a reference to the fetcher and the fetcher
+// holds the futures for the pages that follow, but those results don't
+// reference the fetcher so there are no cycles. Pages are released as soon
+// as the application moves past them.
+//
+// The fetcher can outlive the session and the statement. It uses a copy of
+// the statement and the session's handle, so pages requested after the
+// session is freed fail with an error.
+class PageFetcher : public RefCounted<PageFetcher> {
+public:
+  typedef SharedRefPtr<PageFetcher> Ptr;
+
+  PageFetcher(const SessionHandle::Ptr& session,
+              const Statement* statement,
+              RetryPolicy* retry_policy,
+              unsigned prefetch_pages);
+  ~PageFetcher();
+
+  // Called on an IO worker thread when a page of rows arrives and before
+  // the page's future is set. This guarantees that the next page is known
+  // by the time the application sees the current one.
+  void on_page(const ResultResponse* result);
+
+  // Called by the application when it moves on to the next page. Returns
+  // the next page's future or an empty pointer if there are no more pages.
+  ResponseFuture::Ptr next_page();
+
+  const Request::ConstPtr& statement() const { return statement_; }
+
+private:
+  RequestHandler::Ptr new_request(const std::string& paging_state);
+
+private:
+  const SessionHandle::Ptr session_;
+  const Request::ConstPtr statement_;
+  const RetryPolicy::Ptr retry_policy_;
+  const unsigned prefetch_pages_;
+
+  uv_mutex_t mutex_;
+  std::deque<ResponseFuture::Ptr> pages_;
+  bool has_pending_page_;
+  std::string pending_paging_state_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(PageFetcher);
+};
+
+} // namespace cass
+
+#endif
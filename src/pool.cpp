@@ -30,6 +30,13 @@
 
 namespace cass {
 
+// The number of load samples taken during each resize window
+static const unsigned RESIZE_SAMPLES_PER_WINDOW = 10;
+
+// A connection is considered saturated if this fraction of its streams are in
+// use or its write queue grows past the write bytes low water mark.
+static const double RESIZE_STREAM_UTILIZATION_THRESHOLD = 0.75;
+
 static bool least_busy_comp(Connection* a, Connection* b) {
   return a->pending_request_count() < b->pending_request_count();
 }
@@ -97,7 +104,8 @@ void SetKeyspaceCallback::on_result_response(ResponseMessage* response) {
 
 Pool::Pool(IOWorker* io_worker,
            const Host::ConstPtr& host,
-           bool is_initial_connection)
+           bool is_initial_connection,
+           bool is_on_demand)
     : io_worker_(io_worker)
     , host_(host)
     , loop_(io_worker->loop())
@@ -108,8 +116,14 @@ Pool::Pool(IOWorker* io_worker,
     , available_connection_count_(0)
     , is_available_(false)
     , is_initial_connection_(is_initial_connection)
+    , is_on_demand_(is_on_demand)
     , is_pending_flush_(false)
-    , cancel_reconnect_(false) { }
+    , cancel_reconnect_(false)
+    , sample_count_(0)
+    , peak_in_flight_(0)
+    , peak_stream_utilization_(0.0)
+    , peak_write_bytes_(0)
+    , is_idle_(false) { }
 
 Pool::~Pool() {
   LOG_DEBUG("Pool(%p) dtor with %u pending requests",
@@ -142,11 +156,11 @@ void Pool::connect() {
   }
 }
 
-void Pool::delayed_connect() {
+void Pool::delayed_connect(uint64_t delay_ms) {
   if (state_ == POOL_STATE_NEW) {
     state_ = POOL_STATE_WAITING_TO_CONNECT;
     connect_timer.start(loop_,
-                        config_.reconnect_wait_time_ms(),
+                        delay_ms,
                         this, on_wait_to_connect);
   }
 }
@@ -158,6 +172,8 @@ void Pool::close(bool cancel_reconnect) {
               host_->address_string().c_str());
 
     connect_timer.stop();
+    resize_timer_.stop();
+    idle_timer_.stop();
 
     // We're closing before we've connected (likely because of an error), we need
     // to notify we're "ready"
@@ -181,6 +197,11 @@ void Pool::close(bool cancel_reconnect) {
          it != end; ++it) {
       (*it)->close();
     }
+    for (ConnectionVec::iterator it = draining_connections_.begin(),
+                                 end = draining_connections_.end();
+         it != end; ++it) {
+      (*it)->close();
+    }
   }
 
   maybe_close();
@@ -206,6 +227,8 @@ Connection* Pool::borrow_connection() {
 }
 
 void Pool::return_connection(Connection* connection) {
+  if (is_draining(connection)) return;
+
   while (connection->is_ready() && !pending_requests_.is_empty()) {
     SpeculativeExecution::Ptr speculative_execution(
           static_cast<SpeculativeExecution*>(pending_requests_.front()));
@@ -226,6 +249,10 @@ void Pool::remove_pending_request(SpeculativeExecution* speculative_execution) {
 }
 
 void Pool::set_is_available(bool is_available) {
+  // Host availability is only tracked by the pools of the IO workers that
+  // own the host
+  if (is_on_demand_) return;
+
   if (is_available) {
     if (!is_available_ &&
         available_connection_count_ > 0 &&
@@ -243,6 +270,7 @@ void Pool::set_is_available(bool is_available) {
 
 bool Pool::write(Connection* connection, const SpeculativeExecution::Ptr& speculative_execution) {
   speculative_execution->set_pool(this);
+  is_idle_ = false;
   if (*io_worker_->keyspace() == connection->keyspace()) {
     if (!connection->write(speculative_execution, false)) {
       return false;
@@ -282,13 +310,15 @@ void Pool::maybe_notify_ready() {
               static_cast<void*>(this),
               host_->address_string().c_str());
     state_ = POOL_STATE_READY;
+    start_resize_timer();
+    start_idle_timer();
     io_worker_->notify_pool_ready(this);
   }
 }
 
 void Pool::maybe_close() {
   if (state_ == POOL_STATE_CLOSING && connections_.empty() &&
-      pending_connections_.empty()) {
+      pending_connections_.empty() && draining_connections_.empty()) {
 
     LOG_DEBUG("Pool(%p) closed connections to host %s",
               static_cast<void*>(this),
@@ -302,6 +332,7 @@ void Pool::spawn_connection() {
   if (state_ != POOL_STATE_CLOSING && state_ != POOL_STATE_CLOSED) {
     Connection* connection =
         new Connection(loop_, config_, metrics_,
+                       io_worker_->buffer_pool(),
                        host_,
                        *io_worker_->keyspace(),
                        io_worker_->protocol_version(),
@@ -333,6 +364,128 @@ void Pool::maybe_spawn_connection() {
   spawn_connection();
 }
 
+void Pool::start_resize_timer() {
+  unsigned window_ms = config_.connection_pool_resize_window_ms();
+  if (window_ms > 0) {
+    uint64_t interval = window_ms / RESIZE_SAMPLES_PER_WINDOW;
+    resize_timer_.start(loop_, interval > 0 ? interval : 1,
+                        this, on_resize_sample);
+  }
+}
+
+void Pool::start_idle_timer() {
+  unsigned timeout_ms = config_.on_demand_pool_idle_timeout_ms();
+  if (is_on_demand_ && timeout_ms > 0) {
+    idle_timer_.start(loop_, timeout_ms, this, on_idle_timeout);
+  }
+}
+
+bool Pool::has_requests_in_flight() {
+  if (!pending_requests_.is_empty()) return true;
+  for (ConnectionVec::const_iterator it = connections_.begin(),
+       end = connections_.end(); it != end; ++it) {
+    if ((*it)->pending_request_count() > 0) return true;
+  }
+  return !draining_connections_.empty();
+}
+
+void Pool::sample_load() {
+  size_t in_flight = pending_requests_.size();
+  for (ConnectionVec::const_iterator it = connections_.begin(),
+       end = connections_.end(); it != end; ++it) {
+    const Connection* connection = *it;
+    size_t pending = connection->pending_request_count();
+    size_t total_streams = pending + connection->available_streams();
+    in_flight += pending;
+    if (total_streams > 0) {
+      double utilization = static_cast<double>(pending) / total_streams;
+      peak_stream_utilization_ = std::max(peak_stream_utilization_, utilization);
+    }
+    peak_write_bytes_ = std::max(peak_write_bytes_,
+                                 connection->pending_writes_size());
+  }
+  peak_in_flight_ = std::max(peak_in_flight_, in_flight);
+  ++sample_count_;
+}
+
+// Sizes the pool for the peak load of the last window. A single saturated
+// connection adds a connection even if the total load doesn't require it
+// (e.g. large requests). The pool grows as fast as connections can be created
+// but only shrinks by one connection per window.
+void Pool::resize() {
+  size_t threshold = config_.max_concurrent_requests_threshold();
+  size_t current = connections_.size();
+
+  size_t target = (peak_in_flight_ + threshold - 1) / threshold;
+  if (peak_stream_utilization_ >= RESIZE_STREAM_UTILIZATION_THRESHOLD ||
+      peak_write_bytes_ >= config_.write_bytes_low_water_mark()) {
+    target = std::max(target, current + 1);
+  }
+  target = std::max<size_t>(target, config_.core_connections_per_host());
+  target = std::min<size_t>(target, config_.max_connections_per_host());
+
+  if (target > current + pending_connections_.size()) {
+    LOG_DEBUG("Growing pool(%p) for host %s from %u to %u connections "
+              "(peak in-flight requests: %u)",
+              static_cast<void*>(this),
+              host_->address_string().c_str(),
+              static_cast<unsigned int>(current),
+              static_cast<unsigned int>(target),
+              static_cast<unsigned int>(peak_in_flight_));
+
+    // Reuse draining connections before creating new ones
+    while (current < target && !draining_connections_.empty()) {
+      Connection* connection = draining_connections_.back();
+      draining_connections_.pop_back();
+      connections_.push_back(connection);
+      return_connection(connection);
+      ++current;
+    }
+    for (size_t i = current + pending_connections_.size(); i < target; ++i) {
+      maybe_spawn_connection();
+    }
+  } else if (target < current) {
+    ConnectionVec::iterator it = std::min_element(
+        connections_.begin(), connections_.end(), least_busy_comp);
+    Connection* connection = *it;
+
+    LOG_DEBUG("Draining connection(%p) from pool(%p) for host %s "
+              "(peak in-flight requests: %u, connections: %u)",
+              static_cast<void*>(connection),
+              static_cast<void*>(this),
+              host_->address_string().c_str(),
+              static_cast<unsigned int>(peak_in_flight_),
+              static_cast<unsigned int>(current));
+
+    connections_.erase(it);
+    draining_connections_.push_back(connection);
+    // Requests may have been written, but not yet flushed
+    connection->flush();
+  }
+
+  sample_count_ = 0;
+  peak_in_flight_ = 0;
+  peak_stream_utilization_ = 0.0;
+  peak_write_bytes_ = 0;
+}
+
+bool Pool::is_draining(Connection* connection) const {
+  return !draining_connections_.empty() &&
+      std::find(draining_connections_.begin(), draining_connections_.end(),
+                connection) != draining_connections_.end();
+}
+
+void Pool::maybe_close_drained() {
+  // Copied because closing a connection can remove it from the vector
+  ConnectionVec draining(draining_connections_);
+  for (ConnectionVec::iterator it = draining.begin(),
+       end = draining.end(); it != end; ++it) {
+    if ((*it)->pending_request_count() == 0) {
+      (*it)->close();
+    }
+  }
+}
+
 Connection* Pool::find_least_busy() {
   ConnectionVec::iterator it = std::min_element(
       connections_.begin(), connections_.end(), least_busy_comp);
@@ -350,6 +503,8 @@ void Pool::on_ready(Connection* connection) {
 
   maybe_notify_ready();
 
+  io_worker_->reset_reconnect_delay(host_->address());
+
   metrics_->total_connections.inc();
 }
 
@@ -362,6 +517,20 @@ void Pool::on_close(Connection* connection) {
   if (it != connections_.end()) {
     connections_.erase(it);
     metrics_->total_connections.dec();
+  } else {
+    it = std::find(draining_connections_.begin(), draining_connections_.end(),
+                   connection);
+    if (it != draining_connections_.end()) {
+      draining_connections_.erase(it);
+      metrics_->total_connections.dec();
+
+      // A drained connection that was closed gracefully doesn't affect the
+      // rest of the pool.
+      if (!connection->is_defunct() && !connection->is_timeout_error()) {
+        maybe_close();
+        return;
+      }
+    }
   }
 
   // For timeouts, if there are any valid connections left then don't close the
@@ -369,7 +538,7 @@ void Pool::on_close(Connection* connection) {
   if (connection->is_timeout_error() && !connections_.empty()) {
     if (!connect_timer.is_running()) {
       connect_timer.start(loop_,
-                          config_.reconnect_wait_time_ms(),
+                          io_worker_->next_reconnect_delay_ms(host_->address()),
                           this, on_partial_reconnect);
     }
     maybe_notify_ready();
@@ -424,7 +593,7 @@ void Pool::on_availability_change(Connection* connection) {
   }
 }
 
-void Pool::on_pending_request_timeout(Timer* timer) {
+void Pool::on_pending_request_timeout(WheelTimer* timer) {
   SpeculativeExecution::Ptr speculative_execution(
         static_cast<SpeculativeExecution*>(timer->data()));
   Pool* pool = speculative_execution->pool();
@@ -482,6 +651,33 @@ void Pool::on_partial_reconnect(Timer* timer) {
   }
 }
 
+void Pool::on_resize_sample(Timer* timer) {
+  Pool* pool = static_cast<Pool*>(timer->data());
+  if (pool->state_ != POOL_STATE_READY) return;
+
+  pool->maybe_close_drained();
+  pool->sample_load();
+  if (pool->sample_count_ >= RESIZE_SAMPLES_PER_WINDOW) {
+    pool->resize();
+  }
+  pool->start_resize_timer();
+}
+
+void Pool::on_idle_timeout(Timer* timer) {
+  Pool* pool = static_cast<Pool*>(timer->data());
+  if (pool->state_ != POOL_STATE_READY) return;
+
+  if (pool->is_idle_ && !pool->has_requests_in_flight()) {
+    LOG_DEBUG("Closing idle on demand pool(%p) for host %s",
+              static_cast<void*>(pool),
+              pool->host_->address_string().c_str());
+    pool->close();
+    return;
+  }
+  pool->is_idle_ = true;
+  pool->start_idle_timer();
+}
+
 void Pool::on_wait_to_connect(Timer* timer) {
   Pool* pool = static_cast<Pool*>(timer->data());
   pool->connect();
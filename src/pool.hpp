@@ -47,13 +47,18 @@ public:
     POOL_STATE_CLOSED
   };
 
+  // On demand pools are created by IO workers for hosts they don't own (see
+  // cass_cluster_set_num_threads_io_per_host()) when a retry or speculative
+  // execution needs one. They aren't reconnected, they don't change the
+  // host's state and they're closed once they've been idle for a while.
   Pool(IOWorker* io_worker,
        const Host::ConstPtr& host,
-       bool is_initial_connection);
+       bool is_initial_connection,
+       bool is_on_demand = false);
   virtual ~Pool();
 
   void connect();
-  void delayed_connect();
+  void delayed_connect(uint64_t delay_ms);
   void close(bool cancel_reconnect = false);
 
   bool write(Connection* connection, const SpeculativeExecution::Ptr& speculative_execution);
@@ -64,9 +69,12 @@ public:
 
   const Host::ConstPtr& host() const { return host_; }
   uv_loop_t* loop() { return loop_; }
+  IOWorker* io_worker() const { return io_worker_; }
   const Config& config() const { return config_; }
 
   bool is_initial_connection() const { return is_initial_connection_; }
+  bool is_on_demand() const { return is_on_demand_; }
+  bool is_connecting() const { return state_ == POOL_STATE_CONNECTING; }
   bool is_ready() const { return state_ == POOL_STATE_READY; }
   bool is_keyspace_error() const {
     return error_code_ == Connection::CONNECTION_ERROR_KEYSPACE;
@@ -92,15 +100,25 @@ private:
   void spawn_connection();
   void maybe_spawn_connection();
 
+  void start_resize_timer();
+  void start_idle_timer();
+  bool has_requests_in_flight();
+  void sample_load();
+  void resize();
+  bool is_draining(Connection* connection) const;
+  void maybe_close_drained();
+
   // Connection listener methods
   virtual void on_ready(Connection* connection);
   virtual void on_close(Connection* connection);
   virtual void on_availability_change(Connection* connection);
   virtual void on_event(EventResponse* response) {}
 
-  static void on_pending_request_timeout(Timer* timer);
+  static void on_pending_request_timeout(WheelTimer* timer);
   static void on_partial_reconnect(Timer* timer);
   static void on_wait_to_connect(Timer* timer);
+  static void on_resize_sample(Timer* timer);
+  static void on_idle_timeout(Timer* timer);
 
   Connection* find_least_busy();
 
@@ -117,14 +135,30 @@ private:
   Connection::ConnectionError error_code_;
   ConnectionVec connections_;
   ConnectionVec pending_connections_;
+  // Connections removed by the resize controller. They stop taking new
+  // requests and are closed once their in-flight requests finish.
+  ConnectionVec draining_connections_;
   List<RequestCallback> pending_requests_;
   int available_connection_count_;
   bool is_available_;
   bool is_initial_connection_;
+  bool is_on_demand_;
   bool is_pending_flush_;
   bool cancel_reconnect_;
 
   Timer connect_timer;
+
+  // The peak load measured during the current resize window
+  unsigned sample_count_;
+  size_t peak_in_flight_;
+  double peak_stream_utilization_;
+  size_t peak_write_bytes_;
+  Timer resize_timer_;
+
+  // Set when the idle timer fires and cleared by each write. An on demand
+  // pool is closed when it's still set on the next tick.
+  bool is_idle_;
+  Timer idle_timer_;
 };
 
 } // namespace cass
@@ -0,0 +1,65 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "power_of_two_choices_policy.hpp"
+
+namespace cass {
+
+static inline bool is_less_busy(const Host::Ptr& a, const Host::Ptr& b) {
+  int64_t a_count = a->inflight_request_count();
+  int64_t b_count = b->inflight_request_count();
+  if (a_count != b_count) return a_count < b_count;
+  return a->pending_write_bytes() < b->pending_write_bytes();
+}
+
+QueryPlan* PowerOfTwoChoicesPolicy::new_query_plan(const std::string& connected_keyspace,
+                                                   RequestHandler* request_handler,
+                                                   const TokenMap* token_map) {
+  QueryPlan* child_plan = child_policy_->new_query_plan(connected_keyspace,
+                                                        request_handler,
+                                                        token_map);
+  return new (QueryPlan::block(request_handler)) PowerOfTwoChoicesQueryPlan(child_policy_.get(),
+                                                                            child_plan);
+}
+
+Host::Ptr PowerOfTwoChoicesPolicy::PowerOfTwoChoicesQueryPlan::compute_next() {
+  if (is_first_) {
+    is_first_ = false;
+    Host::Ptr first(child_plan_->compute_next());
+    if (!first) return first;
+    second_ = child_plan_->compute_next();
+    // Only swap hosts at the same distance so that a less busy remote host
+    // isn't used before a local one
+    if (second_ &&
+        child_policy_->distance(first) == child_policy_->distance(second_) &&
+        is_less_busy(second_, first)) {
+      Host::Ptr temp(first);
+      first = second_;
+      second_ = temp;
+    }
+    return first;
+  }
+
+  if (second_) {
+    Host::Ptr host(second_);
+    second_.reset();
+    return host;
+  }
+
+  return child_plan_->compute_next();
+}
+
+} // namespace cass
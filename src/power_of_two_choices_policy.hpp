@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_POWER_OF_TWO_CHOICES_POLICY_HPP_INCLUDED__
+#define __CASS_POWER_OF_TWO_CHOICES_POLICY_HPP_INCLUDED__
+
+#include "load_balancing.hpp"
+#include "macros.hpp"
+#include "scoped_ptr.hpp"
+
+namespace cass {
+
+// Compares the first two hosts of the child policy's query plan (the first
+// two replicas when it's token-aware) and tries the one with fewer requests
+// in flight first. Pending write bytes break ties. This avoids sending more
+// requests to a replica that's temporarily slow (e.g. because of a GC pause
+// or compaction) without waiting for its average latency to catch up.
+class PowerOfTwoChoicesPolicy : public ChainedLoadBalancingPolicy {
+public:
+  PowerOfTwoChoicesPolicy(LoadBalancingPolicy* child_policy)
+    : ChainedLoadBalancingPolicy(child_policy) {}
+
+  virtual ~PowerOfTwoChoicesPolicy() {}
+
+  virtual QueryPlan* new_query_plan(const std::string& connected_keyspace,
+                                    RequestHandler* request_handler,
+                                    const TokenMap* token_map);
+
+  virtual LoadBalancingPolicy* new_instance() {
+    return new PowerOfTwoChoicesPolicy(child_policy_->new_instance());
+  }
+
+private:
+  class PowerOfTwoChoicesQueryPlan : public QueryPlan {
+  public:
+    PowerOfTwoChoicesQueryPlan(LoadBalancingPolicy* child_policy, QueryPlan* child_plan)
+      : child_policy_(child_policy)
+      , child_plan_(child_plan)
+      , is_first_(true) {}
+
+    Host::Ptr compute_next();
+
+  private:
+    LoadBalancingPolicy* child_policy_;
+    ScopedPtr<QueryPlan> child_plan_;
+    Host::Ptr second_;
+    bool is_first_;
+  };
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(PowerOfTwoChoicesPolicy);
+};
+
+} // namespace cass
+
+#endif
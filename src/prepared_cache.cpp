@@ -0,0 +1,104 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "prepared_cache.hpp"
+
+#include "scoped_lock.hpp"
+
+namespace cass {
+
+PreparedCache::Entry::Entry(const std::string& keyspace,
+                            const std::string& query)
+  : keyspace_(keyspace)
+  , query_(query) {
+  uv_mutex_init(&mutex_);
+}
+
+PreparedCache::Entry::~Entry() {
+  uv_mutex_destroy(&mutex_);
+}
+
+ResultResponse::Ptr PreparedCache::Entry::result(Address* address) const {
+  ScopedMutex lock(&mutex_);
+  if (address != NULL) {
+    *address = address_;
+  }
+  return result_;
+}
+
+bool PreparedCache::Entry::set_result(const Address& address,
+                                      const ResultResponse::Ptr& result) {
+  ScopedMutex lock(&mutex_);
+  if (result_) return false;
+  address_ = address;
+  result_ = result;
+  return true;
+}
+
+PreparedCache::PreparedCache() {
+  uv_mutex_init(&mutex_);
+  marked_hosts_.set_empty_key(Address::EMPTY_KEY);
+  marked_hosts_.set_deleted_key(Address::DELETED_KEY);
+}
+
+PreparedCache::~PreparedCache() {
+  uv_mutex_destroy(&mutex_);
+}
+
+PreparedCache::Entry::Ptr PreparedCache::get(const std::string& keyspace,
+                                             const std::string& query) {
+  ScopedMutex lock(&mutex_);
+  Entry::Ptr& entry = entries_[Key(keyspace, query)];
+  if (!entry) {
+    entry = Entry::Ptr(new Entry(keyspace, query));
+  }
+  return entry;
+}
+
+PreparedCache::EntryVec PreparedCache::prepared_entries(const std::string& keyspace) const {
+  EntryVec entries;
+  ScopedMutex lock(&mutex_);
+  for (EntryMap::const_iterator i = entries_.begin(),
+       end = entries_.end(); i != end; ++i) {
+    if (i->first.first == keyspace && i->second->result()) {
+      entries.push_back(i->second);
+    }
+  }
+  return entries;
+}
+
+void PreparedCache::mark_host(const Address& address) {
+  ScopedMutex lock(&mutex_);
+  marked_hosts_.insert(address);
+}
+
+bool PreparedCache::unmark_host(const Address& address) {
+  ScopedMutex lock(&mutex_);
+  return marked_hosts_.erase(address) > 0;
+}
+
+size_t PreparedCache::size() const {
+  ScopedMutex lock(&mutex_);
+  return entries_.size();
+}
+
+void PreparedCache::clear() {
+  ScopedMutex lock(&mutex_);
+  entries_.clear();
+  marked_hosts_.clear();
+}
+
+} // namespace cass
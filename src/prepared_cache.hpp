@@ -0,0 +1,105 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_PREPARED_CACHE_HPP_INCLUDED__
+#define __CASS_PREPARED_CACHE_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "macros.hpp"
+#include "ref_counted.hpp"
+#include "result_response.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <uv.h>
+#include <vector>
+
+namespace cass {
+
+// The statements prepared using cass_session_prepare_cached() keyed by the
+// session's keyspace and the query string. A statement is prepared on every
+// host that's up the first time it's used and it's prepared again on hosts
+// that come back up (or are added) so that executing it doesn't require
+// re-preparing it after an UNPREPARED error. This can be used from any
+// thread.
+class PreparedCache {
+public:
+  class Entry : public RefCounted<Entry> {
+  public:
+    typedef SharedRefPtr<Entry> Ptr;
+
+    Entry(const std::string& keyspace, const std::string& query);
+    ~Entry();
+
+    const std::string& keyspace() const { return keyspace_; }
+    const std::string& query() const { return query_; }
+
+    // Returns the prepared result (or NULL if the statement hasn't been
+    // prepared yet) and the address of the host that prepared it.
+    ResultResponse::Ptr result(Address* address = NULL) const;
+
+    // Returns true if this is the statement's first prepared result
+    bool set_result(const Address& address, const ResultResponse::Ptr& result);
+
+  private:
+    const std::string keyspace_;
+    const std::string query_;
+    mutable uv_mutex_t mutex_;
+    Address address_;
+    ResultResponse::Ptr result_;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(Entry);
+  };
+
+  typedef std::vector<Entry::Ptr> EntryVec;
+
+  PreparedCache();
+  ~PreparedCache();
+
+  // Returns the entry for the query, adding it if it doesn't exist
+  Entry::Ptr get(const std::string& keyspace, const std::string& query);
+
+  // The statements in the keyspace that have been prepared
+  EntryVec prepared_entries(const std::string& keyspace) const;
+
+  // Hosts that are marked (because they came back up or were added) need
+  // the cached statements prepared once their connections are ready.
+  void mark_host(const Address& address);
+
+  // Returns true if the host was marked
+  bool unmark_host(const Address& address);
+
+  size_t size() const;
+
+  void clear();
+
+private:
+  typedef std::pair<std::string, std::string> Key;
+  typedef std::map<Key, Entry::Ptr> EntryMap;
+
+  mutable uv_mutex_t mutex_;
+  EntryMap entries_;
+  AddressSet marked_hosts_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(PreparedCache);
+};
+
+} // namespace cass
+
+#endif
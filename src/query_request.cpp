@@ -23,6 +23,17 @@
 
 namespace cass {
 
+QueryRequest::QueryRequest(const QueryRequest& other)
+  : Statement(other) {
+  if (other.value_names_) {
+    // The entries are added again because they link to each other
+    value_names_.reset(new ValueNameHashTable(elements().size()));
+    for (size_t i = 0; i < other.value_names_->size(); ++i) {
+      value_names_->add(ValueName((*other.value_names_)[i].name));
+    }
+  }
+}
+
 int QueryRequest::encode(int version, RequestCallback* callback, BufferVec* bufs) const {
   if (version == 1) {
     return encode_v1(callback, bufs);
@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "reconnection_policy.hpp"
+
+#include "random.hpp"
+
+namespace cass {
+
+class ConstantReconnectionSchedule : public ReconnectionSchedule {
+public:
+  ConstantReconnectionSchedule(uint64_t delay_ms)
+    : delay_ms_(delay_ms) { }
+
+  virtual uint64_t next_delay_ms() { return delay_ms_; }
+
+private:
+  const uint64_t delay_ms_;
+};
+
+class ExponentialReconnectionSchedule : public ReconnectionSchedule {
+public:
+  ExponentialReconnectionSchedule(uint64_t base_delay_ms, uint64_t max_delay_ms,
+                                  Random* random)
+    : delay_ms_(base_delay_ms)
+    , max_delay_ms_(max_delay_ms)
+    , random_(random) { }
+
+  virtual uint64_t next_delay_ms() {
+    uint64_t delay_ms = delay_ms_;
+    if (delay_ms_ < max_delay_ms_) {
+      // Doubling is capped before it can overflow
+      delay_ms_ = delay_ms_ > max_delay_ms_ / 2 ? max_delay_ms_ : delay_ms_ * 2;
+    }
+    if (random_ == NULL || delay_ms < 2) {
+      return delay_ms;
+    }
+    uint64_t half = delay_ms / 2;
+    return delay_ms - half + random_->next(half + 1);
+  }
+
+private:
+  uint64_t delay_ms_;
+  const uint64_t max_delay_ms_;
+  Random* random_;
+};
+
+ReconnectionSchedule* ConstantReconnectionPolicy::new_schedule(Random* random) const {
+  return new ConstantReconnectionSchedule(delay_ms_);
+}
+
+ReconnectionSchedule* ExponentialReconnectionPolicy::new_schedule(Random* random) const {
+  return new ExponentialReconnectionSchedule(base_delay_ms_, max_delay_ms_, random);
+}
+
+} // namespace cass
@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_RECONNECTION_POLICY_HPP_INCLUDED__
+#define __CASS_RECONNECTION_POLICY_HPP_INCLUDED__
+
+#include "ref_counted.hpp"
+
+#include <stdint.h>
+
+namespace cass {
+
+class Random;
+
+// The delays between attempts to reconnect to a single host. A schedule is
+// only used by a single thread and it's replaced with a new one once a
+// connection to the host is established.
+class ReconnectionSchedule : public RefCounted<ReconnectionSchedule> {
+public:
+  typedef SharedRefPtr<ReconnectionSchedule> Ptr;
+
+  virtual ~ReconnectionSchedule() { }
+
+  // Returns the delay (in milliseconds) before the next attempt
+  virtual uint64_t next_delay_ms() = 0;
+};
+
+class ReconnectionPolicy : public RefCounted<ReconnectionPolicy> {
+public:
+  typedef SharedRefPtr<ReconnectionPolicy> Ptr;
+
+  enum Type {
+    CONSTANT,
+    EXPONENTIAL
+  };
+
+  ReconnectionPolicy(Type type)
+    : type_(type) { }
+
+  virtual ~ReconnectionPolicy() { }
+
+  Type type() const { return type_; }
+
+  // The random number generator (used for jitter) belongs to the thread
+  // that uses the schedule. It can be NULL.
+  virtual ReconnectionSchedule* new_schedule(Random* random) const = 0;
+
+private:
+  Type type_;
+};
+
+class ConstantReconnectionPolicy : public ReconnectionPolicy {
+public:
+  ConstantReconnectionPolicy(uint64_t delay_ms)
+    : ReconnectionPolicy(CONSTANT)
+    , delay_ms_(delay_ms) { }
+
+  uint64_t delay_ms() const { return delay_ms_; }
+
+  virtual ReconnectionSchedule* new_schedule(Random* random) const;
+
+private:
+  const uint64_t delay_ms_;
+};
+
+// Doubles the delay after each attempt, starting from the base delay, up to
+// the max delay. Each delay is randomly chosen from the upper half of the
+// current delay so that threads and clients that lost their connections at
+// the same time don't reconnect to a restarting host in lockstep.
+class ExponentialReconnectionPolicy : public ReconnectionPolicy {
+public:
+  ExponentialReconnectionPolicy(uint64_t base_delay_ms, uint64_t max_delay_ms)
+    : ReconnectionPolicy(EXPONENTIAL)
+    , base_delay_ms_(base_delay_ms)
+    , max_delay_ms_(max_delay_ms) { }
+
+  uint64_t base_delay_ms() const { return base_delay_ms_; }
+  uint64_t max_delay_ms() const { return max_delay_ms_; }
+
+  virtual ReconnectionSchedule* new_schedule(Random* random) const;
+
+private:
+  const uint64_t base_delay_ms_;
+  const uint64_t max_delay_ms_;
+};
+
+} // namespace cass
+
+#endif
@@ -106,6 +106,12 @@ public:
     copy<T>(ptr);
   }
 
+  void swap(SharedRefPtr<T>& ref) {
+    T* temp = ptr_;
+    ptr_ = ref.ptr_;
+    ref.ptr_ = temp;
+  }
+
   T* get() const { return ptr_; }
   T& operator*() const { return *ptr_; }
   T* operator->() const { return ptr_; }
@@ -130,36 +136,52 @@ private:
   T* ptr_;
 };
 
+class BufferPool;
+
+// The buffer's data directly follows the object. Every buffer is prefixed
+// with a header that records the pool it was allocated from (or NULL if it
+// came from the heap) and the size of its allocation.
 class RefBuffer : public RefCounted<RefBuffer> {
 public:
   typedef SharedRefPtr<RefBuffer> Ptr;
 
-  static RefBuffer* create(size_t size) {
-#if defined(_WIN32)
-#pragma warning(push)
-#pragma warning(disable: 4291) //Invalid warning thrown RefBuffer has a delete function
-#endif
-    return new (size) RefBuffer();
-#if defined(_WIN32)
-#pragma warning(pop)
-#endif
+  static const size_t HEADER_SIZE = 16;
+
+  static size_t allocation_size(size_t size) {
+    return HEADER_SIZE + sizeof(RefBuffer) + size;
   }
 
+  // Creates a buffer that doesn't belong to a pool (defined in buffer_pool.cpp)
+  static RefBuffer* create(size_t size);
+
   char* data() {
     return reinterpret_cast<char*>(this) + sizeof(RefBuffer);
   }
 
-  void operator delete(void* ptr) {
-    ::operator delete(ptr);
-  }
+  // Defined in buffer_pool.cpp
+  void operator delete(void* ptr);
 
 private:
-  RefBuffer() { }
+  friend class BufferPool;
 
-  void* operator new(size_t size, size_t extra) {
-    return ::operator new(size + extra);
+  struct Header {
+    BufferPool* pool;
+    size_t capacity;
+  };
+
+  static RefBuffer* create(char* memory, size_t capacity, BufferPool* pool) {
+    Header* header = reinterpret_cast<Header*>(memory);
+    header->pool = pool;
+    header->capacity = capacity;
+    return ::new (memory + HEADER_SIZE) RefBuffer();
   }
 
+  static Header* header(void* ptr) {
+    return reinterpret_cast<Header*>(static_cast<char*>(ptr) - HEADER_SIZE);
+  }
+
+  RefBuffer() { }
+
   DISALLOW_COPY_AND_ASSIGN(RefBuffer);
 };
 
@@ -64,7 +64,8 @@ public:
     REQUEST_ERROR_BATCH_WITH_NAMED_VALUES = -2,
     REQUEST_ERROR_PARAMETER_UNSET = -3,
     REQUEST_ERROR_NO_AVAILABLE_STREAM_IDS = -4,
-    REQUEST_ERROR_CANCELLED = -5
+    REQUEST_ERROR_CANCELLED = -5,
+    REQUEST_ERROR_COMPRESSION = -6
   };
 
   static const CassConsistency DEFAULT_CONSISTENCY = CASS_CONSISTENCY_LOCAL_ONE;
@@ -132,6 +133,19 @@ public:
 
   virtual int encode(int version, RequestCallback* callback, BufferVec* bufs) const = 0;
 
+protected:
+  Request(const Request& other)
+      : RefCounted<Request>()
+      , opcode_(other.opcode_)
+      , consistency_(other.consistency_)
+      , serial_consistency_(other.serial_consistency_)
+      , timestamp_(other.timestamp_)
+      , is_idempotent_(other.is_idempotent_)
+      , record_attempted_addresses_(other.record_attempted_addresses_)
+      , request_timeout_ms_(other.request_timeout_ms_)
+      , retry_policy_(other.retry_policy_)
+      , custom_payload_(other.custom_payload_) { }
+
 private:
   uint8_t opcode_;
   CassConsistency consistency_;
@@ -144,7 +158,7 @@ private:
   CustomPayload::ConstPtr custom_payload_;
 
 private:
-  DISALLOW_COPY_AND_ASSIGN(Request);
+  DISALLOW_ASSIGN(Request);
 };
 
 class RoutableRequest : public Request {
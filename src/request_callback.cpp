@@ -16,6 +16,7 @@
 
 #include "request_callback.hpp"
 
+#include "compression.hpp"
 #include "config.hpp"
 #include "connection.hpp"
 #include "constants.hpp"
@@ -34,7 +35,7 @@ void RequestCallback::start(Connection* connection, int stream) {
   on_start();
 }
 
-int32_t RequestCallback::encode(int version, int flags, BufferVec* bufs) {
+int32_t RequestCallback::encode(int version, int flags, Compressor* compressor, BufferVec* bufs) {
   size_t index = bufs->size();
   bufs->push_back(Buffer()); // Placeholder
 
@@ -54,6 +55,19 @@ int32_t RequestCallback::encode(int version, int flags, BufferVec* bufs) {
   if (result < 0) return result;
   length += result;
 
+  // The STARTUP message is never compressed because it's used to negotiate
+  // the compression algorithm.
+  if (compressor != NULL && length > 0 && req->opcode() != CQL_OPCODE_STARTUP) {
+    Buffer compressed;
+    if (!compressor->compress(*bufs, index + 1, length, &compressed)) {
+      return Request::REQUEST_ERROR_COMPRESSION;
+    }
+    bufs->resize(index + 1);
+    bufs->push_back(compressed);
+    flags |= CASS_FLAG_COMPRESSION;
+    length = compressed.size();
+  }
+
   const size_t header_size
       = (version >= 3) ? CASS_HEADER_SIZE_V3 : CASS_HEADER_SIZE_V1_AND_V2;
 
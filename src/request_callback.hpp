@@ -32,11 +32,13 @@
 
 namespace cass {
 
+class Compressor;
 class Config;
 class Connection;
 class Metrics;
 class ResponseMessage;
 class ResultResponse;
+class Row;
 
 typedef std::vector<uv_buf_t> UvBufVec;
 
@@ -73,10 +75,26 @@ public:
   virtual void on_error(CassError code, const std::string& message) = 0;
   virtual void on_cancel() = 0;
 
-  int32_t encode(int version, int flags, BufferVec* bufs);
+  int32_t encode(int version, int flags, Compressor* compressor, BufferVec* bufs);
 
   virtual int64_t timestamp() const { return request()->timestamp(); }
 
+  // The paging state to use instead of the statement's (or NULL). This is
+  // used to fetch the following pages of a statement in the background.
+  virtual const std::string* paging_state() const { return NULL; }
+
+  // The rows of a RESULT response are passed to on_row() as they arrive on
+  // the socket, instead of being buffered, if this returns true. It's
+  // checked on the IO worker thread after the response's header arrives.
+  virtual bool is_streaming_rows() const { return false; }
+
+  // Called with the metadata of a streamed result before its first row
+  virtual void on_row_stream_metadata(ResultResponse* result) { }
+
+  // Called for each row of a streamed result. The row is only valid for
+  // the duration of the call.
+  virtual void on_row(const Row* row) { }
+
   Connection* connection() const { return connection_; }
 
   int stream() const { return stream_; }
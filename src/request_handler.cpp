@@ -22,9 +22,11 @@
 #include "error_response.hpp"
 #include "execute_request.hpp"
 #include "io_worker.hpp"
+#include "page_fetcher.hpp"
 #include "pool.hpp"
 #include "prepare_request.hpp"
 #include "response.hpp"
+#include "result_iterator.hpp"
 #include "result_response.hpp"
 #include "row.hpp"
 #include "schema_change_callback.hpp"
@@ -34,6 +36,22 @@
 
 namespace cass {
 
+RequestBlock* QueryPlan::block(RequestHandler* request_handler) {
+  return request_handler != NULL ? request_handler->block() : NULL;
+}
+
+// Returns the statement if the request's rows are passed to a row callback
+static const Statement* row_callback_statement(const Request* request) {
+  if (request->opcode() == CQL_OPCODE_QUERY ||
+      request->opcode() == CQL_OPCODE_EXECUTE) {
+    const Statement* statement = static_cast<const Statement*>(request);
+    if (statement->row_callback() != NULL) {
+      return statement;
+    }
+  }
+  return NULL;
+}
+
 class PrepareCallback : public SimpleRequestCallback {
 public:
   PrepareCallback(const std::string& query, SpeculativeExecution* speculative_execution)
@@ -76,6 +94,31 @@ void PrepareCallback::on_internal_timeout() {
   speculative_execution_->retry_next_host();
 }
 
+RequestHandler::RequestHandler(const Request::ConstPtr& request,
+                               const ResponseFuture::Ptr& future,
+                               RetryPolicy* retry_policy)
+  : request_(request)
+  , timestamp_(request->timestamp())
+  , future_(future)
+  , retry_policy_(retry_policy)
+  , is_handoff_(false)
+  , io_worker_(NULL)
+  , running_executions_(0)
+  , start_time_ns_(uv_hrtime())
+  , streaming_execution_(NULL) { }
+
+RequestHandler::~RequestHandler() { }
+
+void RequestHandler::set_page_fetcher(const PageFetcher::Ptr& page_fetcher) {
+  page_fetcher_ = page_fetcher;
+}
+
+void RequestHandler::set_next_page(const PageFetcher::Ptr& page_fetcher,
+                                   const std::string& paging_state) {
+  page_fetcher_ = page_fetcher;
+  paging_state_ = paging_state;
+}
+
 void RequestHandler::add_execution(SpeculativeExecution* speculative_execution) {
   running_executions_++;
   speculative_execution->inc_ref();
@@ -86,31 +129,104 @@ void RequestHandler::add_attempted_address(const Address& address) {
   future_->add_attempted_address(address);
 }
 
+bool RequestHandler::start_streaming_rows(SpeculativeExecution* speculative_execution) {
+  if (streaming_execution_ != NULL) {
+    return streaming_execution_ == speculative_execution;
+  }
+
+  // Rows can't be taken back once they've been passed to the row callback
+  streaming_execution_ = speculative_execution;
+  for (SpeculativeExecutionVec::const_iterator i = speculative_executions_.begin(),
+       end = speculative_executions_.end(); i != end; ++i) {
+    if (*i != speculative_execution) {
+      (*i)->cancel();
+    }
+  }
+  return true;
+}
+
 void RequestHandler::schedule_next_execution(const Host::Ptr& current_host) {
+  if (streaming_execution_ != NULL) return;
   int64_t timeout = execution_plan_->next_execution(current_host);
   if (timeout >= 0) {
     SpeculativeExecution::Ptr speculative_execution(
-          new SpeculativeExecution(RequestHandler::Ptr(this)));
+          new (block()) SpeculativeExecution(RequestHandler::Ptr(this)));
     speculative_execution->schedule_next(timeout);
   }
 }
 
+bool RequestHandler::acquire_retry_budget(bool is_speculative_execution) {
+  RetryBudget* retry_budget = io_worker_->session()->retry_budget();
+  if (retry_budget == NULL) return true;
+
+  Metrics* metrics = io_worker_->metrics();
+  if (!retry_budget->try_withdraw()) {
+    metrics->retry_budget_exhausted.inc();
+    return false;
+  }
+  if (is_speculative_execution) {
+    metrics->retry_budget_speculative_executions.inc();
+  } else {
+    metrics->retry_budget_retries.inc();
+  }
+  return true;
+}
+
 void RequestHandler::start_request(IOWorker* io_worker) {
   io_worker_ = io_worker;
   uint64_t request_timeout_ms = request_->request_timeout_ms(
                                   io_worker->config().request_timeout_ms());
   if (request_timeout_ms > 0) { // 0 means no timeout
-    timer_.start(io_worker->loop(),
+    timer_.start(io_worker->timer_wheel(),
                  request_timeout_ms,
                  this,
                  on_timeout);
   }
 }
 
+void RequestHandler::on_page(const Response::Ptr& response) {
+  if (response->opcode() != CQL_OPCODE_RESULT) return;
+
+  ResultResponse* result = static_cast<ResultResponse*>(response.get());
+  if (result->kind() != CASS_RESULT_KIND_ROWS) return;
+
+  // Only the first page references the fetcher so that the application can
+  // iterate over the following pages.
+  if (paging_state_.empty()) {
+    result->set_page_fetcher(page_fetcher_);
+  }
+  page_fetcher_->on_page(result);
+}
+
+void RequestHandler::on_prepared(const Host::Ptr& host,
+                                 const Response::Ptr& response) {
+  if (response->opcode() != CQL_OPCODE_RESULT) return;
+
+  ResultResponse::Ptr result(static_cast<ResultResponse*>(response.get()));
+  if (result->kind() != CASS_RESULT_KIND_PREPARED) return;
+
+  if (prepared_entry_->set_result(host->address(), result)) {
+    io_worker_->session()->prepare_on_all_hosts(prepared_entry_, host->address());
+  }
+}
+
 void RequestHandler::set_response(const Host::Ptr& host,
                                   const Response::Ptr& response) {
+  // Cache prepared statements before the future is set so that they're
+  // available as soon as the application sees the result.
+  if (prepared_entry_) {
+    on_prepared(host, response);
+  }
+  // The next page needs to be requested before the future is set
+  if (page_fetcher_ && !future_->ready()) {
+    on_page(response);
+  }
   if (future_->set_response(host->address(), response)) {
     io_worker_->metrics()->record_request(uv_hrtime() - start_time_ns_);
+    RetryBudget* retry_budget = io_worker_->session()->retry_budget();
+    if (retry_budget != NULL) {
+      retry_budget->deposit();
+    }
     stop_request();
   }
 }
@@ -144,7 +260,7 @@ void RequestHandler::set_error_with_error_response(const Host::Ptr& host,
   }
 }
 
-void RequestHandler::on_timeout(Timer* timer) {
+void RequestHandler::on_timeout(WheelTimer* timer) {
   RequestHandler* request_handler =
       static_cast<RequestHandler*>(timer->data());
   request_handler->io_worker_->metrics()->request_timeouts.inc();
@@ -177,8 +293,41 @@ SpeculativeExecution::SpeculativeExecution(const RequestHandler::Ptr& request_ha
   request_handler_->add_execution(this);
 }
 
-void SpeculativeExecution::on_execute(Timer* timer) {
+bool SpeculativeExecution::is_streaming_rows() const {
+  return !is_cancelled() &&
+      row_callback_statement(request()) != NULL &&
+      (request_handler_->streaming_execution_ == NULL ||
+       request_handler_->streaming_execution_ == this);
+}
+
+void SpeculativeExecution::on_row_stream_metadata(ResultResponse* result) {
+  // See on_result_response()
+  if (request()->opcode() == CQL_OPCODE_EXECUTE && result->no_metadata()) {
+    const ExecuteRequest* execute = static_cast<const ExecuteRequest*>(request());
+    if (execute->skip_metadata()) {
+      result->set_metadata(execute->prepared()->result()->result_metadata().get());
+    }
+  }
+  request_handler_->start_streaming_rows(this);
+}
+
+void SpeculativeExecution::on_row(const Row* row) {
+  if (is_cancelled() || request_handler_->streaming_execution_ != this) {
+    return;
+  }
+  const Statement* statement = row_callback_statement(request());
+  statement->row_callback()(CassRow::to(row), statement->row_callback_data());
+}
+
+void SpeculativeExecution::on_execute(WheelTimer* timer) {
   SpeculativeExecution* speculative_execution = static_cast<SpeculativeExecution*>(timer->data());
+  RequestHandler* request_handler = speculative_execution->request_handler_.get();
+  if (!request_handler->execution_plan_->can_execute() ||
+      !request_handler->acquire_retry_budget(true)) {
+    // The execution is left idle and is cleaned up when the request finishes
+    --request_handler->running_executions_;
+    return;
+  }
   speculative_execution->next_host();
   speculative_execution->execute();
 }
@@ -226,6 +375,12 @@ void SpeculativeExecution::on_error(CassError code, const std::string& message)
 void SpeculativeExecution::on_retry(bool use_next_host) {
   return_connection();
 
+  if (!request_handler_->acquire_retry_budget(false)) {
+    set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT,
+              "Request timed out and the retry budget is exhausted");
+    return;
+  }
+
   if (use_next_host) {
     retry_next_host();
   } else {
@@ -247,6 +402,13 @@ void SpeculativeExecution::retry_current_host() {
     return;
   }
 
+  if (request_handler_->streaming_execution_ == this) {
+    set_error(CASS_ERROR_LIB_UNEXPECTED_RESPONSE,
+              "Unable to retry a statement after its rows have been passed "
+              "to the row callback");
+    return;
+  }
+
   // Reset the request so it can be executed again
   set_state(REQUEST_STATE_NEW);
   pool_ = NULL;
@@ -258,9 +420,10 @@ void SpeculativeExecution::retry_next_host() {
   retry_current_host();
 }
 
-void SpeculativeExecution::start_pending_request(Pool* pool, Timer::Callback cb) {
+void SpeculativeExecution::start_pending_request(Pool* pool, WheelTimer::Callback cb) {
   pool_ = pool;
-  pending_request_timer_.start(pool->loop(), pool->config().connect_timeout_ms(), this, cb);
+  pending_request_timer_.start(pool->io_worker()->timer_wheel(),
+                               pool->config().connect_timeout_ms(), this, cb);
 }
 
 void SpeculativeExecution::stop_pending_request() {
@@ -277,7 +440,7 @@ void SpeculativeExecution::execute() {
 
 void SpeculativeExecution::schedule_next(int64_t timeout) {
   if (timeout > 0) {
-    schedule_timer_.start(request_handler_->io_worker()->loop(), timeout, this, on_execute);
+    schedule_timer_.start(request_handler_->io_worker()->timer_wheel(), timeout, this, on_execute);
   } else {
     next_host();
     execute();
@@ -293,6 +456,8 @@ void SpeculativeExecution::on_result_response(ResponseMessage* response) {
   ResultResponse* result =
       static_cast<ResultResponse*>(response->response_body().get());
 
+  current_host_->update_percentile_latency(uv_hrtime() - start_time_ns_);
+
   switch (result->kind()) {
     case CASS_RESULT_KIND_ROWS:
       current_host_->update_latency(uv_hrtime() - start_time_ns_);
@@ -309,6 +474,21 @@ void SpeculativeExecution::on_result_response(ResponseMessage* response) {
         }
         result->set_metadata(execute->prepared()->result()->result_metadata().get());
       }
+
+      // Rows that weren't streamed as they arrived (e.g. compressed frames)
+      // are passed to the row callback now.
+      if (result->row_count() > 0) {
+        const Statement* statement = row_callback_statement(request());
+        if (statement != NULL && request_handler_->start_streaming_rows(this)) {
+          ResultIterator iterator(result);
+          while (iterator.next()) {
+            statement->row_callback()(CassRow::to(iterator.row()),
+                                      statement->row_callback_data());
+          }
+          result->clear_rows();
+        }
+      }
+
       set_response(response->response_body());
       break;
 
@@ -407,6 +587,12 @@ void SpeculativeExecution::on_error_response(ResponseMessage* response) {
       break;
   }
 
+  // Fail fast with the error when the retry budget is exhausted
+  if (decision.type() == RetryPolicy::RetryDecision::RETRY &&
+      !request_handler_->acquire_retry_budget(false)) {
+    decision = RetryPolicy::RetryDecision::return_error();
+  }
+
   // Process retry decision
   switch(decision.type()) {
     case RetryPolicy::RetryDecision::RETURN_ERROR:
@@ -470,6 +656,13 @@ bool SpeculativeExecution::is_host_up(const Address& address) const {
   return request_handler_->io_worker()->is_host_up(address);
 }
 
+bool SpeculativeExecution::is_cancelled() const {
+  return state() == REQUEST_STATE_CANCELLED ||
+      state() == REQUEST_STATE_CANCELLED_WRITING ||
+      state() == REQUEST_STATE_CANCELLED_READING ||
+      state() == REQUEST_STATE_CANCELLED_READ_BEFORE_WRITE;
+}
+
 void SpeculativeExecution::set_response(const Response::Ptr& response) {
   request_handler_->set_response(current_host_, response);
 }
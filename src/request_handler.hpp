@@ -25,11 +25,14 @@
 #include "load_balancing.hpp"
 #include "metadata.hpp"
 #include "request.hpp"
+#include "request_pool.hpp"
 #include "response.hpp"
+#include "prepared_cache.hpp"
 #include "retry_policy.hpp"
 #include "scoped_ptr.hpp"
 #include "small_vector.hpp"
 #include "speculative_execution.hpp"
+#include "timer_wheel.hpp"
 
 #include <string>
 #include <uv.h>
@@ -38,10 +41,11 @@ namespace cass {
 
 class Connection;
 class IOWorker;
+class PageFetcher;
 class Pool;
 class Timer;
 
-class ResponseFuture : public Future {
+class ResponseFuture : public Future, public RequestBlockAllocated {
 public:
   typedef SharedRefPtr<ResponseFuture> Ptr;
 
@@ -123,26 +127,43 @@ private:
 
 class SpeculativeExecution;
 
-class RequestHandler : public RefCounted<RequestHandler> {
+class RequestHandler : public RefCounted<RequestHandler>, public RequestBlockAllocated {
 public:
   typedef SharedRefPtr<RequestHandler> Ptr;
 
   RequestHandler(const Request::ConstPtr& request,
                  const ResponseFuture::Ptr& future,
-                 RetryPolicy* retry_policy)
-    : request_(request)
-    , timestamp_(request->timestamp())
-    , future_(future)
-    , retry_policy_(retry_policy)
-    , io_worker_(NULL)
-    , running_executions_(0)
-    , start_time_ns_(uv_hrtime()) { }
+                 RetryPolicy* retry_policy);
+
+  ~RequestHandler();
 
   const Request* request() const { return request_.get(); }
 
+  // The block the handler was allocated from (or NULL). Speculative
+  // executions are allocated from the same block while it has room.
+  RequestBlock* block() const { return RequestBlock::from(this); }
+
   int64_t timestamp() const { return timestamp_; }
   void set_timestamp(int64_t timestamp) { timestamp_ = timestamp; }
 
+  // The paging state for a page that's fetched in the background (or NULL)
+  const std::string* paging_state() const {
+    return paging_state_.empty() ? NULL : &paging_state_;
+  }
+
+  // Prefetch the pages that follow the first page of the request
+  void set_page_fetcher(const SharedRefPtr<PageFetcher>& page_fetcher);
+
+  // This request fetches one of the following pages
+  void set_next_page(const SharedRefPtr<PageFetcher>& page_fetcher,
+                     const std::string& paging_state);
+
+  // Cache the statement when it's prepared. The first time this happens the
+  // statement is also prepared on all the other hosts that are up.
+  void set_prepared_entry(const PreparedCache::Entry::Ptr& prepared_entry) {
+    prepared_entry_ = prepared_entry;
+  }
+
   Request::EncodingCache* encoding_cache() { return &encoding_cache_; }
 
   RetryPolicy* retry_policy() { return retry_policy_; }
@@ -155,15 +176,29 @@ public:
     preferred_address_ = preferred_address;
   }
 
-  void set_query_plan(QueryPlan* query_plan) { query_plan_.reset(query_plan); }
+  // Hosts with the skipped address (if it's valid) aren't returned by the
+  // query plan
+  void set_query_plan(QueryPlan* query_plan,
+                      const Address& skipped_address = Address()) {
+    query_plan_.reset(query_plan);
+    skipped_address_ = skipped_address;
+  }
 
   void set_execution_plan(SpeculativeExecutionPlan* execution_plan) {
     execution_plan_.reset(execution_plan);
   }
 
+  // Set when the request is handed off to an IO worker that owns the first
+  // host in its query plan. That IO worker rebuilds the query plan.
+  bool is_handoff() const { return is_handoff_; }
+  void set_is_handoff(bool is_handoff) { is_handoff_ = is_handoff; }
+
   const Host::Ptr& current_host() const { return current_host_; }
   const Host::Ptr& next_host() {
     current_host_ = query_plan_->compute_next();
+    if (current_host_ && current_host_->address() == skipped_address_) {
+      current_host_ = query_plan_->compute_next();
+    }
     return current_host_;
   }
 
@@ -181,15 +216,27 @@ public:
                                      CassError code, const std::string& message);
 
 private:
-  static void on_timeout(Timer* timer);
+  static void on_timeout(WheelTimer* timer);
 
 private:
   friend class SpeculativeExecution;
 
   void add_execution(SpeculativeExecution* speculative_execution);
+  void on_page(const Response::Ptr& response);
+  void on_prepared(const Host::Ptr& host, const Response::Ptr& response);
+
+  // Only one execution can pass rows to the statement's row callback. The
+  // others are cancelled. Returns false if another execution already has.
+  bool start_streaming_rows(SpeculativeExecution* speculative_execution);
+
   void add_attempted_address(const Address& address);
   void schedule_next_execution(const Host::Ptr& current_host);
 
+  // Takes a token from the session's retry budget (if there is one) before
+  // a request that was already sent to a host is sent again. Returns false
+  // if the budget is exhausted.
+  bool acquire_retry_budget(bool is_speculative_execution);
+
   // This MUST only be called once and that's currently guaranteed by the
   // response future.
   void stop_request();
@@ -202,18 +249,24 @@ private:
   SharedRefPtr<ResponseFuture> future_;
   RetryPolicy* retry_policy_;
   ScopedPtr<QueryPlan> query_plan_;
+  Address skipped_address_;
+  bool is_handoff_;
   ScopedPtr<SpeculativeExecutionPlan> execution_plan_;
   Host::Ptr current_host_;
   IOWorker* io_worker_;
-  Timer timer_;
+  WheelTimer timer_;
   int running_executions_;
   SpeculativeExecutionVec speculative_executions_;
   Request::EncodingCache encoding_cache_;
   uint64_t start_time_ns_;
   Address preferred_address_;
+  SharedRefPtr<PageFetcher> page_fetcher_;
+  std::string paging_state_;
+  SpeculativeExecution* streaming_execution_;
+  PreparedCache::Entry::Ptr prepared_entry_;
 };
 
-class SpeculativeExecution : public RequestCallback {
+class SpeculativeExecution : public RequestCallback, public RequestBlockAllocated {
 public:
   typedef SharedRefPtr<SpeculativeExecution> Ptr;
 
@@ -222,8 +275,13 @@ public:
 
   virtual const Request* request() const { return request_handler_->request(); }
   virtual int64_t timestamp() const { return request_handler_->timestamp(); }
+  virtual const std::string* paging_state() const { return request_handler_->paging_state(); }
   virtual Request::EncodingCache* encoding_cache() { return request_handler_->encoding_cache(); }
 
+  virtual bool is_streaming_rows() const;
+  virtual void on_row_stream_metadata(ResultResponse* result);
+  virtual void on_row(const Row* row);
+
   Pool* pool() const { return pool_; }
   void set_pool(Pool* pool) { pool_ = pool; }
 
@@ -233,7 +291,7 @@ public:
   void retry_current_host();
   void retry_next_host();
 
-  void start_pending_request(Pool* pool, Timer::Callback cb);
+  void start_pending_request(Pool* pool, WheelTimer::Callback cb);
   void stop_pending_request();
 
   void execute();
@@ -243,7 +301,7 @@ public:
   virtual void on_error(CassError code, const std::string& message);
 
 private:
-  static void on_execute(Timer* timer);
+  static void on_execute(WheelTimer* timer);
 
   virtual void on_start();
 
@@ -262,6 +320,7 @@ private:
   friend class SchemaChangeCallback;
 
   bool is_host_up(const Address& address) const;
+  bool is_cancelled() const;
 
   void set_response(const Response::Ptr& response);
   void set_error(CassError code, const std::string& message);
@@ -273,8 +332,8 @@ private:
   Host::Ptr current_host_;
   Pool* pool_;
   Connection* connection_;
-  Timer schedule_timer_;
-  Timer pending_request_timer_;
+  WheelTimer schedule_timer_;
+  WheelTimer pending_request_timer_;
   int num_retries_;
   uint64_t start_time_ns_;
 };
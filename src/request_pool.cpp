@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "request_pool.hpp"
+
+#include <assert.h>
+#include <new>
+#include <stdlib.h>
+
+namespace cass {
+
+static size_t block_data_offset() {
+  return (sizeof(RequestBlock) + RequestBlock::HEADER_SIZE - 1) &
+      ~(RequestBlock::HEADER_SIZE - 1);
+}
+
+char* RequestBlock::data() {
+  return reinterpret_cast<char*>(this) + block_data_offset();
+}
+
+void* RequestBlock::allocate(RequestBlock* block, size_t size) {
+  size_t allocation_size = RequestBlock::allocation_size(size);
+  char* ptr;
+  if (block != NULL && block->used_ + allocation_size <= block->size_) {
+    ptr = block->data() + block->used_;
+    block->used_ += allocation_size;
+    block->inc_ref();
+  } else {
+    ptr = static_cast<char*>(malloc(allocation_size));
+    if (ptr == NULL) throw std::bad_alloc();
+    block = NULL;
+  }
+  *reinterpret_cast<RequestBlock**>(ptr) = block;
+  return ptr + HEADER_SIZE;
+}
+
+void RequestBlock::deallocate(void* ptr) {
+  if (ptr == NULL) return;
+  RequestBlock* block = from(ptr);
+  if (block != NULL) {
+    block->dec_ref();
+  } else {
+    free(static_cast<char*>(ptr) - HEADER_SIZE);
+  }
+}
+
+void RequestBlock::dec_ref() {
+  int new_ref_count = ref_count_.fetch_sub(1, MEMORY_ORDER_RELEASE);
+  assert(new_ref_count >= 1);
+  if (new_ref_count == 1) {
+    atomic_thread_fence(MEMORY_ORDER_ACQUIRE);
+    pool_->release(this);
+  }
+}
+
+RequestPool::RequestPool(size_t block_size, size_t max_cached_blocks)
+  : block_size_(block_size)
+  , blocks_(max_cached_blocks)
+  , blocks_allocated_(0) { }
+
+RequestPool::~RequestPool() {
+  RequestBlock* block;
+  while (blocks_.dequeue(block)) {
+    block->~RequestBlock();
+    free(block);
+  }
+}
+
+RequestBlock* RequestPool::acquire() {
+  RequestBlock* block;
+  if (!blocks_.dequeue(block)) {
+    void* memory = malloc(block_data_offset() + block_size_);
+    if (memory == NULL) throw std::bad_alloc();
+    block = new (memory) RequestBlock(this, block_size_);
+    blocks_allocated_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  }
+  // Blocks keep their pool alive while they're in use
+  inc_ref();
+  // Nothing else can reference the block yet
+  block->ref_count_.store(1, MEMORY_ORDER_RELAXED);
+  return block;
+}
+
+void RequestPool::release(RequestBlock* block) {
+  block->used_ = 0;
+  if (!blocks_.enqueue(block)) {
+    block->~RequestBlock();
+    free(block);
+  }
+  dec_ref();
+}
+
+} // namespace cass
@@ -0,0 +1,139 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_REQUEST_POOL_HPP_INCLUDED__
+#define __CASS_REQUEST_POOL_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "macros.hpp"
+#include "mpmc_queue.hpp"
+#include "ref_counted.hpp"
+
+#include <stddef.h>
+
+namespace cass {
+
+class RequestPool;
+
+// A block of memory that holds the objects that make up a request's
+// lifecycle (the response future, the request handler and its first
+// speculative execution) so they can be created with a single allocation.
+// The objects keep their own reference counts and the block is returned
+// to its pool once all of them have been destroyed.
+class RequestBlock {
+public:
+  // Every allocation is prefixed with a header that points back to the
+  // block it came from (or NULL if it came from the heap). This keeps
+  // objects aligned for any of the types stored in a block.
+  static const size_t HEADER_SIZE = 16;
+
+  static size_t allocation_size(size_t size) {
+    return HEADER_SIZE + ((size + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1));
+  }
+
+  // Allocates from the block and falls back to the heap if the block is
+  // NULL or doesn't have enough space left.
+  static void* allocate(RequestBlock* block, size_t size);
+  static void deallocate(void* ptr);
+
+  // The block that an object was allocated from or NULL
+  static RequestBlock* from(const void* ptr) {
+    return *reinterpret_cast<RequestBlock* const*>(
+          static_cast<const char*>(ptr) - HEADER_SIZE);
+  }
+
+  // Each object allocated from the block holds a reference. The creator of
+  // a block also holds a reference until it's done constructing objects.
+  void inc_ref() { ref_count_.fetch_add(1, MEMORY_ORDER_RELAXED); }
+  void dec_ref();
+
+private:
+  friend class RequestPool;
+
+  RequestBlock(RequestPool* pool, size_t size)
+    : pool_(pool)
+    , ref_count_(0)
+    , size_(size)
+    , used_(0) { }
+
+  char* data();
+
+  RequestPool* const pool_;
+  Atomic<int> ref_count_;
+  const size_t size_;
+  size_t used_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(RequestBlock);
+};
+
+// A cache of request blocks that can be used from any thread. Blocks are
+// allocated on the calling thread and released on whatever thread drops
+// the last reference so a bounded lock-free queue is used instead of
+// per-thread caches. Blocks hold a reference to their pool so it's safe
+// for futures to outlive the session.
+class RequestPool : public RefCounted<RequestPool> {
+public:
+  typedef SharedRefPtr<RequestPool> Ptr;
+
+  RequestPool(size_t block_size, size_t max_cached_blocks);
+  ~RequestPool();
+
+  size_t block_size() const { return block_size_; }
+
+  // Returns an empty block with a single reference held by the caller
+  RequestBlock* acquire();
+
+  size_t blocks_allocated() const {
+    return blocks_allocated_.load(MEMORY_ORDER_RELAXED);
+  }
+
+private:
+  friend class RequestBlock;
+
+  void release(RequestBlock* block);
+
+private:
+  const size_t block_size_;
+  MPMCQueue<RequestBlock*> blocks_;
+  Atomic<size_t> blocks_allocated_;
+};
+
+// Objects that derive from this can be constructed in a request block
+// using "new (block) T(...)". Normal "new T(...)" allocates from the heap.
+class RequestBlockAllocated {
+public:
+  static void* operator new(size_t size) {
+    return RequestBlock::allocate(NULL, size);
+  }
+
+  static void* operator new(size_t size, RequestBlock* block) {
+    return RequestBlock::allocate(block, size);
+  }
+
+  static void operator delete(void* ptr) {
+    RequestBlock::deallocate(ptr);
+  }
+
+  // Only called if a constructor throws
+  static void operator delete(void* ptr, RequestBlock* block) {
+    RequestBlock::deallocate(ptr);
+  }
+};
+
+} // namespace cass
+
+#endif
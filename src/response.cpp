@@ -17,11 +17,14 @@
 #include "response.hpp"
 
 #include "auth_responses.hpp"
+#include "compression.hpp"
 #include "error_response.hpp"
 #include "event_response.hpp"
 #include "logger.hpp"
 #include "ready_response.hpp"
+#include "request_callback.hpp"
 #include "result_response.hpp"
+#include "row_stream.hpp"
 #include "supported_response.hpp"
 #include "serialization.hpp"
 
@@ -54,6 +57,39 @@ char* Response::decode_warnings(char* buffer, size_t size) {
   return pos;
 }
 
+ResponseMessage::ResponseMessage(Compressor* compressor,
+                                 BufferPool* buffer_pool)
+  : compressor_(compressor)
+  , buffer_pool_(buffer_pool)
+  , version_(0)
+  , flags_(0)
+  , stream_(0)
+  , opcode_(0)
+  , length_(0)
+  , received_(0)
+  , header_size_(0)
+  , is_header_received_(false)
+  , header_buffer_pos_(header_buffer_)
+  , is_body_ready_(false)
+  , is_body_error_(false)
+  , body_buffer_pos_(NULL)
+  , is_row_stream_pending_(false) { }
+
+ResponseMessage::~ResponseMessage() { }
+
+void ResponseMessage::start_row_stream(const RequestCallback::Ptr& callback) {
+  assert(is_row_stream_pending_);
+  is_row_stream_pending_ = false;
+  if (callback) {
+    row_stream_.reset(new RowStream(version_,
+                                    static_cast<ResultResponse*>(response_body_.get()),
+                                    callback));
+  } else {
+    response_body_->set_buffer(length_, buffer_pool_);
+    body_buffer_pos_ = response_body_->data();
+  }
+}
+
 bool ResponseMessage::allocate_body(int8_t opcode) {
   response_body_.reset();
   switch (opcode) {
@@ -95,6 +131,42 @@ bool ResponseMessage::allocate_body(int8_t opcode) {
   }
 }
 
+bool ResponseMessage::can_stream_rows() const {
+  // The rows of compressed frames and frames with a prefix before the result
+  // are only decoded once the whole body has arrived.
+  return opcode_ == CQL_OPCODE_RESULT && length_ > 0 &&
+      !(flags_ & (CASS_FLAG_COMPRESSION | CASS_FLAG_TRACING |
+                  CASS_FLAG_WARNING | CASS_FLAG_CUSTOM_PAYLOAD));
+}
+
+bool ResponseMessage::decompress_body() {
+  if (compressor_ == NULL) {
+    LOG_ERROR("Received a compressed frame, but compression wasn't negotiated");
+    return false;
+  }
+
+  // Keep the compressed body alive while it's decompressed into a new buffer
+  RefBuffer::Ptr compressed(response_body_->buffer());
+
+  size_t length = 0;
+  if (!compressor_->uncompressed_length(compressed->data(), length_, &length) ||
+      length > static_cast<size_t>(CASS_MAX_FRAME_BODY_SIZE)) {
+    LOG_ERROR("Invalid uncompressed length for %s compressed frame",
+              compressor_->name());
+    return false;
+  }
+
+  response_body_->set_buffer(length, buffer_pool_);
+  if (!compressor_->decompress(compressed->data(), length_,
+                               response_body_->data(), length)) {
+    LOG_ERROR("Unable to decompress %s compressed frame", compressor_->name());
+    return false;
+  }
+
+  length_ = static_cast<int32_t>(length);
+  return true;
+}
+
 ssize_t ResponseMessage::decode(char* input, size_t size) {
   char* input_pos = input;
 
@@ -138,7 +210,15 @@ ssize_t ResponseMessage::decode(char* input, size_t size) {
         return -1;
       }
 
-      response_body_->set_buffer(length_);
+      if (can_stream_rows()) {
+        // Stop after the header so the rest of the frame is decoded after
+        // start_row_stream(). Only the header's bytes have been consumed.
+        is_row_stream_pending_ = true;
+        received_ = header_size_;
+        return input_pos - input;
+      }
+
+      response_body_->set_buffer(length_, buffer_pool_);
       body_buffer_pos_ = response_body_->data();
     } else {
       // We haven't received all the data for the header. We consume the
@@ -157,11 +237,25 @@ ssize_t ResponseMessage::decode(char* input, size_t size) {
     size_t overage = received_ - frame_size;
     size_t needed = remaining - overage;
 
+    if (row_stream_) {
+      if (!row_stream_->decode(input_pos, needed) || !row_stream_->finish()) {
+        is_body_error_ = true;
+        return -1;
+      }
+      is_body_ready_ = true;
+      return (input_pos + needed) - input;
+    }
+
     memcpy(body_buffer_pos_, input_pos, needed);
     body_buffer_pos_ += needed;
     input_pos += needed;
     assert(body_buffer_pos_ == response_body_->data() + length_);
 
+    if ((flags_ & CASS_FLAG_COMPRESSION) && !decompress_body()) {
+      is_body_error_ = true;
+      return -1;
+    }
+
     char* pos = response_body()->data();
 
     if (flags_ & CASS_FLAG_WARNING) {
@@ -181,6 +275,13 @@ ssize_t ResponseMessage::decode(char* input, size_t size) {
   } else {
     // We haven't received all the data for the frame. We consume the entire
     // buffer.
+    if (row_stream_) {
+      if (!row_stream_->decode(input_pos, remaining)) {
+        is_body_error_ = true;
+        return -1;
+      }
+      return size;
+    }
     memcpy(body_buffer_pos_, input_pos, remaining);
     body_buffer_pos_ += remaining;
     return size;
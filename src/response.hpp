@@ -18,16 +18,21 @@
 #define __CASS_RESPONSE_HPP_INCLUDED__
 
 #include "utils.hpp"
+#include "buffer_pool.hpp"
 #include "constants.hpp"
 #include "hash_table.hpp"
 #include "macros.hpp"
 #include "ref_counted.hpp"
+#include "row_stream.hpp"
 #include "scoped_ptr.hpp"
 
 #include <uv.h>
 
 namespace cass {
 
+class Compressor;
+class RequestCallback;
+
 class Response : public RefCounted<Response> {
 public:
   typedef SharedRefPtr<Response> Ptr;
@@ -53,8 +58,11 @@ public:
 
   const RefBuffer::Ptr& buffer() const { return buffer_; }
 
-  void set_buffer(size_t size) {
-    buffer_ = RefBuffer::Ptr(RefBuffer::create(size));
+  // The buffer is allocated from the pool if it's not NULL
+  void set_buffer(size_t size, BufferPool* buffer_pool = NULL) {
+    buffer_ = RefBuffer::Ptr(buffer_pool != NULL
+                             ? buffer_pool->create_ref_buffer(size)
+                             : RefBuffer::create(size));
   }
 
   const CustomPayloadVec& custom_payload() const { return custom_payload_; }
@@ -76,22 +84,14 @@ private:
 
 class ResponseMessage {
 public:
-  ResponseMessage()
-      : version_(0)
-      , flags_(0)
-      , stream_(0)
-      , opcode_(0)
-      , length_(0)
-      , received_(0)
-      , header_size_(0)
-      , is_header_received_(false)
-      , header_buffer_pos_(header_buffer_)
-      , is_body_ready_(false)
-      , is_body_error_(false)
-      , body_buffer_pos_(NULL) {}
+  ResponseMessage(Compressor* compressor = NULL,
+                  BufferPool* buffer_pool = NULL);
+  ~ResponseMessage();
 
   uint8_t floats() const { return flags_; }
 
+  void set_compressor(Compressor* compressor) { compressor_ = compressor; }
+
   uint8_t opcode() const { return opcode_; }
 
   int16_t stream() const { return stream_; }
@@ -100,12 +100,25 @@ public:
 
   bool is_body_ready() const { return is_body_ready_; }
 
+  // The body of a RESULT frame can be streamed to the request's callback.
+  // When this is true, decode() has stopped after the frame's header and
+  // start_row_stream() must be called before decoding the rest of the frame.
+  bool is_row_stream_pending() const { return is_row_stream_pending_; }
+
+  // Streams the rows of the body to the callback or buffers the whole body
+  // as usual if the callback is NULL.
+  void start_row_stream(const SharedRefPtr<RequestCallback>& callback);
+
   ssize_t decode(char* input, size_t size);
 
 private:
   bool allocate_body(int8_t opcode);
+  bool decompress_body();
+  bool can_stream_rows() const;
 
 private:
+  Compressor* compressor_;
+  BufferPool* buffer_pool_;
   uint8_t version_;
   uint8_t flags_;
   int16_t stream_;
@@ -123,6 +136,9 @@ private:
   Response::Ptr response_body_;
   char* body_buffer_pos_;
 
+  bool is_row_stream_pending_;
+  ScopedPtr<RowStream> row_stream_;
+
 private:
   DISALLOW_COPY_AND_ASSIGN(ResponseMessage);
 };
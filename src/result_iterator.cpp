@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "result_iterator.hpp"
+
+namespace cass {
+
+bool ResultIterator::next_page() {
+  ResponseFuture::Ptr future(page_fetcher_->next_page());
+  if (!future) {
+    page_fetcher_.reset();
+    return false;
+  }
+
+  // Waits for the page if it hasn't arrived yet
+  Future::Error* error = future->error();
+  if (error != NULL) {
+    error_code_ = error->code;
+    error_message_ = error->message;
+    page_fetcher_.reset();
+    return false;
+  }
+
+  // The previous page is released here
+  page_ = future->response();
+  result_ = static_cast<const ResultResponse*>(page_.get());
+  index_ = -1;
+  position_ = result_->rows();
+  row_ = Row(result_);
+  row_.values.reserve(result_->column_count());
+
+  return true;
+}
+
+} // namespace cass
@@ -18,9 +18,12 @@
 #define __CASS_RESULT_ITERATOR_HPP_INCLUDED__
 
 #include "iterator.hpp"
+#include "page_fetcher.hpp"
 #include "result_response.hpp"
 #include "row.hpp"
 
+#include <string>
+
 namespace cass {
 
 class ResultIterator : public Iterator {
@@ -30,13 +33,30 @@ public:
       , result_(result)
       , index_(-1)
       , position_(result->rows())
-      , row_(result) {
+      , row_(result)
+      , error_code_(CASS_OK) {
+    row_.values.reserve(result->column_count());
+  }
+
+  // Iterates over the rows of the result and then the rows of the pages
+  // that follow it.
+  ResultIterator(const ResultResponse* result,
+                 const PageFetcher::Ptr& page_fetcher)
+      : Iterator(CASS_ITERATOR_TYPE_RESULT)
+      , result_(result)
+      , index_(-1)
+      , position_(result->rows())
+      , row_(result)
+      , page_fetcher_(page_fetcher)
+      , error_code_(CASS_OK) {
     row_.values.reserve(result->column_count());
   }
 
   virtual bool next() {
-    if (index_ + 1 >= result_->row_count()) {
-      return false;
+    while (index_ + 1 >= result_->row_count()) {
+      if (!page_fetcher_ || !next_page()) {
+        return false;
+      }
     }
 
     ++index_;
@@ -57,11 +77,21 @@ public:
     }
   }
 
+  CassError error_code() const { return error_code_; }
+  const std::string& error_message() const { return error_message_; }
+
+private:
+  bool next_page();
+
 private:
   const ResultResponse* result_;
   int32_t index_;
   char* position_;
   Row row_;
+  PageFetcher::Ptr page_fetcher_;
+  Response::Ptr page_;
+  CassError error_code_;
+  std::string error_message_;
 };
 
 } // namespace cass
@@ -17,6 +17,7 @@
 #include "result_response.hpp"
 
 #include "external.hpp"
+#include "page_fetcher.hpp"
 #include "result_metadata.hpp"
 #include "serialization.hpp"
 
@@ -194,6 +195,22 @@ private:
   SimpleDataTypeCache& cache_;
 };
 
+ResultResponse::ResultResponse()
+    : Response(CQL_OPCODE_RESULT)
+    , protocol_version_(0)
+    , kind_(CASS_RESULT_KIND_VOID)
+    , has_more_pages_(false)
+    , row_count_(0)
+    , rows_(NULL) {
+  first_row_.set_result(this);
+}
+
+ResultResponse::~ResultResponse() { }
+
+void ResultResponse::set_page_fetcher(const PageFetcher::Ptr& page_fetcher) {
+  page_fetcher_ = page_fetcher;
+}
+
 bool ResultResponse::decode(int version, char* input, size_t size) {
   protocol_version_ = version;
 
@@ -226,6 +243,24 @@ bool ResultResponse::decode(int version, char* input, size_t size) {
   return false;
 }
 
+bool ResultResponse::decode_metadata_only(int version, char* input, size_t size) {
+  protocol_version_ = version;
+
+  char* buffer = decode_int32(input, kind_);
+  if (kind_ != CASS_RESULT_KIND_ROWS) return false;
+
+  decode_metadata(buffer, &metadata_);
+  row_count_ = 0;
+  rows_ = NULL;
+  return true;
+}
+
+void ResultResponse::clear_rows() {
+  row_count_ = 0;
+  rows_ = NULL;
+  first_row_.values.clear();
+}
+
 char* ResultResponse::decode_metadata(char* input, ResultMetadata::Ptr* metadata,
                                       bool has_pk_indices) {
   int32_t flags = 0;
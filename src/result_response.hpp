@@ -31,6 +31,7 @@
 
 namespace cass {
 
+class PageFetcher;
 class ResultIterator;
 
 class ResultResponse : public Response {
@@ -39,15 +40,8 @@ public:
   typedef SharedRefPtr<const ResultResponse> ConstPtr;
   typedef std::vector<size_t> PKIndexVec;
 
-  ResultResponse()
-      : Response(CQL_OPCODE_RESULT)
-      , protocol_version_(0)
-      , kind_(CASS_RESULT_KIND_VOID)
-      , has_more_pages_(false)
-      , row_count_(0)
-      , rows_(NULL) {
-    first_row_.set_result(this);
-  }
+  ResultResponse();
+  ~ResultResponse();
 
   int protocol_version() const{ return protocol_version_; }
 
@@ -81,8 +75,21 @@ public:
 
   const PKIndexVec& pk_indices() const { return pk_indices_; }
 
+  // Fetches the following pages in the background (or NULL). This is only
+  // set for the first page of a statement with prefetching enabled.
+  const SharedRefPtr<PageFetcher>& page_fetcher() const { return page_fetcher_; }
+
+  void set_page_fetcher(const SharedRefPtr<PageFetcher>& page_fetcher);
+
   bool decode(int version, char* input, size_t size);
 
+  // Decodes the kind and metadata of a rows result without its rows. The
+  // rows are decoded as they arrive instead (see RowStream).
+  bool decode_metadata_only(int version, char* input, size_t size);
+
+  // Drops the rows after they've been passed to a statement's row callback
+  void clear_rows();
+
 private:
   char* decode_metadata(char* input, ResultMetadata::Ptr* metadata,
                         bool has_pk_indices = false);
@@ -112,6 +119,7 @@ private:
   char* rows_;
   Row first_row_;
   PKIndexVec pk_indices_;
+  SharedRefPtr<PageFetcher> page_fetcher_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(ResultResponse);
@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "retry_budget.hpp"
+
+namespace cass {
+
+RetryBudget::RetryBudget(double ratio, unsigned max_tokens)
+  : deposit_(static_cast<int64_t>(ratio * TOKEN))
+  , max_(static_cast<int64_t>(max_tokens) * TOKEN)
+  , tokens_(max_) { }
+
+void RetryBudget::deposit() {
+  if (deposit_ <= 0) return;
+  int64_t current = tokens_.load(MEMORY_ORDER_RELAXED);
+  while (current < max_) {
+    int64_t next = current + deposit_;
+    if (next > max_) next = max_;
+    if (tokens_.compare_exchange_weak(current, next, MEMORY_ORDER_RELAXED)) {
+      break;
+    }
+  }
+}
+
+bool RetryBudget::try_withdraw() {
+  int64_t current = tokens_.load(MEMORY_ORDER_RELAXED);
+  while (current >= TOKEN) {
+    if (tokens_.compare_exchange_weak(current, current - TOKEN, MEMORY_ORDER_RELAXED)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace cass
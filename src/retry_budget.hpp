@@ -0,0 +1,64 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_RETRY_BUDGET_HPP_INCLUDED__
+#define __CASS_RETRY_BUDGET_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "macros.hpp"
+
+#include <stdint.h>
+
+namespace cass {
+
+// A session-wide token bucket that limits how many requests are sent again
+// after they've already been sent to a host (retries and speculative
+// executions). Each successful request adds "ratio" tokens, up to
+// "max_tokens", and each extra execution takes a whole token. When a
+// cluster is overloaded the successes stop, the bucket empties and requests
+// fail fast instead of multiplying the load on the remaining hosts.
+//
+// The bucket starts full and is shared by all the IO workers.
+class RetryBudget {
+public:
+  RetryBudget(double ratio, unsigned max_tokens);
+
+  // Called when a request succeeds
+  void deposit();
+
+  // Takes a token if there's one available
+  bool try_withdraw();
+
+  double available_tokens() const {
+    return static_cast<double>(tokens_.load(MEMORY_ORDER_RELAXED)) / TOKEN;
+  }
+
+private:
+  // Tokens are stored in thousandths so that fractions of a token can be
+  // added for each successful request
+  static const int64_t TOKEN = 1000;
+
+  const int64_t deposit_;
+  const int64_t max_;
+  Atomic<int64_t> tokens_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(RetryBudget);
+};
+
+} // namespace cass
+
+#endif
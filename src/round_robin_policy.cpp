@@ -38,7 +38,7 @@ CassHostDistance RoundRobinPolicy::distance(const Host::Ptr& host) const {
 QueryPlan* RoundRobinPolicy::new_query_plan(const std::string& connected_keyspace,
                                             RequestHandler* request_handler,
                                             const TokenMap* token_map) {
-  return new RoundRobinQueryPlan(hosts_, index_++);
+  return new (QueryPlan::block(request_handler)) RoundRobinQueryPlan(hosts_, index_++);
 }
 
 void RoundRobinPolicy::on_add(const Host::Ptr& host) {
@@ -0,0 +1,353 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "row_stream.hpp"
+
+#include "constants.hpp"
+#include "request_callback.hpp"
+#include "result_response.hpp"
+#include "serialization.hpp"
+
+#include <string.h>
+
+// Nested types deeper than this are considered invalid
+#define MAX_TYPE_DEPTH 32
+
+namespace cass {
+
+namespace {
+
+// A bounds checked reader used to find out whether a complete piece of the
+// body has been received before it's decoded. The normal decoders assume
+// the whole body is available.
+class Scanner {
+public:
+  enum Result {
+    RESULT_COMPLETE,
+    RESULT_INCOMPLETE,
+    RESULT_INVALID
+  };
+
+  Scanner(char* input, size_t size)
+    : pos_(input)
+    , end_(input + size)
+    , result_(RESULT_COMPLETE) { }
+
+  Result result() const { return result_; }
+  char* position() const { return pos_; }
+
+  void read_int32(int32_t* value) {
+    if (check(sizeof(int32_t))) {
+      pos_ = decode_int32(pos_, *value);
+    } else {
+      *value = 0;
+    }
+  }
+
+  void read_uint16(uint16_t* value) {
+    if (check(sizeof(uint16_t))) {
+      pos_ = decode_uint16(pos_, *value);
+    } else {
+      *value = 0;
+    }
+  }
+
+  void skip(size_t size) {
+    if (check(size)) pos_ += size;
+  }
+
+  void skip_string() {
+    uint16_t size;
+    read_uint16(&size);
+    skip(size);
+  }
+
+  void skip_bytes() {
+    int32_t size;
+    read_int32(&size);
+    if (size > 0) skip(size);
+  }
+
+  void skip_option(int depth) {
+    if (depth > MAX_TYPE_DEPTH) {
+      set_invalid();
+      return;
+    }
+
+    uint16_t value_type;
+    read_uint16(&value_type);
+    switch (value_type) {
+      case CASS_VALUE_TYPE_CUSTOM:
+        skip_string();
+        break;
+
+      case CASS_VALUE_TYPE_LIST:
+      case CASS_VALUE_TYPE_SET:
+        skip_option(depth + 1);
+        break;
+
+      case CASS_VALUE_TYPE_MAP:
+        skip_option(depth + 1);
+        skip_option(depth + 1);
+        break;
+
+      case CASS_VALUE_TYPE_UDT: {
+        skip_string(); // Keyspace
+        skip_string(); // Type name
+        uint16_t n;
+        read_uint16(&n);
+        for (uint16_t i = 0; i < n && result_ == RESULT_COMPLETE; ++i) {
+          skip_string(); // Field name
+          skip_option(depth + 1);
+        }
+        break;
+      }
+
+      case CASS_VALUE_TYPE_TUPLE: {
+        uint16_t n;
+        read_uint16(&n);
+        for (uint16_t i = 0; i < n && result_ == RESULT_COMPLETE; ++i) {
+          skip_option(depth + 1);
+        }
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  void set_invalid() { result_ = RESULT_INVALID; }
+
+private:
+  bool check(size_t size) {
+    if (result_ != RESULT_COMPLETE) return false;
+    if (static_cast<size_t>(end_ - pos_) < size) {
+      result_ = RESULT_INCOMPLETE;
+      return false;
+    }
+    return true;
+  }
+
+private:
+  char* pos_;
+  char* const end_;
+  Result result_;
+};
+
+// Format: <kind><flags><columns_count>[<paging_state>][<global_table_spec>?<col_spec_1>...<col_spec_n>]<rows_count>
+Scanner::Result scan_rows_metadata(char* input, size_t size,
+                                   size_t* metadata_size,
+                                   int32_t* column_count,
+                                   int32_t* row_count) {
+  Scanner scanner(input, size);
+
+  int32_t kind;
+  scanner.read_int32(&kind);
+
+  int32_t flags;
+  scanner.read_int32(&flags);
+  scanner.read_int32(column_count);
+
+  if (flags & CASS_RESULT_FLAG_HAS_MORE_PAGES) {
+    scanner.skip_bytes();
+  }
+
+  if (!(flags & CASS_RESULT_FLAG_NO_METADATA)) {
+    bool global_table_spec = flags & CASS_RESULT_FLAG_GLOBAL_TABLESPEC;
+    if (global_table_spec) {
+      scanner.skip_string(); // Keyspace
+      scanner.skip_string(); // Table
+    }
+
+    for (int32_t i = 0;
+         i < *column_count && scanner.result() == Scanner::RESULT_COMPLETE; ++i) {
+      if (!global_table_spec) {
+        scanner.skip_string(); // Keyspace
+        scanner.skip_string(); // Table
+      }
+      scanner.skip_string(); // Name
+      scanner.skip_option(0);
+    }
+  }
+
+  scanner.read_int32(row_count);
+
+  if (scanner.result() == Scanner::RESULT_COMPLETE) {
+    if (*column_count < 0 || *row_count < 0) {
+      return Scanner::RESULT_INVALID;
+    }
+    *metadata_size = scanner.position() - input;
+  }
+  return scanner.result();
+}
+
+// Returns the number of bytes needed before more of the row can be
+// scanned or zero if the row is complete.
+size_t scan_row(char* input, size_t size, int32_t column_count,
+                size_t* row_size) {
+  size_t pos = 0;
+  for (int32_t i = 0; i < column_count; ++i) {
+    if (size - pos < sizeof(int32_t)) {
+      return sizeof(int32_t) - (size - pos);
+    }
+    int32_t value_size;
+    decode_int32(input + pos, value_size);
+    pos += sizeof(int32_t);
+    if (value_size > 0) {
+      if (size - pos < static_cast<size_t>(value_size)) {
+        return value_size - (size - pos);
+      }
+      pos += value_size;
+    }
+  }
+  *row_size = pos;
+  return 0;
+}
+
+} // namespace
+
+RowStream::RowStream(int version, ResultResponse* result,
+                     const RequestCallback::Ptr& callback)
+  : version_(version)
+  , result_(result)
+  , callback_(callback)
+  , state_(STATE_KIND)
+  , max_buffered_(0)
+  , column_count_(0)
+  , remaining_rows_(0)
+  , row_(result) { }
+
+RowStream::~RowStream() { }
+
+bool RowStream::decode(char* input, size_t size) {
+  if (state_ == STATE_ROWS) {
+    return decode_rows(input, size);
+  }
+
+  buffer_.insert(buffer_.end(), input, input + size);
+  if (buffer_.size() > max_buffered_) {
+    max_buffered_ = buffer_.size();
+  }
+
+  if (state_ == STATE_KIND && buffer_.size() >= sizeof(int32_t)) {
+    int32_t kind;
+    decode_int32(&buffer_[0], kind);
+    state_ = kind == CASS_RESULT_KIND_ROWS ? STATE_METADATA : STATE_BUFFERED;
+  }
+
+  if (state_ == STATE_METADATA) {
+    size_t metadata_size = 0;
+    switch (scan_rows_metadata(&buffer_[0], buffer_.size(), &metadata_size,
+                               &column_count_, &remaining_rows_)) {
+      case Scanner::RESULT_COMPLETE:
+        break;
+      case Scanner::RESULT_INCOMPLETE:
+        return true;
+      case Scanner::RESULT_INVALID:
+        return false;
+    }
+
+    // The metadata is copied into the result because its column names,
+    // keyspace, table and paging state reference the result's buffer.
+    result_->set_buffer(metadata_size);
+    memcpy(result_->data(), &buffer_[0], metadata_size);
+    if (!result_->decode_metadata_only(version_, result_->data(), metadata_size)) {
+      return false;
+    }
+    callback_->on_row_stream_metadata(result_);
+
+    state_ = STATE_ROWS;
+    std::vector<char> rows(buffer_.begin() + metadata_size, buffer_.end());
+    buffer_.clear();
+    if (!rows.empty()) {
+      return decode_rows(&rows[0], rows.size());
+    }
+  }
+
+  return true;
+}
+
+bool RowStream::finish() {
+  switch (state_) {
+    case STATE_ROWS:
+      return remaining_rows_ == 0 && buffer_.empty();
+
+    case STATE_BUFFERED:
+      result_->set_buffer(buffer_.size());
+      memcpy(result_->data(), &buffer_[0], buffer_.size());
+      return result_->decode(version_, result_->data(), buffer_.size());
+
+    default:
+      return false;
+  }
+}
+
+bool RowStream::decode_rows(char* input, size_t size) {
+  size_t row_size;
+
+  // Finish the row that was partially received by the previous call. Only
+  // the bytes needed to complete the row are copied.
+  while (!buffer_.empty() && size > 0) {
+    size_t needed = scan_row(&buffer_[0], buffer_.size(), column_count_, &row_size);
+    if (needed > 0) {
+      size_t n = needed < size ? needed : size;
+      buffer_.insert(buffer_.end(), input, input + n);
+      input += n;
+      size -= n;
+      if (buffer_.size() > max_buffered_) {
+        max_buffered_ = buffer_.size();
+      }
+    }
+    if (scan_row(&buffer_[0], buffer_.size(), column_count_, &row_size) == 0) {
+      if (!emit_row(&buffer_[0])) return false;
+      buffer_.clear();
+    }
+  }
+
+  // Decode complete rows directly from the input
+  while (size > 0 && scan_row(input, size, column_count_, &row_size) == 0) {
+    if (!emit_row(input)) return false;
+    input += row_size;
+    size -= row_size;
+  }
+
+  // Keep the start of the next row
+  if (size > 0) {
+    if (remaining_rows_ == 0) return false;
+    buffer_.insert(buffer_.end(), input, input + size);
+    if (buffer_.size() > max_buffered_) {
+      max_buffered_ = buffer_.size();
+    }
+  }
+
+  return true;
+}
+
+bool RowStream::emit_row(char* row) {
+  if (remaining_rows_ == 0) return false; // More rows than the row count
+  --remaining_rows_;
+
+  // Rows can't be decoded without metadata. The request's callback reports
+  // the error when the response is finished.
+  if (!result_->no_metadata()) {
+    decode_row(row, result_, row_.values);
+    callback_->on_row(&row_);
+  }
+  return true;
+}
+
+} // namespace cass
@@ -0,0 +1,82 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_ROW_STREAM_HPP_INCLUDED__
+#define __CASS_ROW_STREAM_HPP_INCLUDED__
+
+#include "macros.hpp"
+#include "ref_counted.hpp"
+#include "row.hpp"
+
+#include <stddef.h>
+#include <vector>
+
+namespace cass {
+
+class RequestCallback;
+class ResultResponse;
+
+// Decodes the body of a RESULT response as it arrives and passes each
+// complete row to the request's callback. Only the metadata and the
+// partial row at the end of the data received so far are buffered, so
+// memory use is bounded by the size of the largest row instead of the size
+// of the response. Results that aren't rows are buffered and decoded once
+// the whole body has arrived.
+class RowStream {
+public:
+  RowStream(int version, ResultResponse* result,
+            const SharedRefPtr<RequestCallback>& callback);
+  ~RowStream();
+
+  // The input MUST only contain bytes from the frame's body. Returns false
+  // if the body is invalid.
+  bool decode(char* input, size_t size);
+
+  // Called after the last byte of the body. Returns false if the body was
+  // incomplete.
+  bool finish();
+
+  size_t max_buffered() const { return max_buffered_; }
+
+private:
+  enum State {
+    STATE_KIND,
+    STATE_METADATA,
+    STATE_ROWS,
+    STATE_BUFFERED
+  };
+
+  bool decode_rows(char* input, size_t size);
+  bool emit_row(char* row);
+
+private:
+  const int version_;
+  ResultResponse* const result_;
+  SharedRefPtr<RequestCallback> callback_;
+  State state_;
+  std::vector<char> buffer_;
+  size_t max_buffered_;
+  int32_t column_count_;
+  int32_t remaining_rows_;
+  Row row_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(RowStream);
+};
+
+} // namespace cass
+
+#endif
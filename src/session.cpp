@@ -21,12 +21,15 @@
 #include "config.hpp"
 #include "constants.hpp"
 #include "logger.hpp"
+#include "page_fetcher.hpp"
 #include "prepare_request.hpp"
 #include "scoped_lock.hpp"
 #include "statement.hpp"
 #include "timer.hpp"
 #include "external.hpp"
 
+#define MAX_CACHED_REQUEST_BLOCKS 1024
+
 extern "C" {
 
 CassSession* cass_session_new() {
@@ -78,6 +81,18 @@ CassFuture* cass_session_prepare(CassSession* session, const char* query) {
   return cass_session_prepare_n(session, query, strlen(query));
 }
 
+CassFuture* cass_session_prepare_cached(CassSession* session, const char* query) {
+  return cass_session_prepare_cached_n(session, query, strlen(query));
+}
+
+CassFuture* cass_session_prepare_cached_n(CassSession* session,
+                                          const char* query,
+                                          size_t query_length) {
+  cass::Future::Ptr future(session->prepare_cached(query, query_length));
+  future->inc_ref();
+  return CassFuture::to(future.get());
+}
+
 CassFuture* cass_session_prepare_n(CassSession* session,
                                    const char* query,
                                    size_t query_length) {
@@ -137,6 +152,28 @@ void  cass_session_get_metrics(const CassSession* session,
   metrics->errors.request_timeouts = internal_metrics->request_timeouts.sum();
 }
 
+void cass_session_get_buffer_pool_metrics(const CassSession* session,
+                                          CassBufferPoolMetrics* metrics) {
+  cass::BufferPool::Stats stats;
+  session->buffer_pool_stats(&stats);
+  metrics->cached_bytes = stats.cached_bytes;
+  metrics->in_use_bytes = stats.in_use_bytes;
+  metrics->hits = stats.hits;
+  metrics->misses = stats.misses;
+  metrics->unpooled = stats.unpooled;
+  metrics->trimmed_bytes = stats.trimmed_bytes;
+}
+
+void cass_session_get_retry_budget_metrics(const CassSession* session,
+                                           CassRetryBudgetMetrics* metrics) {
+  const cass::Metrics* internal_metrics = session->metrics();
+  const cass::RetryBudget* retry_budget = session->retry_budget();
+  metrics->available_tokens = retry_budget != NULL ? retry_budget->available_tokens() : 0.0;
+  metrics->retries = internal_metrics->retry_budget_retries.sum();
+  metrics->speculative_executions = internal_metrics->retry_budget_speculative_executions.sum();
+  metrics->exhausted = internal_metrics->retry_budget_exhausted.sum();
+}
+
 } // extern "C"
 
 namespace cass {
@@ -144,16 +181,24 @@ namespace cass {
 Session::Session()
     : state_(SESSION_STATE_CLOSED)
     , connect_error_code_(CASS_OK)
+    , current_io_worker_(0)
+    , request_pool_(new RequestPool(RequestBlock::allocation_size(sizeof(ResponseFuture)) +
+                                    RequestBlock::allocation_size(sizeof(RequestHandler)) +
+                                    RequestBlock::allocation_size(sizeof(SpeculativeExecution)) +
+                                    QueryPlan::BLOCK_SIZE,
+                                    MAX_CACHED_REQUEST_BLOCKS))
+    , buffer_pool_(new BufferPool())
     , current_host_mark_(true)
     , pending_pool_count_(0)
     , pending_workers_count_(0)
-    , current_io_worker_(0)
     , keyspace_(new std::string){
   uv_mutex_init(&state_mutex_);
   uv_mutex_init(&hosts_mutex_);
+  handle_.reset(new SessionHandle(this));
 }
 
 Session::~Session() {
+  handle_->detach();
   join();
   uv_mutex_destroy(&state_mutex_);
   uv_mutex_destroy(&hosts_mutex_);
@@ -163,8 +208,13 @@ void Session::clear(const Config& config) {
   config_ = config;
   random_.reset();
   metrics_.reset(new Metrics(config_.thread_count_io() + 1));
+  if (config_.retry_budget_max_tokens() > 0) {
+    retry_budget_.reset(new RetryBudget(config_.retry_budget_ratio(),
+                                        config_.retry_budget_max_tokens()));
+  } else {
+    retry_budget_.reset();
+  }
   load_balancing_policy_.reset(config.load_balancing_policy());
-  speculative_execution_policy_.reset(config.speculative_execution_policy());
   connect_future_.reset();
   close_future_.reset();
   { // Lock hosts
@@ -172,7 +222,8 @@ void Session::clear(const Config& config) {
     hosts_.clear();
   }
   io_workers_.clear();
-  request_queue_.reset();
+  current_io_worker_.store(0);
+  prepared_cache_.clear();
   metadata_.clear();
   control_connection_.clear();
   connect_error_code_ = CASS_OK;
@@ -180,16 +231,11 @@ void Session::clear(const Config& config) {
   current_host_mark_ = true;
   pending_pool_count_ = 0;
   pending_workers_count_ = 0;
-  current_io_worker_ = 0;
 }
 
 int Session::init() {
   int rc = EventThread<SessionEvent>::init(config_.queue_size_event());
   if (rc != 0) return rc;
-  request_queue_.reset(
-      new AsyncQueue<MPMCQueue<RequestHandler*> >(config_.queue_size_io()));
-  rc = request_queue_->init(loop(), this, &Session::on_execute);
-  if (rc != 0) return rc;
 
   for (unsigned int i = 0; i < config_.thread_count_io(); ++i) {
     IOWorker::Ptr io_worker(new IOWorker(this));
@@ -215,6 +261,22 @@ void Session::broadcast_keyspace_change(const std::string& keyspace,
   keyspace_ = CopyOnWritePtr<std::string>(new std::string(keyspace));
 }
 
+void Session::buffer_pool_stats(BufferPool::Stats* stats) const {
+  buffer_pool_->stats(stats);
+  // The IO workers vector never changes after initialization
+  for (IOWorkerVec::const_iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    BufferPool::Stats io_worker_stats;
+    (*it)->buffer_pool()->stats(&io_worker_stats);
+    stats->cached_bytes += io_worker_stats.cached_bytes;
+    stats->in_use_bytes += io_worker_stats.in_use_bytes;
+    stats->hits += io_worker_stats.hits;
+    stats->misses += io_worker_stats.misses;
+    stats->unpooled += io_worker_stats.unpooled;
+    stats->trimmed_bytes += io_worker_stats.trimmed_bytes;
+  }
+}
+
 Host::Ptr Session::get_host(const Address& address) {
   // Lock hosts. This can be called on a non-session thread.
   ScopedMutex l(&hosts_mutex_);
@@ -360,7 +422,9 @@ void Session::internal_connect() {
 }
 
 void Session::internal_close() {
-  while (!request_queue_->enqueue(NULL)) {
+  SessionEvent event;
+  event.type = SessionEvent::CLOSE;
+  while (!send_event_async(event)) {
     // Keep trying
   }
 
@@ -410,7 +474,6 @@ void Session::notify_closed() {
 
 void Session::close_handles() {
   EventThread<SessionEvent>::close_handles();
-  request_queue_->close_handles();
   load_balancing_policy_->close_handles();
 }
 
@@ -474,6 +537,14 @@ void Session::on_event(const SessionEvent& event) {
       break;
     }
 
+    case SessionEvent::CLOSE:
+      pending_workers_count_ = io_workers_.size();
+      for (IOWorkerVec::iterator it = io_workers_.begin(),
+           end = io_workers_.end(); it != end; ++it) {
+        (*it)->close_async();
+      }
+      break;
+
     case SessionEvent::NOTIFY_READY:
       if (pending_pool_count_ > 0) {
         if (--pending_pool_count_ == 0) {
@@ -543,12 +614,81 @@ void Session::execute(const RequestHandler::Ptr& request_handler) {
     return;
   }
 
-  request_handler->inc_ref(); // Queue reference
-  if (!request_queue_->enqueue(request_handler.get())) {
-    request_handler->dec_ref();
-    request_handler->set_error(CASS_ERROR_LIB_REQUEST_QUEUE_FULL,
-                               "The request queue has reached capacity");
+  // Avoid handing off the request between IO workers when the host is
+  // already known.
+  if (request_handler->preferred_address().is_valid() &&
+      io_worker_owner_count() < io_workers_.size() &&
+      execute_on_owner(request_handler, request_handler->preferred_address(), false)) {
+    return;
+  }
+
+  // The request is enqueued directly on an IO worker from the calling
+  // thread. The IO worker builds the query plan so that request dispatch
+  // isn't serialized on the session thread.
+  size_t size = io_workers_.size();
+  size_t start = current_io_worker_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  for (size_t i = 0; i < size; ++i) {
+    if (io_workers_[(start + i) % size]->execute(request_handler)) {
+      return;
+    }
+  }
+
+  request_handler->set_error(CASS_ERROR_LIB_REQUEST_QUEUE_FULL,
+                             "The request queue has reached capacity");
+}
+
+void SessionHandle::execute(const RequestHandler::Ptr& request_handler) {
+  ScopedMutex lock(&mutex_);
+  if (session_ == NULL) {
+    request_handler->set_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
+                               "Session has been freed");
+    return;
+  }
+  session_->execute(request_handler);
+}
+
+size_t Session::io_worker_owner_count() const {
+  size_t count = config_.thread_count_io_per_host();
+  if (count == 0 || count > io_workers_.size()) {
+    return io_workers_.size();
   }
+  return count;
+}
+
+size_t Session::first_io_worker_owner(const Address& address) const {
+  return AddressHash()(address) % io_workers_.size();
+}
+
+bool Session::is_host_owner(const IOWorker* io_worker, const Address& address) const {
+  size_t size = io_workers_.size();
+  size_t count = io_worker_owner_count();
+  if (count == size) return true;
+
+  size_t first = first_io_worker_owner(address);
+  for (size_t i = 0; i < count; ++i) {
+    if (io_workers_[(first + i) % size].get() == io_worker) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Session::execute_on_owner(const RequestHandler::Ptr& request_handler,
+                               const Address& address,
+                               bool is_handoff) {
+  size_t size = io_workers_.size();
+  size_t count = io_worker_owner_count();
+  size_t first = first_io_worker_owner(address);
+  size_t start = current_io_worker_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  // This must be set before the request is enqueued on another thread
+  request_handler->set_is_handoff(is_handoff);
+  for (size_t i = 0; i < count; ++i) {
+    if (io_workers_[(first + (start + i) % count) % size]->execute(request_handler)) {
+      return true;
+    }
+  }
+  request_handler->set_is_handoff(false);
+  return false;
 }
 
 #if UV_VERSION_MAJOR >= 1
@@ -581,6 +721,8 @@ void Session::on_control_connection_ready() {
   load_balancing_policy_->register_handles(loop());
   for (IOWorkerVec::iterator it = io_workers_.begin(),
        end = io_workers_.end(); it != end; ++it) {
+    (*it)->init_load_balancing_policy(control_connection_.connected_host(),
+                                      hosts_, random_.get());
     (*it)->set_protocol_version(control_connection_.protocol_version());
   }
   for (HostMap::iterator it = hosts_.begin(), hosts_end = hosts_.end();
@@ -604,14 +746,106 @@ void Session::on_control_connection_error(CassError code, const std::string& mes
 Future::Ptr Session::prepare(const char* statement, size_t length) {
   SharedRefPtr<PrepareRequest> prepare(new PrepareRequest(std::string(statement, length)));
 
-  ResponseFuture::Ptr future(new ResponseFuture(metadata_.schema_snapshot(protocol_version(), cassandra_version())));
+  RequestBlock* block = request_pool_->acquire();
+
+  ResponseFuture::Ptr future(new (block) ResponseFuture(metadata_.schema_snapshot(protocol_version(), cassandra_version())));
   future->statement.assign(statement, length);
 
-  execute(RequestHandler::Ptr(new RequestHandler(prepare, future, NULL)));
+  RequestHandler::Ptr request_handler(new (block) RequestHandler(prepare, future, NULL));
+  block->dec_ref();
+
+  execute(request_handler);
+
+  return future;
+}
+
+Future::Ptr Session::prepare_cached(const char* statement, size_t length) {
+  std::string query(statement, length);
+  const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  PreparedCache::Entry::Ptr entry(prepared_cache_.get(*keyspace, query));
+
+  ResponseFuture::Ptr future(new ResponseFuture(metadata_.schema_snapshot(protocol_version(), cassandra_version())));
+  future->statement = query;
+
+  Address address;
+  ResultResponse::Ptr result(entry->result(&address));
+  if (result) {
+    future->set_response(address, result);
+    return future;
+  }
+
+  // The statement is prepared on the other hosts once the first host has
+  // prepared it. See RequestHandler::on_prepared().
+  execute(new_prepare_handler(query, future, entry));
 
   return future;
 }
 
+void Session::prepare_on_all_hosts(const PreparedCache::Entry::Ptr& entry,
+                                   const Address& prepared_address) {
+  HostVec hosts;
+  { // Lock hosts
+    ScopedMutex l(&hosts_mutex_);
+    for (HostMap::const_iterator i = hosts_.begin(),
+         end = hosts_.end(); i != end; ++i) {
+      if (i->second->is_up() && !(i->first == prepared_address)) {
+        hosts.push_back(i->second);
+      }
+    }
+  }
+
+  for (HostVec::const_iterator i = hosts.begin(),
+       end = hosts.end(); i != end; ++i) {
+    execute(new_prepare_handler(entry->query(),
+                                ResponseFuture::Ptr(new ResponseFuture()),
+                                PreparedCache::Entry::Ptr(),
+                                *i));
+  }
+}
+
+void Session::prepare_on_up_host(IOWorker* io_worker, const Address& address) {
+  if (!prepared_cache_.unmark_host(address)) return;
+
+  Host::Ptr host(get_host(address));
+  if (!host) return;
+
+  const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  PreparedCache::EntryVec entries(prepared_cache_.prepared_entries(*keyspace));
+
+  LOG_DEBUG("Preparing %u cached statement(s) on host %s",
+            static_cast<unsigned int>(entries.size()),
+            host->address_string().c_str());
+
+  for (PreparedCache::EntryVec::const_iterator i = entries.begin(),
+       end = entries.end(); i != end; ++i) {
+    if (!io_worker->execute(new_prepare_handler((*i)->query(),
+                                                ResponseFuture::Ptr(new ResponseFuture()),
+                                                PreparedCache::Entry::Ptr(),
+                                                host))) {
+      LOG_WARN("Unable to prepare cached statements on host %s because "
+               "the request queue has reached capacity",
+               host->address_string().c_str());
+      break;
+    }
+  }
+}
+
+RequestHandler::Ptr Session::new_prepare_handler(const std::string& query,
+                                                 const ResponseFuture::Ptr& future,
+                                                 const PreparedCache::Entry::Ptr& entry,
+                                                 const Host::Ptr& host) {
+  RequestHandler::Ptr request_handler(
+        new RequestHandler(Request::ConstPtr(new PrepareRequest(query)), future, NULL));
+  request_handler->set_prepared_entry(entry);
+  if (host) {
+    // Requests with a query plan and a current host are run as is
+    request_handler->set_query_plan(new SingleHostQueryPlan(host));
+    request_handler->next_host();
+    request_handler->set_preferred_address(host->address());
+  }
+  return request_handler;
+}
+
 void Session::on_add(Host::Ptr host, bool is_initial_connection) {
 #if UV_VERSION_MAJOR >= 1
   if (config_.use_hostname_resolution() && host->hostname().empty()) {
@@ -635,19 +869,21 @@ void Session::internal_on_add(Host::Ptr host, bool is_initial_connection) {
   }
 
   if (is_initial_connection) {
-    pending_pool_count_ += io_workers_.size();
+    pending_pool_count_ += io_worker_owner_count();
   } else {
-    load_balancing_policy_->on_add(host);
+    prepared_cache_.mark_host(host->address());
+    policy_on_add(host);
   }
 
   for (IOWorkerVec::iterator it = io_workers_.begin(),
        end = io_workers_.end(); it != end; ++it) {
+    if (!is_host_owner(it->get(), host->address())) continue;
     (*it)->add_pool_async(host, is_initial_connection);
   }
 }
 
 void Session::on_remove(Host::Ptr host) {
-  load_balancing_policy_->on_remove(host);
+  policy_on_remove(host);
   { // Lock hosts
     ScopedMutex l(&hosts_mutex_);
     hosts_.erase(host->address());
@@ -660,22 +896,25 @@ void Session::on_remove(Host::Ptr host) {
 
 void Session::on_up(Host::Ptr host) {
   host->set_up();
+  prepared_cache_.mark_host(host->address());
 
   if (load_balancing_policy_->distance(host) == CASS_HOST_DISTANCE_IGNORE) {
     return;
   }
 
-  load_balancing_policy_->on_up(host);
+  policy_on_up(host);
 
   for (IOWorkerVec::iterator it = io_workers_.begin(),
        end = io_workers_.end(); it != end; ++it) {
+    if (!is_host_owner(it->get(), host->address())) continue;
     (*it)->add_pool_async(host, false);
   }
 }
 
 void Session::on_down(Host::Ptr host) {
   host->set_down();
-  load_balancing_policy_->on_down(host);
+  prepared_cache_.mark_host(host->address());
+  policy_on_down(host);
 
   bool cancel_reconnect = false;
   if (load_balancing_policy_->distance(host) == CASS_HOST_DISTANCE_IGNORE) {
@@ -689,93 +928,95 @@ void Session::on_down(Host::Ptr host) {
   }
 }
 
+void Session::policy_on_add(const Host::Ptr& host) {
+  load_balancing_policy_->on_add(host);
+  for (IOWorkerVec::iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    (*it)->notify_host_add_async(host);
+  }
+}
+
+void Session::policy_on_remove(const Host::Ptr& host) {
+  load_balancing_policy_->on_remove(host);
+  for (IOWorkerVec::iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    (*it)->notify_host_remove_async(host);
+  }
+}
+
+void Session::policy_on_up(const Host::Ptr& host) {
+  load_balancing_policy_->on_up(host);
+  for (IOWorkerVec::iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    (*it)->notify_host_up_async(host);
+  }
+}
+
+void Session::policy_on_down(const Host::Ptr& host) {
+  load_balancing_policy_->on_down(host);
+  for (IOWorkerVec::iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    (*it)->notify_host_down_async(host);
+  }
+}
+
 Future::Ptr Session::execute(const Request::ConstPtr& request,
                              const Address* preferred_address) {
-  ResponseFuture::Ptr future(new ResponseFuture());
+  RequestBlock* block = request_pool_->acquire();
+
+  ResponseFuture::Ptr future(new (block) ResponseFuture());
 
   RetryPolicy* retry_policy
       = request->retry_policy() != NULL ? request->retry_policy()
                                         : config().retry_policy();
 
-  RequestHandler::Ptr request_handler(new RequestHandler(request,
-                                                         future,
-                                                         retry_policy));
+  RequestHandler::Ptr request_handler(new (block) RequestHandler(request,
+                                                                 future,
+                                                                 retry_policy));
+  block->dec_ref();
   if (preferred_address) {
     request_handler->set_preferred_address(*preferred_address);
   }
 
+  if (request->opcode() == CQL_OPCODE_QUERY ||
+      request->opcode() == CQL_OPCODE_EXECUTE) {
+    const Statement* statement = static_cast<const Statement*>(request.get());
+    unsigned prefetch_pages = statement->prefetch_pages(config().prefetch_pages());
+    if (statement->page_size() > 0 && prefetch_pages > 0) {
+      request_handler->set_page_fetcher(
+            PageFetcher::Ptr(new PageFetcher(handle_, statement, retry_policy,
+                                             prefetch_pages)));
+    }
+  }
+
   execute(request_handler);
 
   return future;
 }
 
-#if UV_VERSION_MAJOR == 0
-void Session::on_execute(uv_async_t* data, int status) {
-#else
-void Session::on_execute(uv_async_t* data) {
-#endif
-  Session* session = static_cast<Session*>(data->data);
-
-  bool is_closing = false;
-
-  RequestHandler* temp = NULL;
-  while (session->request_queue_->dequeue(temp)) {
-    RequestHandler::Ptr request_handler(temp);
-    if (request_handler) {
-      request_handler->dec_ref(); // Queue reference
-
-      request_handler->set_query_plan(session->new_query_plan(request_handler));
-      request_handler->set_execution_plan(session->new_execution_plan(request_handler->request()));
-
-      if (request_handler->timestamp() == CASS_INT64_MIN) {
-        request_handler->set_timestamp(session->config_.timestamp_gen()->next());
-      }
-
-      bool is_done = false;
-      while (!is_done) {
-        request_handler->next_host();
-
-        if (!request_handler->current_host()) {
-          request_handler->set_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
-                                     "All connections on all I/O threads are busy");
-          break;
-        }
-
-        size_t start = session->current_io_worker_;
-        for (size_t i = 0, size = session->io_workers_.size(); i < size; ++i) {
-          const IOWorker::Ptr& io_worker = session->io_workers_[start % size];
-          if (io_worker->is_host_available(request_handler->current_host()->address()) &&
-              io_worker->execute(request_handler)) {
-            session->current_io_worker_ = (start + 1) % size;
-            is_done = true;
-            break;
-          }
-          start++;
-        }
-      }
-    } else {
-      is_closing = true;
-    }
-  }
+QueryPlan* Session::new_query_plan() {
+  const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  return load_balancing_policy_->new_query_plan(*keyspace, NULL, token_map_.get());
+}
 
-  if (is_closing) {
-    session->pending_workers_count_ = session->io_workers_.size();
-    for (IOWorkerVec::iterator it = session->io_workers_.begin(),
-                               end = session->io_workers_.end();
-         it != end; ++it) {
-      (*it)->close_async();
-    }
+TokenMap* Session::token_map_for_update() {
+  if (token_map_ && token_map_->ref_count() > 1) {
+    token_map_ = TokenMap::Ptr(token_map_->copy());
   }
+  return token_map_.get();
 }
 
-QueryPlan* Session::new_query_plan(const RequestHandler::Ptr& request_handler) {
-  const CopyOnWritePtr<std::string> keyspace(keyspace_);
-  return load_balancing_policy_->new_query_plan(*keyspace, request_handler.get(), token_map_.get());
+void Session::set_token_map(TokenMap* token_map) {
+  token_map_ = TokenMap::Ptr(token_map);
 }
 
-SpeculativeExecutionPlan* Session::new_execution_plan(const Request* request) {
-  const CopyOnWritePtr<std::string> keyspace(keyspace_);
-  return speculative_execution_policy_->new_plan(*keyspace, request);
+void Session::publish_token_map() {
+  if (!token_map_) return;
+  TokenMap::ConstPtr token_map(token_map_);
+  for (IOWorkerVec::iterator it = io_workers_.begin(),
+       end = io_workers_.end(); it != end; ++it) {
+    (*it)->notify_token_map_update_async(token_map);
+  }
 }
 
 } // namespace cass
@@ -17,6 +17,7 @@
 #ifndef __CASS_SESSION_HPP_INCLUDED__
 #define __CASS_SESSION_HPP_INCLUDED__
 
+#include "buffer_pool.hpp"
 #include "config.hpp"
 #include "control_connection.hpp"
 #include "event_thread.hpp"
@@ -27,11 +28,13 @@
 #include "load_balancing.hpp"
 #include "metadata.hpp"
 #include "metrics.hpp"
-#include "mpmc_queue.hpp"
+#include "prepared_cache.hpp"
 #include "random.hpp"
 #include "ref_counted.hpp"
 #include "request_handler.hpp"
+#include "request_pool.hpp"
 #include "resolver.hpp"
+#include "retry_budget.hpp"
 #include "row.hpp"
 #include "scoped_lock.hpp"
 #include "scoped_ptr.hpp"
@@ -54,6 +57,7 @@ struct SessionEvent {
   enum Type {
     INVALID,
     CONNECT,
+    CLOSE,
     NOTIFY_READY,
     NOTIFY_KEYSPACE_ERROR,
     NOTIFY_WORKER_CLOSED,
@@ -68,6 +72,43 @@ struct SessionEvent {
   Address address;
 };
 
+class Session;
+
+// A reference to a session that stays valid after the session is freed.
+// Requests executed through it after that fail right away. This is used by
+// objects that are owned by the application, like the page fetchers held by
+// results.
+class SessionHandle : public RefCounted<SessionHandle> {
+public:
+  typedef SharedRefPtr<SessionHandle> Ptr;
+
+  SessionHandle(Session* session)
+    : session_(session) {
+    uv_mutex_init(&mutex_);
+  }
+
+  ~SessionHandle() {
+    uv_mutex_destroy(&mutex_);
+  }
+
+  void execute(const RequestHandler::Ptr& request_handler);
+
+private:
+  friend class Session;
+
+  void detach() {
+    ScopedMutex lock(&mutex_);
+    session_ = NULL;
+  }
+
+private:
+  uv_mutex_t mutex_;
+  Session* session_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(SessionHandle);
+};
+
 class Session : public EventThread<SessionEvent> {
 public:
   enum State {
@@ -81,7 +122,16 @@ public:
   ~Session();
 
   const Config& config() const { return config_; }
+  const SessionHandle::Ptr& handle() const { return handle_; }
   Metrics* metrics() const { return metrics_.get(); }
+  // The retry budget or NULL if retries aren't limited
+  RetryBudget* retry_budget() const { return retry_budget_.get(); }
+
+  // Used by the control connection
+  BufferPool* buffer_pool() const { return buffer_pool_.get(); }
+
+  // The combined stats of the session's and the IO workers' buffer pools
+  void buffer_pool_stats(BufferPool::Stats* stats) const;
 
   void set_load_balancing_policy(LoadBalancingPolicy* policy) {
     load_balancing_policy_.reset(policy);
@@ -102,9 +152,37 @@ public:
   void close_async(const Future::Ptr& future);
 
   Future::Ptr prepare(const char* statement, size_t length);
+
+  // Returns the cached prepared statement for the query in the session's
+  // current keyspace. Otherwise, the statement is prepared and added to
+  // the cache.
+  Future::Ptr prepare_cached(const char* statement, size_t length);
+
+  // Called on an IO worker thread when a statement is first prepared to
+  // prepare it on the other hosts that are up.
+  void prepare_on_all_hosts(const PreparedCache::Entry::Ptr& entry,
+                            const Address& prepared_address);
+
+  // Called on an IO worker thread when a host's pool becomes ready. The
+  // cached statements are prepared on hosts that were added or came back
+  // up. The requests are executed on the calling IO worker because its
+  // pool is known to be ready.
+  void prepare_on_up_host(IOWorker* io_worker, const Address& address);
+
+  const PreparedCache& prepared_cache() const { return prepared_cache_; }
   Future::Ptr execute(const Request::ConstPtr& request,
                       const Address* preferred_address = NULL);
 
+  // Hosts are partitioned across the IO workers when the number of IO
+  // threads per host is limited. These can be called on any thread because
+  // the IO workers vector never changes after initialization.
+  bool is_host_owner(const IOWorker* io_worker, const Address& address) const;
+  // Handoffs are requests that already have a query plan built by another
+  // IO worker
+  bool execute_on_owner(const RequestHandler::Ptr& request_handler,
+                        const Address& address,
+                        bool is_handoff);
+
   const Metadata& metadata() const { return metadata_; }
 
   int protocol_version() const {
@@ -130,6 +208,14 @@ private:
 
   void execute(const RequestHandler::Ptr& request_handler);
 
+  RequestHandler::Ptr new_prepare_handler(const std::string& query,
+                                          const ResponseFuture::Ptr& future,
+                                          const PreparedCache::Entry::Ptr& entry,
+                                          const Host::Ptr& host = Host::Ptr());
+
+  size_t io_worker_owner_count() const;
+  size_t first_io_worker_owner(const Address& address) const;
+
   virtual void on_run();
   virtual void on_after_run();
   virtual void on_event(const SessionEvent& event);
@@ -155,20 +241,14 @@ private:
   static void on_add_resolve_name(NameResolver* resolver);
 #endif
 
-#if UV_VERSION_MAJOR == 0
-  static void on_execute(uv_async_t* data, int status);
-#else
-  static void on_execute(uv_async_t* data);
-#endif
-
-  QueryPlan* new_query_plan(const RequestHandler::Ptr& request_handler = RequestHandler::Ptr());
-  SpeculativeExecutionPlan* new_execution_plan(const Request* request);
+  QueryPlan* new_query_plan();
 
   void on_reconnect(Timer* timer);
 
 private:
   // TODO(mpenick): Consider removing friend access to session
   friend class ControlConnection;
+  friend class SessionHandle;
 
   Host::Ptr add_host(const Address& address);
   void purge_hosts(bool is_initial_connection);
@@ -185,16 +265,34 @@ private:
   void on_up(Host::Ptr host);
   void on_down(Host::Ptr host);
 
+  // These update the session's load balancing policy and forward the change
+  // to the copies used by the IO workers to build query plans.
+  void policy_on_add(const Host::Ptr& host);
+  void policy_on_remove(const Host::Ptr& host);
+  void policy_on_up(const Host::Ptr& host);
+  void policy_on_down(const Host::Ptr& host);
+
+  // Returns a token map that's safe to modify. The current map is copied
+  // first if it's been published to the IO workers.
+  TokenMap* token_map_for_update();
+  void set_token_map(TokenMap* token_map);
+
+  // Sends an immutable snapshot of the current token map to the IO workers.
+  // This must only be called after the map has been built.
+  void publish_token_map();
+
 private:
   typedef std::vector<IOWorker::Ptr > IOWorkerVec;
 
   Atomic<State> state_;
   uv_mutex_t state_mutex_;
 
+  SessionHandle::Ptr handle_;
+
   Config config_;
   ScopedPtr<Metrics> metrics_;
+  ScopedPtr<RetryBudget> retry_budget_;
   LoadBalancingPolicy::Ptr load_balancing_policy_;
-  SharedRefPtr<SpeculativeExecutionPolicy> speculative_execution_policy_;
   CassError connect_error_code_;
   std::string connect_error_message_;
   Future::Ptr connect_future_;
@@ -204,16 +302,27 @@ private:
   uv_mutex_t hosts_mutex_;
 
   IOWorkerVec io_workers_;
-  ScopedPtr<AsyncQueue<MPMCQueue<RequestHandler*> > > request_queue_;
+  Atomic<size_t> current_io_worker_;
+
+  // The response future, request handler and first speculative execution
+  // of a request are allocated from a single pooled block.
+  RequestPool::Ptr request_pool_;
+
+  BufferPool::Ptr buffer_pool_;
+
+  PreparedCache prepared_cache_;
+
+  // The token map is only modified on the session thread (by the control
+  // connection). The IO workers each hold a reference to the last published
+  // snapshot so they never read a map that's being rebuilt.
+  TokenMap::Ptr token_map_;
 
-  ScopedPtr<TokenMap> token_map_;
   Metadata metadata_;
   ScopedPtr<Random> random_;
   ControlConnection control_connection_;
   bool current_host_mark_;
   int pending_pool_count_;
   int pending_workers_count_;
-  int current_io_worker_;
 
   CopyOnWritePtr<std::string> keyspace_;
 };
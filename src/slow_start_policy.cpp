@@ -0,0 +1,121 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "slow_start_policy.hpp"
+
+#include "get_time.hpp"
+#include "random.hpp"
+
+namespace cass {
+
+void SlowStartPolicy::init(const Host::Ptr& connected_host,
+                           const HostMap& hosts,
+                           Random* random) {
+  if (random != NULL) {
+    rng_ = MT19937_64(random->next(CASS_UINT64_MAX));
+  } else {
+    rng_ = MT19937_64(uv_hrtime());
+  }
+  ChainedLoadBalancingPolicy::init(connected_host, hosts, random);
+}
+
+QueryPlan* SlowStartPolicy::new_query_plan(const std::string& connected_keyspace,
+                                           RequestHandler* request_handler,
+                                           const TokenMap* token_map) {
+  QueryPlan* child_plan = child_policy_->new_query_plan(connected_keyspace,
+                                                        request_handler,
+                                                        token_map);
+  return new (QueryPlan::block(request_handler)) SlowStartQueryPlan(this, child_plan,
+                                                                    rng_());
+}
+
+double SlowStartPolicy::weight(const Host::Ptr& host, uint64_t now) const {
+  uint64_t up_time_ns = host->up_time_ns();
+  if (up_time_ns == 0 || now < up_time_ns ||
+      now - up_time_ns >= settings_.window_ns) {
+    return 1.0;
+  }
+  double ramp = static_cast<double>(now - up_time_ns) / settings_.window_ns;
+  return settings_.initial_weight + (1.0 - settings_.initial_weight) * ramp;
+}
+
+bool SlowStartPolicy::SlowStartQueryPlan::should_defer(const Host::Ptr& host) {
+  if (now_ == 0) {
+    now_ = get_time_monotonic_ns();
+  }
+
+  double weight = policy_->weight(host, now_);
+  if (weight >= 1.0) return false;
+
+  // SplitMix64: a small generator is enough to spread the decisions and its
+  // state fits in the query plan
+  uint64_t z = (rng_state_ += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+
+  // A uniformly distributed number in the range [0, 1)
+  double r = static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+  return r >= weight;
+}
+
+Host::Ptr SlowStartPolicy::SlowStartQueryPlan::compute_next() {
+  while (true) {
+    Host::Ptr host;
+    if (next_) {
+      host = next_;
+      next_.reset();
+    } else {
+      host = child_plan_->compute_next();
+    }
+
+    if (!host) {
+      return next_deferred();
+    }
+
+    // Deferred hosts are returned before any host at a different distance so
+    // that a warming up local host is still tried before remote hosts
+    if (deferred_index_ < deferred_.size() &&
+        policy_->distance(host) != deferred_distance_) {
+      next_ = host;
+      return next_deferred();
+    }
+
+    if (host->up_time_ns() == 0) {
+      return host;
+    }
+
+    if (!should_defer(host)) {
+      return host;
+    }
+
+    if (deferred_index_ >= deferred_.size()) {
+      deferred_.clear();
+      deferred_index_ = 0;
+      deferred_distance_ = policy_->distance(host);
+    }
+    deferred_.push_back(host);
+  }
+}
+
+Host::Ptr SlowStartPolicy::SlowStartQueryPlan::next_deferred() {
+  if (deferred_index_ < deferred_.size()) {
+    return deferred_[deferred_index_++];
+  }
+  return Host::Ptr();
+}
+
+} // namespace cass
@@ -0,0 +1,104 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_SLOW_START_POLICY_HPP_INCLUDED__
+#define __CASS_SLOW_START_POLICY_HPP_INCLUDED__
+
+#include "load_balancing.hpp"
+#include "macros.hpp"
+#include "scoped_ptr.hpp"
+#include "third_party/mt19937_64/mt19937_64.hpp"
+
+#include <vector>
+
+namespace cass {
+
+// Ramps up the traffic to a host that was just marked up after being down
+// so that it isn't given a full share of requests while its caches are
+// cold. During the window the host's weight grows linearly from the initial
+// weight to 1 and each query plan only keeps the host in its place with a
+// probability equal to its weight. Otherwise, the host is moved after the
+// other hosts at the same distance.
+class SlowStartPolicy : public ChainedLoadBalancingPolicy {
+public:
+  struct Settings {
+    Settings()
+      : window_ns(60LL * 1000LL * 1000LL * 1000LL) // 1 minute
+      , initial_weight(0.1) { }
+    uint64_t window_ns;
+    double initial_weight;
+  };
+
+  SlowStartPolicy(LoadBalancingPolicy* child_policy, const Settings& settings)
+    : ChainedLoadBalancingPolicy(child_policy)
+    , settings_(settings) {}
+
+  virtual ~SlowStartPolicy() {}
+
+  virtual void init(const Host::Ptr& connected_host, const HostMap& hosts, Random* random);
+
+  virtual QueryPlan* new_query_plan(const std::string& connected_keyspace,
+                                    RequestHandler* request_handler,
+                                    const TokenMap* token_map);
+
+  virtual LoadBalancingPolicy* new_instance() {
+    return new SlowStartPolicy(child_policy_->new_instance(), settings_);
+  }
+
+  // Returns the host's current weight in the range [initial weight, 1]
+  double weight(const Host::Ptr& host, uint64_t now) const;
+
+private:
+  // The query plans are seeded from the policy's generator when they're
+  // built, but they make their own decisions so that a plan can be iterated
+  // on a different thread than the one that owns the policy.
+  class SlowStartQueryPlan : public QueryPlan {
+  public:
+    SlowStartQueryPlan(const SlowStartPolicy* policy, QueryPlan* child_plan,
+                       uint64_t seed)
+      : policy_(policy)
+      , child_plan_(child_plan)
+      , rng_state_(seed)
+      , now_(0)
+      , deferred_distance_(CASS_HOST_DISTANCE_IGNORE)
+      , deferred_index_(0) {}
+
+    Host::Ptr compute_next();
+
+  private:
+    bool should_defer(const Host::Ptr& host);
+    Host::Ptr next_deferred();
+
+    const SlowStartPolicy* policy_;
+    ScopedPtr<QueryPlan> child_plan_;
+    uint64_t rng_state_;
+    uint64_t now_;
+    Host::Ptr next_;
+    HostVec deferred_;
+    CassHostDistance deferred_distance_;
+    size_t deferred_index_;
+  };
+
+  const Settings settings_;
+  MT19937_64 rng_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(SlowStartPolicy);
+};
+
+} // namespace cass
+
+#endif
@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "speculative_execution.hpp"
+
+#include <uv.h>
+
+namespace cass {
+
+SpeculativeExecutionPlan* PercentileSpeculativeExecutionPolicy::new_plan(const std::string& keyspace,
+                                                                         const Request* request) {
+  uint64_t now = uv_hrtime();
+  if (now - budget_window_start_ns_ >= settings_.window_ns) {
+    // Older requests count half as much toward the budget as the previous
+    // window so it adapts to changes in the request rate
+    request_count_ /= 2;
+    speculative_execution_count_ /= 2;
+    budget_window_start_ns_ = now;
+  }
+  ++request_count_;
+  return new Plan(this);
+}
+
+bool PercentileSpeculativeExecutionPolicy::try_acquire_budget() {
+  double limit = static_cast<double>(request_count_) * settings_.budget_percent / 100.0;
+  if (static_cast<double>(speculative_execution_count_ + 1) > limit) {
+    return false;
+  }
+  ++speculative_execution_count_;
+  return true;
+}
+
+int64_t PercentileSpeculativeExecutionPolicy::Plan::next_execution(const Host::Ptr& current_host) {
+  if (count_ <= 0 || !current_host) return -1;
+
+  const Settings& settings = policy_->settings();
+  current_host->enable_percentile_tracking(settings.percentile,
+                                           settings.window_ns,
+                                           settings.min_measured);
+
+  int64_t percentile_ns = current_host->latency_percentile();
+  if (percentile_ns < 0) return -1;
+
+  --count_;
+  // Delays are in milliseconds (rounded to the nearest) and a delay of 0
+  // would start the next execution immediately
+  int64_t delay_ms = (percentile_ns + 500000LL) / 1000000LL;
+  return delay_ms > 0 ? delay_ms : 1;
+}
+
+bool PercentileSpeculativeExecutionPolicy::Plan::can_execute() {
+  return policy_->try_acquire_budget();
+}
+
+} // namespace cass
@@ -32,6 +32,10 @@ public:
   virtual ~SpeculativeExecutionPlan() { }
 
   virtual int64_t next_execution(const Host::Ptr& current_host) = 0;
+
+  // Called when the delay of a scheduled execution has expired. The
+  // execution is skipped if this returns false.
+  virtual bool can_execute() { return true; }
 };
 
 class SpeculativeExecutionPolicy : public RefCounted<SpeculativeExecutionPolicy> {
@@ -92,6 +96,72 @@ public:
   const int max_speculative_executions_;
 };
 
+// Sets the delay from a rolling latency percentile (e.g. the 99th) of the
+// host that's currently executing the request so that a request is only
+// hedged when it's slower than almost all other requests to that host. No
+// speculative executions are started before a host has a complete window.
+//
+// The extra load is capped by a budget: speculative executions are skipped
+// when they'd be more than "budget_percent" of the recent requests. Each IO
+// worker has its own instance so the counters aren't shared between threads.
+class PercentileSpeculativeExecutionPolicy : public SpeculativeExecutionPolicy {
+public:
+  typedef SharedRefPtr<PercentileSpeculativeExecutionPolicy> Ptr;
+
+  struct Settings {
+    Settings()
+      : percentile(99.0)
+      , max_speculative_executions(1)
+      , budget_percent(10.0)
+      , window_ns(1000LL * 1000LL * 1000LL)
+      , min_measured(100) { }
+
+    double percentile;
+    int max_speculative_executions;
+    double budget_percent;
+    uint64_t window_ns; // The length of the percentile and budget windows
+    uint64_t min_measured;
+  };
+
+  PercentileSpeculativeExecutionPolicy(const Settings& settings)
+    : settings_(settings)
+    , budget_window_start_ns_(0)
+    , request_count_(0)
+    , speculative_execution_count_(0) { }
+
+  virtual SpeculativeExecutionPlan* new_plan(const std::string& keyspace,
+                                             const Request* request);
+
+  virtual SpeculativeExecutionPolicy* new_instance() {
+    return new PercentileSpeculativeExecutionPolicy(settings_);
+  }
+
+  const Settings& settings() const { return settings_; }
+
+  // Returns true and counts the execution if it's within the budget
+  bool try_acquire_budget();
+
+private:
+  class Plan : public SpeculativeExecutionPlan {
+  public:
+    Plan(PercentileSpeculativeExecutionPolicy* policy)
+      : policy_(policy)
+      , count_(policy->settings().max_speculative_executions) { }
+
+    virtual int64_t next_execution(const Host::Ptr& current_host);
+    virtual bool can_execute();
+
+  private:
+    Ptr policy_;
+    int count_;
+  };
+
+  const Settings settings_;
+  uint64_t budget_window_start_ns_;
+  uint64_t request_count_;
+  uint64_t speculative_execution_count_;
+};
+
 } // namespace cass
 
 #endif
@@ -33,6 +33,11 @@ public:
       , version_("3.0.0")
       , compression_("") {}
 
+  explicit StartupRequest(const std::string& compression)
+      : Request(CQL_OPCODE_STARTUP)
+      , version_("3.0.0")
+      , compression_(compression) {}
+
   bool encode(size_t reserved, char** output, size_t& size);
 
   const std::string version() const { return version_; }
@@ -92,6 +92,19 @@ CassError cass_statement_set_paging_size(CassStatement* statement,
   return CASS_OK;
 }
 
+CassError cass_statement_set_prefetch_pages(CassStatement* statement,
+                                            unsigned pages) {
+  statement->set_prefetch_pages(pages);
+  return CASS_OK;
+}
+
+CassError cass_statement_set_row_callback(CassStatement* statement,
+                                          CassRowCallback callback,
+                                          void* data) {
+  statement->set_row_callback(callback, data);
+  return CASS_OK;
+}
+
 CassError cass_statement_set_paging_state(CassStatement* statement,
                                           const CassResult* result) {
   statement->set_paging_state(result->paging_state().to_string());
@@ -362,7 +375,7 @@ int32_t Statement::encode_begin(int version, uint16_t element_count,
     flags |= CASS_QUERY_FLAG_PAGE_SIZE;
   }
 
-  if (!paging_state().empty()) {
+  if (!encoded_paging_state(callback).empty()) {
     flags |= CASS_QUERY_FLAG_PAGING_STATE;
   }
 
@@ -426,13 +439,14 @@ int32_t Statement::encode_values(int version, RequestCallback* callback, BufferV
 int32_t Statement::encode_end(int version, RequestCallback* callback, BufferVec* bufs) const {
   int32_t length = 0;
   size_t paging_buf_size = 0;
+  const std::string& paging_state = encoded_paging_state(callback);
 
   if (page_size() > 0) {
     paging_buf_size += sizeof(int32_t); // [int]
   }
 
-  if (!paging_state().empty()) {
-    paging_buf_size += sizeof(int32_t) + paging_state().size(); // [bytes]
+  if (!paging_state.empty()) {
+    paging_buf_size += sizeof(int32_t) + paging_state.size(); // [bytes]
   }
 
   if (serial_consistency() != 0) {
@@ -454,8 +468,8 @@ int32_t Statement::encode_end(int version, RequestCallback* callback, BufferVec*
       pos = buf.encode_int32(pos, page_size());
     }
 
-    if (!paging_state().empty()) {
-      pos = buf.encode_bytes(pos, paging_state().data(), paging_state().size());
+    if (!paging_state.empty()) {
+      pos = buf.encode_bytes(pos, paging_state.data(), paging_state.size());
     }
 
     if (serial_consistency() != 0) {
@@ -470,6 +484,11 @@ int32_t Statement::encode_end(int version, RequestCallback* callback, BufferVec*
   return length;
 }
 
+const std::string& Statement::encoded_paging_state(RequestCallback* callback) const {
+  const std::string* paging_state = callback->paging_state();
+  return paging_state != NULL ? *paging_state : paging_state_;
+}
+
 bool Statement::calculate_routing_key(const std::vector<size_t>& key_indices,
                                       std::string* routing_key, EncodingCache* cache) const {
   if (key_indices.empty()) return false;
@@ -45,7 +45,10 @@ public:
       , AbstractData(values_count)
       , query_or_id_(sizeof(int32_t) + query_length)
       , flags_(0)
-      , page_size_(-1) {
+      , page_size_(-1)
+      , prefetch_pages_(-1) // Disabled (use the cluster-level setting)
+      , row_callback_(NULL)
+      , row_callback_data_(NULL) {
     // <query> [long string]
     query_or_id_.encode_long_string(0, query, query_length);
   }
@@ -56,7 +59,10 @@ public:
       , AbstractData(prepared->result()->column_count())
       , query_or_id_(sizeof(uint16_t) + prepared->id().size())
       , flags_(0)
-      , page_size_(-1) {
+      , page_size_(-1)
+      , prefetch_pages_(-1) // Disabled (use the cluster-level setting)
+      , row_callback_(NULL)
+      , row_callback_data_(NULL) {
     // <id> [short bytes] (or [string])
     const std::string& id = prepared->id();
     query_or_id_.encode_string(0, id.data(), id.size());
@@ -64,6 +70,10 @@ public:
 
   virtual ~Statement() { }
 
+  // Returns a copy of the statement that doesn't change when the
+  // application modifies or frees the original
+  virtual Statement::Ptr copy() const = 0;
+
   bool skip_metadata() const {
     return flags_ & CASS_QUERY_FLAG_SKIP_METADATA;
   }
@@ -92,6 +102,23 @@ public:
 
   void set_page_size(int32_t page_size) { page_size_ = page_size; }
 
+  unsigned prefetch_pages(unsigned default_prefetch_pages) const {
+    return prefetch_pages_ < 0 ? default_prefetch_pages
+                               : static_cast<unsigned>(prefetch_pages_);
+  }
+
+  void set_prefetch_pages(unsigned prefetch_pages) {
+    prefetch_pages_ = static_cast<int32_t>(prefetch_pages);
+  }
+
+  CassRowCallback row_callback() const { return row_callback_; }
+  void* row_callback_data() const { return row_callback_data_; }
+
+  void set_row_callback(CassRowCallback callback, void* data) {
+    row_callback_ = callback;
+    row_callback_data_ = data;
+  }
+
   const std::string& paging_state() const { return paging_state_; }
 
   void set_paging_state(const std::string& paging_state) {
@@ -112,6 +139,18 @@ public:
   int32_t encode_batch(int version, RequestCallback* callback, BufferVec* bufs) const;
 
 protected:
+  Statement(const Statement& other)
+      : RoutableRequest(other)
+      , AbstractData(other)
+      , query_or_id_(other.query_or_id_)
+      , flags_(other.flags_)
+      , page_size_(other.page_size_)
+      , prefetch_pages_(other.prefetch_pages_)
+      , row_callback_(other.row_callback_)
+      , row_callback_data_(other.row_callback_data_)
+      , paging_state_(other.paging_state_)
+      , key_indices_(other.key_indices_) { }
+
   int32_t encode_v1(RequestCallback* callback, BufferVec* bufs) const;
 
   int32_t encode_begin(int version, uint16_t element_count,
@@ -119,6 +158,8 @@ protected:
   int32_t encode_values(int version, RequestCallback* callback, BufferVec* bufs) const;
   int32_t encode_end(int version, RequestCallback* callback, BufferVec* bufs) const;
 
+  const std::string& encoded_paging_state(RequestCallback* callback) const;
+
   bool calculate_routing_key(const std::vector<size_t>& key_indices,
                              std::string* routing_key, EncodingCache* cache) const;
 
@@ -126,11 +167,14 @@ private:
   Buffer query_or_id_;
   int32_t flags_;
   int32_t page_size_;
+  int32_t prefetch_pages_;
+  CassRowCallback row_callback_;
+  void* row_callback_data_;
   std::string paging_state_;
   std::vector<size_t> key_indices_;
 
 private:
-  DISALLOW_COPY_AND_ASSIGN(Statement);
+  DISALLOW_ASSIGN(Statement);
 };
 
 } // namespace cass
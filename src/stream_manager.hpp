@@ -60,6 +60,15 @@ public:
     release_stream(stream);
   }
 
+  bool get_pending(int stream, T& output) const {
+    typename PendingMap::const_iterator i = pending_.find(stream);
+    if (i != pending_.end()) {
+      output = i->second;
+      return true;
+    }
+    return false;
+  }
+
   bool get_pending_and_release(int stream, T& output) {
     typename PendingMap::iterator i = pending_.find(stream);
     if (i != pending_.end()) {
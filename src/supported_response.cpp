@@ -17,6 +17,7 @@
 #include "supported_response.hpp"
 
 #include "serialization.hpp"
+#include "string_ref.hpp"
 
 namespace cass {
 
@@ -36,4 +37,12 @@ bool SupportedResponse::decode(int version, char* buffer, size_t size) {
   return true;
 }
 
+bool SupportedResponse::supports_compression(const std::string& name) const {
+  for (std::list<std::string>::const_iterator it = compression_.begin(),
+       end = compression_.end(); it != end; ++it) {
+    if (iequals(*it, name)) return true;
+  }
+  return false;
+}
+
 } // namespace cass
@@ -32,6 +32,10 @@ public:
 
   bool decode(int version, char* buffer, size_t size);
 
+  const std::list<std::string>& compression() const { return compression_; }
+
+  bool supports_compression(const std::string& name) const;
+
 private:
   std::list<std::string> compression_;
   std::list<std::string> versions_;
@@ -0,0 +1,225 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "timer_wheel.hpp"
+
+#include "utils.hpp"
+
+#include <assert.h>
+
+#define SLOT_MASK (TimerWheel::NUM_SLOTS - 1)
+
+// Timers that expire beyond this are placed in the highest level and
+// re-inserted when they cascade.
+#define MAX_RANGE (static_cast<uint64_t>(1) << (TimerWheel::LEVEL_BITS * TimerWheel::NUM_LEVELS))
+
+namespace cass {
+
+void WheelTimer::start(TimerWheel* wheel, uint64_t timeout, void* data, Callback cb) {
+  stop();
+  data_ = data;
+  cb_ = cb;
+  wheel->add(this, timeout);
+}
+
+void WheelTimer::stop() {
+  if (wheel_ == NULL) return;
+  wheel_->remove(this);
+}
+
+TimerWheel::TimerWheel()
+  : loop_(NULL)
+  , is_scheduled_(false)
+  , scheduled_expires_(0)
+  , current_(0)
+  , count_(0) {
+  for (size_t i = 0; i < NUM_LEVELS; ++i) {
+    non_empty_slots_[i] = 0;
+  }
+}
+
+int TimerWheel::init(uv_loop_t* loop) {
+  loop_ = loop;
+  current_ = uv_now(loop);
+  timer_.data = this;
+  return uv_timer_init(loop, &timer_);
+}
+
+void TimerWheel::close_handles() {
+  uv_close(reinterpret_cast<uv_handle_t*>(&timer_), NULL);
+}
+
+void TimerWheel::advance(uint64_t now) {
+  while (current_ < now) {
+    if (count_ == 0) {
+      current_ = now;
+      break;
+    }
+
+    // Skip ahead to the next cascade if there's nothing in the lowest level
+    if (non_empty_slots_[0] == 0) {
+      uint64_t next = (current_ | SLOT_MASK) + 1;
+      if (next > now) {
+        current_ = now;
+        break;
+      }
+      current_ = next - 1;
+    }
+
+    ++current_;
+
+    // Cascade from the highest level that's turned over so that timers can
+    // move down more than one level at a time.
+    if ((current_ & SLOT_MASK) == 0) {
+      size_t level = 1;
+      while (level < NUM_LEVELS - 1 &&
+             ((current_ >> (LEVEL_BITS * level)) & SLOT_MASK) == 0) {
+        ++level;
+      }
+      for (; level > 0; --level) {
+        cascade(level);
+      }
+    }
+
+    expire(&slots_[0][current_ & SLOT_MASK]);
+  }
+}
+
+void TimerWheel::add(WheelTimer* timer, uint64_t timeout) {
+  uint64_t now = uv_now(loop_);
+  if (count_ == 0 && now > current_) {
+    current_ = now; // Nothing to expire, catch up without turning the wheel
+  }
+  if (now < current_) {
+    now = current_;
+  }
+
+  uint64_t expires = now + timeout;
+  if (expires <= current_) {
+    expires = current_ + 1;
+  }
+
+  timer->wheel_ = this;
+  timer->expires_ = expires;
+  insert(timer);
+  ++count_;
+
+  if (!is_scheduled_ || expires < scheduled_expires_) {
+    schedule(next_expiration());
+  }
+}
+
+void TimerWheel::remove(WheelTimer* timer) {
+  List<WheelTimer>* slot = timer->slot_;
+  slot->remove(timer);
+  if (slot->is_empty()) {
+    size_t index = slot - &slots_[0][0];
+    non_empty_slots_[index / NUM_SLOTS] &=
+        ~(static_cast<uint64_t>(1) << (index % NUM_SLOTS));
+  }
+  timer->wheel_ = NULL;
+  timer->slot_ = NULL;
+  --count_;
+  // The libuv timer is left running. It's cheaper to handle an occasional
+  // early wake up than to re-arm it every time a request finishes.
+}
+
+void TimerWheel::insert(WheelTimer* timer) {
+  uint64_t expires = timer->expires_;
+  if (expires - current_ >= MAX_RANGE) {
+    expires = current_ + MAX_RANGE - 1;
+  }
+
+  uint64_t delta = expires - current_;
+  size_t level = 0;
+  while (level < NUM_LEVELS - 1 &&
+         delta >= (static_cast<uint64_t>(1) << (LEVEL_BITS * (level + 1)))) {
+    ++level;
+  }
+
+  size_t index = (expires >> (LEVEL_BITS * level)) & SLOT_MASK;
+  List<WheelTimer>* slot = &slots_[level][index];
+  slot->add_to_back(timer);
+  timer->slot_ = slot;
+  non_empty_slots_[level] |= static_cast<uint64_t>(1) << index;
+}
+
+void TimerWheel::cascade(size_t level) {
+  size_t index = (current_ >> (LEVEL_BITS * level)) & SLOT_MASK;
+  List<WheelTimer>* slot = &slots_[level][index];
+  non_empty_slots_[level] &= ~(static_cast<uint64_t>(1) << index);
+  while (!slot->is_empty()) {
+    WheelTimer* timer = slot->front();
+    slot->remove(timer);
+    insert(timer);
+  }
+}
+
+void TimerWheel::expire(List<WheelTimer>* slot) {
+  // Callbacks can start and stop other timers, but new timers never expire
+  // in the current slot.
+  while (!slot->is_empty()) {
+    WheelTimer* timer = slot->front();
+    assert(timer->expires_ == current_);
+    remove(timer);
+    timer->cb_(timer);
+  }
+}
+
+uint64_t TimerWheel::next_expiration() const {
+  uint64_t next = current_ + MAX_RANGE;
+  for (size_t level = 0; level < NUM_LEVELS; ++level) {
+    uint64_t slots = non_empty_slots_[level];
+    if (slots == 0) continue;
+
+    // Find the first non-empty slot after the current one. For higher
+    // levels this is when the slot cascades which is the earliest any of
+    // its timers can expire.
+    size_t shift = LEVEL_BITS * level;
+    uint64_t base = current_ >> shift;
+    size_t start = static_cast<size_t>((base + 1) & SLOT_MASK);
+    if (start != 0) {
+      slots = (slots >> start) | (slots << (NUM_SLOTS - start));
+    }
+    uint64_t expires = (base + 1 + num_trailing_zeros(slots)) << shift;
+    if (expires < next) {
+      next = expires;
+    }
+  }
+  return next;
+}
+
+void TimerWheel::schedule(uint64_t expires) {
+  uint64_t now = uv_now(loop_);
+  is_scheduled_ = true;
+  scheduled_expires_ = expires;
+  uv_timer_start(&timer_, on_timeout, expires > now ? expires - now : 0, 0);
+}
+
+#if UV_VERSION_MAJOR == 0
+void TimerWheel::on_timeout(uv_timer_t* handle, int status) {
+#else
+void TimerWheel::on_timeout(uv_timer_t* handle) {
+#endif
+  TimerWheel* wheel = static_cast<TimerWheel*>(handle->data);
+  wheel->is_scheduled_ = false;
+  wheel->advance(uv_now(wheel->loop_));
+  if (wheel->count_ > 0 && !wheel->is_scheduled_) {
+    wheel->schedule(wheel->next_expiration());
+  }
+}
+
+} // namespace cass
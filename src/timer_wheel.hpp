@@ -0,0 +1,135 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_TIMER_WHEEL_HPP_INCLUDED__
+#define __CASS_TIMER_WHEEL_HPP_INCLUDED__
+
+#include "list.hpp"
+#include "macros.hpp"
+
+#include <stdint.h>
+#include <uv.h>
+
+namespace cass {
+
+class TimerWheel;
+
+// A timer that's scheduled on a timer wheel instead of using its own libuv
+// timer handle. Starting and stopping are constant time and don't allocate
+// which makes it suitable for timeouts that are started for every request.
+// It MUST only be used on the thread that runs the wheel's loop.
+class WheelTimer : public List<WheelTimer>::Node {
+public:
+  typedef void (*Callback)(WheelTimer*);
+
+  WheelTimer()
+    : wheel_(NULL)
+    , slot_(NULL)
+    , data_(NULL)
+    , cb_(NULL)
+    , expires_(0) { }
+
+  ~WheelTimer() {
+    stop();
+  }
+
+  void* data() const { return data_; }
+
+  bool is_running() const { return wheel_ != NULL; }
+
+  // The timeout is in milliseconds
+  void start(TimerWheel* wheel, uint64_t timeout, void* data, Callback cb);
+  void stop();
+
+private:
+  friend class TimerWheel;
+
+  TimerWheel* wheel_;
+  List<WheelTimer>* slot_;
+  void* data_;
+  Callback cb_;
+  uint64_t expires_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(WheelTimer);
+};
+
+// A hierarchical timer wheel with a resolution of one millisecond (the
+// resolution of the loop's time). Each level has 64 slots and covers 64
+// times the range of the level below it: ~64 ms, ~4 s, ~4.4 min and
+// ~4.7 hours. Timers are placed in the lowest level that covers their
+// expiration and cascade down to lower levels as the wheel turns. Timers
+// further out than the highest level are re-inserted when their slot comes
+// up.
+//
+// A single libuv timer drives the wheel. It's only re-armed when a timer is
+// started that expires earlier than the current deadline, so the loop's
+// timer heap stays the same size no matter how many requests are in flight.
+class TimerWheel {
+public:
+  static const size_t LEVEL_BITS = 6;
+  static const size_t NUM_SLOTS = 1 << LEVEL_BITS;
+  static const size_t NUM_LEVELS = 4;
+
+  TimerWheel();
+
+  int init(uv_loop_t* loop);
+  void close_handles();
+
+  uv_loop_t* loop() const { return loop_; }
+
+  size_t size() const { return count_; }
+
+  // Expires all the timers up to the loop time "now". This is called by the
+  // wheel's libuv timer, but it's also useful for testing.
+  void advance(uint64_t now);
+
+private:
+  friend class WheelTimer;
+
+  void add(WheelTimer* timer, uint64_t timeout);
+  void remove(WheelTimer* timer);
+
+  void insert(WheelTimer* timer);
+  void cascade(size_t level);
+  void expire(List<WheelTimer>* slot);
+
+  uint64_t next_expiration() const;
+  void schedule(uint64_t expires);
+
+#if UV_VERSION_MAJOR == 0
+  static void on_timeout(uv_timer_t* handle, int status);
+#else
+  static void on_timeout(uv_timer_t* handle);
+#endif
+
+private:
+  uv_loop_t* loop_;
+  uv_timer_t timer_;
+  bool is_scheduled_;
+  uint64_t scheduled_expires_;
+  uint64_t current_;
+  size_t count_;
+  uint64_t non_empty_slots_[NUM_LEVELS];
+  List<WheelTimer> slots_[NUM_LEVELS][NUM_SLOTS];
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+} // namespace cass
+
+#endif
@@ -57,17 +57,17 @@ QueryPlan* TokenAwarePolicy::new_query_plan(const std::string& connected_keyspac
         const std::string& statement_keyspace = request->keyspace();
         const std::string& keyspace = statement_keyspace.empty()
                                       ? connected_keyspace : statement_keyspace;
-        std::string routing_key;
-        if (request->get_routing_key(&routing_key, request_handler->encoding_cache()) && !keyspace.empty()) {
+        if (request->get_routing_key(&routing_key_, request_handler->encoding_cache()) && !keyspace.empty()) {
           if (token_map != NULL) {
-            CopyOnWriteHostVec replicas = token_map->get_replicas(keyspace, routing_key);
+            const CopyOnWriteHostVec& replicas = token_map->get_replicas(keyspace, routing_key_);
             if (replicas && !replicas->empty()) {
-              return new TokenAwareQueryPlan(child_policy_.get(),
-                                             child_policy_->new_query_plan(connected_keyspace,
-                                                                           request_handler,
-                                                                           token_map),
-                                             replicas,
-                                             index_++);
+              QueryPlan* child_plan = child_policy_->new_query_plan(connected_keyspace,
+                                                                    request_handler,
+                                                                    token_map);
+              return new (QueryPlan::block(request_handler)) TokenAwareQueryPlan(child_policy_.get(),
+                                                                                 child_plan,
+                                                                                 replicas,
+                                                                                 index_++);
             }
           }
         }
@@ -84,9 +84,11 @@ QueryPlan* TokenAwarePolicy::new_query_plan(const std::string& connected_keyspac
 }
 
 Host::Ptr TokenAwarePolicy::TokenAwareQueryPlan::compute_next()  {
+  // Only the const accessors are used so the shared replicas aren't copied
+  const HostVec& replicas(*static_cast<const CopyOnWriteHostVec&>(replicas_));
   while (remaining_ > 0) {
     --remaining_;
-    const Host::Ptr& host((*replicas_)[index_++ % replicas_->size()]);
+    const Host::Ptr& host(replicas[index_++ % replicas.size()]);
     if (host->is_up() && child_policy_->distance(host) == CASS_HOST_DISTANCE_LOCAL) {
       return host;
     }
@@ -61,6 +61,10 @@ private:
   };
 
   size_t index_;
+  // Reused for every query plan so the routing key's memory isn't allocated
+  // for each request. Each instance of the policy is only used by a single
+  // thread.
+  std::string routing_key_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(TokenAwarePolicy);
@@ -20,13 +20,14 @@
 
 namespace cass {
 
-TokenMap* TokenMap::from_partitioner(StringRef partitioner) {
+TokenMap* TokenMap::from_partitioner(StringRef partitioner,
+                                     const BuildSettings& settings) {
   if (ends_with(partitioner, Murmur3Partitioner::name())) {
-    return new TokenMapImpl<Murmur3Partitioner>();
+    return new TokenMapImpl<Murmur3Partitioner>(settings);
   } else if (ends_with(partitioner, RandomPartitioner::name())) {
-    return new TokenMapImpl<RandomPartitioner>();
+    return new TokenMapImpl<RandomPartitioner>(settings);
   } else if (ends_with(partitioner, ByteOrderedPartitioner::name())) {
-    return new TokenMapImpl<ByteOrderedPartitioner>();
+    return new TokenMapImpl<ByteOrderedPartitioner>(settings);
   } else {
     LOG_WARN("Unsupported partitioner class '%s'", partitioner.to_string().c_str());
     return NULL;
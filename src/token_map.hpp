@@ -18,6 +18,7 @@
 #define __CASS_TOKEN_MAP_HPP_INCLUDED__
 
 #include "host.hpp"
+#include "ref_counted.hpp"
 
 #include <string>
 
@@ -28,12 +29,33 @@ class Value;
 class ResultResponse;
 class StringRef;
 
-class TokenMap {
+// Token maps are only ever modified by the session thread. Once a map has
+// been built it's published to the IO workers as an immutable snapshot and
+// the session makes a copy before applying the next update (see
+// Session::token_map_for_update()) so that replica lookups never need a lock.
+class TokenMap : public RefCounted<TokenMap> {
 public:
-  static TokenMap* from_partitioner(StringRef partitioner);
+  typedef SharedRefPtr<TokenMap> Ptr;
+  typedef SharedRefPtr<const TokenMap> ConstPtr;
+
+  struct BuildSettings {
+    BuildSettings()
+      : num_threads(4)
+      , is_lazy(false) { }
+    // The maximum number of threads, including the calling thread, used to
+    // build the replicas of the different replication strategies
+    unsigned num_threads;
+    // Only build a keyspace's replicas on its first lookup
+    bool is_lazy;
+  };
+
+  static TokenMap* from_partitioner(StringRef partitioner,
+                                    const BuildSettings& settings = BuildSettings());
 
   virtual ~TokenMap() { }
 
+  virtual TokenMap* copy() const = 0;
+
   virtual void add_host(const Host::Ptr& host, const Value* tokens) = 0;
   virtual void update_host_and_build(const Host::Ptr& host, const Value* tokens) = 0;
   virtual void remove_host_and_build(const Host::Ptr& host) = 0;
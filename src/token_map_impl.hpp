@@ -17,14 +17,18 @@
 #ifndef __CASS_TOKEN_MAP_IMPL_HPP_INCLUDED__
 #define __CASS_TOKEN_MAP_IMPL_HPP_INCLUDED__
 
+#include "atomic.hpp"
 #include "collection_iterator.hpp"
 #include "constants.hpp"
 #include "map_iterator.hpp"
+#include "ref_counted.hpp"
 #include "result_iterator.hpp"
 #include "result_response.hpp"
 #include "row.hpp"
+#include "scoped_lock.hpp"
 #include "string_ref.hpp"
 #include "token_map.hpp"
+#include "utils.hpp"
 #include "value.hpp"
 
 #include "third_party/rapidjson/rapidjson/document.h"
@@ -232,6 +236,18 @@ public:
     }
   };
 
+  // The part of the ring that was visited to find a token's replicas. The
+  // walk starts at the token and ends at "last_token". It's incomplete if the
+  // whole ring was visited without finding enough replicas.
+  struct ReplicaWalk {
+    ReplicaWalk()
+      : is_complete(false) { }
+    Token last_token;
+    bool is_complete;
+  };
+
+  typedef std::vector<ReplicaWalk> ReplicaWalkVec;
+
   enum Type {
     NETWORK_TOPOLOGY_STRATEGY,
     SIMPLE_STRATEGY,
@@ -251,15 +267,51 @@ public:
   }
 
   void build_replicas(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                      TokenReplicasVec& result) const;
+                      TokenReplicasVec& result, ReplicaWalkVec* walks = NULL) const;
+
+  // Builds the replicas after a single host's tokens have been removed,
+  // added or changed. "old_num_tokens" and "old_datacenters" describe the
+  // ring "old_result" and "old_walks" were built from and "changed_tokens"
+  // are the host's old and new tokens (sorted). Only the tokens whose walk of
+  // the ring includes one of the changed tokens are recomputed. Everything is
+  // rebuilt if the change affects the number of replicas or the racks in a
+  // datacenter. The old replicas that are still valid are moved out of
+  // "old_result" unless it's shared.
+  void update_replicas(const TokenHostVec& tokens, const DatacenterMap& datacenters,
+                       size_t old_num_tokens, const DatacenterMap& old_datacenters,
+                       const TokenHostVec& changed_tokens,
+                       TokenReplicasVec& old_result, const ReplicaWalkVec& old_walks,
+                       bool is_old_result_shared,
+                       TokenReplicasVec& result, ReplicaWalkVec& walks) const;
 
 private:
-  void build_replicas_network_topology(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                                       TokenReplicasVec& result) const;
-  void build_replicas_simple(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                             TokenReplicasVec& result) const ;
-  void build_replicas_non_replicated(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                                     TokenReplicasVec& result) const;
+  // The replication factors after they've been limited by the nodes in the
+  // ring and the per-token state used while walking it
+  struct BuildState {
+    BuildState()
+      : num_replicas(0) { }
+    size_t num_replicas;
+    DatacenterRackInfoMap dc_racks;
+  };
+
+  bool init_build_state(size_t num_tokens, const DatacenterMap& datacenters,
+                        BuildState* state) const;
+  bool is_equivalent(size_t num_tokens, const DatacenterMap& datacenters,
+                     size_t other_num_tokens, const DatacenterMap& other_datacenters) const;
+
+  CopyOnWriteHostVec find_replicas(const TokenHostVec& tokens,
+                                   typename TokenHostVec::const_iterator token_it,
+                                   BuildState* state, ReplicaWalk* walk) const;
+  CopyOnWriteHostVec find_replicas_network_topology(const TokenHostVec& tokens,
+                                                    typename TokenHostVec::const_iterator token_it,
+                                                    BuildState* state, ReplicaWalk* walk) const;
+  CopyOnWriteHostVec find_replicas_simple(const TokenHostVec& tokens,
+                                          typename TokenHostVec::const_iterator token_it,
+                                          BuildState* state, ReplicaWalk* walk) const;
+
+  static bool is_walk_changed(const Token& token, const ReplicaWalk& walk,
+                              typename TokenHostVec::const_iterator next_changed_it,
+                              const TokenHostVec& changed_tokens);
 
 private:
   Type type_;
@@ -347,169 +399,461 @@ void ReplicationStrategy<Partitioner>::init(IdGenerator& dc_ids,
 
 template <class Partitioner>
 void ReplicationStrategy<Partitioner>::build_replicas(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                                                      TokenReplicasVec& result) const {
+                                                      TokenReplicasVec& result, ReplicaWalkVec* walks) const {
   result.clear();
   result.reserve(tokens.size());
-
-  switch (type_) {
-    case NETWORK_TOPOLOGY_STRATEGY:
-      build_replicas_network_topology(tokens, datacenters, result);
-      break;
-    case SIMPLE_STRATEGY:
-      build_replicas_simple(tokens, datacenters, result);
-      break;
-    default:
-      build_replicas_non_replicated(tokens, datacenters, result);
-      break;
+  if (walks != NULL) {
+    walks->clear();
+    walks->reserve(tokens.size());
   }
-}
 
-template <class Partitioner>
-void ReplicationStrategy<Partitioner>::build_replicas_network_topology(const TokenHostVec& tokens, const DatacenterMap& datacenters,
-                                                                       TokenReplicasVec& result) const {
-  if (replication_factors_.empty()) {
+  BuildState state;
+  if (!init_build_state(tokens.size(), datacenters, &state)) {
     return;
   }
 
-  DatacenterRackInfoMap dc_racks;
-  dc_racks.resize(datacenters.size());
-
-  size_t num_replicas = 0;
-
-  // Populate the datacenter and rack information. Only considering valid
-  // datacenters that actually have hosts. If there's a replication factor
-  // for a datacenter that doesn't exist or has no node then it will not
-  // be counted.
-  for (ReplicationFactorMap::const_iterator i = replication_factors_.begin(),
-       end = replication_factors_.end(); i != end; ++i) {
-    DatacenterMap::const_iterator j = datacenters.find(i->first);
-    // Don't include datacenters that don't exist
-    if (j != datacenters.end()) {
-      // A replication factor cannot exceed the number of nodes in a datacenter
-      size_t replication_factor = std::min<size_t>(i->second.count, j->second.num_nodes);
-      num_replicas += replication_factor;
-      DatacenterRackInfo dc_rack_info;
-      dc_rack_info.replication_factor = replication_factor;
-      dc_rack_info.rack_count = j->second.racks.size();
-      dc_racks[j->first] = dc_rack_info;
-    } else {
-      LOG_WARN("No nodes in datacenter '%s'. Check your replication strategies.", i->second.name.c_str());
+  ReplicaWalk walk;
+  for (typename TokenHostVec::const_iterator i = tokens.begin(),
+       end = tokens.end(); i != end; ++i) {
+    result.push_back(TokenReplicas(i->first, find_replicas(tokens, i, &state, &walk)));
+    if (walks != NULL) {
+      walks->push_back(walk);
     }
   }
+}
 
-  if (num_replicas == 0) {
+template <class Partitioner>
+void ReplicationStrategy<Partitioner>::update_replicas(const TokenHostVec& tokens, const DatacenterMap& datacenters,
+                                                       size_t old_num_tokens, const DatacenterMap& old_datacenters,
+                                                       const TokenHostVec& changed_tokens,
+                                                       TokenReplicasVec& old_result, const ReplicaWalkVec& old_walks,
+                                                       bool is_old_result_shared,
+                                                       TokenReplicasVec& result, ReplicaWalkVec& walks) const {
+  BuildState state;
+  if (old_result.size() != old_num_tokens || old_walks.size() != old_num_tokens ||
+      !is_equivalent(tokens.size(), datacenters, old_num_tokens, old_datacenters) ||
+      !init_build_state(tokens.size(), datacenters, &state)) {
+    build_replicas(tokens, datacenters, result, &walks);
     return;
   }
 
+  result.clear();
+  result.reserve(tokens.size());
+  walks.clear();
+  walks.reserve(tokens.size());
+
+  // The old replicas, the new tokens and the changed tokens are all sorted
+  // so everything is found with a single pass. If nothing else is using the
+  // old replicas then the ones that are still valid are swapped into the
+  // result instead of being copied so their reference counts (spread all
+  // over the heap) aren't touched.
+  const CopyOnWriteHostVec no_replicas(NULL);
+  size_t old_index = 0;
+  typename TokenHostVec::const_iterator changed_it = changed_tokens.begin();
+  ReplicaWalk walk;
   for (typename TokenHostVec::const_iterator i = tokens.begin(),
        end = tokens.end(); i != end; ++i) {
-    Token token = i->first;
-    typename TokenHostVec::const_iterator token_it = i;
-
-    CopyOnWriteHostVec replicas(new HostVec());
-    replicas->reserve(num_replicas);
-
-    // Clear datacenter and rack information for the next token
-    for (typename DatacenterRackInfoMap::iterator j = dc_racks.begin(),
-         end = dc_racks.end(); j != end; ++j) {
-      j->second.replica_count = 0;
-      j->second.racks_observed.clear();
-      j->second.skipped_endpoints.clear();
-    }
-
-    for (typename TokenHostVec::const_iterator j = tokens.begin(),
-         end = tokens.end(); j != end && replicas->size() < num_replicas; ++j) {
-      typename TokenHostVec::const_iterator  curr_token_it = token_it;
-      Host* host = curr_token_it->second;
-      uint32_t dc = host->dc_id();
-      uint32_t rack = host->rack_id();
-
-      ++token_it;
-      if (token_it == tokens.end()) {
-        token_it = tokens.begin();
+    const Token& token = i->first;
+    while (old_index < old_result.size() && old_result[old_index].first < token) {
+      ++old_index;
+    }
+    while (changed_it != changed_tokens.end() && changed_it->first < token) {
+      ++changed_it;
+    }
+
+    if (old_index < old_result.size() &&
+        old_result[old_index].first == token &&
+        old_walks[old_index].is_complete &&
+        !is_walk_changed(token, old_walks[old_index], changed_it, changed_tokens)) {
+      if (is_old_result_shared) {
+        result.push_back(old_result[old_index]);
+      } else {
+        result.push_back(TokenReplicas(token, no_replicas));
+        result.back().second.swap(old_result[old_index].second);
+      }
+      walks.push_back(old_walks[old_index]);
+    } else {
+      result.push_back(TokenReplicas(token, find_replicas(tokens, i, &state, &walk)));
+      walks.push_back(walk);
+    }
+  }
+}
+
+template <class Partitioner>
+bool ReplicationStrategy<Partitioner>::init_build_state(size_t num_tokens, const DatacenterMap& datacenters,
+                                                        BuildState* state) const {
+  switch (type_) {
+    case NETWORK_TOPOLOGY_STRATEGY: {
+      if (replication_factors_.empty()) {
+        return false;
+      }
+
+      state->num_replicas = 0;
+      state->dc_racks.resize(datacenters.size());
+
+      // Populate the datacenter and rack information. Only considering valid
+      // datacenters that actually have hosts. If there's a replication factor
+      // for a datacenter that doesn't exist or has no node then it will not
+      // be counted.
+      for (ReplicationFactorMap::const_iterator i = replication_factors_.begin(),
+           end = replication_factors_.end(); i != end; ++i) {
+        DatacenterMap::const_iterator j = datacenters.find(i->first);
+        // Don't include datacenters that don't exist
+        if (j != datacenters.end()) {
+          // A replication factor cannot exceed the number of nodes in a datacenter
+          size_t replication_factor = std::min<size_t>(i->second.count, j->second.num_nodes);
+          state->num_replicas += replication_factor;
+          DatacenterRackInfo dc_rack_info;
+          dc_rack_info.replication_factor = replication_factor;
+          dc_rack_info.rack_count = j->second.racks.size();
+          state->dc_racks[j->first] = dc_rack_info;
+        } else {
+          LOG_WARN("No nodes in datacenter '%s'. Check your replication strategies.", i->second.name.c_str());
+        }
       }
+      break;
+    }
 
-      typename DatacenterRackInfoMap::iterator dc_rack_it = dc_racks.find(dc);
-      if (dc_rack_it == dc_racks.end()) {
-        continue;
+    case SIMPLE_STRATEGY: {
+      ReplicationFactorMap::const_iterator it = replication_factors_.find(1);
+      if (it == replication_factors_.end()) {
+        return false;
       }
+      state->num_replicas = std::min<size_t>(it->second.count, num_tokens);
+      break;
+    }
 
-      DatacenterRackInfo& dc_rack_info = dc_rack_it->second;
+    default:
+      state->num_replicas = 1;
+      break;
+  }
 
-      size_t& replica_count_this_dc = dc_rack_info.replica_count;
-      const size_t replication_factor = dc_rack_info.replication_factor;
+  return state->num_replicas > 0;
+}
 
-      if (replica_count_this_dc >= replication_factor) {
-        continue;
+template <class Partitioner>
+bool ReplicationStrategy<Partitioner>::is_equivalent(size_t num_tokens, const DatacenterMap& datacenters,
+                                                     size_t other_num_tokens, const DatacenterMap& other_datacenters) const {
+  switch (type_) {
+    case NETWORK_TOPOLOGY_STRATEGY:
+      for (ReplicationFactorMap::const_iterator i = replication_factors_.begin(),
+           end = replication_factors_.end(); i != end; ++i) {
+        DatacenterMap::const_iterator j = datacenters.find(i->first);
+        DatacenterMap::const_iterator k = other_datacenters.find(i->first);
+        if (j == datacenters.end() || k == other_datacenters.end()) {
+          if (j != datacenters.end() || k != other_datacenters.end()) return false;
+        } else if (std::min<size_t>(i->second.count, j->second.num_nodes) !=
+                   std::min<size_t>(i->second.count, k->second.num_nodes) ||
+                   j->second.racks.size() != k->second.racks.size()) {
+          return false;
+        }
       }
+      return true;
+
+    case SIMPLE_STRATEGY: {
+      ReplicationFactorMap::const_iterator it = replication_factors_.find(1);
+      return it == replication_factors_.end() ||
+          std::min<size_t>(it->second.count, num_tokens) ==
+          std::min<size_t>(it->second.count, other_num_tokens);
+    }
+
+    default:
+      return true;
+  }
+}
+
+template <class Partitioner>
+CopyOnWriteHostVec ReplicationStrategy<Partitioner>::find_replicas(const TokenHostVec& tokens,
+                                                                   typename TokenHostVec::const_iterator token_it,
+                                                                   BuildState* state, ReplicaWalk* walk) const {
+  switch (type_) {
+    case NETWORK_TOPOLOGY_STRATEGY:
+      return find_replicas_network_topology(tokens, token_it, state, walk);
+    case SIMPLE_STRATEGY:
+      return find_replicas_simple(tokens, token_it, state, walk);
+    default:
+      walk->last_token = token_it->first;
+      walk->is_complete = true;
+      return CopyOnWriteHostVec(new HostVec(1, Host::Ptr(token_it->second)));
+  }
+}
+
+template <class Partitioner>
+CopyOnWriteHostVec ReplicationStrategy<Partitioner>::find_replicas_network_topology(const TokenHostVec& tokens,
+                                                                                    typename TokenHostVec::const_iterator token_it,
+                                                                                    BuildState* state, ReplicaWalk* walk) const {
+  const size_t num_replicas = state->num_replicas;
+  DatacenterRackInfoMap& dc_racks = state->dc_racks;
+
+  CopyOnWriteHostVec replicas(new HostVec());
+  replicas->reserve(num_replicas);
+
+  // Clear datacenter and rack information for the next token
+  for (typename DatacenterRackInfoMap::iterator j = dc_racks.begin(),
+       end = dc_racks.end(); j != end; ++j) {
+    j->second.replica_count = 0;
+    j->second.racks_observed.clear();
+    j->second.skipped_endpoints.clear();
+  }
+
+  for (typename TokenHostVec::const_iterator j = tokens.begin(),
+       end = tokens.end(); j != end && replicas->size() < num_replicas; ++j) {
+    typename TokenHostVec::const_iterator  curr_token_it = token_it;
+    Host* host = curr_token_it->second;
+    uint32_t dc = host->dc_id();
+    uint32_t rack = host->rack_id();
+
+    walk->last_token = curr_token_it->first;
 
-      RackSet& racks_observed_this_dc = dc_rack_info.racks_observed;
-      const size_t rack_count_this_dc = dc_rack_info.rack_count;
+    ++token_it;
+    if (token_it == tokens.end()) {
+      token_it = tokens.begin();
+    }
+
+    typename DatacenterRackInfoMap::iterator dc_rack_it = dc_racks.find(dc);
+    if (dc_rack_it == dc_racks.end()) {
+      continue;
+    }
+
+    DatacenterRackInfo& dc_rack_info = dc_rack_it->second;
+
+    size_t& replica_count_this_dc = dc_rack_info.replica_count;
+    const size_t replication_factor = dc_rack_info.replication_factor;
 
-      // First, attempt to distribute replicas over all possible racks in a
-      // datacenter only then consider hosts in the same rack
+    if (replica_count_this_dc >= replication_factor) {
+      continue;
+    }
+
+    RackSet& racks_observed_this_dc = dc_rack_info.racks_observed;
+    const size_t rack_count_this_dc = dc_rack_info.rack_count;
 
-      if (rack == 0 || racks_observed_this_dc.size() == rack_count_this_dc) {
+    // First, attempt to distribute replicas over all possible racks in a
+    // datacenter only then consider hosts in the same rack
+
+    if (rack == 0 || racks_observed_this_dc.size() == rack_count_this_dc) {
+      ++replica_count_this_dc;
+      replicas->push_back(Host::Ptr(host));
+    } else {
+      TokenHostQueue& skipped_endpoints_this_dc = dc_rack_info.skipped_endpoints;
+      if (racks_observed_this_dc.count(rack) > 0) {
+        skipped_endpoints_this_dc.push_back(curr_token_it);
+      } else {
         ++replica_count_this_dc;
         replicas->push_back(Host::Ptr(host));
-      } else {
-        TokenHostQueue& skipped_endpoints_this_dc = dc_rack_info.skipped_endpoints;
-        if (racks_observed_this_dc.count(rack) > 0) {
-          skipped_endpoints_this_dc.push_back(curr_token_it);
-        } else {
-          ++replica_count_this_dc;
-          replicas->push_back(Host::Ptr(host));
-          racks_observed_this_dc.insert(rack);
-
-          // Once we visited every rack in the current datacenter then starting considering
-          // hosts we've already skipped.
-          if (racks_observed_this_dc.size() == rack_count_this_dc) {
-            while (!skipped_endpoints_this_dc.empty() && replica_count_this_dc < replication_factor) {
-              ++replica_count_this_dc;
-              replicas->push_back(Host::Ptr(skipped_endpoints_this_dc.front()->second));
-              skipped_endpoints_this_dc.pop_front();
-            }
+        racks_observed_this_dc.insert(rack);
+
+        // Once we visited every rack in the current datacenter then starting considering
+        // hosts we've already skipped.
+        if (racks_observed_this_dc.size() == rack_count_this_dc) {
+          while (!skipped_endpoints_this_dc.empty() && replica_count_this_dc < replication_factor) {
+            ++replica_count_this_dc;
+            replicas->push_back(Host::Ptr(skipped_endpoints_this_dc.front()->second));
+            skipped_endpoints_this_dc.pop_front();
           }
         }
       }
     }
+  }
+
+  walk->is_complete = replicas->size() >= num_replicas;
+  return replicas;
+}
+
+template <class Partitioner>
+CopyOnWriteHostVec ReplicationStrategy<Partitioner>::find_replicas_simple(const TokenHostVec& tokens,
+                                                                          typename TokenHostVec::const_iterator token_it,
+                                                                          BuildState* state, ReplicaWalk* walk) const {
+  CopyOnWriteHostVec replicas(new HostVec());
+  do {
+    walk->last_token = token_it->first;
+    replicas->push_back(Host::Ptr(token_it->second));
+    ++token_it;
+    if (token_it == tokens.end()) {
+      token_it = tokens.begin();
+    }
+  } while (replicas->size() < state->num_replicas);
+  // Walks that go all the way around the ring can't be reused
+  walk->is_complete = state->num_replicas < tokens.size();
+  return replicas;
+}
 
-    result.push_back(TokenReplicas(token, replicas));
+template <class Partitioner>
+bool ReplicationStrategy<Partitioner>::is_walk_changed(const Token& token, const ReplicaWalk& walk,
+                                                       typename TokenHostVec::const_iterator next_changed_it,
+                                                       const TokenHostVec& changed_tokens) {
+  // The walk covers [token, last_token] and it wraps around the end of the
+  // ring when the last token is before the starting token. "next_changed_it"
+  // is the first changed token that's not before the starting token. Only
+  // the walk is checked, not the replicas, so that the hosts don't need to be
+  // loaded.
+  typename TokenHostVec::const_iterator it = next_changed_it;
+  if (!(walk.last_token < token)) {
+    return it != changed_tokens.end() && !(walk.last_token < it->first);
   }
+  return it != changed_tokens.end() ||
+      (!changed_tokens.empty() && !(walk.last_token < changed_tokens.front().first));
 }
 
+// A copy of a strategy's replicas that's laid out for lookups. The tokens are
+// stored in Eytzinger (breadth-first) order, apart from their replicas, so
+// the first levels of the search share a few cache lines and a lookup only
+// loads the replicas that it returns. Tokens store an index into the replica
+// sets and consecutive tokens with the same replicas share a set.
 template <class Partitioner>
-void ReplicationStrategy<Partitioner>::build_replicas_simple(const TokenHostVec& tokens, const DatacenterMap& not_used,
-                                                             TokenReplicasVec& result) const {
-  ReplicationFactorMap::const_iterator it = replication_factors_.find(1);
-  if (it == replication_factors_.end()) {
-    return;
+class TokenRing {
+public:
+  typedef typename Partitioner::Token Token;
+  typedef typename ReplicationStrategy<Partitioner>::TokenReplicasVec TokenReplicasVec;
+
+  TokenRing()
+    : tokens_(1)
+    , replica_indices_(1, 0)
+    , replica_sets_(1, CopyOnWriteHostVec(NULL)) { }
+
+  void build(const TokenReplicasVec& replicas);
+
+  // Returns the replicas of the first token after the token, wrapping around
+  // the ring, or no replicas if the ring is empty
+  const CopyOnWriteHostVec& find(const Token& token) const {
+    // The root is at index 1 and the children of "k" are 2k and 2k + 1
+    size_t k = 1;
+    size_t n = tokens_.size();
+    while (k < n) {
+      k = 2 * k + !(token < tokens_[k]);
+    }
+    // Undo the right turns after the last left turn, that's the first token
+    // greater than the token. It's index 0 when there's no left turn which
+    // is the first token in the ring.
+    k >>= num_trailing_zeros(~static_cast<uint64_t>(k)) + 1;
+    return replica_sets_[replica_indices_[k]];
   }
-  size_t num_replicas = std::min<size_t>(it->second.count, tokens.size());
-  for (typename TokenHostVec::const_iterator i = tokens.begin(),
-       end = tokens.end(); i != end; ++i) {
-    CopyOnWriteHostVec replicas(new HostVec());
-    typename TokenHostVec::const_iterator token_it = i;
-    do {
-      replicas->push_back(Host::Ptr(token_it->second));
-      ++token_it;
-      if (token_it == tokens.end()) {
-        token_it = tokens.begin();
-      }
-    } while (replicas->size() < num_replicas);
-    result.push_back(TokenReplicas(i->first, replicas));
+
+private:
+  void build_tree(const TokenReplicasVec& replicas,
+                  const std::vector<uint32_t>& indices,
+                  size_t k, size_t* i);
+
+private:
+  std::vector<Token> tokens_;
+  std::vector<uint32_t> replica_indices_;
+  std::vector<CopyOnWriteHostVec> replica_sets_;
+};
+
+template <class Partitioner>
+void TokenRing<Partitioner>::build(const TokenReplicasVec& replicas) {
+  std::vector<uint32_t> indices;
+  indices.reserve(replicas.size());
+
+  replica_sets_.clear();
+  for (typename TokenReplicasVec::const_iterator i = replicas.begin(),
+       end = replicas.end(); i != end; ++i) {
+    const CopyOnWriteHostVec& hosts = i->second;
+    // Only const access, otherwise the shared replicas would be copied
+    const CopyOnWriteHostVec* last = replica_sets_.empty() ? NULL : &replica_sets_.back();
+    if (last == NULL || !hosts || !*last || *hosts != **last) {
+      replica_sets_.push_back(hosts);
+    }
+    indices.push_back(static_cast<uint32_t>(replica_sets_.size() - 1));
+  }
+  if (replica_sets_.empty()) {
+    replica_sets_.push_back(CopyOnWriteHostVec(NULL));
+    indices.push_back(0);
   }
+
+  tokens_.resize(replicas.size() + 1);
+  replica_indices_.resize(replicas.size() + 1);
+  replica_indices_[0] = indices.front();
+  size_t i = 0;
+  build_tree(replicas, indices, 1, &i);
 }
 
 template <class Partitioner>
-void ReplicationStrategy<Partitioner>::build_replicas_non_replicated(const TokenHostVec& tokens, const DatacenterMap& not_used,
-                                                                     TokenReplicasVec& result) const {
-  for (typename TokenHostVec::const_iterator i = tokens.begin(); i != tokens.end(); ++i) {
-    CopyOnWriteHostVec replicas(new HostVec(1, Host::Ptr(i->second)));
-    result.push_back(TokenReplicas(i->first, replicas));
+void TokenRing<Partitioner>::build_tree(const TokenReplicasVec& replicas,
+                                        const std::vector<uint32_t>& indices,
+                                        size_t k, size_t* i) {
+  // An in-order walk of the tree visits the tokens in sorted order
+  if (k < tokens_.size()) {
+    build_tree(replicas, indices, 2 * k, i);
+    tokens_[k] = replicas[*i].first;
+    replica_indices_[k] = indices[*i];
+    ++(*i);
+    build_tree(replicas, indices, 2 * k + 1, i);
   }
 }
 
+// The replicas of every token in the ring for a replication strategy.
+// Keyspaces with the same strategy share them. They're built at most once,
+// either when the token map is built or on their first lookup, and they're
+// immutable afterwards so copies of the token map share them too. Changes
+// to the ring always create new replicas.
+template <class Partitioner>
+class StrategyReplicas : public RefCounted<StrategyReplicas<Partitioner> > {
+public:
+  typedef SharedRefPtr<StrategyReplicas<Partitioner> > Ptr;
+
+  typedef typename ReplicationStrategy<Partitioner>::TokenHostVec TokenHostVec;
+  typedef typename ReplicationStrategy<Partitioner>::TokenReplicasVec TokenReplicasVec;
+  typedef typename ReplicationStrategy<Partitioner>::ReplicaWalkVec ReplicaWalkVec;
+
+  StrategyReplicas(const ReplicationStrategy<Partitioner>& strategy)
+    : strategy_(strategy)
+    , is_built_(false) {
+    uv_mutex_init(&mutex_);
+  }
+
+  ~StrategyReplicas() {
+    uv_mutex_destroy(&mutex_);
+  }
+
+  const ReplicationStrategy<Partitioner>& strategy() const { return strategy_; }
+
+  bool is_built() const { return is_built_.load(MEMORY_ORDER_ACQUIRE); }
+
+  // Only valid once the replicas have been built
+  const TokenReplicasVec& replicas() const { return replicas_; }
+  const TokenRing<Partitioner>& ring() const { return ring_; }
+
+  // This can be called on any thread
+  void build(const TokenHostVec& tokens, const DatacenterMap& datacenters) {
+    ScopedMutex l(&mutex_);
+    if (is_built_.load(MEMORY_ORDER_RELAXED)) return;
+    strategy_.build_replicas(tokens, datacenters, replicas_, &walks_);
+    ring_.build(replicas_);
+    is_built_.store(true, MEMORY_ORDER_RELEASE);
+  }
+
+  // Builds the replicas from the replicas of the same strategy before a
+  // single host changed (see ReplicationStrategy::update_replicas()). The
+  // old replicas must have been built.
+  void update(const TokenHostVec& tokens, const DatacenterMap& datacenters,
+              size_t old_num_tokens, const DatacenterMap& old_datacenters,
+              const TokenHostVec& changed_tokens, const Ptr& old) {
+    ScopedMutex l(&mutex_);
+    assert(old->is_built());
+    // The caller holds a reference to the old replicas
+    bool is_old_shared = old->ref_count() > 1;
+    strategy_.update_replicas(tokens, datacenters,
+                              old_num_tokens, old_datacenters,
+                              changed_tokens,
+                              old->replicas_, old->walks_,
+                              is_old_shared,
+                              replicas_, walks_);
+    ring_.build(replicas_);
+    is_built_.store(true, MEMORY_ORDER_RELEASE);
+  }
+
+private:
+  const ReplicationStrategy<Partitioner> strategy_;
+  Atomic<bool> is_built_;
+  uv_mutex_t mutex_;
+  TokenReplicasVec replicas_;
+  ReplicaWalkVec walks_;
+  TokenRing<Partitioner> ring_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(StrategyReplicas);
+};
+
 template <class Partitioner>
 class TokenMapImpl : public TokenMap {
 public:
@@ -538,27 +882,35 @@ public:
     const Host::Ptr& host;
   };
 
-  typedef std::pair<Token, CopyOnWriteHostVec> TokenReplicas;
-  typedef std::vector<TokenReplicas> TokenReplicasVec;
-
-  struct TokenReplicasCompare {
-    bool operator()(const TokenReplicas& lhs, const TokenReplicas& rhs) const {
-      return lhs.first < rhs.first;
-    }
-  };
+  typedef typename StrategyReplicas<Partitioner>::Ptr StrategyReplicasPtr;
+  typedef std::vector<StrategyReplicasPtr> StrategyReplicasVec;
 
-  typedef sparsehash::dense_hash_map<std::string, TokenReplicasVec> KeyspaceReplicaMap;
-  typedef sparsehash::dense_hash_map<std::string, ReplicationStrategy<Partitioner> > KeyspaceStrategyMap;
+  typedef sparsehash::dense_hash_map<std::string, StrategyReplicasPtr> KeyspaceReplicaMap;
 
   static const CopyOnWriteHostVec NO_REPLICAS;
 
-  TokenMapImpl() {
+  TokenMapImpl(const BuildSettings& settings = BuildSettings())
+    : settings_(settings)
+    , is_ring_built_(false) {
     replicas_.set_empty_key(std::string());
     replicas_.set_deleted_key(std::string(1, '\0'));
-    strategies_.set_empty_key(std::string());
-    strategies_.set_deleted_key(std::string(1, '\0'));
   }
 
+  // The reference count isn't copied. The replicas are immutable once
+  // they're built so they're shared with the copy.
+  TokenMapImpl(const TokenMapImpl& other)
+    : TokenMap()
+    , settings_(other.settings_)
+    , tokens_(other.tokens_)
+    , hosts_(other.hosts_)
+    , datacenters_(other.datacenters_)
+    , is_ring_built_(other.is_ring_built_)
+    , replicas_(other.replicas_)
+    , rack_ids_(other.rack_ids_)
+    , dc_ids_(other.dc_ids_) { }
+
+  virtual TokenMap* copy() const { return new TokenMapImpl<Partitioner>(*this); }
+
   virtual void add_host(const Host::Ptr& host, const Value* tokens);
   virtual void update_host_and_build(const Host::Ptr& host, const Value* tokens);
   virtual void remove_host_and_build(const Host::Ptr& host);
@@ -583,20 +935,49 @@ public:
     return false;
   }
 
+  // Test only
+  bool is_keyspace_built(const std::string& keyspace_name) const {
+    typename KeyspaceReplicaMap::const_iterator i = replicas_.find(keyspace_name);
+    return i != replicas_.end() && i->second->is_built();
+  }
+
 private:
+  struct BuildJob {
+    BuildJob(const StrategyReplicasVec& replicas,
+             const TokenHostVec& tokens,
+             const DatacenterMap& datacenters)
+      : replicas(replicas)
+      , tokens(tokens)
+      , datacenters(datacenters)
+      , next(0) { }
+    const StrategyReplicasVec& replicas;
+    const TokenHostVec& tokens;
+    const DatacenterMap& datacenters;
+    Atomic<size_t> next;
+  };
+
+  static void on_build_replicas(void* arg);
+
   void update_keyspace(const VersionNumber& cassandra_version,
                        ResultResponse* result,
                        bool should_build_replicas);
-  void remove_host_tokens(const Host::Ptr& host);
+  void remove_host_tokens(const Host::Ptr& host, TokenHostVec* removed_tokens = NULL);
   void update_host_ids(const Host::Ptr& host);
+  StrategyReplicasPtr find_or_create_replicas(const ReplicationStrategy<Partitioner>& strategy) const;
   void build_replicas();
+  void build_replicas_in_parallel(const StrategyReplicasVec& replicas);
+  void update_replicas(const TokenHostVec& changed_tokens,
+                       size_t old_num_tokens, const DatacenterMap& old_datacenters);
 
 private:
+  const BuildSettings settings_;
   TokenHostVec tokens_;
   HostSet hosts_;
   DatacenterMap datacenters_;
+  // False when hosts have been added or cleared without building the map.
+  // Replicas are never built from a partial ring.
+  bool is_ring_built_;
   KeyspaceReplicaMap replicas_;
-  KeyspaceStrategyMap strategies_;
   IdGenerator rack_ids_;
   IdGenerator dc_ids_;
 };
@@ -606,6 +987,7 @@ const CopyOnWriteHostVec TokenMapImpl<Partitioner>::NO_REPLICAS(NULL);
 
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::add_host(const Host::Ptr& host, const Value* tokens) {
+  is_ring_built_ = false;
   update_host_ids(host);
   hosts_.insert(host);
 
@@ -619,7 +1001,11 @@ void TokenMapImpl<Partitioner>::add_host(const Host::Ptr& host, const Value* tok
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::update_host_and_build(const Host::Ptr& host, const Value* tokens) {
   uint64_t start = uv_hrtime();
-  remove_host_tokens(host);
+  size_t old_num_tokens = tokens_.size();
+  uint32_t old_rack_id = host->rack_id();
+  uint32_t old_dc_id = host->dc_id();
+  TokenHostVec old_tokens;
+  remove_host_tokens(host, &old_tokens);
 
   update_host_ids(host);
   hosts_.insert(host);
@@ -639,7 +1025,23 @@ void TokenMapImpl<Partitioner>::update_host_and_build(const Host::Ptr& host, con
              merged.begin(), TokenHostCompare());
   tokens_ = merged;
 
-  build_replicas();
+  if (!is_ring_built_) {
+    std::sort(tokens_.begin(), tokens_.end());
+    build_replicas();
+  } else if (!old_tokens.empty() &&
+             (host->rack_id() != old_rack_id || host->dc_id() != old_dc_id)) {
+    // The host moved so the replicas that skipped it might be different. A
+    // host that had no tokens (e.g. a new host whose ids are still unset)
+    // wasn't part of any replica's walk so it's updated incrementally.
+    build_replicas();
+  } else {
+    TokenHostVec changed_tokens(old_tokens.size() + new_tokens.size());
+    std::merge(old_tokens.begin(), old_tokens.end(),
+               new_tokens.begin(), new_tokens.end(),
+               changed_tokens.begin(), TokenHostCompare());
+    DatacenterMap old_datacenters(datacenters_);
+    update_replicas(changed_tokens, old_num_tokens, old_datacenters);
+  }
   LOG_DEBUG("Updated token map with host %s (%u tokens). Rebuilt token map with %u hosts and %u tokens in %f ms",
             host->address_string().c_str(),
             (unsigned int)new_tokens.size(),
@@ -651,9 +1053,17 @@ void TokenMapImpl<Partitioner>::update_host_and_build(const Host::Ptr& host, con
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::remove_host_and_build(const Host::Ptr& host) {
   uint64_t start = uv_hrtime();
-  remove_host_tokens(host);
+  size_t old_num_tokens = tokens_.size();
+  DatacenterMap old_datacenters(datacenters_);
+  TokenHostVec old_tokens;
+  remove_host_tokens(host, &old_tokens);
   hosts_.erase(host);
-  build_replicas();
+  if (!is_ring_built_) {
+    std::sort(tokens_.begin(), tokens_.end());
+    build_replicas();
+  } else {
+    update_replicas(old_tokens, old_num_tokens, old_datacenters);
+  }
   LOG_DEBUG("Removed host %s from token map. Rebuilt token map with %u hosts and %u tokens in %f ms",
             host->address_string().c_str(),
             (unsigned int)hosts_.size(),
@@ -663,6 +1073,7 @@ void TokenMapImpl<Partitioner>::remove_host_and_build(const Host::Ptr& host) {
 
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::clear_tokens_and_hosts() {
+  is_ring_built_ = false;
   tokens_.clear();
   hosts_.clear();
 }
@@ -682,13 +1093,11 @@ void TokenMapImpl<Partitioner>::update_keyspaces_and_build(const VersionNumber&
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::drop_keyspace(const std::string& keyspace_name) {
   replicas_.erase(keyspace_name);
-  strategies_.erase(keyspace_name);
 }
 
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::clear_replicas_and_strategies() {
   replicas_.clear();
-  strategies_.clear();
 }
 
 template <class Partitioner>
@@ -708,21 +1117,28 @@ const CopyOnWriteHostVec& TokenMapImpl<Partitioner>::get_replicas(const std::str
   typename KeyspaceReplicaMap::const_iterator ks_it = replicas_.find(keyspace_name);
 
   if (ks_it != replicas_.end()) {
-    Token token = Partitioner::hash(routing_key);
-    const TokenReplicasVec& replicas = ks_it->second;
-    typename TokenReplicasVec::const_iterator replicas_it = std::upper_bound(replicas.begin(), replicas.end(),
-                                                                             TokenReplicas(token, NO_REPLICAS),
-                                                                             TokenReplicasCompare());
-    if (replicas_it != replicas.end()) {
-      return replicas_it->second;
-    } else if (!replicas.empty()) {
-      return replicas.front().second;
+    const StrategyReplicasPtr& strategy_replicas = ks_it->second;
+    if (!strategy_replicas->is_built()) {
+      if (!is_ring_built_) return NO_REPLICAS;
+      // Lazily built replicas are built by the first lookup
+      strategy_replicas->build(tokens_, datacenters_);
     }
+
+    return strategy_replicas->ring().find(Partitioner::hash(routing_key));
   }
 
   return NO_REPLICAS;
 }
 
+template <class Partitioner>
+void TokenMapImpl<Partitioner>::on_build_replicas(void* arg) {
+  BuildJob* job = static_cast<BuildJob*>(arg);
+  size_t index;
+  while ((index = job->next.fetch_add(1)) < job->replicas.size()) {
+    job->replicas[index]->build(job->tokens, job->datacenters);
+  }
+}
+
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::update_keyspace(const VersionNumber& cassandra_version,
                                                 ResultResponse* result,
@@ -742,17 +1158,15 @@ void TokenMapImpl<Partitioner>::update_keyspace(const VersionNumber& cassandra_v
 
     strategy.init(dc_ids_, cassandra_version, row);
 
-    typename KeyspaceStrategyMap::iterator i = strategies_.find(keyspace_name);
-    if (i == strategies_.end() || i->second != strategy) {
-      if (i == strategies_.end()) {
-        strategies_[keyspace_name] = strategy;
-      } else {
-        i->second = strategy;
-      }
-      if (should_build_replicas) {
+    typename KeyspaceReplicaMap::iterator i = replicas_.find(keyspace_name);
+    if (i == replicas_.end() || i->second->strategy() != strategy) {
+      StrategyReplicasPtr strategy_replicas(find_or_create_replicas(strategy));
+      replicas_[keyspace_name] = strategy_replicas;
+      if (should_build_replicas && is_ring_built_ &&
+          !settings_.is_lazy && !strategy_replicas->is_built()) {
         uint64_t start = uv_hrtime();
         build_datacenters(hosts_, datacenters_);
-        strategy.build_replicas(tokens_, datacenters_, replicas_[keyspace_name]);
+        strategy_replicas->build(tokens_, datacenters_);
         LOG_DEBUG("Updated token map with keyspace '%s'. Rebuilt token map with %u hosts and %u tokens in %f ms",
                   keyspace_name.c_str(),
                   (unsigned int)hosts_.size(),
@@ -764,10 +1178,17 @@ void TokenMapImpl<Partitioner>::update_keyspace(const VersionNumber& cassandra_v
 }
 
 template <class Partitioner>
-void TokenMapImpl<Partitioner>::remove_host_tokens(const Host::Ptr& host) {
-  typename TokenHostVec::iterator last = std::remove_copy_if(tokens_.begin(), tokens_.end(),
-                                                             tokens_.begin(),
-                                                             RemoveTokenHostIf(host));
+void TokenMapImpl<Partitioner>::remove_host_tokens(const Host::Ptr& host, TokenHostVec* removed_tokens) {
+  RemoveTokenHostIf is_host_token(host);
+  typename TokenHostVec::iterator last = tokens_.begin();
+  for (typename TokenHostVec::iterator i = tokens_.begin(),
+       end = tokens_.end(); i != end; ++i) {
+    if (is_host_token(*i)) {
+      if (removed_tokens != NULL) removed_tokens->push_back(*i);
+    } else {
+      *last++ = *i;
+    }
+  }
   tokens_.resize(last - tokens_.begin());
 }
 
@@ -776,15 +1197,99 @@ void TokenMapImpl<Partitioner>::update_host_ids(const Host::Ptr& host) {
   host->set_rack_and_dc_ids(rack_ids_.get(host->rack()), dc_ids_.get(host->dc()));
 }
 
+template <class Partitioner>
+typename TokenMapImpl<Partitioner>::StrategyReplicasPtr
+TokenMapImpl<Partitioner>::find_or_create_replicas(const ReplicationStrategy<Partitioner>& strategy) const {
+  for (typename KeyspaceReplicaMap::const_iterator i = replicas_.begin(),
+       end = replicas_.end(); i != end; ++i) {
+    if (!(i->second->strategy() != strategy)) {
+      return i->second;
+    }
+  }
+  return StrategyReplicasPtr(new StrategyReplicas<Partitioner>(strategy));
+}
+
 template <class Partitioner>
 void TokenMapImpl<Partitioner>::build_replicas() {
+  is_ring_built_ = true;
   build_datacenters(hosts_, datacenters_);
-  for (typename KeyspaceStrategyMap::const_iterator i = strategies_.begin(),
-       end = strategies_.end();
-       i != end; ++i) {
-    const std::string& keyspace_name = i->first;
-    const ReplicationStrategy<Partitioner>& strategy = i->second;
-    strategy.build_replicas(tokens_, datacenters_, replicas_[keyspace_name]);
+
+  // The ring might have changed so new replicas are created for each unique
+  // strategy. The current replicas might still be used by copies of the map.
+  StrategyReplicasVec replicas;
+  for (typename KeyspaceReplicaMap::iterator i = replicas_.begin(),
+       end = replicas_.end(); i != end; ++i) {
+    typename StrategyReplicasVec::const_iterator j = replicas.begin();
+    while (j != replicas.end() && (*j)->strategy() != i->second->strategy()) {
+      ++j;
+    }
+    if (j == replicas.end()) {
+      replicas.push_back(StrategyReplicasPtr(new StrategyReplicas<Partitioner>(i->second->strategy())));
+      j = replicas.end() - 1;
+    }
+    i->second = *j;
+  }
+
+  if (!settings_.is_lazy) {
+    build_replicas_in_parallel(replicas);
+  }
+}
+
+template <class Partitioner>
+void TokenMapImpl<Partitioner>::build_replicas_in_parallel(const StrategyReplicasVec& replicas) {
+  BuildJob job(replicas, tokens_, datacenters_);
+
+  // The calling thread is also used to build replicas
+  size_t num_threads = std::min<size_t>(settings_.num_threads, replicas.size());
+  std::vector<uv_thread_t> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    uv_thread_t thread;
+    if (uv_thread_create(&thread, on_build_replicas, &job) != 0) {
+      LOG_WARN("Unable to create a thread to build the token map");
+      break;
+    }
+    threads.push_back(thread);
+  }
+
+  on_build_replicas(&job);
+
+  for (std::vector<uv_thread_t>::iterator i = threads.begin(),
+       end = threads.end(); i != end; ++i) {
+    uv_thread_join(&(*i));
+  }
+}
+
+template <class Partitioner>
+void TokenMapImpl<Partitioner>::update_replicas(const TokenHostVec& changed_tokens,
+                                                size_t old_num_tokens, const DatacenterMap& old_datacenters) {
+  build_datacenters(hosts_, datacenters_);
+
+  // New replicas are created for each unique strategy. The current replicas
+  // might still be used by copies of the map, otherwise they're reused.
+  StrategyReplicasVec old_replicas;
+  StrategyReplicasVec new_replicas;
+  for (typename KeyspaceReplicaMap::iterator i = replicas_.begin(),
+       end = replicas_.end(); i != end; ++i) {
+    size_t index = 0;
+    while (index < old_replicas.size() && old_replicas[index].get() != i->second.get()) {
+      ++index;
+    }
+    if (index == old_replicas.size()) {
+      old_replicas.push_back(i->second);
+      new_replicas.push_back(StrategyReplicasPtr(new StrategyReplicas<Partitioner>(i->second->strategy())));
+    }
+    i->second = new_replicas[index];
+  }
+
+  for (size_t i = 0; i < old_replicas.size(); ++i) {
+    if (old_replicas[i]->is_built()) {
+      new_replicas[i]->update(tokens_, datacenters_,
+                              old_num_tokens, old_datacenters,
+                              changed_tokens, old_replicas[i]);
+    } else if (!settings_.is_lazy) {
+      new_replicas[i]->build(tokens_, datacenters_);
+    }
+    old_replicas[i].reset();
   }
 }
 
@@ -126,6 +126,27 @@ inline size_t num_leading_zeros(int64_t value) {
 #endif
 }
 
+inline size_t num_trailing_zeros(uint64_t value) {
+  if (value == 0)
+    return 64;
+
+#if defined(_MSC_VER)
+  unsigned long index;
+#  if defined(_M_AMD64)
+  _BitScanForward64(&index, value);
+#  else
+  // On 32-bit this needs to be split into two operations
+  if (_BitScanForward(&index, (unsigned long)value) == 0) {
+    _BitScanForward(&index, (unsigned long)(value >> 32));
+    index += 32;
+  }
+#  endif
+  return index;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
 inline size_t vint_size(int64_t value) {
   // | with 1 to ensure magnitude <= 63, so (63 - 1) / 7 <= 8
   size_t magnitude = num_leading_zeros(value | 1);
@@ -277,23 +277,32 @@ void UuidGen::set_clock_seq_and_node(uint64_t node) {
 }
 
 uint64_t UuidGen::monotonic_timestamp() {
+  // The timestamp has a resolution of 100 nanoseconds but the clock only has a
+  // resolution of a millisecond, so the timestamp doubles as a counter: up to
+  // 10,000 timestamps are generated for each millisecond by counting up from
+  // the current time. Every UUID comes from a single exchange on the last
+  // timestamp, so the UUIDs are increasing across all threads. A failed
+  // exchange retries with the latest timestamp without reading the clock
+  // again. The clock is only read again when a millisecond's timestamps have
+  // all been used.
+  uint64_t now = from_unix_timestamp(get_time_since_epoch_ms());
+  uint64_t last = last_timestamp_.load(MEMORY_ORDER_RELAXED);
   while (true) {
-    uint64_t now = from_unix_timestamp(get_time_since_epoch_ms());
-    uint64_t last = last_timestamp_.load();
+    uint64_t candidate;
     if (now > last) {
-      if (last_timestamp_.compare_exchange_strong(last, now)) {
-        return now;
-      }
+      candidate = now;
+    } else if (last + 1 < now + 10000) {
+      candidate = last + 1;
+    } else if (last >= now + 10000) {
+      // The clock went backwards
+      return last_timestamp_.fetch_add(1, MEMORY_ORDER_RELAXED) + 1;
     } else {
-      uint64_t last_ms = to_milliseconds(last);
-      if (to_milliseconds(now) < last_ms) {
-        return last_timestamp_.fetch_add(1);
-      }
-      uint64_t candidate = last + 1;
-      if (to_milliseconds(candidate) == last_ms &&
-          last_timestamp_.compare_exchange_strong(last, candidate)) {
-        return candidate;
-      }
+      // All the timestamps for this millisecond have been used
+      now = from_unix_timestamp(get_time_since_epoch_ms());
+      continue;
+    }
+    if (last_timestamp_.compare_exchange_weak(last, candidate, MEMORY_ORDER_RELAXED)) {
+      return candidate;
     }
   }
 }
@@ -43,7 +43,14 @@ private:
   uint64_t monotonic_timestamp();
 
   uint64_t clock_seq_and_node_;
+
+  // Time UUIDs only need a single exchange on this timestamp so it's kept
+  // on its own cache line, away from the state used for random UUIDs.
+  static const size_t cacheline_size = 64;
+  char pad1__[cacheline_size];
   Atomic<uint64_t> last_timestamp_;
+  char pad2__[cacheline_size];
+  void no_unused_private_warning__() { pad1__[0] = 0; pad2__[0] = 0; }
 
   uv_mutex_t mutex_;
   MT19937_64 ng_;
@@ -0,0 +1,71 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "buffer.hpp"
+#include "encode.hpp"
+#include "serialization.hpp"
+
+#include <string.h>
+
+BENCHMARK(encode_int64) {
+  char output[sizeof(int64_t)];
+  int64_t value = 0;
+  while (state.keep_running()) {
+    cass::encode_int64(output, value++);
+    benchmark::do_not_optimize(output);
+  }
+}
+
+BENCHMARK(buffer_encode_header) {
+  // The fields of a v3 frame header
+  while (state.keep_running()) {
+    cass::Buffer buf(9);
+    size_t pos = buf.encode_byte(0, 0x03);
+    pos = buf.encode_byte(pos, 0);
+    pos = buf.encode_int16(pos, 1);
+    pos = buf.encode_byte(pos, 0x07);
+    buf.encode_int32(pos, 1024);
+    benchmark::do_not_optimize(buf);
+  }
+}
+
+BENCHMARK(buffer_encode_string) {
+  const char* query = "SELECT * FROM keyspace1.table1 WHERE key = ?";
+  uint16_t size = static_cast<uint16_t>(strlen(query));
+  while (state.keep_running()) {
+    cass::Buffer buf(sizeof(uint16_t) + size);
+    buf.encode_string(0, query, size);
+    benchmark::do_not_optimize(buf);
+  }
+}
+
+BENCHMARK(encode_with_length_int32) {
+  cass_int32_t value = 0;
+  while (state.keep_running()) {
+    cass::Buffer buf(cass::encode_with_length(value++));
+    benchmark::do_not_optimize(buf);
+  }
+}
+
+BENCHMARK(encode_with_length_text) {
+  cass::CassString value("abcdefghijklmnopqrstuvwxyz", 26);
+  while (state.keep_running()) {
+    cass::Buffer buf(cass::encode_with_length(value));
+    benchmark::do_not_optimize(buf);
+  }
+}
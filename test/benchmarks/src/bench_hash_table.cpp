@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "hash_table.hpp"
+
+#include <stdio.h>
+#include <string>
+
+struct BenchmarkEntry : cass::HashTableEntry<BenchmarkEntry> {
+  BenchmarkEntry(const std::string& name)
+    : name(name) { }
+  std::string name;
+};
+
+typedef cass::CaseInsensitiveHashTable<BenchmarkEntry> BenchmarkHashTable;
+
+static const size_t NUM_COLUMNS = 16;
+
+static void populate(BenchmarkHashTable* table, std::string* names) {
+  for (size_t i = 0; i < NUM_COLUMNS; ++i) {
+    char name[32];
+    sprintf(name, "column_name_%u", static_cast<unsigned>(i));
+    table->add(BenchmarkEntry(name));
+    names[i] = name;
+  }
+}
+
+// Lookups done by cass_row_get_column_by_name() and friends
+BENCHMARK(case_insensitive_hash_table_get) {
+  BenchmarkHashTable table(NUM_COLUMNS);
+  std::string names[NUM_COLUMNS];
+  populate(&table, names);
+
+  cass::IndexVec indices;
+  size_t index = 0;
+  while (state.keep_running()) {
+    benchmark::do_not_optimize(table.get_indices(names[index], &indices));
+    index = (index + 1) % NUM_COLUMNS;
+  }
+}
+
+// Quoted names are matched case sensitively
+BENCHMARK(case_insensitive_hash_table_get_quoted) {
+  BenchmarkHashTable table(NUM_COLUMNS);
+  std::string names[NUM_COLUMNS];
+  populate(&table, names);
+  for (size_t i = 0; i < NUM_COLUMNS; ++i) {
+    names[i] = "\"" + names[i] + "\"";
+  }
+
+  cass::IndexVec indices;
+  size_t index = 0;
+  while (state.keep_running()) {
+    benchmark::do_not_optimize(table.get_indices(names[index], &indices));
+    index = (index + 1) % NUM_COLUMNS;
+  }
+}
+
+BENCHMARK(case_insensitive_hash_table_get_missing) {
+  BenchmarkHashTable table(NUM_COLUMNS);
+  std::string names[NUM_COLUMNS];
+  populate(&table, names);
+
+  cass::IndexVec indices;
+  while (state.keep_running()) {
+    benchmark::do_not_optimize(table.get_indices("does_not_exist", &indices));
+  }
+}
+
+BENCHMARK(case_insensitive_hash_table_build) {
+  std::string names[NUM_COLUMNS];
+  {
+    BenchmarkHashTable table(NUM_COLUMNS);
+    populate(&table, names);
+  }
+
+  while (state.keep_running()) {
+    BenchmarkHashTable table(NUM_COLUMNS);
+    for (size_t i = 0; i < NUM_COLUMNS; ++i) {
+      table.add(BenchmarkEntry(names[i]));
+    }
+    benchmark::do_not_optimize(table);
+  }
+}
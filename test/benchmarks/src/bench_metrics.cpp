@@ -0,0 +1,42 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "metrics.hpp"
+
+BENCHMARK(histogram_record_value) {
+  cass::Metrics::ThreadState thread_state(1);
+  cass::Metrics::Histogram histogram(&thread_state);
+  int64_t value = 1;
+  while (state.keep_running()) {
+    histogram.record_value(value);
+    value = (value * 7) % 1000000 + 1;
+  }
+}
+
+BENCHMARK(histogram_get_snapshot) {
+  cass::Metrics::ThreadState thread_state(4);
+  cass::Metrics::Histogram histogram(&thread_state);
+  for (int64_t i = 1; i <= 100000; ++i) {
+    histogram.record_value(i);
+  }
+  while (state.keep_running()) {
+    cass::Metrics::Histogram::Snapshot snapshot;
+    histogram.get_snapshot(&snapshot);
+    benchmark::do_not_optimize(snapshot);
+  }
+}
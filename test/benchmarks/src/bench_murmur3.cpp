@@ -0,0 +1,45 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "murmur3.hpp"
+
+#include <string>
+
+static void murmur3(benchmark::State& state, size_t size) {
+  std::string key(size, 'a');
+  while (state.keep_running()) {
+    int64_t hash = cass::MurmurHash3_x64_128(key.data(), static_cast<int>(key.size()), 0);
+    benchmark::do_not_optimize(hash);
+    ++key[0];
+  }
+}
+
+// A single int key (the most common partition key)
+BENCHMARK(murmur3_4_bytes) {
+  murmur3(state, 4);
+}
+
+// A timeuuid key
+BENCHMARK(murmur3_16_bytes) {
+  murmur3(state, 16);
+}
+
+// A composite key
+BENCHMARK(murmur3_128_bytes) {
+  murmur3(state, 128);
+}
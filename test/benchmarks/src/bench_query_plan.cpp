@@ -0,0 +1,112 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "dc_aware_policy.hpp"
+#include "latency_aware_policy.hpp"
+#include "query_request.hpp"
+#include "request_handler.hpp"
+#include "request_pool.hpp"
+#include "round_robin_policy.hpp"
+#include "token_aware_policy.hpp"
+
+#include "test_token_map_utils.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+static const size_t NUM_HOSTS = 12;
+
+// A 12 node cluster in 2 datacenters with a single token per node
+class Cluster {
+public:
+  Cluster()
+    : token_map_(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()))
+    , request_pool_(new cass::RequestPool(
+                      cass::RequestBlock::allocation_size(sizeof(cass::RequestHandler)) +
+                      cass::QueryPlan::BLOCK_SIZE, 1))
+    , request_(new cass::QueryRequest("SELECT * FROM table1 WHERE key = ?", 1)) {
+    MT19937_64 rng;
+    for (size_t i = 0; i < NUM_HOSTS; ++i) {
+      char address[32];
+      sprintf(address, "127.0.0.%u", static_cast<unsigned>(i + 1));
+      cass::Host::Ptr host(create_host(address, "rack1", i % 2 == 0 ? "dc1" : "dc2"));
+      host->set_up();
+      hosts_[host->address()] = host;
+      add_murmur3_host(host, rng, 1, token_map_.get());
+    }
+    ReplicationMap replication;
+    replication["dc1"] = "3";
+    replication["dc2"] = "3";
+    add_keyspace_network_topology("ks", replication, token_map_.get());
+    token_map_->build();
+
+    const char* key = "abc";
+    request_->set(0, cass::CassString(key, strlen(key)));
+    request_->add_key_index(0);
+  }
+
+  const cass::HostMap& hosts() const { return hosts_; }
+
+  // Builds a query plan for a request handler that's allocated from a
+  // request block, the same as it's done for requests executed by a session
+  void run(benchmark::State& state, cass::LoadBalancingPolicy* policy) {
+    policy->init(cass::Host::Ptr(), hosts_, NULL);
+    while (state.keep_running()) {
+      cass::RequestBlock* block = request_pool_->acquire();
+      cass::RequestHandler::Ptr request_handler(
+            new (block) cass::RequestHandler(request_, cass::ResponseFuture::Ptr(), NULL));
+      block->dec_ref();
+
+      cass::ScopedPtr<cass::QueryPlan> query_plan(
+            policy->new_query_plan("ks", request_handler.get(), token_map_.get()));
+      benchmark::do_not_optimize(query_plan->compute_next());
+    }
+  }
+
+private:
+  cass::HostMap hosts_;
+  cass::TokenMap::Ptr token_map_;
+  cass::RequestPool::Ptr request_pool_;
+  cass::SharedRefPtr<cass::QueryRequest> request_;
+};
+
+BENCHMARK(query_plan_round_robin) {
+  Cluster cluster;
+  cass::RoundRobinPolicy policy;
+  cluster.run(state, &policy);
+}
+
+BENCHMARK(query_plan_dc_aware) {
+  Cluster cluster;
+  cass::DCAwarePolicy policy("dc1", 0, false);
+  cluster.run(state, &policy);
+}
+
+BENCHMARK(query_plan_token_aware_dc_aware) {
+  Cluster cluster;
+  cass::TokenAwarePolicy policy(new cass::DCAwarePolicy("dc1", 0, false));
+  cluster.run(state, &policy);
+}
+
+BENCHMARK(query_plan_latency_aware_token_aware_dc_aware) {
+  Cluster cluster;
+  cass::LatencyAwarePolicy::Settings settings;
+  cass::LatencyAwarePolicy policy(new cass::TokenAwarePolicy(new cass::DCAwarePolicy("dc1", 0, false)),
+                                  settings);
+  cluster.run(state, &policy);
+}
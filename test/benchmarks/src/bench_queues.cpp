@@ -0,0 +1,87 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "mpmc_queue.hpp"
+#include "spsc_queue.hpp"
+
+#include <uv.h>
+
+static const size_t QUEUE_SIZE = 8192;
+
+template <class Queue>
+static void enqueue_dequeue(benchmark::State& state) {
+  Queue queue(QUEUE_SIZE);
+  intptr_t value = 0;
+  while (state.keep_running()) {
+    queue.enqueue(value++);
+    intptr_t output;
+    queue.dequeue(output);
+    benchmark::do_not_optimize(output);
+  }
+}
+
+template <class Queue>
+struct Producer {
+  Producer(Queue* queue, uint64_t count)
+    : queue(queue)
+    , count(count) { }
+
+  static void run(void* arg) {
+    Producer* producer = static_cast<Producer*>(arg);
+    for (uint64_t i = 0; i < producer->count; ++i) {
+      while (!producer->queue->enqueue(static_cast<intptr_t>(i))) { }
+    }
+  }
+
+  Queue* queue;
+  uint64_t count;
+};
+
+// Items are produced on another thread and consumed on this one. The
+// producer can fill the queue before the first item is measured, which is
+// negligible compared to the number of iterations.
+template <class Queue>
+static void producer_consumer(benchmark::State& state) {
+  Queue queue(QUEUE_SIZE);
+  Producer<Queue> producer(&queue, state.iterations());
+
+  uv_thread_t thread;
+  uv_thread_create(&thread, Producer<Queue>::run, &producer);
+  while (state.keep_running()) {
+    intptr_t output;
+    while (!queue.dequeue(output)) { }
+    benchmark::do_not_optimize(output);
+  }
+  uv_thread_join(&thread);
+}
+
+BENCHMARK(spsc_queue_enqueue_dequeue) {
+  enqueue_dequeue<cass::SPSCQueue<intptr_t> >(state);
+}
+
+BENCHMARK(spsc_queue_producer_consumer) {
+  producer_consumer<cass::SPSCQueue<intptr_t> >(state);
+}
+
+BENCHMARK(mpmc_queue_enqueue_dequeue) {
+  enqueue_dequeue<cass::MPMCQueue<intptr_t> >(state);
+}
+
+BENCHMARK(mpmc_queue_producer_consumer) {
+  producer_consumer<cass::MPMCQueue<intptr_t> >(state);
+}
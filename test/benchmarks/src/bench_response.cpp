@@ -0,0 +1,150 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "buffer_pool.hpp"
+#include "constants.hpp"
+#include "request_callback.hpp"
+#include "response.hpp"
+#include "result_response.hpp"
+#include "row.hpp"
+#include "serialization.hpp"
+
+#include <string>
+
+static const int32_t NUM_ROWS = 100;
+
+// A RESULT body with rows that have an int, a text and a bigint column
+class RowsBody {
+public:
+  RowsBody(int32_t row_count) {
+    append_int32(CASS_RESULT_KIND_ROWS);
+    append_int32(CASS_RESULT_FLAG_GLOBAL_TABLESPEC);
+    append_int32(3); // Column count
+    append_string("keyspace1");
+    append_string("table1");
+    append_string("key");
+    append_uint16(CASS_VALUE_TYPE_INT);
+    append_string("value");
+    append_uint16(CASS_VALUE_TYPE_VARCHAR);
+    append_string("updated");
+    append_uint16(CASS_VALUE_TYPE_BIGINT);
+
+    append_int32(row_count);
+    for (int32_t i = 0; i < row_count; ++i) {
+      append_int32(sizeof(int32_t));
+      append_int32(i);
+      std::string value(32, 'a' + (i % 26));
+      append_int32(value.size());
+      body_.append(value);
+      append_int32(sizeof(int64_t));
+      char temp[sizeof(int64_t)];
+      cass::encode_int64(temp, i);
+      body_.append(temp, sizeof(temp));
+    }
+  }
+
+  const std::string& body() const { return body_; }
+
+  // The body with a v3 frame header
+  std::string frame() const {
+    std::string frame;
+    frame.push_back(static_cast<char>(0x83)); // Version 3 response
+    frame.push_back(0); // Flags
+    char temp[sizeof(int32_t)];
+    cass::encode_int16(temp, 1); // Stream
+    frame.append(temp, sizeof(int16_t));
+    frame.push_back(CQL_OPCODE_RESULT);
+    cass::encode_int32(temp, body_.size());
+    frame.append(temp, sizeof(int32_t));
+    frame.append(body_);
+    return frame;
+  }
+
+private:
+  void append_uint16(uint16_t value) {
+    char temp[sizeof(uint16_t)];
+    cass::encode_uint16(temp, value);
+    body_.append(temp, sizeof(temp));
+  }
+
+  void append_int32(int32_t value) {
+    char temp[sizeof(int32_t)];
+    cass::encode_int32(temp, value);
+    body_.append(temp, sizeof(temp));
+  }
+
+  void append_string(const std::string& str) {
+    append_uint16(str.size());
+    body_.append(str);
+  }
+
+private:
+  std::string body_;
+};
+
+// Decodes a whole frame as it's done for a response read from a connection
+BENCHMARK(response_message_decode_100_rows) {
+  std::string frame(RowsBody(NUM_ROWS).frame());
+  while (state.keep_running()) {
+    cass::ResponseMessage response;
+    ssize_t consumed = response.decode(&frame[0], frame.size());
+    if (response.is_row_stream_pending()) {
+      // Not streamed to a callback so the body is buffered
+      response.start_row_stream(cass::RequestCallback::Ptr());
+      consumed += response.decode(&frame[consumed], frame.size() - consumed);
+    }
+    benchmark::do_not_optimize(consumed);
+  }
+}
+
+// The same as above, but the body is allocated from a buffer pool as it is
+// on an IO worker
+BENCHMARK(response_message_decode_100_rows_pooled) {
+  std::string frame(RowsBody(NUM_ROWS).frame());
+  cass::BufferPool::Ptr buffer_pool(new cass::BufferPool());
+  while (state.keep_running()) {
+    cass::ResponseMessage response(NULL, buffer_pool.get());
+    ssize_t consumed = response.decode(&frame[0], frame.size());
+    if (response.is_row_stream_pending()) {
+      response.start_row_stream(cass::RequestCallback::Ptr());
+      consumed += response.decode(&frame[consumed], frame.size() - consumed);
+    }
+    benchmark::do_not_optimize(consumed);
+  }
+}
+
+BENCHMARK(decode_row) {
+  std::string body(RowsBody(NUM_ROWS).body());
+  cass::ResultResponse result;
+  result.decode(3, &body[0], body.size());
+
+  cass::Row row(&result);
+  row.values.reserve(result.column_count());
+
+  // The first row is decoded with the result
+  char* position = result.rows();
+  int32_t index = 1;
+  while (state.keep_running()) {
+    position = cass::decode_row(position, &result, row.values);
+    if (++index == result.row_count()) {
+      position = result.rows();
+      index = 1;
+    }
+  }
+  benchmark::do_not_optimize(row);
+}
@@ -0,0 +1,51 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "stream_manager.hpp"
+
+#include <vector>
+
+// Acquires and releases streams with a steady number of requests in flight
+static void acquire_release(benchmark::State& state, size_t in_flight) {
+  cass::StreamManager<void*> streams(3);
+  std::vector<int> pending(in_flight);
+  for (size_t i = 0; i < in_flight; ++i) {
+    pending[i] = streams.acquire(&pending);
+  }
+
+  size_t index = 0;
+  while (state.keep_running()) {
+    void* item;
+    streams.get_pending_and_release(pending[index], item);
+    pending[index] = streams.acquire(item);
+    benchmark::do_not_optimize(pending[index]);
+    index = (index + 1) % in_flight;
+  }
+}
+
+BENCHMARK(stream_manager_acquire_release_1) {
+  acquire_release(state, 1);
+}
+
+BENCHMARK(stream_manager_acquire_release_128) {
+  acquire_release(state, 128);
+}
+
+BENCHMARK(stream_manager_acquire_release_4096) {
+  acquire_release(state, 4096);
+}
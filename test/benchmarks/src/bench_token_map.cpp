@@ -0,0 +1,335 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "test_token_map_utils.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const size_t NUM_HOSTS = 30;
+static const size_t NUM_VNODES = 256;
+static const size_t NUM_KEYS = 1024;
+
+// A 30 node cluster in 2 datacenters using vnodes
+static cass::TokenMap* create_token_map() {
+  cass::TokenMap* token_map = cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name());
+
+  MT19937_64 rng;
+  for (size_t i = 0; i < NUM_HOSTS; ++i) {
+    char address[32];
+    sprintf(address, "127.0.%u.%u",
+            static_cast<unsigned>(i / 255), static_cast<unsigned>(i % 255 + 1));
+    char rack[32];
+    sprintf(rack, "rack%u", static_cast<unsigned>(i % 3));
+    add_murmur3_host(create_host(address, rack, i % 2 == 0 ? "dc1" : "dc2"),
+                     rng, NUM_VNODES, token_map);
+  }
+
+  add_keyspace_simple("simple", 3, token_map);
+
+  ReplicationMap replication;
+  replication["dc1"] = "3";
+  replication["dc2"] = "3";
+  add_keyspace_network_topology("network_topology", replication, token_map);
+
+  token_map->build();
+  return token_map;
+}
+
+static std::vector<std::string> create_keys() {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < NUM_KEYS; ++i) {
+    char key[32];
+    sprintf(key, "key%u", static_cast<unsigned>(i));
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+// Hashes the routing key and finds the token's replicas
+static void get_replicas(benchmark::State& state, const std::string& keyspace) {
+  cass::TokenMap::Ptr token_map(create_token_map());
+  std::vector<std::string> keys(create_keys());
+
+  size_t index = 0;
+  while (state.keep_running()) {
+    const cass::CopyOnWriteHostVec& replicas = token_map->get_replicas(keyspace, keys[index]);
+    benchmark::do_not_optimize(replicas);
+    index = (index + 1) % NUM_KEYS;
+  }
+}
+
+BENCHMARK(token_map_get_replicas_simple) {
+  get_replicas(state, "simple");
+}
+
+BENCHMARK(token_map_get_replicas_network_topology) {
+  get_replicas(state, "network_topology");
+}
+
+BENCHMARK(token_map_build) {
+  while (state.keep_running()) {
+    cass::TokenMap::Ptr token_map(create_token_map());
+    benchmark::do_not_optimize(token_map);
+  }
+}
+
+static const size_t LARGE_NUM_HOSTS = 500;
+
+// A 500 node cluster in 2 datacenters using vnodes. It's only built once
+// because a full build of its 128k tokens takes a while.
+class LargeCluster {
+public:
+  static LargeCluster& instance() {
+    static LargeCluster cluster;
+    return cluster;
+  }
+
+  cass::TokenMap* token_map() { return token_map_.get(); }
+
+  const cass::Host::Ptr& host(size_t index) const { return hosts_[index]; }
+  cass::Value* tokens(size_t index) { return tokens_[index].finish(); }
+
+private:
+  LargeCluster()
+    : token_map_(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()))
+    , tokens_(LARGE_NUM_HOSTS) {
+    MT19937_64 rng;
+    for (size_t i = 0; i < LARGE_NUM_HOSTS; ++i) {
+      char address[32];
+      sprintf(address, "127.0.%u.%u",
+              static_cast<unsigned>(i / 255), static_cast<unsigned>(i % 255 + 1));
+      char rack[32];
+      sprintf(rack, "rack%u", static_cast<unsigned>(i % 3));
+      hosts_.push_back(create_host(address, rack, i % 2 == 0 ? "dc1" : "dc2"));
+      for (size_t j = 0; j < NUM_VNODES; ++j) {
+        tokens_[i].append_token(static_cast<int64_t>(rng()));
+      }
+      token_map_->add_host(hosts_[i], tokens_[i].finish());
+    }
+
+    add_keyspace_simple("simple", 3, token_map_.get());
+
+    ReplicationMap replication;
+    replication["dc1"] = "3";
+    replication["dc2"] = "3";
+    add_keyspace_network_topology("network_topology", replication, token_map_.get());
+
+    token_map_->build();
+  }
+
+private:
+  cass::TokenMap::Ptr token_map_;
+  cass::HostVec hosts_;
+  std::vector<TokenCollectionBuilder> tokens_;
+};
+
+// Replica lookups on a 128k token ring. The keys are spread over the whole
+// ring so most lookups miss the CPU caches.
+static void get_replicas_128k_tokens(benchmark::State& state, const std::string& keyspace) {
+  LargeCluster& cluster = LargeCluster::instance();
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 64 * NUM_KEYS; ++i) {
+    char key[32];
+    sprintf(key, "key%u", static_cast<unsigned>(i));
+    keys.push_back(key);
+  }
+
+  size_t index = 0;
+  while (state.keep_running()) {
+    const cass::CopyOnWriteHostVec& replicas = cluster.token_map()->get_replicas(keyspace, keys[index]);
+    benchmark::do_not_optimize(replicas);
+    index = (index + 1) % keys.size();
+  }
+}
+
+BENCHMARK(token_map_get_replicas_simple_128k_tokens) {
+  get_replicas_128k_tokens(state, "simple");
+}
+
+BENCHMARK(token_map_get_replicas_network_topology_128k_tokens) {
+  get_replicas_128k_tokens(state, "network_topology");
+}
+
+// The cost of a single host changing before incremental updates
+BENCHMARK(token_map_full_rebuild_500_nodes) {
+  LargeCluster& cluster = LargeCluster::instance();
+  while (state.keep_running()) {
+    cluster.token_map()->build();
+  }
+}
+
+// A host refreshing its tokens, e.g. after a topology change event
+BENCHMARK(token_map_update_host_500_nodes) {
+  LargeCluster& cluster = LargeCluster::instance();
+  size_t index = 0;
+  while (state.keep_running()) {
+    cluster.token_map()->update_host_and_build(cluster.host(index), cluster.tokens(index));
+    index = (index + 1) % LARGE_NUM_HOSTS;
+  }
+}
+
+// A host leaving and then joining the ring again
+BENCHMARK(token_map_remove_and_add_host_500_nodes) {
+  LargeCluster& cluster = LargeCluster::instance();
+  size_t index = 0;
+  while (state.keep_running()) {
+    cluster.token_map()->remove_host_and_build(cluster.host(index));
+    cluster.token_map()->update_host_and_build(cluster.host(index), cluster.tokens(index));
+    index = (index + 1) % LARGE_NUM_HOSTS;
+  }
+}
+
+static const size_t NUM_KEYSPACES = 100;
+
+// The same 30 node cluster with many keyspaces that only use a few different
+// replication strategies. This is common for multi-tenant applications.
+static void build_many_keyspaces(benchmark::State& state,
+                                 const cass::TokenMap::BuildSettings& settings) {
+  while (state.keep_running()) {
+    cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name(),
+                                                                   settings));
+    MT19937_64 rng;
+    for (size_t i = 0; i < NUM_HOSTS; ++i) {
+      char address[32];
+      sprintf(address, "127.0.%u.%u",
+              static_cast<unsigned>(i / 255), static_cast<unsigned>(i % 255 + 1));
+      char rack[32];
+      sprintf(rack, "rack%u", static_cast<unsigned>(i % 3));
+      add_murmur3_host(create_host(address, rack, i % 2 == 0 ? "dc1" : "dc2"),
+                       rng, NUM_VNODES, token_map.get());
+    }
+
+    for (size_t i = 0; i < NUM_KEYSPACES; ++i) {
+      char keyspace[32];
+      sprintf(keyspace, "keyspace%u", static_cast<unsigned>(i));
+      ReplicationMap replication;
+      replication["dc1"] = i % 2 == 0 ? "3" : "2";
+      replication["dc2"] = i % 4 < 2 ? "3" : "1";
+      add_keyspace_network_topology(keyspace, replication, token_map.get());
+    }
+
+    token_map->build();
+    benchmark::do_not_optimize(token_map);
+  }
+}
+
+BENCHMARK(token_map_build_many_keyspaces_single_thread) {
+  cass::TokenMap::BuildSettings settings;
+  settings.num_threads = 1;
+  build_many_keyspaces(state, settings);
+}
+
+BENCHMARK(token_map_build_many_keyspaces) {
+  build_many_keyspaces(state, cass::TokenMap::BuildSettings());
+}
+
+BENCHMARK(token_map_build_many_keyspaces_lazy) {
+  cass::TokenMap::BuildSettings settings;
+  settings.is_lazy = true;
+  build_many_keyspaces(state, settings);
+}
+
+static const size_t RING_NUM_TOKENS = 128 * 1024;
+
+// A ring of 128k tokens with three replicas for each token. This is used to
+// compare the lookup structure used by the token map with a binary search
+// of the replicas. It's only built once.
+class Ring {
+public:
+  typedef cass::ReplicationStrategy<cass::Murmur3Partitioner>::TokenReplicas TokenReplicas;
+  typedef cass::ReplicationStrategy<cass::Murmur3Partitioner>::TokenReplicasVec TokenReplicasVec;
+
+  struct TokenReplicasCompare {
+    bool operator()(const TokenReplicas& lhs, const TokenReplicas& rhs) const {
+      return lhs.first < rhs.first;
+    }
+  };
+
+  static Ring& instance() {
+    static Ring ring;
+    return ring;
+  }
+
+  const TokenReplicasVec& replicas() const { return replicas_; }
+  const cass::TokenRing<cass::Murmur3Partitioner>& ring() const { return ring_; }
+  const std::vector<int64_t>& keys() const { return keys_; }
+
+private:
+  Ring() {
+    MT19937_64 rng;
+    cass::HostVec hosts;
+    for (size_t i = 0; i < LARGE_NUM_HOSTS; ++i) {
+      char address[32];
+      sprintf(address, "127.0.%u.%u",
+              static_cast<unsigned>(i / 255), static_cast<unsigned>(i % 255 + 1));
+      hosts.push_back(create_host(address));
+    }
+
+    std::vector<int64_t> tokens;
+    for (size_t i = 0; i < RING_NUM_TOKENS; ++i) {
+      tokens.push_back(static_cast<int64_t>(rng()));
+    }
+    std::sort(tokens.begin(), tokens.end());
+
+    for (size_t i = 0; i < RING_NUM_TOKENS; ++i) {
+      cass::CopyOnWriteHostVec replicas(new cass::HostVec());
+      for (size_t j = 0; j < 3; ++j) {
+        replicas->push_back(hosts[(i + j) % LARGE_NUM_HOSTS]);
+      }
+      replicas_.push_back(TokenReplicas(tokens[i], replicas));
+    }
+    ring_.build(replicas_);
+
+    for (size_t i = 0; i < 64 * NUM_KEYS; ++i) {
+      keys_.push_back(static_cast<int64_t>(rng()));
+    }
+  }
+
+private:
+  TokenReplicasVec replicas_;
+  cass::TokenRing<cass::Murmur3Partitioner> ring_;
+  std::vector<int64_t> keys_;
+};
+
+BENCHMARK(token_ring_find_128k_tokens) {
+  const Ring& ring = Ring::instance();
+  size_t index = 0;
+  while (state.keep_running()) {
+    benchmark::do_not_optimize(ring.ring().find(ring.keys()[index]));
+    index = (index + 1) % ring.keys().size();
+  }
+}
+
+// The binary search that was used before the lookup structure
+BENCHMARK(token_ring_upper_bound_128k_tokens) {
+  const Ring& ring = Ring::instance();
+  const Ring::TokenReplicasVec& replicas = ring.replicas();
+  const cass::CopyOnWriteHostVec no_replicas(NULL);
+  size_t index = 0;
+  while (state.keep_running()) {
+    Ring::TokenReplicasVec::const_iterator it
+        = std::upper_bound(replicas.begin(), replicas.end(),
+                           Ring::TokenReplicas(ring.keys()[index], no_replicas),
+                           Ring::TokenReplicasCompare());
+    benchmark::do_not_optimize(it != replicas.end() ? it->second : replicas.front().second);
+    index = (index + 1) % ring.keys().size();
+  }
+}
@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "atomic.hpp"
+#include "get_time.hpp"
+#include "uuids.hpp"
+
+#include <uv.h>
+
+static const int NUM_BACKGROUND_THREADS = 3;
+
+static uint64_t from_unix_timestamp(uint64_t timestamp) {
+  return (timestamp * 10000L) + 0x01B21DD213814000LL;
+}
+
+// The same timestamps as UuidGen::generate_time() but serialized on a mutex
+class MutexUuidGen {
+public:
+  MutexUuidGen()
+    : last_timestamp_(0) {
+    uv_mutex_init(&mutex_);
+  }
+
+  ~MutexUuidGen() {
+    uv_mutex_destroy(&mutex_);
+  }
+
+  void generate_time(CassUuid* output) {
+    uv_mutex_lock(&mutex_);
+    uint64_t now = from_unix_timestamp(cass::get_time_since_epoch_ms());
+    while (now <= last_timestamp_ && last_timestamp_ + 1 >= now + 10000) {
+      if (last_timestamp_ >= now + 10000) break; // The clock went backwards
+      now = from_unix_timestamp(cass::get_time_since_epoch_ms());
+    }
+    last_timestamp_ = now > last_timestamp_ ? now : last_timestamp_ + 1;
+    output->time_and_version = last_timestamp_;
+    uv_mutex_unlock(&mutex_);
+    output->clock_seq_and_node = 0;
+  }
+
+private:
+  uv_mutex_t mutex_;
+  uint64_t last_timestamp_;
+};
+
+// Generates UUIDs on other threads until it's stopped so that the measured
+// thread is contending with them
+template <class Gen>
+class Contention {
+public:
+  Contention(Gen* gen)
+    : gen_(gen)
+    , is_running_(true) {
+    for (int i = 0; i < NUM_BACKGROUND_THREADS; ++i) {
+      uv_thread_create(&threads_[i], run, this);
+    }
+  }
+
+  ~Contention() {
+    is_running_.store(false);
+    for (int i = 0; i < NUM_BACKGROUND_THREADS; ++i) {
+      uv_thread_join(&threads_[i]);
+    }
+  }
+
+private:
+  static void run(void* arg) {
+    Contention* contention = static_cast<Contention*>(arg);
+    CassUuid uuid;
+    while (contention->is_running_.load(cass::MEMORY_ORDER_RELAXED)) {
+      contention->gen_->generate_time(&uuid);
+      benchmark::do_not_optimize(uuid);
+    }
+  }
+
+  Gen* gen_;
+  cass::Atomic<bool> is_running_;
+  uv_thread_t threads_[NUM_BACKGROUND_THREADS];
+};
+
+template <class Gen>
+static void generate_time(benchmark::State& state, Gen* gen) {
+  CassUuid uuid;
+  while (state.keep_running()) {
+    gen->generate_time(&uuid);
+    benchmark::do_not_optimize(uuid);
+  }
+}
+
+BENCHMARK(uuid_gen_time) {
+  cass::UuidGen gen(0);
+  generate_time(state, &gen);
+}
+
+BENCHMARK(uuid_gen_time_mutex) {
+  MutexUuidGen gen;
+  generate_time(state, &gen);
+}
+
+BENCHMARK(uuid_gen_time_4_threads) {
+  cass::UuidGen gen(0);
+  Contention<cass::UuidGen> contention(&gen);
+  generate_time(state, &gen);
+}
+
+BENCHMARK(uuid_gen_time_mutex_4_threads) {
+  MutexUuidGen gen;
+  Contention<MutexUuidGen> contention(&gen);
+  generate_time(state, &gen);
+}
@@ -0,0 +1,103 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_BENCHMARK_HPP_INCLUDED__
+#define __CASS_BENCHMARK_HPP_INCLUDED__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+namespace benchmark {
+
+// The number of calls to operator new and the bytes requested since the
+// program started. These are counted for every thread.
+uint64_t allocation_count();
+uint64_t allocation_bytes();
+
+// Passed to each benchmark. Only the iterations of the keep_running() loop
+// are measured so setup before the loop and cleanup after it are excluded:
+//
+//   BENCHMARK(example) {
+//     Setup setup;
+//     while (state.keep_running()) {
+//       benchmark::do_not_optimize(operation());
+//     }
+//   }
+class State {
+public:
+  State(uint64_t iterations);
+
+  uint64_t iterations() const { return iterations_; }
+
+  bool keep_running() {
+    if (remaining_ == iterations_) start();
+    if (remaining_ == 0) {
+      stop();
+      return false;
+    }
+    --remaining_;
+    return true;
+  }
+
+  uint64_t elapsed_ns() const { return elapsed_ns_; }
+  uint64_t allocations() const { return allocations_; }
+  uint64_t allocated_bytes() const { return allocated_bytes_; }
+
+private:
+  void start();
+  void stop();
+
+private:
+  const uint64_t iterations_;
+  uint64_t remaining_;
+  uint64_t start_ns_;
+  uint64_t start_allocations_;
+  uint64_t start_allocated_bytes_;
+  uint64_t elapsed_ns_;
+  uint64_t allocations_;
+  uint64_t allocated_bytes_;
+};
+
+typedef void (*Function)(State& state);
+
+struct Registrar {
+  Registrar(const char* name, Function function);
+};
+
+// Prevents the compiler from optimizing away a value that's otherwise unused
+template <class T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+  __asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+  const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+  (void)*sink;
+  _ReadWriteBarrier();
+#endif
+}
+
+} // namespace benchmark
+
+#define BENCHMARK(name) \
+  static void name(benchmark::State& state); \
+  static benchmark::Registrar name##_registrar(#name, name); \
+  static void name(benchmark::State& state)
+
+#endif
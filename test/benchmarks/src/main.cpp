@@ -0,0 +1,209 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "benchmark.hpp"
+
+#include "atomic.hpp"
+
+#include <uv.h>
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Every allocation made with new (by the driver or by a benchmark) is
+// counted so that each benchmark can report its allocations per operation.
+
+#if __cplusplus >= 201103L
+#  define THROW_BAD_ALLOC
+#  define NO_THROW noexcept
+#else
+#  define THROW_BAD_ALLOC throw(std::bad_alloc)
+#  define NO_THROW throw()
+#endif
+
+static cass::Atomic<uint64_t> allocation_count_(0);
+static cass::Atomic<uint64_t> allocation_bytes_(0);
+
+static void* counted_allocate(size_t size) {
+  allocation_count_.fetch_add(1, cass::MEMORY_ORDER_RELAXED);
+  allocation_bytes_.fetch_add(size, cass::MEMORY_ORDER_RELAXED);
+  void* ptr = malloc(size > 0 ? size : 1);
+  if (ptr == NULL) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(size_t size) THROW_BAD_ALLOC {
+  return counted_allocate(size);
+}
+
+void* operator new[](size_t size) THROW_BAD_ALLOC {
+  return counted_allocate(size);
+}
+
+void operator delete(void* ptr) NO_THROW {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) NO_THROW {
+  free(ptr);
+}
+
+namespace benchmark {
+
+uint64_t allocation_count() {
+  return allocation_count_.load(cass::MEMORY_ORDER_RELAXED);
+}
+
+uint64_t allocation_bytes() {
+  return allocation_bytes_.load(cass::MEMORY_ORDER_RELAXED);
+}
+
+State::State(uint64_t iterations)
+  : iterations_(iterations)
+  , remaining_(iterations)
+  , start_ns_(0)
+  , start_allocations_(0)
+  , start_allocated_bytes_(0)
+  , elapsed_ns_(0)
+  , allocations_(0)
+  , allocated_bytes_(0) { }
+
+void State::start() {
+  start_allocations_ = allocation_count();
+  start_allocated_bytes_ = allocation_bytes();
+  start_ns_ = uv_hrtime();
+}
+
+void State::stop() {
+  elapsed_ns_ = uv_hrtime() - start_ns_;
+  allocations_ = allocation_count() - start_allocations_;
+  allocated_bytes_ = allocation_bytes() - start_allocated_bytes_;
+}
+
+struct Entry {
+  Entry(const char* name, Function function)
+    : name(name)
+    , function(function) { }
+  const char* name;
+  Function function;
+};
+
+typedef std::vector<Entry> EntryVec;
+
+// Constructed on first use because benchmarks register themselves during
+// static initialization.
+static EntryVec& entries() {
+  static EntryVec entries;
+  return entries;
+}
+
+Registrar::Registrar(const char* name, Function function) {
+  entries().push_back(Entry(name, function));
+}
+
+} // namespace benchmark
+
+static const uint64_t MAX_ITERATIONS = 1000000000ULL;
+
+// Increases the number of iterations until a run takes at least the
+// minimum time and reports the last run.
+static void run(const benchmark::Entry& entry, uint64_t min_time_ns) {
+  uint64_t iterations = 1;
+  for (;;) {
+    benchmark::State state(iterations);
+    entry.function(state);
+
+    if (state.elapsed_ns() >= min_time_ns || iterations >= MAX_ITERATIONS) {
+      double ops = static_cast<double>(state.iterations());
+      printf("%-40s %12llu %12.1f %12.2f %12.1f\n",
+             entry.name,
+             static_cast<unsigned long long>(state.iterations()),
+             static_cast<double>(state.elapsed_ns()) / ops,
+             static_cast<double>(state.allocations()) / ops,
+             static_cast<double>(state.allocated_bytes()) / ops);
+      fflush(stdout);
+      return;
+    }
+
+    // Aim 50% past the minimum time using the rate from this run, but don't
+    // grow by more than 100x at a time because short runs are noisy.
+    uint64_t next = iterations * 100;
+    if (state.elapsed_ns() > 0) {
+      double estimate = 1.5 * static_cast<double>(min_time_ns) *
+                        static_cast<double>(iterations) /
+                        static_cast<double>(state.elapsed_ns());
+      if (estimate < static_cast<double>(next)) {
+        next = static_cast<uint64_t>(estimate);
+      }
+    }
+    iterations = next > iterations ? next : iterations + 1;
+    if (iterations > MAX_ITERATIONS) iterations = MAX_ITERATIONS;
+  }
+}
+
+static void print_usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [--min-time=<seconds>] [--list] [filter...]\n"
+          "  Runs the benchmarks whose names contain any of the filters\n"
+          "  (all of them if there are no filters).\n", program);
+}
+
+int main(int argc, char** argv) {
+  double min_time = 0.5;
+  bool list = false;
+  std::vector<std::string> filters;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_time = atof(argv[i] + 11);
+    } else if (strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else if (argv[i][0] == '-') {
+      print_usage(argv[0]);
+      return 1;
+    } else {
+      filters.push_back(argv[i]);
+    }
+  }
+
+  if (!list) {
+    printf("%-40s %12s %12s %12s %12s\n",
+           "Benchmark", "Iterations", "ns/op", "allocs/op", "bytes/op");
+  }
+
+  const benchmark::EntryVec& entries = benchmark::entries();
+  for (benchmark::EntryVec::const_iterator i = entries.begin(),
+       end = entries.end(); i != end; ++i) {
+    bool matches = filters.empty();
+    for (std::vector<std::string>::const_iterator filter = filters.begin();
+         !matches && filter != filters.end(); ++filter) {
+      matches = strstr(i->name, filter->c_str()) != NULL;
+    }
+    if (!matches) continue;
+
+    if (list) {
+      printf("%s\n", i->name);
+    } else {
+      run(*i, static_cast<uint64_t>(min_time * 1000000000.0));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,315 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// Drives a session against a local mock cluster and reports the throughput
+// and latency percentiles of the whole driver pipeline.
+
+#include "cassandra.h"
+#include "mock_cluster.hpp"
+
+#include "third_party/hdr_histogram/hdr_histogram.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uv.h>
+
+struct Options {
+  Options()
+    : num_nodes(3)
+    , num_requests(200000)
+    , concurrency(1000)
+    , num_io_threads(1)
+    , use_prepared(false)
+    , use_token_aware(true) { }
+
+  unsigned num_nodes;
+  unsigned num_requests;
+  unsigned concurrency;
+  unsigned num_io_threads;
+  bool use_prepared;
+  bool use_token_aware;
+  mock::Cluster::Settings settings;
+};
+
+class Benchmark {
+public:
+  Benchmark(CassSession* session, const CassPrepared* prepared,
+            const Options& options)
+    : session_(session)
+    , prepared_(prepared)
+    , options_(options)
+    , num_started_(0)
+    , num_completed_(0)
+    , num_errors_(0) {
+    uv_mutex_init(&mutex_);
+    uv_cond_init(&cond_);
+    hdr_init(1LL, 3600LL * 1000LL * 1000LL, 3, &histogram_);
+  }
+
+  ~Benchmark() {
+    free(histogram_);
+    uv_cond_destroy(&cond_);
+    uv_mutex_destroy(&mutex_);
+  }
+
+  // Returns the elapsed time in nanoseconds
+  uint64_t run() {
+    uint64_t start = uv_hrtime();
+    unsigned initial = options_.concurrency < options_.num_requests
+                       ? options_.concurrency : options_.num_requests;
+    for (unsigned i = 0; i < initial; ++i) {
+      uv_mutex_lock(&mutex_);
+      unsigned index = num_started_++;
+      uv_mutex_unlock(&mutex_);
+      start_request(index);
+    }
+
+    uv_mutex_lock(&mutex_);
+    while (num_completed_ < options_.num_requests) {
+      uv_cond_wait(&cond_, &mutex_);
+    }
+    uv_mutex_unlock(&mutex_);
+    return uv_hrtime() - start;
+  }
+
+  void report(uint64_t elapsed_ns) const {
+    double seconds = static_cast<double>(elapsed_ns) / 1000000000.0;
+    printf("requests:   %u (%u errors)\n", num_completed_, num_errors_);
+    printf("elapsed:    %.3f s\n", seconds);
+    printf("throughput: %.0f requests/s\n", num_completed_ / seconds);
+    printf("latency (us): min %lld, mean %.0f, median %lld, 75th %lld, 95th %lld, "
+           "99th %lld, 99.9th %lld, max %lld\n",
+           static_cast<long long>(hdr_min(histogram_)),
+           hdr_mean(histogram_),
+           static_cast<long long>(hdr_value_at_percentile(histogram_, 50.0)),
+           static_cast<long long>(hdr_value_at_percentile(histogram_, 75.0)),
+           static_cast<long long>(hdr_value_at_percentile(histogram_, 95.0)),
+           static_cast<long long>(hdr_value_at_percentile(histogram_, 99.0)),
+           static_cast<long long>(hdr_value_at_percentile(histogram_, 99.9)),
+           static_cast<long long>(hdr_max(histogram_)));
+  }
+
+private:
+  struct Request {
+    Benchmark* benchmark;
+    uint64_t start;
+  };
+
+  // The mutex can't be held because the callback runs immediately if the
+  // request fails before it's sent.
+  void start_request(unsigned index) {
+    CassStatement* statement;
+    char key[32];
+    sprintf(key, "key%u", index);
+    if (prepared_ != NULL) {
+      statement = cass_prepared_bind(prepared_);
+    } else {
+      statement = cass_statement_new("SELECT * FROM table1 WHERE key = ?", 1);
+    }
+    cass_statement_bind_string(statement, 0, key);
+
+    Request* request = new Request();
+    request->benchmark = this;
+    request->start = uv_hrtime();
+
+    CassFuture* future = cass_session_execute(session_, statement);
+    cass_future_set_callback(future, on_result, request);
+    cass_future_free(future);
+    cass_statement_free(statement);
+  }
+
+  static void on_result(CassFuture* future, void* data) {
+    Request* request = static_cast<Request*>(data);
+    Benchmark* benchmark = request->benchmark;
+    int64_t latency_us = static_cast<int64_t>((uv_hrtime() - request->start) / 1000);
+    bool is_error = cass_future_error_code(future) != CASS_OK;
+    delete request;
+
+    bool is_next = false;
+    unsigned index = 0;
+    uv_mutex_lock(&benchmark->mutex_);
+    hdr_record_value(benchmark->histogram_, latency_us > 0 ? latency_us : 1);
+    if (is_error) ++benchmark->num_errors_;
+    if (++benchmark->num_completed_ == benchmark->options_.num_requests) {
+      uv_cond_signal(&benchmark->cond_);
+    } else if (benchmark->num_started_ < benchmark->options_.num_requests) {
+      is_next = true;
+      index = benchmark->num_started_++;
+    }
+    uv_mutex_unlock(&benchmark->mutex_);
+
+    if (is_next) benchmark->start_request(index);
+  }
+
+private:
+  CassSession* session_;
+  const CassPrepared* prepared_;
+  const Options& options_;
+  uv_mutex_t mutex_;
+  uv_cond_t cond_;
+  hdr_histogram* histogram_;
+  unsigned num_started_;
+  unsigned num_completed_;
+  unsigned num_errors_;
+};
+
+static void print_usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --nodes=<n>          Number of mock nodes (default: 3)\n"
+          "  --requests=<n>       Number of requests (default: 200000)\n"
+          "  --concurrency=<n>    Number of requests in flight (default: 1000)\n"
+          "  --io-threads=<n>     Number of driver I/O threads (default: 1)\n"
+          "  --prepared           Use a prepared statement\n"
+          "  --no-token-aware     Disable token-aware routing\n"
+          "  --latency=<ms>       Response delay for each node (default: 0)\n"
+          "  --slow-node=<ms>     Response delay for the first node only\n"
+          "  --rows=<n>           Rows returned per request (default: 1)\n"
+          "  --row-size=<bytes>   Size of each row's value (default: 64)\n"
+          "  --error-rate=<r>     Fraction of requests that fail (default: 0)\n"
+          "  --error-code=<code>  Protocol error code for failures (default: 0x1001)\n"
+          "  --port=<port>        Port used by the mock nodes (default: %d)\n",
+          program, mock::Cluster::DEFAULT_PORT);
+}
+
+static bool parse_option(const char* arg, const char* name, const char** value) {
+  size_t size = strlen(name);
+  if (strncmp(arg, name, size) != 0 || arg[size] != '=') return false;
+  *value = arg + size + 1;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  int port = mock::Cluster::DEFAULT_PORT;
+  long slow_node_ms = -1;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* value;
+    if (parse_option(argv[i], "--nodes", &value)) {
+      options.num_nodes = strtoul(value, NULL, 10);
+    } else if (parse_option(argv[i], "--requests", &value)) {
+      options.num_requests = strtoul(value, NULL, 10);
+    } else if (parse_option(argv[i], "--concurrency", &value)) {
+      options.concurrency = strtoul(value, NULL, 10);
+    } else if (parse_option(argv[i], "--io-threads", &value)) {
+      options.num_io_threads = strtoul(value, NULL, 10);
+    } else if (strcmp(argv[i], "--prepared") == 0) {
+      options.use_prepared = true;
+    } else if (strcmp(argv[i], "--no-token-aware") == 0) {
+      options.use_token_aware = false;
+    } else if (parse_option(argv[i], "--latency", &value)) {
+      options.settings.latency_ms = strtoul(value, NULL, 10);
+    } else if (parse_option(argv[i], "--slow-node", &value)) {
+      slow_node_ms = strtol(value, NULL, 10);
+    } else if (parse_option(argv[i], "--rows", &value)) {
+      options.settings.row_count = strtol(value, NULL, 10);
+    } else if (parse_option(argv[i], "--row-size", &value)) {
+      options.settings.row_size = strtoul(value, NULL, 10);
+    } else if (parse_option(argv[i], "--error-rate", &value)) {
+      options.settings.error_rate = atof(value);
+    } else if (parse_option(argv[i], "--error-code", &value)) {
+      options.settings.error_code = strtol(value, NULL, 0);
+    } else if (parse_option(argv[i], "--port", &value)) {
+      port = strtol(value, NULL, 10);
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (options.num_nodes == 0 || options.num_nodes > 254 ||
+      options.num_requests == 0 || options.concurrency == 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  options.settings.replication_factor = options.num_nodes < 3 ? options.num_nodes : 3;
+  mock::Cluster mock_cluster(options.num_nodes, options.settings, port);
+  if (slow_node_ms >= 0) {
+    mock_cluster.settings(0).latency_ms = static_cast<unsigned>(slow_node_ms);
+  }
+
+  int rc = mock_cluster.start();
+  if (rc != 0) {
+    fprintf(stderr, "Unable to start the mock cluster (%d)\n", rc);
+    return 1;
+  }
+
+  CassCluster* cluster = cass_cluster_new();
+  cass_cluster_set_contact_points(cluster, mock_cluster.contact_points().c_str());
+  cass_cluster_set_port(cluster, port);
+  cass_cluster_set_num_threads_io(cluster, options.num_io_threads);
+  cass_cluster_set_queue_size_io(cluster, options.concurrency * 2);
+  cass_cluster_set_pending_requests_high_water_mark(cluster, options.concurrency * 2);
+  cass_cluster_set_write_bytes_high_water_mark(cluster, 64 * 1024 * 1024);
+  cass_cluster_set_token_aware_routing(cluster, options.use_token_aware ? cass_true : cass_false);
+  cass_cluster_set_use_schema(cluster, cass_false);
+
+  CassSession* session = cass_session_new();
+  int status = 0;
+
+  CassFuture* future = cass_session_connect_keyspace(session, cluster,
+                                                     options.settings.keyspace.c_str());
+  if (cass_future_error_code(future) != CASS_OK) {
+    const char* message;
+    size_t message_length;
+    cass_future_error_message(future, &message, &message_length);
+    fprintf(stderr, "Unable to connect: %.*s\n", static_cast<int>(message_length), message);
+    status = 1;
+  }
+  cass_future_free(future);
+
+  const CassPrepared* prepared = NULL;
+  if (status == 0 && options.use_prepared) {
+    future = cass_session_prepare(session, "SELECT * FROM table1 WHERE key = ?");
+    if (cass_future_error_code(future) == CASS_OK) {
+      prepared = cass_future_get_prepared(future);
+    } else {
+      fprintf(stderr, "Unable to prepare the statement\n");
+      status = 1;
+    }
+    cass_future_free(future);
+  }
+
+  if (status == 0) {
+    printf("nodes: %u, requests: %u, concurrency: %u, I/O threads: %u, %s, %s\n",
+           options.num_nodes, options.num_requests, options.concurrency,
+           options.num_io_threads,
+           options.use_prepared ? "prepared" : "simple statements",
+           options.use_token_aware ? "token-aware" : "not token-aware");
+
+    Benchmark benchmark(session, prepared, options);
+    benchmark.report(benchmark.run());
+
+    for (size_t i = 0; i < mock_cluster.num_nodes(); ++i) {
+      printf("%s: %llu requests\n", mock_cluster.address(i).c_str(),
+             static_cast<unsigned long long>(mock_cluster.request_count(i)));
+    }
+  }
+
+  if (prepared != NULL) cass_prepared_free(prepared);
+
+  future = cass_session_close(session);
+  cass_future_wait(future);
+  cass_future_free(future);
+  cass_session_free(session);
+  cass_cluster_free(cluster);
+
+  mock_cluster.stop();
+  return status;
+}
@@ -0,0 +1,974 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "mock_cluster.hpp"
+
+#include "address.hpp"
+#include "atomic.hpp"
+#include "constants.hpp"
+#include "loop_thread.hpp"
+#include "md5.hpp"
+#include "serialization.hpp"
+
+#include "third_party/mt19937_64/mt19937_64.hpp"
+
+#include <assert.h>
+#include <ctype.h>
+#include <map>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#define CQL_VALUE_TYPE_BLOB 0x0003
+#define CQL_VALUE_TYPE_BOOLEAN 0x0004
+#define CQL_VALUE_TYPE_INT 0x0009
+#define CQL_VALUE_TYPE_UUID 0x000C
+#define CQL_VALUE_TYPE_VARCHAR 0x000D
+#define CQL_VALUE_TYPE_INET 0x0010
+#define CQL_VALUE_TYPE_MAP 0x0021
+#define CQL_VALUE_TYPE_SET 0x0022
+
+#define CQL_CONSISTENCY_ONE 0x0001
+
+#define MURMUR3_PARTITIONER "org.apache.cassandra.dht.Murmur3Partitioner"
+#define SIMPLE_STRATEGY "org.apache.cassandra.locator.SimpleStrategy"
+
+namespace mock {
+
+// Builds protocol messages (only the notations used by the nodes)
+class Encoder {
+public:
+  const std::string& str() const { return buffer_; }
+  size_t size() const { return buffer_.size(); }
+
+  void append_byte(uint8_t value) {
+    buffer_.push_back(static_cast<char>(value));
+  }
+
+  void append_uint16(uint16_t value) {
+    char temp[sizeof(uint16_t)];
+    cass::encode_uint16(temp, value);
+    buffer_.append(temp, sizeof(temp));
+  }
+
+  void append_int32(int32_t value) {
+    char temp[sizeof(int32_t)];
+    cass::encode_int32(temp, value);
+    buffer_.append(temp, sizeof(temp));
+  }
+
+  void encode_int32_at(size_t index, int32_t value) {
+    assert(index + sizeof(int32_t) <= buffer_.size());
+    cass::encode_int32(&buffer_[index], value);
+  }
+
+  // [string] and [short bytes]
+  void append_string(const std::string& value) {
+    append_uint16(static_cast<uint16_t>(value.size()));
+    buffer_.append(value);
+  }
+
+  // [bytes]
+  void append_bytes(const std::string& value) {
+    append_int32(static_cast<int32_t>(value.size()));
+    buffer_.append(value);
+  }
+
+  void append_raw(const std::string& value) {
+    buffer_.append(value);
+  }
+
+private:
+  std::string buffer_;
+};
+
+static std::string int32_value(int32_t value) {
+  char temp[sizeof(int32_t)];
+  cass::encode_int32(temp, value);
+  return std::string(temp, sizeof(temp));
+}
+
+static std::string inet_value(const std::string& ip) {
+  uint8_t inet[16];
+  uint8_t size = cass::Address(ip, 0).to_inet(inet);
+  return std::string(reinterpret_cast<char*>(inet), size);
+}
+
+// Collections use the v3+ encoding
+static std::string collection_value(const std::vector<std::string>& elements) {
+  Encoder encoder;
+  encoder.append_int32(static_cast<int32_t>(elements.size()));
+  for (std::vector<std::string>::const_iterator i = elements.begin(),
+       end = elements.end(); i != end; ++i) {
+    encoder.append_bytes(*i);
+  }
+  return encoder.str();
+}
+
+struct Column {
+  Column(const std::string& name, uint16_t type)
+    : name(name) {
+    types.push_back(type);
+  }
+
+  Column(const std::string& name, uint16_t type, uint16_t sub_type)
+    : name(name) {
+    types.push_back(type);
+    types.push_back(sub_type);
+    if (type == CQL_VALUE_TYPE_MAP) types.push_back(sub_type);
+  }
+
+  std::string name;
+  std::vector<uint16_t> types;
+};
+
+typedef std::vector<Column> ColumnVec;
+
+static void append_metadata(const std::string& keyspace,
+                            const std::string& table,
+                            const ColumnVec& columns,
+                            Encoder* encoder) {
+  if (columns.empty()) {
+    encoder->append_int32(0); // Flags
+    encoder->append_int32(0); // Column count
+    return;
+  }
+  encoder->append_int32(CASS_RESULT_FLAG_GLOBAL_TABLESPEC);
+  encoder->append_int32(static_cast<int32_t>(columns.size()));
+  encoder->append_string(keyspace);
+  encoder->append_string(table);
+  for (ColumnVec::const_iterator i = columns.begin(),
+       end = columns.end(); i != end; ++i) {
+    encoder->append_string(i->name);
+    for (std::vector<uint16_t>::const_iterator type = i->types.begin();
+         type != i->types.end(); ++type) {
+      encoder->append_uint16(*type);
+    }
+  }
+}
+
+// The body of a ROWS result
+class RowsBuilder {
+public:
+  RowsBuilder(const std::string& keyspace, const std::string& table,
+              const ColumnVec& columns)
+    : row_count_(0) {
+    encoder_.append_int32(CASS_RESULT_KIND_ROWS);
+    append_metadata(keyspace, table, columns, &encoder_);
+    row_count_index_ = encoder_.size();
+    encoder_.append_int32(0); // Row count (updated when finished)
+  }
+
+  void append_value(const std::string& value) {
+    encoder_.append_bytes(value);
+  }
+
+  void end_row() { ++row_count_; }
+
+  std::string finish() {
+    encoder_.encode_int32_at(row_count_index_, row_count_);
+    return encoder_.str();
+  }
+
+private:
+  Encoder encoder_;
+  size_t row_count_index_;
+  int32_t row_count_;
+};
+
+static bool starts_with_ignore_case(const std::string& str, const char* prefix) {
+  size_t size = strlen(prefix);
+  if (str.size() < size) return false;
+  for (size_t i = 0; i < size; ++i) {
+    if (tolower(str[i]) != tolower(prefix[i])) return false;
+  }
+  return true;
+}
+
+static bool contains(const std::string& str, const char* value) {
+  return str.find(value) != std::string::npos;
+}
+
+// The evenly spaced Murmur3 token owned by a node
+static std::string node_token(size_t index, size_t num_nodes) {
+  uint64_t step = ~static_cast<uint64_t>(0) / num_nodes;
+  int64_t token = static_cast<int64_t>(0x8000000000000000ULL + index * step);
+  char temp[32];
+  sprintf(temp, "%lld", static_cast<long long>(token));
+  return temp;
+}
+
+class Connection;
+
+// A node in the mock cluster. Everything except start(), stop() and
+// request_count() runs on the node's event loop thread.
+class Node : public cass::LoopThread {
+public:
+  Node(const Cluster::Settings& settings,
+       const std::vector<std::string>& addresses,
+       size_t index, int port)
+    : settings(settings)
+    , addresses_(addresses)
+    , index_(index)
+    , port_(port)
+    , is_running_(false)
+    , request_count_(0)
+    , rng_(index + 1) { }
+
+  int start();
+  void stop();
+
+  const std::string& address() const { return addresses_[index_]; }
+
+  uint64_t request_count() const {
+    return request_count_.load(cass::MEMORY_ORDER_RELAXED);
+  }
+
+  // Returns the response's opcode and body for a request
+  uint8_t handle(int version, uint8_t opcode, char* body, size_t size,
+                 std::string* response);
+
+  void add_connection(Connection* connection) { connections_.insert(connection); }
+  void remove_connection(Connection* connection) { connections_.erase(connection); }
+
+public:
+  Cluster::Settings settings;
+
+private:
+  struct Prepared {
+    Prepared() : is_select(false), num_markers(0) { }
+    std::string query;
+    bool is_select;
+    int32_t num_markers;
+  };
+
+  typedef std::map<std::string, Prepared> PreparedMap;
+
+  void build_responses();
+  uint8_t query(int version, const std::string& query, std::string* response);
+  uint8_t prepare(int version, const std::string& query, std::string* response);
+  uint8_t execute(int version, const std::string& id, std::string* response);
+  bool inject_error(std::string* response);
+
+  static std::string error(int32_t code, const std::string& message);
+
+#if UV_VERSION_MAJOR == 0
+  static void on_stop(uv_async_t* async, int status);
+#else
+  static void on_stop(uv_async_t* async);
+#endif
+  static void on_connection(uv_stream_t* server, int status);
+
+private:
+  const std::vector<std::string> addresses_;
+  const size_t index_;
+  const int port_;
+  bool is_running_;
+  uv_tcp_t server_;
+  uv_async_t stop_async_;
+  std::set<Connection*> connections_;
+  cass::Atomic<uint64_t> request_count_;
+  MT19937_64 rng_;
+  PreparedMap prepared_;
+
+  std::string local_body_;
+  std::string peers_body_;
+  std::string keyspaces_body_;
+  std::string empty_body_;
+  std::string void_body_;
+  ColumnVec select_columns_;
+  std::string select_body_;
+};
+
+// A client connection. It's deleted once its handle is closed and its
+// delayed responses have been written.
+class Connection {
+public:
+  Connection(Node* node)
+    : node_(node)
+    , refs_(1)
+    , is_closing_(false) {
+    tcp_.data = this;
+  }
+
+  uv_tcp_t* tcp() { return &tcp_; }
+
+  int accept(uv_stream_t* server);
+  void close();
+
+private:
+  struct WriteRequest {
+    uv_write_t req;
+    std::string frame;
+  };
+
+  struct DelayedWrite {
+    uv_timer_t timer;
+    Connection* connection;
+    std::string frame;
+  };
+
+  void release() {
+    if (--refs_ == 0) delete this;
+  }
+
+  void consume(const char* data, size_t size);
+  void handle_frame(int version, int16_t stream, uint8_t opcode,
+                    char* body, size_t size);
+  void write(const std::string& frame);
+
+#if UV_VERSION_MAJOR == 0
+  static uv_buf_t alloc_buffer(uv_handle_t* handle, size_t suggested_size);
+  static void on_read(uv_stream_t* stream, ssize_t nread, uv_buf_t buf);
+  static void on_delayed_write(uv_timer_t* timer, int status);
+#else
+  static void alloc_buffer(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf);
+  static void on_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf);
+  static void on_delayed_write(uv_timer_t* timer);
+#endif
+  static void on_write(uv_write_t* req, int status);
+  static void on_close(uv_handle_t* handle);
+  static void on_timer_close(uv_handle_t* handle);
+
+private:
+  Node* node_;
+  uv_tcp_t tcp_;
+  int refs_;
+  bool is_closing_;
+  std::string buffer_;
+  char read_buffer_[64 * 1024];
+};
+
+int Connection::accept(uv_stream_t* server) {
+  int rc = uv_tcp_init(server->loop, &tcp_);
+  if (rc != 0) return rc;
+  node_->add_connection(this);
+  rc = uv_accept(server, reinterpret_cast<uv_stream_t*>(&tcp_));
+  if (rc != 0) return rc;
+  return uv_read_start(reinterpret_cast<uv_stream_t*>(&tcp_),
+                       alloc_buffer, on_read);
+}
+
+void Connection::close() {
+  if (is_closing_) return;
+  is_closing_ = true;
+  node_->remove_connection(this);
+  uv_close(reinterpret_cast<uv_handle_t*>(&tcp_), on_close);
+}
+
+void Connection::consume(const char* data, size_t size) {
+  buffer_.append(data, size);
+
+  size_t pos = 0;
+  while (!is_closing_) {
+    size_t remaining = buffer_.size() - pos;
+    if (remaining < 1) break;
+
+    char* header = &buffer_[pos];
+    int version = header[0] & 0x7F;
+    size_t header_size = version >= 3 ? CASS_HEADER_SIZE_V3 : CASS_HEADER_SIZE_V1_AND_V2;
+    if (remaining < header_size) break;
+
+    int16_t stream;
+    uint8_t opcode;
+    int32_t length;
+    if (version >= 3) {
+      cass::decode_int16(header + 2, stream);
+      opcode = static_cast<uint8_t>(header[4]);
+      cass::decode_int32(header + 5, length);
+    } else {
+      stream = static_cast<int8_t>(header[2]);
+      opcode = static_cast<uint8_t>(header[3]);
+      cass::decode_int32(header + 4, length);
+    }
+
+    if (length < 0) {
+      close();
+      return;
+    }
+    if (remaining < header_size + length) break;
+
+    handle_frame(version, stream, opcode, header + header_size, length);
+    pos += header_size + length;
+  }
+
+  buffer_.erase(0, pos);
+}
+
+void Connection::handle_frame(int version, int16_t stream, uint8_t opcode,
+                              char* body, size_t size) {
+  std::string response;
+  uint8_t response_opcode = node_->handle(version, opcode, body, size, &response);
+
+  std::string frame;
+  frame.push_back(static_cast<char>(0x80 | version));
+  frame.push_back(0); // Flags
+  if (version >= 3) {
+    char temp[sizeof(int16_t)];
+    cass::encode_int16(temp, stream);
+    frame.append(temp, sizeof(temp));
+  } else {
+    frame.push_back(static_cast<char>(stream));
+  }
+  frame.push_back(static_cast<char>(response_opcode));
+  frame.append(int32_value(static_cast<int32_t>(response.size())));
+  frame.append(response);
+
+  if (node_->settings.latency_ms == 0) {
+    write(frame);
+    return;
+  }
+
+  DelayedWrite* delayed = new DelayedWrite();
+  delayed->connection = this;
+  delayed->frame.swap(frame);
+  delayed->timer.data = delayed;
+  ++refs_;
+  uv_timer_init(tcp_.loop, &delayed->timer);
+  uv_timer_start(&delayed->timer, on_delayed_write, node_->settings.latency_ms, 0);
+}
+
+void Connection::write(const std::string& frame) {
+  if (is_closing_) return;
+  WriteRequest* request = new WriteRequest();
+  request->frame = frame;
+  request->req.data = request;
+  uv_buf_t buf = uv_buf_init(&request->frame[0],
+                             static_cast<unsigned int>(request->frame.size()));
+  if (uv_write(&request->req, reinterpret_cast<uv_stream_t*>(&tcp_),
+               &buf, 1, on_write) != 0) {
+    delete request;
+    close();
+  }
+}
+
+#if UV_VERSION_MAJOR == 0
+uv_buf_t Connection::alloc_buffer(uv_handle_t* handle, size_t suggested_size) {
+  Connection* connection = static_cast<Connection*>(handle->data);
+  return uv_buf_init(connection->read_buffer_, sizeof(connection->read_buffer_));
+}
+#else
+void Connection::alloc_buffer(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+  Connection* connection = static_cast<Connection*>(handle->data);
+  *buf = uv_buf_init(connection->read_buffer_, sizeof(connection->read_buffer_));
+}
+#endif
+
+#if UV_VERSION_MAJOR == 0
+void Connection::on_read(uv_stream_t* stream, ssize_t nread, uv_buf_t buf) {
+#else
+void Connection::on_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+#endif
+  Connection* connection = static_cast<Connection*>(stream->data);
+  if (nread < 0) {
+    connection->close();
+    return;
+  }
+#if UV_VERSION_MAJOR == 0
+  connection->consume(buf.base, nread);
+#else
+  connection->consume(buf->base, nread);
+#endif
+}
+
+#if UV_VERSION_MAJOR == 0
+void Connection::on_delayed_write(uv_timer_t* timer, int status) {
+#else
+void Connection::on_delayed_write(uv_timer_t* timer) {
+#endif
+  DelayedWrite* delayed = static_cast<DelayedWrite*>(timer->data);
+  delayed->connection->write(delayed->frame);
+  uv_close(reinterpret_cast<uv_handle_t*>(timer), on_timer_close);
+}
+
+void Connection::on_write(uv_write_t* req, int status) {
+  WriteRequest* request = static_cast<WriteRequest*>(req->data);
+  delete request;
+}
+
+void Connection::on_close(uv_handle_t* handle) {
+  Connection* connection = static_cast<Connection*>(handle->data);
+  connection->release();
+}
+
+void Connection::on_timer_close(uv_handle_t* handle) {
+  DelayedWrite* delayed = static_cast<DelayedWrite*>(handle->data);
+  delayed->connection->release();
+  delete delayed;
+}
+
+int Node::start() {
+  build_responses();
+
+  int rc = init();
+  if (rc != 0) return rc;
+
+  rc = uv_async_init(loop(), &stop_async_, on_stop);
+  if (rc != 0) return rc;
+  stop_async_.data = this;
+
+  rc = uv_tcp_init(loop(), &server_);
+  if (rc == 0) {
+    server_.data = this;
+    const cass::Address address(addresses_[index_], port_);
+#if UV_VERSION_MAJOR == 0
+    rc = uv_tcp_bind(&server_, *address.addr_in());
+#else
+    rc = uv_tcp_bind(&server_, address.addr(), 0);
+#endif
+    if (rc == 0) {
+      rc = uv_listen(reinterpret_cast<uv_stream_t*>(&server_), 128, on_connection);
+    }
+    if (rc == 0) {
+      rc = run();
+    }
+    if (rc != 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&server_), NULL);
+    }
+  }
+
+  if (rc != 0) {
+    // Close the handles so that the loop can be closed
+    uv_close(reinterpret_cast<uv_handle_t*>(&stop_async_), NULL);
+    close_handles();
+    uv_run(loop(), UV_RUN_DEFAULT);
+    return rc;
+  }
+
+  is_running_ = true;
+  return 0;
+}
+
+void Node::stop() {
+  if (!is_running_) return;
+  is_running_ = false;
+  uv_async_send(&stop_async_);
+  join();
+}
+
+#if UV_VERSION_MAJOR == 0
+void Node::on_stop(uv_async_t* async, int status) {
+#else
+void Node::on_stop(uv_async_t* async) {
+#endif
+  Node* node = static_cast<Node*>(async->data);
+  uv_close(reinterpret_cast<uv_handle_t*>(&node->server_), NULL);
+  uv_close(reinterpret_cast<uv_handle_t*>(&node->stop_async_), NULL);
+  std::set<Connection*> connections(node->connections_);
+  for (std::set<Connection*>::iterator i = connections.begin(),
+       end = connections.end(); i != end; ++i) {
+    (*i)->close();
+  }
+  node->close_handles();
+}
+
+void Node::on_connection(uv_stream_t* server, int status) {
+  if (status != 0) return;
+  Node* node = static_cast<Node*>(server->data);
+  Connection* connection = new Connection(node);
+  if (connection->accept(server) != 0) {
+    connection->close();
+  }
+}
+
+void Node::build_responses() {
+  std::vector<std::string> tokens;
+
+  // system.local
+  {
+    ColumnVec columns;
+    columns.push_back(Column("key", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("cluster_name", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("data_center", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("rack", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("release_version", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("partitioner", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("rpc_address", CQL_VALUE_TYPE_INET));
+    columns.push_back(Column("schema_version", CQL_VALUE_TYPE_UUID));
+    columns.push_back(Column("tokens", CQL_VALUE_TYPE_SET, CQL_VALUE_TYPE_VARCHAR));
+
+    RowsBuilder builder("system", "local", columns);
+    builder.append_value("local");
+    builder.append_value("mock");
+    builder.append_value(settings.data_center);
+    builder.append_value(settings.rack);
+    builder.append_value(settings.release_version);
+    builder.append_value(MURMUR3_PARTITIONER);
+    builder.append_value(inet_value(address()));
+    builder.append_value(std::string(16, '\0'));
+    tokens.assign(1, node_token(index_, addresses_.size()));
+    builder.append_value(collection_value(tokens));
+    builder.end_row();
+    local_body_ = builder.finish();
+  }
+
+  // system.peers (every node is assumed to use the same datacenter, rack
+  // and version)
+  {
+    ColumnVec columns;
+    columns.push_back(Column("peer", CQL_VALUE_TYPE_INET));
+    columns.push_back(Column("data_center", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("rack", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("release_version", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("rpc_address", CQL_VALUE_TYPE_INET));
+    columns.push_back(Column("schema_version", CQL_VALUE_TYPE_UUID));
+    columns.push_back(Column("tokens", CQL_VALUE_TYPE_SET, CQL_VALUE_TYPE_VARCHAR));
+
+    RowsBuilder builder("system", "peers", columns);
+    for (size_t i = 0; i < addresses_.size(); ++i) {
+      if (i == index_) continue;
+      builder.append_value(inet_value(addresses_[i]));
+      builder.append_value(settings.data_center);
+      builder.append_value(settings.rack);
+      builder.append_value(settings.release_version);
+      builder.append_value(inet_value(addresses_[i]));
+      builder.append_value(std::string(16, '\0'));
+      tokens.assign(1, node_token(i, addresses_.size()));
+      builder.append_value(collection_value(tokens));
+      builder.end_row();
+    }
+    peers_body_ = builder.finish();
+  }
+
+  // The keyspace (using the 3.0+ or the 2.x schema tables)
+  {
+    char replication_factor[32];
+    sprintf(replication_factor, "%d", settings.replication_factor);
+
+    ColumnVec columns;
+    columns.push_back(Column("keyspace_name", CQL_VALUE_TYPE_VARCHAR));
+    columns.push_back(Column("durable_writes", CQL_VALUE_TYPE_BOOLEAN));
+    if (settings.release_version >= "3") {
+      columns.push_back(Column("replication", CQL_VALUE_TYPE_MAP, CQL_VALUE_TYPE_VARCHAR));
+    } else {
+      columns.push_back(Column("strategy_class", CQL_VALUE_TYPE_VARCHAR));
+      columns.push_back(Column("strategy_options", CQL_VALUE_TYPE_VARCHAR));
+    }
+
+    RowsBuilder builder(settings.release_version >= "3" ? "system_schema" : "system",
+                        "keyspaces", columns);
+    builder.append_value(settings.keyspace);
+    builder.append_value(std::string(1, '\1'));
+    if (settings.release_version >= "3") {
+      std::vector<std::string> replication;
+      replication.push_back("class");
+      replication.push_back(SIMPLE_STRATEGY);
+      replication.push_back("replication_factor");
+      replication.push_back(replication_factor);
+      // Maps are encoded as a list of keys and values
+      Encoder encoder;
+      encoder.append_int32(static_cast<int32_t>(replication.size() / 2));
+      for (size_t i = 0; i < replication.size(); ++i) {
+        encoder.append_bytes(replication[i]);
+      }
+      builder.append_value(encoder.str());
+    } else {
+      builder.append_value(SIMPLE_STRATEGY);
+      builder.append_value(std::string("{\"replication_factor\":\"") +
+                           replication_factor + "\"}");
+    }
+    builder.end_row();
+    keyspaces_body_ = builder.finish();
+  }
+
+  empty_body_ = RowsBuilder("system", "empty", ColumnVec()).finish();
+  void_body_ = int32_value(CASS_RESULT_KIND_VOID);
+
+  // The rows returned for user queries
+  select_columns_.clear();
+  select_columns_.push_back(Column("key", CQL_VALUE_TYPE_INT));
+  select_columns_.push_back(Column("value", CQL_VALUE_TYPE_BLOB));
+  {
+    RowsBuilder builder(settings.keyspace, "table", select_columns_);
+    std::string value(settings.row_size, 'x');
+    for (int32_t i = 0; i < settings.row_count; ++i) {
+      builder.append_value(int32_value(i));
+      builder.append_value(value);
+      builder.end_row();
+    }
+    select_body_ = builder.finish();
+  }
+}
+
+uint8_t Node::handle(int version, uint8_t opcode, char* body, size_t size,
+                     std::string* response) {
+  if (version < 3 || version > CASS_HIGHEST_SUPPORTED_PROTOCOL_VERSION) {
+    char message[128];
+    sprintf(message, "Invalid or unsupported protocol version (%d); "
+                     "supported versions are (3/v3, 4/v4)", version);
+    *response = error(CQL_ERROR_PROTOCOL_ERROR, message);
+    return CQL_OPCODE_ERROR;
+  }
+
+  switch (opcode) {
+    case CQL_OPCODE_STARTUP:
+    case CQL_OPCODE_REGISTER:
+      response->clear();
+      return CQL_OPCODE_READY;
+
+    case CQL_OPCODE_OPTIONS: {
+      Encoder encoder;
+      encoder.append_uint16(2);
+      encoder.append_string("CQL_VERSION");
+      encoder.append_uint16(1);
+      encoder.append_string("3.4.0");
+      encoder.append_string("COMPRESSION");
+      encoder.append_uint16(0);
+      *response = encoder.str();
+      return CQL_OPCODE_SUPPORTED;
+    }
+
+    case CQL_OPCODE_QUERY:
+    case CQL_OPCODE_PREPARE: {
+      char* query;
+      size_t query_size;
+      if (size < sizeof(int32_t)) break;
+      cass::decode_long_string(body, &query, query_size);
+      if (query_size > size - sizeof(int32_t)) break;
+      std::string query_string(query, query_size);
+      return opcode == CQL_OPCODE_QUERY ? this->query(version, query_string, response)
+                                        : prepare(version, query_string, response);
+    }
+
+    case CQL_OPCODE_EXECUTE: {
+      char* id;
+      size_t id_size;
+      if (size < sizeof(uint16_t)) break;
+      cass::decode_string(body, &id, id_size);
+      if (id_size > size - sizeof(uint16_t)) break;
+      return execute(version, std::string(id, id_size), response);
+    }
+
+    case CQL_OPCODE_BATCH:
+      request_count_.fetch_add(1, cass::MEMORY_ORDER_RELAXED);
+      if (inject_error(response)) return CQL_OPCODE_ERROR;
+      *response = void_body_;
+      return CQL_OPCODE_RESULT;
+
+    default:
+      *response = error(CQL_ERROR_PROTOCOL_ERROR, "Unsupported opcode");
+      return CQL_OPCODE_ERROR;
+  }
+
+  *response = error(CQL_ERROR_PROTOCOL_ERROR, "Invalid message body");
+  return CQL_OPCODE_ERROR;
+}
+
+uint8_t Node::query(int version, const std::string& query, std::string* response) {
+  if (starts_with_ignore_case(query, "USE ")) {
+    std::string keyspace(query.substr(4));
+    if (keyspace.size() > 1 && keyspace[0] == '"') {
+      keyspace = keyspace.substr(1, keyspace.size() - 2);
+    }
+    Encoder encoder;
+    encoder.append_int32(CASS_RESULT_KIND_SET_KEYSPACE);
+    encoder.append_string(keyspace);
+    *response = encoder.str();
+  } else if (contains(query, "system.local")) {
+    *response = local_body_;
+  } else if (contains(query, "system.peers")) {
+    *response = peers_body_;
+  } else if (contains(query, "system_schema.keyspaces") ||
+             contains(query, "system.schema_keyspaces")) {
+    *response = keyspaces_body_;
+  } else if (contains(query, "system_schema.") || contains(query, "system.")) {
+    *response = empty_body_;
+  } else {
+    request_count_.fetch_add(1, cass::MEMORY_ORDER_RELAXED);
+    if (inject_error(response)) return CQL_OPCODE_ERROR;
+    *response = starts_with_ignore_case(query, "SELECT") ? select_body_ : void_body_;
+  }
+  return CQL_OPCODE_RESULT;
+}
+
+uint8_t Node::prepare(int version, const std::string& query, std::string* response) {
+  // The id is the query's MD5 hash (as it is for Cassandra) so that it's the
+  // same on every node.
+  uint8_t hash[16];
+  cass::Md5 md5;
+  md5.update(reinterpret_cast<const uint8_t*>(query.data()), query.size());
+  md5.final(hash);
+  std::string id(reinterpret_cast<char*>(hash), sizeof(hash));
+
+  Prepared& prepared = prepared_[id];
+  prepared.query = query;
+  prepared.is_select = starts_with_ignore_case(query, "SELECT");
+  prepared.num_markers = 0;
+  for (std::string::const_iterator i = query.begin(); i != query.end(); ++i) {
+    if (*i == '?') ++prepared.num_markers;
+  }
+
+  Encoder encoder;
+  encoder.append_int32(CASS_RESULT_KIND_PREPARED);
+  encoder.append_string(id);
+
+  // Bind marker metadata
+  if (prepared.num_markers == 0) {
+    encoder.append_int32(0); // Flags
+    encoder.append_int32(0); // Column count
+    if (version >= 4) encoder.append_int32(0); // Partition key count
+  } else {
+    encoder.append_int32(CASS_RESULT_FLAG_GLOBAL_TABLESPEC);
+    encoder.append_int32(prepared.num_markers);
+    if (version >= 4) {
+      encoder.append_int32(1); // Partition key count
+      encoder.append_uint16(0); // Partition key index
+    }
+    encoder.append_string(settings.keyspace);
+    encoder.append_string("table");
+    for (int32_t i = 0; i < prepared.num_markers; ++i) {
+      char name[32];
+      sprintf(name, "p%d", static_cast<int>(i));
+      encoder.append_string(name);
+      encoder.append_uint16(CQL_VALUE_TYPE_VARCHAR);
+    }
+  }
+
+  // Result metadata
+  if (prepared.is_select) {
+    append_metadata(settings.keyspace, "table", select_columns_, &encoder);
+  } else {
+    encoder.append_int32(CASS_RESULT_FLAG_NO_METADATA);
+    encoder.append_int32(0); // Column count
+  }
+
+  *response = encoder.str();
+  return CQL_OPCODE_RESULT;
+}
+
+uint8_t Node::execute(int version, const std::string& id, std::string* response) {
+  PreparedMap::const_iterator it = prepared_.find(id);
+  if (it == prepared_.end()) {
+    Encoder encoder;
+    encoder.append_raw(error(CQL_ERROR_UNPREPARED, "Prepared statement not found"));
+    encoder.append_string(id);
+    *response = encoder.str();
+    return CQL_OPCODE_ERROR;
+  }
+
+  request_count_.fetch_add(1, cass::MEMORY_ORDER_RELAXED);
+  if (inject_error(response)) return CQL_OPCODE_ERROR;
+  *response = it->second.is_select ? select_body_ : void_body_;
+  return CQL_OPCODE_RESULT;
+}
+
+bool Node::inject_error(std::string* response) {
+  if (settings.error_rate <= 0.0) return false;
+  double value = static_cast<double>(rng_() >> 11) * (1.0 / 9007199254740992.0);
+  if (value >= settings.error_rate) return false;
+
+  Encoder encoder;
+  encoder.append_raw(error(settings.error_code, "Injected error"));
+  switch (settings.error_code) {
+    case CQL_ERROR_UNAVAILABLE:
+      encoder.append_uint16(CQL_CONSISTENCY_ONE);
+      encoder.append_int32(1); // Required
+      encoder.append_int32(0); // Alive
+      break;
+    case CQL_ERROR_READ_TIMEOUT:
+      encoder.append_uint16(CQL_CONSISTENCY_ONE);
+      encoder.append_int32(0); // Received
+      encoder.append_int32(1); // Block for
+      encoder.append_byte(0); // Data present
+      break;
+    case CQL_ERROR_WRITE_TIMEOUT:
+      encoder.append_uint16(CQL_CONSISTENCY_ONE);
+      encoder.append_int32(0); // Received
+      encoder.append_int32(1); // Block for
+      encoder.append_string("SIMPLE");
+      break;
+    default:
+      break;
+  }
+  *response = encoder.str();
+  return true;
+}
+
+std::string Node::error(int32_t code, const std::string& message) {
+  Encoder encoder;
+  encoder.append_int32(code);
+  encoder.append_string(message);
+  return encoder.str();
+}
+
+Cluster::Cluster(size_t num_nodes, const Settings& settings, int port)
+  : port_(port)
+  , is_started_(false) {
+  assert(num_nodes > 0 && num_nodes < 255);
+  std::vector<std::string> addresses;
+  for (size_t i = 0; i < num_nodes; ++i) {
+    char address[32];
+    sprintf(address, "127.0.0.%u", static_cast<unsigned>(i + 1));
+    addresses.push_back(address);
+  }
+  for (size_t i = 0; i < num_nodes; ++i) {
+    nodes_.push_back(new Node(settings, addresses, i, port));
+  }
+}
+
+Cluster::~Cluster() {
+  stop();
+  for (std::vector<Node*>::iterator i = nodes_.begin(),
+       end = nodes_.end(); i != end; ++i) {
+    delete *i;
+  }
+}
+
+Cluster::Settings& Cluster::settings(size_t node) {
+  assert(!is_started_);
+  return nodes_[node]->settings;
+}
+
+int Cluster::start() {
+  is_started_ = true;
+  for (std::vector<Node*>::iterator i = nodes_.begin(),
+       end = nodes_.end(); i != end; ++i) {
+    int rc = (*i)->start();
+    if (rc != 0) {
+      stop();
+      return rc;
+    }
+  }
+  return 0;
+}
+
+void Cluster::stop() {
+  for (std::vector<Node*>::iterator i = nodes_.begin(),
+       end = nodes_.end(); i != end; ++i) {
+    (*i)->stop();
+  }
+}
+
+std::string Cluster::address(size_t node) const {
+  return nodes_[node]->address();
+}
+
+std::string Cluster::contact_points() const {
+  std::string contact_points;
+  for (std::vector<Node*>::const_iterator i = nodes_.begin(),
+       end = nodes_.end(); i != end; ++i) {
+    if (!contact_points.empty()) contact_points.push_back(',');
+    contact_points.append((*i)->address());
+  }
+  return contact_points;
+}
+
+uint64_t Cluster::request_count(size_t node) const {
+  return nodes_[node]->request_count();
+}
+
+} // namespace mock
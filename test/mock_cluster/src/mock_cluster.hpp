@@ -0,0 +1,118 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __MOCK_CLUSTER_HPP_INCLUDED__
+#define __MOCK_CLUSTER_HPP_INCLUDED__
+
+#include "macros.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace mock {
+
+class Node;
+
+// A cluster of in-process nodes that speak enough of the native protocol
+// (v1 to v4 framing) to run the driver end-to-end without Cassandra. Each
+// node runs its own event loop thread and listens on 127.0.0.<n> (n starting
+// at 1) using the same port, which works on Linux without any setup. Other
+// platforms need the loopback aliases to be configured.
+//
+// Nodes handle STARTUP, OPTIONS, REGISTER, QUERY, PREPARE, EXECUTE and BATCH:
+//   * "system.local" and "system.peers" return canned rows that describe the
+//     cluster (a single datacenter with evenly spaced Murmur3 tokens).
+//   * "system_schema.keyspaces" (and "system.schema_keyspaces") return a
+//     single keyspace using SimpleStrategy. Other schema tables are empty.
+//   * "USE <keyspace>" sets the keyspace.
+//   * Any other SELECT returns the configured rows with an int "key" column
+//     and a blob "value" column of the configured size.
+//   * Everything else returns a VOID result.
+// Prepared statements' bind markers are all typed as text and the first one
+// is used as the partition key.
+class Cluster {
+public:
+  static const int DEFAULT_PORT = 19042;
+
+  struct Settings {
+    Settings()
+      : latency_ms(0)
+      , row_count(1)
+      , row_size(64)
+      , error_rate(0.0)
+      , error_code(0x1001) // Overloaded
+      , release_version("3.0.8")
+      , data_center("dc1")
+      , rack("rack1")
+      , keyspace("benchmark")
+      , replication_factor(3) { }
+
+    // Delay before each response is written
+    unsigned latency_ms;
+
+    // The rows returned by SELECT queries
+    int32_t row_count;
+    size_t row_size;
+
+    // The fraction of user requests (not "system" queries) that fail with
+    // the error code. Server error, unavailable, overloaded, bootstrapping
+    // and read/write timeout errors are supported.
+    double error_rate;
+    int32_t error_code;
+
+    std::string release_version;
+    std::string data_center;
+    std::string rack;
+    std::string keyspace;
+    int replication_factor;
+  };
+
+  Cluster(size_t num_nodes,
+          const Settings& settings = Settings(),
+          int port = DEFAULT_PORT);
+  ~Cluster();
+
+  // A node's settings can only be changed before the cluster is started
+  Settings& settings(size_t node);
+
+  // Returns 0 when every node is listening or a libuv error code
+  int start();
+  void stop();
+
+  size_t num_nodes() const { return nodes_.size(); }
+  int port() const { return port_; }
+
+  // The node's IP address and a comma delimited list of all the nodes'
+  // addresses (for cass_cluster_set_contact_points())
+  std::string address(size_t node) const;
+  std::string contact_points() const;
+
+  // The number of QUERY, EXECUTE and BATCH requests the node has received
+  uint64_t request_count(size_t node) const;
+
+private:
+  std::vector<Node*> nodes_;
+  const int port_;
+  bool is_started_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(Cluster);
+};
+
+} // namespace mock
+
+#endif
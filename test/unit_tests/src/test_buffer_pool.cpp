@@ -0,0 +1,130 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "buffer_pool.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string.h>
+
+BOOST_AUTO_TEST_SUITE(buffer_pool)
+
+BOOST_AUTO_TEST_CASE(size_classes)
+{
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(0), 256u);
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(256), 256u);
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(257), 512u);
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(64 * 1024), 64u * 1024u);
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(4 * 1024 * 1024), 4u * 1024u * 1024u);
+
+  // Larger than the largest size class
+  BOOST_CHECK_EQUAL(cass::BufferPool::capacity_for(4 * 1024 * 1024 + 1), 4u * 1024u * 1024u + 1u);
+}
+
+BOOST_AUTO_TEST_CASE(reuse)
+{
+  cass::BufferPool::Ptr pool(new cass::BufferPool());
+  cass::BufferPool::Stats stats;
+
+  size_t capacity;
+  char* buffer = pool->allocate(1000, &capacity);
+  BOOST_CHECK_EQUAL(capacity, 1024u);
+  memset(buffer, 0, capacity);
+
+  pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.misses, 1u);
+  BOOST_CHECK_EQUAL(stats.in_use_bytes, 1024u);
+  BOOST_CHECK_EQUAL(stats.cached_bytes, 0u);
+
+  pool->release(buffer, capacity);
+  pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.in_use_bytes, 0u);
+  BOOST_CHECK_EQUAL(stats.cached_bytes, 1024u);
+
+  // The same size class reuses the buffer
+  BOOST_CHECK_EQUAL(pool->allocate(600, &capacity), buffer);
+  pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.hits, 1u);
+  BOOST_CHECK_EQUAL(stats.cached_bytes, 0u);
+  pool->release(buffer, capacity);
+
+  // A different size class doesn't
+  char* other = pool->allocate(100, &capacity);
+  BOOST_CHECK(other != buffer);
+  pool->release(other, capacity);
+
+  // Allocations larger than the largest size class aren't cached
+  buffer = pool->allocate(5 * 1024 * 1024, &capacity);
+  pool->release(buffer, capacity);
+  pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.unpooled, 1u);
+  BOOST_CHECK_EQUAL(stats.cached_bytes, 1024u + 256u);
+}
+
+BOOST_AUTO_TEST_CASE(water_marks)
+{
+  cass::BufferPool::Ptr pool(new cass::BufferPool(64 * 1024, 16 * 1024));
+  cass::BufferPool::Stats stats;
+
+  char* buffers[8];
+  size_t capacity = 0;
+  for (int i = 0; i < 8; ++i) {
+    buffers[i] = pool->allocate(16 * 1024, &capacity);
+  }
+  for (int i = 0; i < 8; ++i) {
+    pool->release(buffers[i], capacity);
+  }
+
+  // The fifth release goes past the high water mark so the free buffers are
+  // trimmed down to the low water mark and the rest are also freed
+  pool->stats(&stats);
+  BOOST_CHECK_LE(stats.cached_bytes, 64u * 1024u);
+  BOOST_CHECK_GT(stats.trimmed_bytes, 0u);
+  BOOST_CHECK_EQUAL(stats.in_use_bytes, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ref_buffer)
+{
+  cass::BufferPool::Ptr pool(new cass::BufferPool());
+  cass::BufferPool::Stats stats;
+
+  cass::RefBuffer::Ptr buffer(pool->create_ref_buffer(10000));
+  memset(buffer->data(), 'a', 10000);
+  pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.in_use_bytes, 16u * 1024u);
+
+  // The buffer keeps the pool alive
+  cass::BufferPool* raw_pool = pool.get();
+  pool.reset();
+  BOOST_CHECK_EQUAL(raw_pool->ref_count(), 1);
+
+  raw_pool->inc_ref();
+  buffer.reset();
+  raw_pool->stats(&stats);
+  BOOST_CHECK_EQUAL(stats.in_use_bytes, 0u);
+  BOOST_CHECK_EQUAL(stats.cached_bytes, 16u * 1024u);
+  raw_pool->dec_ref();
+
+  // Buffers created without a pool still come from the heap
+  buffer.reset(cass::RefBuffer::create(100));
+  memset(buffer->data(), 'b', 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,345 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "completion_queue.hpp"
+#include "future.hpp"
+#include "mpsc_queue.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <uv.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+const int MPSC_NUM_ITERATIONS = 100000;
+const int MPSC_NUM_ENQUEUE_THREADS = 4;
+
+struct TestNode : public cass::MPSCQueue<TestNode>::Node {
+  TestNode()
+    : value(0) { }
+  int value;
+};
+
+struct TestEnqueueData {
+  cass::MPSCQueue<TestNode>* queue;
+  TestNode* nodes;
+};
+
+void mpsc_enqueue_thread(void* arg) {
+  TestEnqueueData* data = static_cast<TestEnqueueData*>(arg);
+  for (int i = 0; i < MPSC_NUM_ITERATIONS; ++i) {
+    data->queue->enqueue(&data->nodes[i]);
+  }
+}
+
+static bool is_readable(int fd) {
+#ifndef _WIN32
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+#else
+  return false;
+#endif
+}
+
+static cass::Future* new_future() {
+  cass::Future* future = new cass::Future(cass::CASS_FUTURE_TYPE_RESPONSE);
+  future->inc_ref();
+  return future;
+}
+
+void set_future_thread(void* arg) {
+  static_cast<cass::Future*>(arg)->set();
+}
+
+// Posts a completion from another thread while the drain is clearing the
+// queue's signal
+class PostDuringNextQueue : public cass::CompletionQueue {
+public:
+  PostDuringNextQueue()
+    : future_(NULL) { }
+
+  void set_future_during_next(cass::Future* future) { future_ = future; }
+
+protected:
+  virtual void clear_signal() {
+    if (future_ != NULL) {
+      uv_thread_t thread;
+      uv_thread_create(&thread, set_future_thread, future_);
+      uv_thread_join(&thread);
+      future_ = NULL;
+    }
+    cass::CompletionQueue::clear_signal();
+  }
+
+private:
+  cass::Future* future_;
+};
+
+BOOST_AUTO_TEST_SUITE(completion_queue)
+
+BOOST_AUTO_TEST_CASE(mpsc_simple)
+{
+  cass::MPSCQueue<TestNode> queue;
+  TestNode nodes[16];
+
+  BOOST_CHECK(queue.is_empty());
+  BOOST_CHECK(queue.dequeue() == NULL);
+
+  for (int i = 0; i < 16; ++i) {
+    nodes[i].value = i;
+    queue.enqueue(&nodes[i]);
+  }
+
+  BOOST_CHECK(!queue.is_empty());
+
+  for (int i = 0; i < 16; ++i) {
+    TestNode* node = queue.dequeue();
+    BOOST_REQUIRE(node != NULL);
+    BOOST_CHECK_EQUAL(node->value, i);
+  }
+
+  BOOST_CHECK(queue.dequeue() == NULL);
+
+  // Entries can be reused after they've been dequeued
+  queue.enqueue(&nodes[0]);
+  BOOST_CHECK(queue.dequeue() == &nodes[0]);
+  BOOST_CHECK(queue.dequeue() == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_threads)
+{
+  cass::MPSCQueue<TestNode> queue;
+  std::vector<TestNode> nodes(MPSC_NUM_ENQUEUE_THREADS * MPSC_NUM_ITERATIONS);
+  uv_thread_t threads[MPSC_NUM_ENQUEUE_THREADS];
+  TestEnqueueData data[MPSC_NUM_ENQUEUE_THREADS];
+
+  for (int i = 0; i < MPSC_NUM_ENQUEUE_THREADS; ++i) {
+    data[i].queue = &queue;
+    data[i].nodes = &nodes[i * MPSC_NUM_ITERATIONS];
+    for (int j = 0; j < MPSC_NUM_ITERATIONS; ++j) {
+      data[i].nodes[j].value = j;
+    }
+    uv_thread_create(&threads[i], mpsc_enqueue_thread, &data[i]);
+  }
+
+  // Entries from each producer must be dequeued in order
+  std::vector<int> last(MPSC_NUM_ENQUEUE_THREADS, -1);
+  int count = 0;
+  while (count < MPSC_NUM_ENQUEUE_THREADS * MPSC_NUM_ITERATIONS) {
+    TestNode* node = queue.dequeue();
+    if (node == NULL) continue;
+    int thread = static_cast<int>((node - &nodes[0]) / MPSC_NUM_ITERATIONS);
+    BOOST_REQUIRE(node->value == last[thread] + 1);
+    last[thread] = node->value;
+    ++count;
+  }
+
+  for (int i = 0; i < MPSC_NUM_ENQUEUE_THREADS; ++i) {
+    uv_thread_join(&threads[i]);
+  }
+
+  BOOST_CHECK(queue.dequeue() == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(set_after_attach)
+{
+  CassCompletionQueue* queue = cass_completion_queue_new();
+  BOOST_REQUIRE(queue != NULL);
+
+  int fd = cass_completion_queue_fd(queue);
+  BOOST_CHECK(!is_readable(fd));
+
+  cass::Future* future = new_future();
+  int data = 42;
+  BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(future), queue, &data), CASS_OK);
+  BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(future), queue, &data),
+                    CASS_ERROR_LIB_CALLBACK_ALREADY_SET);
+
+  CassCompletion completion;
+  BOOST_CHECK_EQUAL(cass_completion_queue_next(queue, &completion, 1), 0u);
+
+  future->set();
+#ifndef _WIN32
+  BOOST_CHECK(is_readable(fd));
+#endif
+
+  BOOST_REQUIRE_EQUAL(cass_completion_queue_next(queue, &completion, 1), 1u);
+  BOOST_CHECK(completion.future == CassFuture::to(future));
+  BOOST_CHECK(completion.data == &data);
+
+  // A drain that fills the output re-signals the queue so the next drain
+  // clears it.
+  CassCompletion empty;
+  BOOST_CHECK_EQUAL(cass_completion_queue_next(queue, &empty, 1), 0u);
+  BOOST_CHECK(!is_readable(fd));
+
+  // The queue's reference is returned with the completion
+  BOOST_CHECK_EQUAL(future->ref_count(), 2);
+  cass_future_free(completion.future);
+  cass_future_free(CassFuture::to(future));
+
+  cass_completion_queue_free(queue);
+}
+
+BOOST_AUTO_TEST_CASE(set_before_attach)
+{
+  CassCompletionQueue* queue = cass_completion_queue_new();
+  BOOST_REQUIRE(queue != NULL);
+
+  cass::Future* future = new_future();
+  future->set();
+
+  BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(future), queue, NULL), CASS_OK);
+  // The future can be freed once it's attached
+  cass_future_free(CassFuture::to(future));
+
+  CassCompletion completion;
+  BOOST_REQUIRE_EQUAL(cass_completion_queue_next(queue, &completion, 1), 1u);
+  BOOST_CHECK(completion.future == CassFuture::to(future));
+  BOOST_CHECK(completion.data == NULL);
+  cass_future_free(completion.future);
+
+  cass_completion_queue_free(queue);
+}
+
+BOOST_AUTO_TEST_CASE(drain_limit)
+{
+  CassCompletionQueue* queue = cass_completion_queue_new();
+  BOOST_REQUIRE(queue != NULL);
+
+  int fd = cass_completion_queue_fd(queue);
+
+  cass::Future* futures[8];
+  for (size_t i = 0; i < 8; ++i) {
+    futures[i] = new_future();
+    BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(futures[i]),
+                                                       queue,
+                                                       reinterpret_cast<void*>(i)), CASS_OK);
+  }
+
+  for (size_t i = 0; i < 8; ++i) {
+    futures[i]->set();
+  }
+
+  CassCompletion completions[5];
+  BOOST_REQUIRE_EQUAL(cass_completion_queue_next(queue, completions, 5), 5u);
+  for (size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK(completions[i].data == reinterpret_cast<void*>(i));
+    cass_future_free(completions[i].future);
+  }
+
+  // Still readable because the previous drain stopped at its limit
+#ifndef _WIN32
+  BOOST_CHECK(is_readable(fd));
+#endif
+
+  BOOST_REQUIRE_EQUAL(cass_completion_queue_next(queue, completions, 5), 3u);
+  for (size_t i = 0; i < 3; ++i) {
+    BOOST_CHECK(completions[i].data == reinterpret_cast<void*>(i + 5));
+    cass_future_free(completions[i].future);
+  }
+  BOOST_CHECK(!is_readable(fd));
+
+  for (size_t i = 0; i < 8; ++i) {
+    cass_future_free(CassFuture::to(futures[i]));
+  }
+
+  cass_completion_queue_free(queue);
+}
+
+BOOST_AUTO_TEST_CASE(post_during_next)
+{
+  PostDuringNextQueue* queue = new PostDuringNextQueue();
+  BOOST_REQUIRE_EQUAL(queue->init(), 0);
+  queue->inc_ref();
+
+  int fd = queue->fd();
+
+  cass::Future* futures[3];
+  for (size_t i = 0; i < 3; ++i) {
+    futures[i] = new_future();
+    BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(futures[i]),
+                                                       CassCompletionQueue::to(queue),
+                                                       NULL), CASS_OK);
+  }
+
+  futures[0]->set();
+#ifndef _WIN32
+  BOOST_CHECK(is_readable(fd));
+#endif
+
+  // The second completion is posted by another thread in the middle of the
+  // drain and is returned by it
+  CassCompletion completions[4];
+  queue->set_future_during_next(futures[1]);
+  BOOST_REQUIRE_EQUAL(queue->next(completions, 4), 2u);
+  for (size_t i = 0; i < 2; ++i) {
+    cass_future_free(completions[i].future);
+  }
+  BOOST_CHECK(!is_readable(fd));
+
+  // Completions posted after the drain must still make the descriptor
+  // readable, otherwise an application waiting on it would hang
+  futures[2]->set();
+#ifndef _WIN32
+  BOOST_CHECK(is_readable(fd));
+#endif
+  BOOST_REQUIRE_EQUAL(queue->next(completions, 4), 1u);
+  BOOST_CHECK(completions[0].future == CassFuture::to(futures[2]));
+  cass_future_free(completions[0].future);
+
+  for (size_t i = 0; i < 3; ++i) {
+    cass_future_free(CassFuture::to(futures[i]));
+  }
+
+  queue->dec_ref();
+}
+
+BOOST_AUTO_TEST_CASE(free_with_pending)
+{
+  CassCompletionQueue* queue = cass_completion_queue_new();
+  BOOST_REQUIRE(queue != NULL);
+
+  cass::Future* pending = new_future();
+  cass::Future* posted = new_future();
+  BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(pending), queue, NULL), CASS_OK);
+  BOOST_CHECK_EQUAL(cass_future_set_completion_queue(CassFuture::to(posted), queue, NULL), CASS_OK);
+  posted->set();
+
+  // Pending futures keep the queue alive until they're set and posted
+  // futures are released when the queue is destroyed.
+  cass_completion_queue_free(queue);
+  BOOST_CHECK_EQUAL(posted->ref_count(), 2);
+  pending->set();
+  BOOST_CHECK_EQUAL(posted->ref_count(), 1);
+  BOOST_CHECK_EQUAL(pending->ref_count(), 1);
+
+  cass_future_free(CassFuture::to(pending));
+  cass_future_free(CassFuture::to(posted));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,252 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassconfig.hpp"
+#include "compression.hpp"
+#include "constants.hpp"
+#include "query_request.hpp"
+#include "request_callback.hpp"
+#include "response.hpp"
+#include "scoped_ptr.hpp"
+#include "serialization.hpp"
+#include "startup_request.hpp"
+#include "supported_response.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+// A trivial algorithm that prefixes the body with its length and flips the
+// bits of every byte. It's only used to exercise the framing.
+class InvertCompressor : public cass::Compressor {
+public:
+  virtual const char* name() const { return "invert"; }
+
+  virtual bool uncompressed_length(const char* input, size_t input_size,
+                                   size_t* length) const {
+    if (input_size < sizeof(int32_t)) return false;
+    int32_t temp;
+    cass::decode_int32(const_cast<char*>(input), temp);
+    *length = temp;
+    return input_size - sizeof(int32_t) == *length;
+  }
+
+  virtual bool decompress(const char* input, size_t input_size,
+                          char* output, size_t output_size) const {
+    for (size_t i = 0; i < output_size; ++i) {
+      output[i] = ~input[sizeof(int32_t) + i];
+    }
+    return true;
+  }
+
+protected:
+  virtual size_t max_compressed_length(size_t input_size) const {
+    return sizeof(int32_t) + input_size;
+  }
+
+  virtual bool internal_compress(const char* input, size_t input_size,
+                                 char* output, size_t* output_size) const {
+    cass::encode_int32(output, input_size);
+    for (size_t i = 0; i < input_size; ++i) {
+      output[sizeof(int32_t) + i] = ~input[i];
+    }
+    *output_size = sizeof(int32_t) + input_size;
+    return true;
+  }
+};
+
+class TestRequestCallback : public cass::SimpleRequestCallback {
+public:
+  TestRequestCallback(const cass::Request::ConstPtr& request)
+    : cass::SimpleRequestCallback(request) { }
+
+private:
+  virtual void on_internal_set(cass::ResponseMessage* response) { }
+  virtual void on_internal_error(CassError code, const std::string& message) { }
+  virtual void on_internal_timeout() { }
+};
+
+std::string flatten(const cass::BufferVec& bufs, size_t first = 0) {
+  std::string result;
+  for (size_t i = first; i < bufs.size(); ++i) {
+    result.append(bufs[i].data(), bufs[i].size());
+  }
+  return result;
+}
+
+std::string supported_frame(uint8_t flags, const std::string& body) {
+  cass::Buffer header(CASS_HEADER_SIZE_V3);
+  size_t pos = header.encode_byte(0, 0x84); // Response, version 4
+  pos = header.encode_byte(pos, flags);
+  pos = header.encode_int16(pos, 0);
+  pos = header.encode_byte(pos, CQL_OPCODE_SUPPORTED);
+  header.encode_int32(pos, body.size());
+  return std::string(header.data(), header.size()) + body;
+}
+
+std::string supported_body() {
+  std::vector<std::string> algorithms;
+  algorithms.push_back("snappy");
+  algorithms.push_back("lz4");
+
+  const char* key = "COMPRESSION";
+  size_t length = sizeof(uint16_t) + sizeof(uint16_t) + strlen(key) + sizeof(uint16_t);
+  for (size_t i = 0; i < algorithms.size(); ++i) {
+    length += sizeof(uint16_t) + algorithms[i].size();
+  }
+
+  cass::Buffer buf(length);
+  size_t pos = buf.encode_uint16(0, 1);
+  pos = buf.encode_string(pos, key, strlen(key));
+  buf.encode_string_list(pos, algorithms);
+  return std::string(buf.data(), buf.size());
+}
+
+std::string compress(cass::Compressor* compressor, const std::string& input) {
+  cass::BufferVec bufs;
+  bufs.push_back(cass::Buffer(input.data(), input.size()));
+  cass::Buffer output;
+  BOOST_REQUIRE(compressor->compress(bufs, 0, input.size(), &output));
+  return std::string(output.data(), output.size());
+}
+
+BOOST_AUTO_TEST_SUITE(compression)
+
+BOOST_AUTO_TEST_CASE(encode_request)
+{
+  InvertCompressor compressor;
+  TestRequestCallback callback(cass::Request::ConstPtr(
+                                 new cass::QueryRequest("SELECT * FROM system.local")));
+
+  cass::BufferVec uncompressed;
+  int32_t uncompressed_size = callback.encode(4, 0x00, NULL, &uncompressed);
+  BOOST_REQUIRE(uncompressed_size > 0);
+  BOOST_CHECK((uncompressed[0].data()[1] & CASS_FLAG_COMPRESSION) == 0);
+
+  cass::BufferVec compressed;
+  int32_t compressed_size = callback.encode(4, 0x00, &compressor, &compressed);
+  BOOST_REQUIRE(compressed_size > 0);
+  BOOST_REQUIRE(compressed.size() == 2);
+  BOOST_CHECK((compressed[0].data()[1] & CASS_FLAG_COMPRESSION) != 0);
+
+  // The header's length is the size of the compressed body
+  int32_t length;
+  cass::decode_int32(compressed[0].data() + 5, length);
+  BOOST_CHECK_EQUAL(length, static_cast<int32_t>(compressed[1].size()));
+  BOOST_CHECK_EQUAL(compressed_size, CASS_HEADER_SIZE_V3 + length);
+
+  std::string expected(flatten(uncompressed, 1));
+  size_t body_size = 0;
+  BOOST_REQUIRE(compressor.uncompressed_length(compressed[1].data(), compressed[1].size(),
+                                               &body_size));
+  BOOST_REQUIRE_EQUAL(body_size, expected.size());
+  std::string actual(body_size, '\0');
+  BOOST_REQUIRE(compressor.decompress(compressed[1].data(), compressed[1].size(),
+                                      &actual[0], body_size));
+  BOOST_CHECK(actual == expected);
+}
+
+BOOST_AUTO_TEST_CASE(encode_startup_uncompressed)
+{
+  InvertCompressor compressor;
+  TestRequestCallback callback(cass::Request::ConstPtr(
+                                 new cass::StartupRequest(compressor.name())));
+
+  cass::BufferVec bufs;
+  BOOST_REQUIRE(callback.encode(4, 0x00, &compressor, &bufs) > 0);
+  BOOST_CHECK((bufs[0].data()[1] & CASS_FLAG_COMPRESSION) == 0);
+  BOOST_CHECK(flatten(bufs).find("invert") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(decode_response)
+{
+  InvertCompressor compressor;
+  std::string frame(supported_frame(CASS_FLAG_COMPRESSION,
+                                    compress(&compressor, supported_body())));
+
+  // Decode the frame one byte at a time to verify partial bodies are handled
+  cass::ResponseMessage response(&compressor);
+  for (size_t i = 0; i < frame.size(); ++i) {
+    BOOST_REQUIRE(response.decode(&frame[i], 1) == 1);
+  }
+  BOOST_REQUIRE(response.is_body_ready());
+  BOOST_REQUIRE(response.opcode() == CQL_OPCODE_SUPPORTED);
+
+  cass::SupportedResponse* supported
+      = static_cast<cass::SupportedResponse*>(response.response_body().get());
+  BOOST_CHECK_EQUAL(supported->compression().size(), 2u);
+  BOOST_CHECK(supported->supports_compression("LZ4"));
+  BOOST_CHECK(supported->supports_compression("snappy"));
+  BOOST_CHECK(!supported->supports_compression("invert"));
+}
+
+BOOST_AUTO_TEST_CASE(decode_uncompressed_response)
+{
+  // Uncompressed frames are valid even after compression has been negotiated
+  InvertCompressor compressor;
+  std::string frame(supported_frame(0, supported_body()));
+
+  cass::ResponseMessage response(&compressor);
+  BOOST_REQUIRE(response.decode(&frame[0], frame.size()) == static_cast<ssize_t>(frame.size()));
+  BOOST_REQUIRE(response.is_body_ready());
+}
+
+BOOST_AUTO_TEST_CASE(decode_without_compressor)
+{
+  InvertCompressor compressor;
+  std::string frame(supported_frame(CASS_FLAG_COMPRESSION,
+                                    compress(&compressor, supported_body())));
+
+  cass::ResponseMessage response;
+  BOOST_CHECK(response.decode(&frame[0], frame.size()) < 0);
+}
+
+BOOST_AUTO_TEST_CASE(supported_algorithms)
+{
+  BOOST_CHECK(cass::Compressor::is_supported(CASS_COMPRESSION_NONE));
+  BOOST_CHECK(cass::Compressor::create(CASS_COMPRESSION_NONE) == NULL);
+
+  const CassCompression algorithms[] = { CASS_COMPRESSION_LZ4, CASS_COMPRESSION_SNAPPY };
+  for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); ++i) {
+    cass::ScopedPtr<cass::Compressor> compressor(cass::Compressor::create(algorithms[i]));
+    BOOST_CHECK_EQUAL(cass::Compressor::is_supported(algorithms[i]), compressor.get() != NULL);
+    if (!compressor) continue;
+
+    BOOST_CHECK_EQUAL(std::string(compressor->name()),
+                      std::string(cass::Compressor::to_string(algorithms[i])));
+
+    std::string input;
+    for (int j = 0; j < 1024; ++j) {
+      input.append("a highly compressible frame body ");
+    }
+
+    std::string output(compress(compressor.get(), input));
+    BOOST_CHECK(output.size() < input.size());
+
+    size_t length = 0;
+    BOOST_REQUIRE(compressor->uncompressed_length(output.data(), output.size(), &length));
+    BOOST_REQUIRE_EQUAL(length, input.size());
+    std::string result(length, '\0');
+    BOOST_REQUIRE(compressor->decompress(output.data(), output.size(), &result[0], length));
+    BOOST_CHECK(result == input);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
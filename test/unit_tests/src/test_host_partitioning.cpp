@@ -0,0 +1,161 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cluster.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include <uv.h>
+
+static const size_t NUM_NODES = 4;
+
+// A session where each host has a pool on only one of the IO workers. The
+// hosts are tried in round-robin order so the request's first host is often
+// one that the IO worker that retries it doesn't own.
+struct PartitionedSession {
+  PartitionedSession(const mock::Cluster& mock_cluster)
+    : cluster(cass_cluster_new())
+    , session(cass_session_new()) {
+    cass_cluster_set_contact_points(cluster, mock_cluster.contact_points().c_str());
+    cass_cluster_set_port(cluster, mock_cluster.port());
+    cass_cluster_set_use_schema(cluster, cass_false);
+    cass_cluster_set_load_balance_round_robin(cluster);
+    cass_cluster_set_token_aware_routing(cluster, cass_false);
+    cass_cluster_set_num_threads_io(cluster, NUM_NODES);
+    cass_cluster_set_num_threads_io_per_host(cluster, 1);
+  }
+
+  ~PartitionedSession() {
+    CassFuture* future = cass_session_close(session);
+    cass_future_wait(future);
+    cass_future_free(future);
+    cass_session_free(session);
+    cass_cluster_free(cluster);
+  }
+
+  CassError connect() {
+    CassFuture* future = cass_session_connect(session, cluster);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    return rc;
+  }
+
+  CassError execute(cass_bool_t is_idempotent) {
+    CassStatement* statement = cass_statement_new("SELECT * FROM table1", 0);
+    cass_statement_set_is_idempotent(statement, is_idempotent);
+    CassFuture* future = cass_session_execute(session, statement);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    cass_statement_free(statement);
+    return rc;
+  }
+
+  cass_uint64_t total_connections() {
+    CassMetrics metrics;
+    cass_session_get_metrics(session, &metrics);
+    return metrics.stats.total_connections;
+  }
+
+  CassCluster* cluster;
+  CassSession* session;
+};
+
+BOOST_AUTO_TEST_SUITE(host_partitioning)
+
+// Only the last node can serve requests. The other nodes are bootstrapping
+// so requests are retried on the next host.
+BOOST_AUTO_TEST_CASE(retry_on_host_owned_by_another_worker)
+{
+  mock::Cluster mock_cluster(NUM_NODES);
+  for (size_t i = 0; i < NUM_NODES - 1; ++i) {
+    mock_cluster.settings(i).error_rate = 1.0;
+    mock_cluster.settings(i).error_code = 0x1002; // Bootstrapping
+  }
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  PartitionedSession session(mock_cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  for (int i = 0; i < 4 * static_cast<int>(NUM_NODES); ++i) {
+    BOOST_CHECK_EQUAL(session.execute(cass_false), CASS_OK);
+  }
+  BOOST_CHECK_GE(mock_cluster.request_count(NUM_NODES - 1), 4u * NUM_NODES);
+}
+
+// Only the last node responds quickly. Requests that start on the other
+// nodes finish once a speculative execution reaches it.
+BOOST_AUTO_TEST_CASE(speculative_execution_on_host_owned_by_another_worker)
+{
+  mock::Cluster mock_cluster(NUM_NODES);
+  for (size_t i = 0; i < NUM_NODES - 1; ++i) {
+    mock_cluster.settings(i).latency_ms = 2000;
+  }
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  PartitionedSession session(mock_cluster);
+  cass_cluster_set_constant_speculative_execution_policy(session.cluster, 20, NUM_NODES);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  for (int i = 0; i < 2 * static_cast<int>(NUM_NODES); ++i) {
+    uint64_t start = uv_hrtime();
+    BOOST_CHECK_EQUAL(session.execute(cass_true), CASS_OK);
+    BOOST_CHECK_LT((uv_hrtime() - start) / 1000000, 1000u);
+  }
+  BOOST_CHECK_GE(mock_cluster.request_count(NUM_NODES - 1), 2u * NUM_NODES);
+}
+
+// The IO workers connect to the hosts they don't own for retries and close
+// those connections once they're no longer used
+BOOST_AUTO_TEST_CASE(close_idle_on_demand_pools)
+{
+  mock::Cluster mock_cluster(NUM_NODES);
+  for (size_t i = 0; i < NUM_NODES - 1; ++i) {
+    mock_cluster.settings(i).error_rate = 1.0;
+    mock_cluster.settings(i).error_code = 0x1002; // Bootstrapping
+  }
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  PartitionedSession session(mock_cluster);
+  cass_cluster_set_on_demand_pool_idle_timeout(session.cluster, 100);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  // Each host has a single pool with one connection
+  BOOST_CHECK_EQUAL(session.total_connections(), NUM_NODES);
+
+  for (int i = 0; i < 4 * static_cast<int>(NUM_NODES); ++i) {
+    BOOST_CHECK_EQUAL(session.execute(cass_false), CASS_OK);
+  }
+  BOOST_CHECK_GT(session.total_connections(), NUM_NODES);
+
+  // The on demand pools are closed after two idle timeouts at most
+  uint64_t start = uv_hrtime();
+  while (session.total_connections() > NUM_NODES &&
+         (uv_hrtime() - start) / 1000000 < 5000) {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+  }
+  BOOST_CHECK_EQUAL(session.total_connections(), NUM_NODES);
+
+  // They're created again when they're needed
+  BOOST_CHECK_EQUAL(session.execute(cass_false), CASS_OK);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
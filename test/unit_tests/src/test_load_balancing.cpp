@@ -24,8 +24,10 @@
 #include "latency_aware_policy.hpp"
 #include "loop_thread.hpp"
 #include "murmur3.hpp"
+#include "power_of_two_choices_policy.hpp"
 #include "query_request.hpp"
 #include "request_handler.hpp"
+#include "slow_start_policy.hpp"
 #include "token_aware_policy.hpp"
 #include "whitelist_policy.hpp"
 #include "blacklist_policy.hpp"
@@ -513,7 +515,7 @@ BOOST_AUTO_TEST_CASE(simple)
   // 3.0.0.0  4611686018427387901
   // 4.0.0.0  9223372036854775804
 
-  cass::ScopedPtr<cass::TokenMap> token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()));
+  cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()));
 
   uint64_t partition_size = CASS_UINT64_MAX / num_hosts;
   int64_t token = CASS_INT64_MIN + partition_size;
@@ -590,7 +592,7 @@ BOOST_AUTO_TEST_CASE(network_topology)
   // 6.0.0.0 remote  6588122883467697004
   // 7.0.0.0 local   9223372036854775806
 
-  cass::ScopedPtr<cass::TokenMap> token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()));
+  cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name()));
 
   uint64_t partition_size = CASS_UINT64_MAX / num_hosts;
   int64_t token = CASS_INT64_MIN + partition_size;
@@ -802,6 +804,208 @@ BOOST_AUTO_TEST_CASE(min_average_under_min_measured)
 
 BOOST_AUTO_TEST_SUITE_END() // latency_aware_lb
 
+BOOST_AUTO_TEST_SUITE(power_of_two_choices_lb)
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  cass::HostMap hosts;
+  populate_hosts(4, "rack1", LOCAL_DC, &hosts);
+
+  cass::PowerOfTwoChoicesPolicy policy(new cass::RoundRobinPolicy());
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  // Equally loaded hosts are tried in the child policy's order
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 1, 2, 3, 4 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+
+  // The second host has fewer requests in flight
+  hosts[addr_for_sequence(2)]->update_load(2, 0);
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 3, 2, 4, 1 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+
+  // Pending write bytes break ties
+  hosts[addr_for_sequence(2)]->update_load(-2, 0);
+  hosts[addr_for_sequence(3)]->update_load(0, 1024);
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 4, 3, 1, 2 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+
+  // Only the first two hosts are compared
+  hosts[addr_for_sequence(3)]->update_load(0, -1024);
+  hosts[addr_for_sequence(4)]->update_load(10, 0);
+  hosts[addr_for_sequence(1)]->update_load(20, 0);
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 4, 1, 2, 3 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_before_remote)
+{
+  cass::HostMap hosts;
+  populate_hosts(1, "rack1", LOCAL_DC, &hosts);
+  populate_hosts(1, "rack1", REMOTE_DC, &hosts);
+
+  cass::PowerOfTwoChoicesPolicy policy(new cass::DCAwarePolicy(LOCAL_DC, 1, false));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  // A busy local host is still used before a remote host
+  hosts[addr_for_sequence(1)]->update_load(10, 0);
+  cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+  const size_t seq[] = { 1, 2 };
+  verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // power_of_two_choices_lb
+
+BOOST_AUTO_TEST_SUITE(slow_start_lb)
+
+cass::SlowStartPolicy::Settings slow_start_settings(uint64_t window_ms, double initial_weight) {
+  cass::SlowStartPolicy::Settings settings;
+  settings.window_ns = window_ms * 1000LL * 1000LL;
+  settings.initial_weight = initial_weight;
+  return settings;
+}
+
+void restart_host(const cass::Host::Ptr& host) {
+  host->set_down();
+  host->set_up();
+}
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  cass::HostMap hosts;
+  populate_hosts(4, "rack1", LOCAL_DC, &hosts);
+
+  cass::SlowStartPolicy policy(new cass::RoundRobinPolicy(),
+                               slow_start_settings(60 * 60 * 1000, 0.0));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  // Hosts that have never been down are tried in the child policy's order
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 1, 2, 3, 4 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+
+  // A host that just came back up is tried last
+  restart_host(hosts[addr_for_sequence(2)]);
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    const size_t seq[] = { 3, 4, 1, 2 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(full_weight)
+{
+  cass::HostMap hosts;
+  populate_hosts(4, "rack1", LOCAL_DC, &hosts);
+  restart_host(hosts[addr_for_sequence(1)]);
+
+  // A host starting with its full share of requests is never moved
+  cass::SlowStartPolicy policy(new cass::RoundRobinPolicy(),
+                               slow_start_settings(60 * 60 * 1000, 1.0));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+  const size_t seq[] = { 1, 2, 3, 4 };
+  verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+}
+
+BOOST_AUTO_TEST_CASE(window_elapsed)
+{
+  cass::HostMap hosts;
+  populate_hosts(4, "rack1", LOCAL_DC, &hosts);
+  restart_host(hosts[addr_for_sequence(1)]);
+
+  cass::SlowStartPolicy policy(new cass::RoundRobinPolicy(),
+                               slow_start_settings(1, 0.0));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  uv_sleep(5); // Wait for the window to elapse
+
+  cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+  const size_t seq[] = { 1, 2, 3, 4 };
+  verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+}
+
+BOOST_AUTO_TEST_CASE(weight)
+{
+  cass::HostMap hosts;
+  populate_hosts(2, "rack1", LOCAL_DC, &hosts);
+  const cass::Host::Ptr& host(hosts[addr_for_sequence(1)]);
+  restart_host(host);
+
+  cass::SlowStartPolicy policy(new cass::RoundRobinPolicy(),
+                               slow_start_settings(1000, 0.2));
+  uint64_t up_time_ns = host->up_time_ns();
+  BOOST_REQUIRE(up_time_ns > 0);
+
+  // The weight grows linearly from the initial weight over the window
+  BOOST_CHECK_CLOSE(policy.weight(host, up_time_ns), 0.2, 0.0001);
+  BOOST_CHECK_CLOSE(policy.weight(host, up_time_ns + 500LL * 1000LL * 1000LL), 0.6, 0.0001);
+  BOOST_CHECK_CLOSE(policy.weight(host, up_time_ns + 1000LL * 1000LL * 1000LL), 1.0, 0.0001);
+
+  // A host that has never been down always has its full weight
+  BOOST_CHECK_CLOSE(policy.weight(hosts[addr_for_sequence(2)], up_time_ns), 1.0, 0.0001);
+}
+
+BOOST_AUTO_TEST_CASE(local_before_remote)
+{
+  cass::HostMap hosts;
+  populate_hosts(2, "rack1", LOCAL_DC, &hosts);
+  populate_hosts(1, "rack1", REMOTE_DC, &hosts);
+  restart_host(hosts[addr_for_sequence(1)]);
+
+  cass::SlowStartPolicy policy(new cass::DCAwarePolicy(LOCAL_DC, 1, false),
+                               slow_start_settings(60 * 60 * 1000, 0.0));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  // A warming up local host is still used before a remote host
+  cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+  const size_t seq[] = { 2, 1, 3 };
+  verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+}
+
+BOOST_AUTO_TEST_CASE(partial_weight)
+{
+  cass::HostMap hosts;
+  populate_hosts(2, "rack1", LOCAL_DC, &hosts);
+  restart_host(hosts[addr_for_sequence(1)]);
+
+  cass::SlowStartPolicy policy(new cass::RoundRobinPolicy(),
+                               slow_start_settings(60 * 60 * 1000, 0.5));
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts, NULL);
+
+  // Each query plan makes its own decisions. Round robin puts the warming
+  // up host first in half of the plans and it keeps its place in about half
+  // of those.
+  const int num_plans = 2000;
+  int first_count = 0;
+  for (int i = 0; i < num_plans; ++i) {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, NULL));
+    cass::Host::Ptr host(qp->compute_next());
+    BOOST_REQUIRE(host);
+    if (host->address() == addr_for_sequence(1)) {
+      ++first_count;
+    }
+  }
+  BOOST_CHECK_GT(first_count, num_plans * 15 / 100);
+  BOOST_CHECK_LT(first_count, num_plans * 35 / 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // slow_start_lb
+
 BOOST_AUTO_TEST_SUITE(whitelist_lb)
 
 BOOST_AUTO_TEST_CASE(simple)
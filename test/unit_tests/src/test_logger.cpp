@@ -0,0 +1,136 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "atomic.hpp"
+#include "logger.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <uv.h>
+
+namespace cass {
+void stderr_log_callback(const CassLogMessage* message, void* data);
+} // namespace cass
+
+struct LogCapture {
+  LogCapture()
+    : count(0)
+    , is_blocked(false)
+    , is_other_thread(false) {
+    thread = uv_thread_self();
+  }
+
+  static void on_log(const CassLogMessage* message, void* data) {
+    LogCapture* capture = static_cast<LogCapture*>(data);
+    while (capture->is_blocked.load()) {
+      uv_sleep(1);
+    }
+#if UV_VERSION_MAJOR == 0
+    capture->is_other_thread.store(uv_thread_self() != capture->thread);
+#else
+    uv_thread_t self = uv_thread_self();
+    capture->is_other_thread.store(!uv_thread_equal(&self, &capture->thread));
+#endif
+    capture->count.fetch_add(1);
+  }
+
+  cass::Atomic<int> count;
+  cass::Atomic<bool> is_blocked;
+  cass::Atomic<bool> is_other_thread;
+#if UV_VERSION_MAJOR == 0
+  unsigned long thread;
+#else
+  uv_thread_t thread;
+#endif
+};
+
+// Restores the default logging when a test case is done
+struct LoggerFixture {
+  LoggerFixture() {
+    cass_log_set_level(CASS_LOG_WARN);
+    cass_log_set_callback(LogCapture::on_log, &capture);
+  }
+
+  ~LoggerFixture() {
+    cass_log_stop_async();
+    cass_log_set_rate_limit(CASS_LOG_WARN, 0);
+    cass_log_set_callback(cass::stderr_log_callback, NULL);
+  }
+
+  LogCapture capture;
+};
+
+BOOST_FIXTURE_TEST_SUITE(logger, LoggerFixture)
+
+BOOST_AUTO_TEST_CASE(async)
+{
+  BOOST_REQUIRE_EQUAL(cass_log_start_async(16), CASS_OK);
+  for (int i = 0; i < 10; ++i) {
+    LOG_WARN("Message %d", i);
+  }
+  cass_log_stop_async();
+
+  // All the messages are delivered on the logger thread before it stops
+  BOOST_CHECK_EQUAL(capture.count.load(), 10);
+  BOOST_CHECK(capture.is_other_thread.load());
+}
+
+BOOST_AUTO_TEST_CASE(async_queue_full)
+{
+  CassLogStats before;
+  cass_log_get_stats(&before);
+
+  capture.is_blocked.store(true);
+  BOOST_REQUIRE_EQUAL(cass_log_start_async(4), CASS_OK);
+  for (int i = 0; i < 20; ++i) {
+    LOG_WARN("Message %d", i);
+  }
+  capture.is_blocked.store(false);
+  cass_log_stop_async();
+
+  // Messages are dropped instead of waiting for the blocked callback
+  CassLogStats after;
+  cass_log_get_stats(&after);
+  cass_uint64_t dropped = after.dropped_queue_full - before.dropped_queue_full;
+  BOOST_CHECK_GE(dropped, 16u);
+  BOOST_CHECK_EQUAL(capture.count.load() + dropped, 20u);
+}
+
+BOOST_AUTO_TEST_CASE(rate_limit)
+{
+  CassLogStats before;
+  cass_log_get_stats(&before);
+
+  BOOST_REQUIRE_EQUAL(cass_log_set_rate_limit(CASS_LOG_WARN, 5), CASS_OK);
+  for (int i = 0; i < 20; ++i) {
+    LOG_WARN("Message %d", i);
+  }
+
+  // At most two one second windows are used
+  CassLogStats after;
+  cass_log_get_stats(&after);
+  cass_uint64_t dropped = after.dropped_rate_limited - before.dropped_rate_limited;
+  BOOST_CHECK_GE(dropped, 10u);
+  BOOST_CHECK_EQUAL(capture.count.load() + dropped, 20u);
+
+  BOOST_CHECK_EQUAL(cass_log_set_rate_limit(CASS_LOG_DISABLED, 5), CASS_ERROR_LIB_BAD_PARAMS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
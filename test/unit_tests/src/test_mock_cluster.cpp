@@ -0,0 +1,188 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cluster.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <uv.h>
+
+// Connects a session to the mock cluster using round-robin load balancing
+class MockSession {
+public:
+  MockSession(const mock::Cluster& cluster)
+    : cluster_(cass_cluster_new())
+    , session_(cass_session_new()) {
+    cass_cluster_set_contact_points(cluster_, cluster.contact_points().c_str());
+    cass_cluster_set_port(cluster_, cluster.port());
+    cass_cluster_set_load_balance_round_robin(cluster_);
+    cass_cluster_set_token_aware_routing(cluster_, cass_false);
+    cass_cluster_set_use_schema(cluster_, cass_false);
+  }
+
+  ~MockSession() {
+    CassFuture* future = cass_session_close(session_);
+    cass_future_wait(future);
+    cass_future_free(future);
+    cass_session_free(session_);
+    cass_cluster_free(cluster_);
+  }
+
+  CassError connect() {
+    CassFuture* future = cass_session_connect(session_, cluster_);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    return rc;
+  }
+
+  CassSession* session() { return session_; }
+
+  // Returns the result or NULL if the request failed
+  const CassResult* execute(const CassStatement* statement, CassError* rc = NULL) {
+    CassFuture* future = cass_session_execute(session_, statement);
+    CassError error_code = cass_future_error_code(future);
+    const CassResult* result = NULL;
+    if (error_code == CASS_OK) {
+      result = cass_future_get_result(future);
+    }
+    if (rc != NULL) *rc = error_code;
+    cass_future_free(future);
+    return result;
+  }
+
+  const CassResult* execute(const char* query, CassError* rc = NULL) {
+    CassStatement* statement = cass_statement_new(query, 0);
+    const CassResult* result = execute(statement, rc);
+    cass_statement_free(statement);
+    return result;
+  }
+
+private:
+  CassCluster* cluster_;
+  CassSession* session_;
+};
+
+BOOST_AUTO_TEST_SUITE(mock_cluster)
+
+BOOST_AUTO_TEST_CASE(query)
+{
+  mock::Cluster::Settings settings;
+  settings.row_count = 10;
+  settings.row_size = 100;
+  mock::Cluster cluster(3, settings);
+  BOOST_REQUIRE_EQUAL(cluster.start(), 0);
+
+  MockSession session(cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  const CassResult* result = session.execute("SELECT * FROM table1");
+  BOOST_REQUIRE(result != NULL);
+  BOOST_CHECK_EQUAL(cass_result_row_count(result), 10u);
+  BOOST_CHECK_EQUAL(cass_result_column_count(result), 2u);
+
+  const cass_byte_t* value;
+  size_t value_size;
+  BOOST_REQUIRE_EQUAL(cass_value_get_bytes(cass_row_get_column_by_name(cass_result_first_row(result), "value"),
+                                           &value, &value_size), CASS_OK);
+  BOOST_CHECK_EQUAL(value_size, 100u);
+  cass_result_free(result);
+
+  result = session.execute("INSERT INTO table1 (key, value) VALUES (1, 'a')");
+  BOOST_REQUIRE(result != NULL);
+  BOOST_CHECK_EQUAL(cass_result_row_count(result), 0u);
+  cass_result_free(result);
+
+  // The other nodes are discovered using "system.peers"
+  for (int i = 0; i < 9; ++i) {
+    cass_result_free(session.execute("SELECT * FROM table1"));
+  }
+  for (size_t i = 0; i < cluster.num_nodes(); ++i) {
+    BOOST_CHECK_GT(cluster.request_count(i), 0u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(prepared)
+{
+  mock::Cluster cluster(1);
+  BOOST_REQUIRE_EQUAL(cluster.start(), 0);
+
+  MockSession session(cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  CassFuture* future = cass_session_prepare(session.session(), "SELECT * FROM table1 WHERE key = ?");
+  BOOST_REQUIRE_EQUAL(cass_future_error_code(future), CASS_OK);
+  const CassPrepared* prepared = cass_future_get_prepared(future);
+  cass_future_free(future);
+
+  CassStatement* statement = cass_prepared_bind(prepared);
+  BOOST_REQUIRE_EQUAL(cass_statement_bind_string(statement, 0, "abc"), CASS_OK);
+  const CassResult* result = session.execute(statement);
+  BOOST_REQUIRE(result != NULL);
+  BOOST_CHECK_EQUAL(cass_result_row_count(result), 1u);
+  cass_result_free(result);
+  cass_statement_free(statement);
+  cass_prepared_free(prepared);
+
+  CassBatch* batch = cass_batch_new(CASS_BATCH_TYPE_LOGGED);
+  statement = cass_statement_new("INSERT INTO table1 (key, value) VALUES (1, 'a')", 0);
+  cass_batch_add_statement(batch, statement);
+  future = cass_session_execute_batch(session.session(), batch);
+  BOOST_CHECK_EQUAL(cass_future_error_code(future), CASS_OK);
+  cass_future_free(future);
+  cass_statement_free(statement);
+  cass_batch_free(batch);
+
+  BOOST_CHECK_EQUAL(cluster.request_count(0), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(error_injection)
+{
+  mock::Cluster::Settings settings;
+  settings.error_rate = 1.0;
+  settings.error_code = 0x1002; // Bootstrapping
+  mock::Cluster cluster(1, settings);
+  BOOST_REQUIRE_EQUAL(cluster.start(), 0);
+
+  MockSession session(cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  // The request is tried on the next host but there aren't any
+  CassError rc;
+  BOOST_CHECK(session.execute("SELECT * FROM table1", &rc) == NULL);
+  BOOST_CHECK_EQUAL(rc, CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+}
+
+BOOST_AUTO_TEST_CASE(latency)
+{
+  mock::Cluster::Settings settings;
+  settings.latency_ms = 50;
+  mock::Cluster cluster(1, settings);
+  BOOST_REQUIRE_EQUAL(cluster.start(), 0);
+
+  MockSession session(cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  uint64_t start = uv_hrtime();
+  cass_result_free(session.execute("SELECT * FROM table1"));
+  BOOST_CHECK_GE((uv_hrtime() - start) / 1000000, 50u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
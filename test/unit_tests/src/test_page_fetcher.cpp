@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "constants.hpp"
+#include "page_fetcher.hpp"
+#include "query_request.hpp"
+#include "result_iterator.hpp"
+#include "result_response.hpp"
+#include "serialization.hpp"
+#include "session.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+// A page of rows with a single int column
+struct TestPage {
+  TestPage(int32_t row_count, const std::string& paging_state = std::string())
+    : result(new cass::ResultResponse()) {
+    int32_t flags = CASS_RESULT_FLAG_GLOBAL_TABLESPEC;
+    if (!paging_state.empty()) {
+      flags |= CASS_RESULT_FLAG_HAS_MORE_PAGES;
+    }
+
+    append_int32(CASS_RESULT_KIND_ROWS);
+    append_int32(flags);
+    append_int32(1); // Column count
+    if (!paging_state.empty()) {
+      append_int32(paging_state.size());
+      buffer.append(paging_state);
+    }
+    append_string("keyspace");
+    append_string("table");
+    append_string("value");
+    append_uint16(CASS_VALUE_TYPE_INT);
+
+    append_int32(row_count);
+    for (int32_t i = 0; i < row_count; ++i) {
+      append_int32(sizeof(int32_t));
+      append_int32(i);
+    }
+
+    result->decode(3, &buffer[0], buffer.size());
+  }
+
+  void append_uint16(uint16_t value) {
+    char temp[sizeof(uint16_t)];
+    cass::encode_uint16(temp, value);
+    buffer.append(temp, sizeof(temp));
+  }
+
+  void append_int32(int32_t value) {
+    char temp[sizeof(int32_t)];
+    cass::encode_int32(temp, value);
+    buffer.append(temp, sizeof(temp));
+  }
+
+  void append_string(const std::string& str) {
+    append_uint16(str.size());
+    buffer.append(str);
+  }
+
+  std::string buffer;
+  cass::ResultResponse::Ptr result;
+};
+
+class PagingStateCallback : public cass::RequestCallback {
+public:
+  PagingStateCallback(const cass::Request::ConstPtr& request,
+                      const std::string& paging_state)
+    : request_(request)
+    , paging_state_(paging_state) { }
+
+  virtual const cass::Request* request() const { return request_.get(); }
+  virtual cass::Request::EncodingCache* encoding_cache() { return &encoding_cache_; }
+  virtual const std::string* paging_state() const { return &paging_state_; }
+
+  virtual void on_retry(bool use_next_host) { }
+  virtual void on_set(cass::ResponseMessage* response) { }
+  virtual void on_error(CassError code, const std::string& message) { }
+  virtual void on_cancel() { }
+
+private:
+  virtual void on_start() { }
+
+private:
+  cass::Request::ConstPtr request_;
+  std::string paging_state_;
+  cass::Request::EncodingCache encoding_cache_;
+};
+
+static std::string encode_request(cass::RequestCallback* callback) {
+  cass::BufferVec bufs;
+  callback->request()->encode(3, callback, &bufs);
+  std::string encoded;
+  for (cass::BufferVec::const_iterator it = bufs.begin(),
+       end = bufs.end(); it != end; ++it) {
+    encoded.append(it->data(), it->size());
+  }
+  return encoded;
+}
+
+BOOST_AUTO_TEST_SUITE(page_fetcher)
+
+BOOST_AUTO_TEST_CASE(encode_paging_state)
+{
+  cass::QueryRequest* query = new cass::QueryRequest("SELECT * FROM test");
+  query->set_page_size(100);
+  query->set_paging_state("statement");
+  cass::Request::ConstPtr request(query);
+
+  // Pages fetched in the background don't modify the statement
+  PagingStateCallback callback(request, "background");
+  std::string encoded(encode_request(&callback));
+  BOOST_CHECK(encoded.find("background") != std::string::npos);
+  BOOST_CHECK(encoded.find("statement") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_depth)
+{
+  // The session isn't connected so every page request fails right away,
+  // but the fetcher still tracks the pages it has requested.
+  cass::Session session;
+  cass::Statement::Ptr query(new cass::QueryRequest("SELECT * FROM test"));
+  query->set_page_size(100);
+  cass::PageFetcher::Ptr page_fetcher(
+        new cass::PageFetcher(session.handle(), query.get(), NULL, 2));
+
+  TestPage page1(1, "page2");
+  TestPage page2(1, "page3");
+  TestPage page3(1, "page4");
+  TestPage page4(1);
+
+  // The next two pages are requested right away and the third waits
+  // until the application moves on to the next page.
+  page_fetcher->on_page(page1.result.get());
+  page_fetcher->on_page(page2.result.get());
+  page_fetcher->on_page(page3.result.get());
+
+  cass::ResponseFuture::Ptr futures[3];
+  for (int i = 0; i < 3; ++i) {
+    futures[i] = page_fetcher->next_page();
+    BOOST_REQUIRE(futures[i]);
+    BOOST_CHECK(futures[i]->ready());
+    BOOST_CHECK_EQUAL(futures[i]->error()->code, CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+  }
+
+  page_fetcher->on_page(page4.result.get());
+  BOOST_CHECK(!page_fetcher->next_page());
+}
+
+BOOST_AUTO_TEST_CASE(iterate_single_page)
+{
+  cass::Session session;
+  cass::Statement::Ptr query(new cass::QueryRequest("SELECT * FROM test"));
+  query->set_page_size(100);
+  cass::PageFetcher::Ptr page_fetcher(
+        new cass::PageFetcher(session.handle(), query.get(), NULL, 2));
+
+  TestPage page(3);
+  page.result->set_page_fetcher(page_fetcher);
+  page_fetcher->on_page(page.result.get());
+
+  cass::ResultIterator iterator(page.result.get(), page.result->page_fetcher());
+  int count = 0;
+  while (iterator.next()) {
+    int32_t value;
+    BOOST_CHECK_EQUAL(cass_value_get_int32(
+                        cass_row_get_column(CassRow::to(iterator.row()), 0),
+                        &value), CASS_OK);
+    BOOST_CHECK_EQUAL(value, count);
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 3);
+  BOOST_CHECK_EQUAL(iterator.error_code(), CASS_OK);
+}
+
+BOOST_AUTO_TEST_CASE(iterate_page_error)
+{
+  cass::Session session;
+  cass::Statement::Ptr query(new cass::QueryRequest("SELECT * FROM test"));
+  query->set_page_size(100);
+  cass::PageFetcher::Ptr page_fetcher(
+        new cass::PageFetcher(session.handle(), query.get(), NULL, 1));
+
+  TestPage page(3, "page2");
+  page.result->set_page_fetcher(page_fetcher);
+  page_fetcher->on_page(page.result.get());
+
+  // The rows of the first page are returned before the error
+  cass::ResultIterator iterator(page.result.get(), page.result->page_fetcher());
+  int count = 0;
+  while (iterator.next()) {
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 3);
+  BOOST_CHECK_EQUAL(iterator.error_code(), CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+  BOOST_CHECK(!iterator.error_message().empty());
+}
+
+BOOST_AUTO_TEST_CASE(statement_copy)
+{
+  cass::Session session;
+  cass::Statement::Ptr query(new cass::QueryRequest("SELECT * FROM test", 1));
+  query->set_page_size(100);
+  query->set(cass::StringRef("value"), cass_int32_t(1));
+  cass::PageFetcher::Ptr page_fetcher(
+        new cass::PageFetcher(session.handle(), query.get(), NULL, 1));
+
+  // Changes to the application's statement don't affect the pages that
+  // follow
+  PagingStateCallback callback(page_fetcher->statement(), "page2");
+  BOOST_REQUIRE(callback.request() != query.get());
+  std::string expected(encode_request(&callback));
+  query->set_page_size(10);
+  query->set(cass::StringRef("value"), cass_int32_t(2));
+  query->set_consistency(CASS_CONSISTENCY_ALL);
+  BOOST_CHECK_EQUAL(encode_request(&callback), expected);
+
+  query.reset();
+  BOOST_CHECK_EQUAL(encode_request(&callback), expected);
+}
+
+BOOST_AUTO_TEST_CASE(session_freed)
+{
+  cass::Session* session = new cass::Session();
+  cass::Statement::Ptr query(new cass::QueryRequest("SELECT * FROM test"));
+  query->set_page_size(100);
+  cass::PageFetcher::Ptr page_fetcher(
+        new cass::PageFetcher(session->handle(), query.get(), NULL, 1));
+
+  TestPage page1(1, "page2");
+  TestPage page2(1, "page3");
+
+  page_fetcher->on_page(page1.result.get());
+  page_fetcher->on_page(page2.result.get());
+  delete session;
+
+  // The deferred page is requested after the session is freed
+  for (int i = 0; i < 2; ++i) {
+    cass::ResponseFuture::Ptr future(page_fetcher->next_page());
+    BOOST_REQUIRE(future);
+    BOOST_CHECK_EQUAL(future->error()->code, CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+  }
+  BOOST_CHECK(!page_fetcher->next_page());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cluster.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <uv.h>
+
+#include <vector>
+
+// A single host session whose pools can grow from 1 to 4 connections
+struct PoolSession {
+  PoolSession(const mock::Cluster& mock_cluster, unsigned resize_window_ms)
+    : cluster(cass_cluster_new())
+    , session(cass_session_new()) {
+    cass_cluster_set_contact_points(cluster, mock_cluster.contact_points().c_str());
+    cass_cluster_set_port(cluster, mock_cluster.port());
+    cass_cluster_set_use_schema(cluster, cass_false);
+    cass_cluster_set_num_threads_io(cluster, 1);
+    cass_cluster_set_core_connections_per_host(cluster, 1);
+    cass_cluster_set_max_connections_per_host(cluster, 4);
+    cass_cluster_set_max_concurrent_requests_threshold(cluster, 1);
+    if (resize_window_ms > 0) {
+      cass_cluster_set_connection_pool_resize_window(cluster, resize_window_ms);
+    }
+  }
+
+  ~PoolSession() {
+    CassFuture* future = cass_session_close(session);
+    cass_future_wait(future);
+    cass_future_free(future);
+    cass_session_free(session);
+    cass_cluster_free(cluster);
+  }
+
+  CassError connect() {
+    CassFuture* future = cass_session_connect(session, cluster);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    return rc;
+  }
+
+  // Runs the requests concurrently and waits for all of them
+  void execute_concurrently(size_t num_requests) {
+    std::vector<CassFuture*> futures;
+    CassStatement* statement = cass_statement_new("SELECT * FROM table1", 0);
+    for (size_t i = 0; i < num_requests; ++i) {
+      futures.push_back(cass_session_execute(session, statement));
+    }
+    for (size_t i = 0; i < futures.size(); ++i) {
+      BOOST_CHECK_EQUAL(cass_future_error_code(futures[i]), CASS_OK);
+      cass_future_free(futures[i]);
+    }
+    cass_statement_free(statement);
+  }
+
+  cass_uint64_t total_connections() {
+    CassMetrics metrics;
+    cass_session_get_metrics(session, &metrics);
+    return metrics.stats.total_connections;
+  }
+
+  // Returns the number of connections once it's equal to the expected count
+  // or the last count after the timeout
+  cass_uint64_t wait_for_connections(cass_uint64_t expected, uint64_t timeout_ms) {
+    uint64_t start = uv_hrtime();
+    cass_uint64_t count = total_connections();
+    while (count != expected && (uv_hrtime() - start) / 1000000 < timeout_ms) {
+      uv_sleep(10);
+      count = total_connections();
+    }
+    return count;
+  }
+
+  CassCluster* cluster;
+  CassSession* session;
+};
+
+BOOST_AUTO_TEST_SUITE(pool)
+
+BOOST_AUTO_TEST_CASE(grow_and_drain)
+{
+  mock::Cluster::Settings settings;
+  settings.latency_ms = 100;
+  mock::Cluster mock_cluster(1, settings);
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  PoolSession session(mock_cluster, 100);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+  BOOST_CHECK_EQUAL(session.total_connections(), 1u);
+
+  for (int i = 0; i < 5; ++i) {
+    session.execute_concurrently(20);
+  }
+  BOOST_CHECK_GT(session.total_connections(), 1u);
+
+  // The idle connections are drained back down to the core connections
+  BOOST_CHECK_EQUAL(session.wait_for_connections(1, 5000), 1u);
+
+  // The pool still works after draining
+  session.execute_concurrently(1);
+}
+
+BOOST_AUTO_TEST_CASE(resize_disabled)
+{
+  mock::Cluster::Settings settings;
+  settings.latency_ms = 100;
+  mock::Cluster mock_cluster(1, settings);
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  // Resizing is disabled by default
+  PoolSession session(mock_cluster, 0);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  for (int i = 0; i < 5; ++i) {
+    session.execute_concurrently(20);
+  }
+  uv_sleep(200); // Wait for connections that are still being created
+  cass_uint64_t count = session.total_connections();
+  BOOST_CHECK_GT(count, 1u);
+
+  // Connections are never removed without a resize window
+  uv_sleep(500);
+  BOOST_CHECK_EQUAL(session.total_connections(), count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
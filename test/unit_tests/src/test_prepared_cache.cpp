@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "load_balancing.hpp"
+#include "prepared_cache.hpp"
+#include "session.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(prepared_cache)
+
+BOOST_AUTO_TEST_CASE(entries)
+{
+  cass::PreparedCache cache;
+
+  cass::PreparedCache::Entry::Ptr entry1(cache.get("ks1", "SELECT * FROM t"));
+  BOOST_CHECK(cache.get("ks1", "SELECT * FROM t") == entry1.get());
+  BOOST_CHECK(!(cache.get("ks2", "SELECT * FROM t") == entry1.get()));
+  BOOST_CHECK_EQUAL(cache.size(), 2u);
+
+  // Only the first result is kept
+  cass::Address address1("127.0.0.1", 9042);
+  cass::Address address2("127.0.0.2", 9042);
+  cass::ResultResponse::Ptr result1(new cass::ResultResponse());
+  cass::ResultResponse::Ptr result2(new cass::ResultResponse());
+  BOOST_CHECK(!entry1->result());
+  BOOST_CHECK(entry1->set_result(address1, result1));
+  BOOST_CHECK(!entry1->set_result(address2, result2));
+
+  cass::Address address;
+  BOOST_CHECK(entry1->result(&address) == result1);
+  BOOST_CHECK(address == address1);
+
+  // Statements that haven't been prepared and statements in other
+  // keyspaces aren't returned.
+  cache.get("ks1", "SELECT * FROM u");
+  cass::PreparedCache::EntryVec entries(cache.prepared_entries("ks1"));
+  BOOST_REQUIRE_EQUAL(entries.size(), 1u);
+  BOOST_CHECK(entries[0] == entry1);
+  BOOST_CHECK(cache.prepared_entries("ks2").empty());
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(marked_hosts)
+{
+  cass::PreparedCache cache;
+  cass::Address address1("127.0.0.1", 9042);
+  cass::Address address2("127.0.0.2", 9042);
+
+  cache.mark_host(address1);
+  cache.mark_host(address1);
+  BOOST_CHECK(!cache.unmark_host(address2));
+  BOOST_CHECK(cache.unmark_host(address1));
+
+  // Hosts are only prepared once per mark
+  BOOST_CHECK(!cache.unmark_host(address1));
+}
+
+BOOST_AUTO_TEST_CASE(single_host_query_plan)
+{
+  cass::Host::Ptr host(new cass::Host(cass::Address("127.0.0.1", 9042), false));
+  cass::SingleHostQueryPlan plan(host);
+  BOOST_CHECK(plan.compute_next() == host.get());
+  BOOST_CHECK(!plan.compute_next());
+}
+
+BOOST_AUTO_TEST_CASE(not_connected)
+{
+  // Failed prepares aren't cached
+  cass::Session session;
+  for (int i = 0; i < 2; ++i) {
+    cass::Future::Ptr future(session.prepare_cached("SELECT * FROM t", 15));
+    BOOST_REQUIRE(future->ready());
+    BOOST_CHECK_EQUAL(future->error()->code, CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+  }
+  BOOST_CHECK_EQUAL(session.prepared_cache().size(), 1u);
+  BOOST_CHECK(session.prepared_cache().prepared_entries("").empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,92 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "random.hpp"
+#include "reconnection_policy.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(reconnection_policy)
+
+BOOST_AUTO_TEST_CASE(constant)
+{
+  cass::ConstantReconnectionPolicy policy(2000);
+  cass::Random random;
+  cass::ReconnectionSchedule::Ptr schedule(policy.new_schedule(&random));
+  for (int i = 0; i < 10; ++i) {
+    BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 2000u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(exponential)
+{
+  cass::ExponentialReconnectionPolicy policy(100, 1000);
+
+  // Without a random number generator there's no jitter
+  cass::ReconnectionSchedule::Ptr schedule(policy.new_schedule(NULL));
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 100u);
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 200u);
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 400u);
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 800u);
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 1000u);
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 1000u);
+
+  // A new schedule starts from the base delay
+  schedule.reset(policy.new_schedule(NULL));
+  BOOST_CHECK_EQUAL(schedule->next_delay_ms(), 100u);
+}
+
+BOOST_AUTO_TEST_CASE(exponential_jitter)
+{
+  cass::ExponentialReconnectionPolicy policy(100, 1000);
+  cass::Random random;
+
+  bool is_jittered = false;
+  for (int i = 0; i < 100; ++i) {
+    cass::ReconnectionSchedule::Ptr schedule(policy.new_schedule(&random));
+    uint64_t expected = 100;
+    for (int j = 0; j < 6; ++j) {
+      uint64_t delay_ms = schedule->next_delay_ms();
+      BOOST_CHECK_GE(delay_ms, expected / 2);
+      BOOST_CHECK_LE(delay_ms, expected);
+      if (delay_ms != expected) is_jittered = true;
+      expected = expected * 2 > 1000 ? 1000 : expected * 2;
+    }
+  }
+  BOOST_CHECK(is_jittered);
+}
+
+BOOST_AUTO_TEST_CASE(exponential_overflow)
+{
+  const uint64_t max_delay_ms = CASS_UINT64_MAX - 1;
+  cass::ExponentialReconnectionPolicy policy(1, max_delay_ms);
+  cass::ReconnectionSchedule::Ptr schedule(policy.new_schedule(NULL));
+
+  uint64_t last = 0;
+  for (int i = 0; i < 100; ++i) {
+    uint64_t delay_ms = schedule->next_delay_ms();
+    BOOST_CHECK_GE(delay_ms, last);
+    last = delay_ms;
+  }
+  BOOST_CHECK_EQUAL(last, max_delay_ms);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
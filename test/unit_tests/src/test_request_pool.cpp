@@ -0,0 +1,345 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "load_balancing.hpp"
+#include "query_request.hpp"
+#include "request_handler.hpp"
+#include "request_pool.hpp"
+#include "round_robin_policy.hpp"
+#include "scoped_ptr.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <uv.h>
+#include <vector>
+
+const int NUM_BENCHMARK_REQUESTS = 200000;
+const int NUM_BENCHMARK_IN_FLIGHT = 512;
+
+static size_t request_block_size() {
+  return cass::RequestBlock::allocation_size(sizeof(cass::ResponseFuture)) +
+      cass::RequestBlock::allocation_size(sizeof(cass::RequestHandler)) +
+      cass::RequestBlock::allocation_size(sizeof(cass::SpeculativeExecution));
+}
+
+// An object with the same allocation as the objects stored in request blocks
+struct TestObject : public cass::RequestBlockAllocated {
+  char data[100];
+};
+
+// A chained query plan that records when it's destroyed
+class TestQueryPlan : public cass::QueryPlan {
+public:
+  TestQueryPlan(const std::string& name, cass::QueryPlan* child_plan,
+                std::vector<std::string>* destroyed)
+    : name_(name)
+    , child_plan_(child_plan)
+    , destroyed_(destroyed) { }
+
+  ~TestQueryPlan() {
+    destroyed_->push_back(name_);
+  }
+
+  virtual cass::Host::Ptr compute_next() {
+    return child_plan_ ? child_plan_->compute_next() : cass::Host::Ptr();
+  }
+
+private:
+  std::string name_;
+  cass::ScopedPtr<cass::QueryPlan> child_plan_;
+  std::vector<std::string>* destroyed_;
+};
+
+struct TestRequest {
+  cass::ResponseFuture::Ptr future;
+  cass::RequestHandler::Ptr request_handler;
+};
+
+// Runs the same allocations as Session::execute() and
+// IOWorker::process_request().
+static void start_request(const cass::Request::ConstPtr& request,
+                          cass::RequestPool* pool,
+                          TestRequest* test_request) {
+  cass::RequestBlock* block = pool != NULL ? pool->acquire() : NULL;
+
+  test_request->future.reset(new (block) cass::ResponseFuture());
+  test_request->request_handler.reset(
+        new (block) cass::RequestHandler(request, test_request->future, NULL));
+  if (block != NULL) block->dec_ref();
+
+  cass::SpeculativeExecution::Ptr speculative_execution(
+        new (test_request->request_handler->block())
+        cass::SpeculativeExecution(test_request->request_handler));
+}
+
+static void finish_request(TestRequest* test_request) {
+  test_request->request_handler->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT,
+                                           "Request timed out");
+  test_request->request_handler.reset();
+  test_request->future.reset();
+}
+
+// Returns the average time per request with "in_flight" requests
+// outstanding at a time
+static uint64_t benchmark_requests(const cass::Request::ConstPtr& request,
+                                   cass::RequestPool* pool,
+                                   int in_flight) {
+  std::vector<TestRequest> test_requests(in_flight);
+  uint64_t start = uv_hrtime();
+  for (int i = 0; i < NUM_BENCHMARK_REQUESTS; i += in_flight) {
+    for (int j = 0; j < in_flight; ++j) {
+      start_request(request, pool, &test_requests[j]);
+    }
+    for (int j = 0; j < in_flight; ++j) {
+      finish_request(&test_requests[j]);
+    }
+  }
+  return (uv_hrtime() - start) / NUM_BENCHMARK_REQUESTS;
+}
+
+BOOST_AUTO_TEST_SUITE(request_pool)
+
+BOOST_AUTO_TEST_CASE(fused)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(request_block_size(), 16));
+  cass::Request::ConstPtr request(new cass::QueryRequest("SELECT * FROM test"));
+
+  cass::RequestBlock* block = pool->acquire();
+
+  cass::ResponseFuture::Ptr future(new (block) cass::ResponseFuture());
+  cass::RequestHandler::Ptr request_handler(
+        new (block) cass::RequestHandler(request, future, NULL));
+  block->dec_ref();
+
+  cass::SpeculativeExecution::Ptr first(
+        new (request_handler->block()) cass::SpeculativeExecution(request_handler));
+  // The block is sized for a single execution so the next one uses the heap
+  cass::SpeculativeExecution::Ptr second(
+        new (request_handler->block()) cass::SpeculativeExecution(request_handler));
+
+  BOOST_CHECK(cass::RequestBlock::from(future.get()) == block);
+  BOOST_CHECK(request_handler->block() == block);
+  BOOST_CHECK(cass::RequestBlock::from(first.get()) == block);
+  BOOST_CHECK(cass::RequestBlock::from(second.get()) == NULL);
+
+  request_handler->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT, "Request timed out");
+  BOOST_CHECK(future->ready());
+
+  first.reset();
+  second.reset();
+  request_handler.reset();
+  future.reset();
+
+  // The block is returned to the pool once all of its objects are released
+  BOOST_CHECK(pool->acquire() == block);
+  block->dec_ref();
+
+  BOOST_CHECK_EQUAL(pool->blocks_allocated(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(heap)
+{
+  cass::Request::ConstPtr request(new cass::QueryRequest("SELECT * FROM test"));
+
+  cass::ResponseFuture::Ptr future(new cass::ResponseFuture());
+  cass::RequestHandler::Ptr request_handler(
+        new cass::RequestHandler(request, future, NULL));
+
+  BOOST_CHECK(cass::RequestBlock::from(future.get()) == NULL);
+  BOOST_CHECK(request_handler->block() == NULL);
+
+  request_handler->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT, "Request timed out");
+}
+
+BOOST_AUTO_TEST_CASE(future_outlives_pool)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(request_block_size(), 16));
+  cass::Request::ConstPtr request(new cass::QueryRequest("SELECT * FROM test"));
+
+  cass::RequestBlock* block = pool->acquire();
+  cass::ResponseFuture::Ptr future(new (block) cass::ResponseFuture());
+  block->dec_ref();
+
+  // The block keeps the pool alive until the future is released
+  cass::RequestPool* temp = pool.get();
+  pool.reset();
+  BOOST_CHECK_EQUAL(temp->ref_count(), 1);
+
+  future.reset();
+}
+
+BOOST_AUTO_TEST_CASE(full_cache)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(request_block_size(), 2));
+
+  cass::RequestBlock* blocks[4];
+  for (int i = 0; i < 4; ++i) {
+    blocks[i] = pool->acquire();
+  }
+
+  // Blocks that don't fit in the cache are freed
+  for (int i = 0; i < 4; ++i) {
+    blocks[i]->dec_ref();
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    blocks[i] = pool->acquire();
+  }
+  for (int i = 0; i < 4; ++i) {
+    blocks[i]->dec_ref();
+  }
+
+  BOOST_CHECK_EQUAL(pool->blocks_allocated(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE(block_exhaustion)
+{
+  size_t size = cass::RequestBlock::allocation_size(sizeof(TestObject));
+  cass::RequestPool::Ptr pool(new cass::RequestPool(2 * size + size / 2, 16));
+
+  cass::RequestBlock* block = pool->acquire();
+  TestObject* objects[4];
+  for (int i = 0; i < 4; ++i) {
+    objects[i] = new (block) TestObject();
+  }
+  block->dec_ref();
+
+  // Only two objects fit. The partial space left at the end of the block
+  // isn't used and the rest of the objects fall back to the heap.
+  BOOST_CHECK(cass::RequestBlock::from(objects[0]) == block);
+  BOOST_CHECK(cass::RequestBlock::from(objects[1]) == block);
+  BOOST_CHECK(cass::RequestBlock::from(objects[2]) == NULL);
+  BOOST_CHECK(cass::RequestBlock::from(objects[3]) == NULL);
+  BOOST_CHECK_EQUAL(reinterpret_cast<char*>(objects[1]) -
+                    reinterpret_cast<char*>(objects[0]),
+                    static_cast<ptrdiff_t>(size));
+
+  // The block is returned to the pool after its last object is destroyed.
+  // The heap objects don't hold a reference to it.
+  delete objects[0];
+  delete objects[1];
+  cass::RequestBlock* temp = pool->acquire();
+  BOOST_CHECK(temp == block);
+
+  // The block's space is available again
+  TestObject* object = new (temp) TestObject();
+  BOOST_CHECK(cass::RequestBlock::from(object) == block);
+  temp->dec_ref();
+
+  delete object;
+  delete objects[2];
+  delete objects[3];
+  BOOST_CHECK_EQUAL(pool->blocks_allocated(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(query_plan_destructor_order)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(cass::QueryPlan::BLOCK_SIZE, 16));
+  std::vector<std::string> destroyed;
+
+  cass::RequestBlock* block = pool->acquire();
+  cass::QueryPlan* child = new (block) TestQueryPlan("child", NULL, &destroyed);
+  cass::ScopedPtr<cass::QueryPlan> plan(
+        new (block) TestQueryPlan("parent", child, &destroyed));
+  block->dec_ref();
+
+  BOOST_CHECK(cass::RequestBlock::from(child) == block);
+  BOOST_CHECK(cass::RequestBlock::from(plan.get()) == block);
+
+  // Chained plans are destroyed from the outside in and the block is only
+  // released after the innermost plan is destroyed
+  plan.reset();
+  BOOST_REQUIRE_EQUAL(destroyed.size(), 2u);
+  BOOST_CHECK_EQUAL(destroyed[0], "parent");
+  BOOST_CHECK_EQUAL(destroyed[1], "child");
+
+  cass::RequestBlock* temp = pool->acquire();
+  BOOST_CHECK(temp == block);
+  temp->dec_ref();
+  BOOST_CHECK_EQUAL(pool->blocks_allocated(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(query_plan_in_request_block)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(request_block_size() +
+                                                    cass::QueryPlan::BLOCK_SIZE, 16));
+  cass::Request::ConstPtr request(new cass::QueryRequest("SELECT * FROM test"));
+
+  cass::HostMap hosts;
+  cass::Address address("127.0.0.1", 9042);
+  cass::Host::Ptr host(new cass::Host(address, false));
+  host->set_up();
+  hosts[address] = host;
+  cass::RoundRobinPolicy policy;
+  policy.init(cass::Host::Ptr(), hosts, NULL);
+
+  cass::RequestBlock* block = pool->acquire();
+  cass::ResponseFuture::Ptr future(new (block) cass::ResponseFuture());
+  cass::RequestHandler::Ptr request_handler(
+        new (block) cass::RequestHandler(request, future, NULL));
+  block->dec_ref();
+
+  // The plan is built in the space reserved after the request's objects
+  cass::QueryPlan* plan = policy.new_query_plan("ks", request_handler.get(), NULL);
+  BOOST_CHECK(cass::RequestBlock::from(plan) == block);
+  request_handler->set_query_plan(plan);
+  BOOST_CHECK(request_handler->next_host().get() == host.get());
+
+  // A plan for a request without a block is allocated from the heap
+  cass::ScopedPtr<cass::QueryPlan> heap_plan(policy.new_query_plan("ks", NULL, NULL));
+  BOOST_CHECK(cass::RequestBlock::from(heap_plan.get()) == NULL);
+
+  request_handler->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT, "Request timed out");
+  request_handler.reset();
+  future.reset();
+
+  // The plan was destroyed with its request handler so the block is reused
+  cass::RequestBlock* temp = pool->acquire();
+  BOOST_CHECK(temp == block);
+  temp->dec_ref();
+}
+
+BOOST_AUTO_TEST_CASE(benchmark)
+{
+  cass::RequestPool::Ptr pool(new cass::RequestPool(request_block_size(),
+                                                    NUM_BENCHMARK_IN_FLIGHT));
+  cass::Request::ConstPtr request(new cass::QueryRequest("SELECT * FROM test"));
+
+  int in_flight[] = { 1, NUM_BENCHMARK_IN_FLIGHT };
+
+  for (size_t i = 0; i < sizeof(in_flight) / sizeof(in_flight[0]); ++i) {
+    uint64_t heap_ns = benchmark_requests(request, NULL, in_flight[i]);
+    uint64_t pooled_ns = benchmark_requests(request, pool.get(), in_flight[i]);
+
+    // The heap path makes an allocation for each of the future, the
+    // request handler and the speculative execution. The pooled path only
+    // allocates a block when there isn't one cached.
+    BOOST_TEST_MESSAGE("Request lifecycle (" << in_flight[i] << " in flight): "
+                       << "heap " << heap_ns << " ns/request (3 allocations/request), "
+                       << "pooled " << pooled_ns << " ns/request ("
+                       << pool->blocks_allocated() << " allocations total)");
+  }
+
+  BOOST_CHECK_EQUAL(pool->blocks_allocated(),
+                    static_cast<size_t>(NUM_BENCHMARK_IN_FLIGHT));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
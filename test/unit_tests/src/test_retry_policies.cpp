@@ -18,6 +18,7 @@
 #   define BOOST_TEST_MODULE cassandra
 #endif
 
+#include "retry_budget.hpp"
 #include "retry_policy.hpp"
 
 #include <boost/test/unit_test.hpp>
@@ -226,4 +227,33 @@ BOOST_AUTO_TEST_CASE(logging)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(retry_budget)
 
+BOOST_AUTO_TEST_CASE(simple)
+{
+  cass::RetryBudget budget(0.5, 2);
+  BOOST_CHECK_CLOSE(budget.available_tokens(), 2.0, 0.001);
+
+  // The budget starts full
+  BOOST_CHECK(budget.try_withdraw());
+  BOOST_CHECK(budget.try_withdraw());
+  BOOST_CHECK(!budget.try_withdraw());
+
+  // Two successful requests refill a token
+  budget.deposit();
+  BOOST_CHECK(!budget.try_withdraw());
+  budget.deposit();
+  BOOST_CHECK(budget.try_withdraw());
+  BOOST_CHECK(!budget.try_withdraw());
+}
+
+BOOST_AUTO_TEST_CASE(max_tokens)
+{
+  cass::RetryBudget budget(0.5, 2);
+  for (int i = 0; i < 100; ++i) {
+    budget.deposit();
+  }
+  BOOST_CHECK_CLOSE(budget.available_tokens(), 2.0, 0.001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,290 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "constants.hpp"
+#include "query_request.hpp"
+#include "request_callback.hpp"
+#include "response.hpp"
+#include "result_response.hpp"
+#include "row.hpp"
+#include "row_stream.hpp"
+#include "serialization.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Rows with an int and a text column
+struct StreamedRowsBody {
+  StreamedRowsBody(int32_t row_count, int32_t extra_rows = 0)
+    : max_row_size(0) {
+    append_int32(CASS_RESULT_KIND_ROWS);
+    append_int32(CASS_RESULT_FLAG_GLOBAL_TABLESPEC);
+    append_int32(2); // Column count
+    append_string("keyspace");
+    append_string("table");
+    append_string("key");
+    append_uint16(CASS_VALUE_TYPE_INT);
+    append_string("value");
+    append_uint16(CASS_VALUE_TYPE_VARCHAR);
+    metadata_size = buffer.size() + sizeof(int32_t);
+
+    append_int32(row_count);
+    for (int32_t i = 0; i < row_count + extra_rows; ++i) {
+      append_int32(sizeof(int32_t));
+      append_int32(i);
+      std::string value(text(i));
+      append_int32(value.size());
+      buffer.append(value);
+      max_row_size = std::max(max_row_size, 3 * sizeof(int32_t) + value.size());
+    }
+  }
+
+  static std::string text(int32_t i) {
+    return std::string(static_cast<size_t>(i % 50), 'a' + (i % 26));
+  }
+
+  void append_uint16(uint16_t value) {
+    char temp[sizeof(uint16_t)];
+    cass::encode_uint16(temp, value);
+    buffer.append(temp, sizeof(temp));
+  }
+
+  void append_int32(int32_t value) {
+    char temp[sizeof(int32_t)];
+    cass::encode_int32(temp, value);
+    buffer.append(temp, sizeof(temp));
+  }
+
+  void append_string(const std::string& str) {
+    append_uint16(str.size());
+    buffer.append(str);
+  }
+
+  std::string buffer;
+  size_t metadata_size;
+  size_t max_row_size;
+};
+
+class RowStreamCallback : public cass::RequestCallback {
+public:
+  RowStreamCallback()
+    : request_(new cass::QueryRequest("SELECT * FROM test"))
+    , metadata_count(0)
+    , is_valid(true) { }
+
+  virtual const cass::Request* request() const { return request_.get(); }
+  virtual cass::Request::EncodingCache* encoding_cache() { return &encoding_cache_; }
+
+  virtual bool is_streaming_rows() const { return true; }
+
+  virtual void on_row_stream_metadata(cass::ResultResponse* result) {
+    ++metadata_count;
+  }
+
+  virtual void on_row(const cass::Row* row) {
+    int32_t key;
+    const char* value;
+    size_t value_length;
+    if (cass_value_get_int32(cass_row_get_column(CassRow::to(row), 0), &key) != CASS_OK ||
+        cass_value_get_string(cass_row_get_column(CassRow::to(row), 1),
+                              &value, &value_length) != CASS_OK ||
+        key != static_cast<int32_t>(keys.size()) ||
+        std::string(value, value_length) != StreamedRowsBody::text(key)) {
+      is_valid = false;
+    }
+    keys.push_back(key);
+  }
+
+  virtual void on_retry(bool use_next_host) { }
+  virtual void on_set(cass::ResponseMessage* response) { }
+  virtual void on_error(CassError code, const std::string& message) { }
+  virtual void on_cancel() { }
+
+private:
+  virtual void on_start() { }
+
+private:
+  cass::Request::ConstPtr request_;
+  cass::Request::EncodingCache encoding_cache_;
+
+public:
+  int metadata_count;
+  bool is_valid;
+  std::vector<int32_t> keys;
+};
+
+static std::string streamed_rows_frame(const std::string& body) {
+  std::string frame;
+  frame.push_back(static_cast<char>(0x83)); // Version 3 response
+  frame.push_back(0); // Flags
+  char temp[sizeof(int32_t)];
+  cass::encode_int16(temp, 1); // Stream
+  frame.append(temp, sizeof(int16_t));
+  frame.push_back(CQL_OPCODE_RESULT);
+  cass::encode_int32(temp, body.size());
+  frame.append(temp, sizeof(int32_t));
+  frame.append(body);
+  return frame;
+}
+
+BOOST_AUTO_TEST_SUITE(row_stream)
+
+BOOST_AUTO_TEST_CASE(stream_in_chunks)
+{
+  const int32_t row_count = 1000;
+  StreamedRowsBody body(row_count);
+
+  size_t chunk_sizes[] = { 1, 3, 7, 64, 1500 };
+  for (size_t i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++i) {
+    cass::ResultResponse::Ptr result(new cass::ResultResponse());
+    RowStreamCallback* callback = new RowStreamCallback();
+    cass::RequestCallback::Ptr callback_ptr(callback);
+    cass::RowStream stream(3, result.get(), callback_ptr);
+
+    for (size_t pos = 0; pos < body.buffer.size(); pos += chunk_sizes[i]) {
+      size_t size = std::min(chunk_sizes[i], body.buffer.size() - pos);
+      BOOST_REQUIRE(stream.decode(&body.buffer[pos], size));
+    }
+    BOOST_REQUIRE(stream.finish());
+
+    BOOST_CHECK_EQUAL(callback->metadata_count, 1);
+    BOOST_CHECK_EQUAL(callback->keys.size(), static_cast<size_t>(row_count));
+    BOOST_CHECK(callback->is_valid);
+
+    // Only the metadata and a single chunk or row are ever buffered
+    BOOST_CHECK_LE(stream.max_buffered(),
+                   body.metadata_size + std::max(chunk_sizes[i], body.max_row_size));
+
+    BOOST_CHECK_EQUAL(result->kind(), CASS_RESULT_KIND_ROWS);
+    BOOST_CHECK_EQUAL(result->column_count(), 2);
+    BOOST_CHECK_EQUAL(result->row_count(), 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(rows_before_body_complete)
+{
+  StreamedRowsBody body(100);
+
+  cass::ResultResponse::Ptr result(new cass::ResultResponse());
+  RowStreamCallback* callback = new RowStreamCallback();
+  cass::RequestCallback::Ptr callback_ptr(callback);
+  cass::RowStream stream(3, result.get(), callback_ptr);
+
+  size_t half = body.buffer.size() / 2;
+  BOOST_REQUIRE(stream.decode(&body.buffer[0], half));
+  BOOST_CHECK_EQUAL(callback->metadata_count, 1);
+  BOOST_CHECK_GT(callback->keys.size(), 0u);
+  BOOST_CHECK_LT(callback->keys.size(), 100u);
+
+  // The body isn't complete
+  BOOST_CHECK(!stream.finish());
+
+  BOOST_REQUIRE(stream.decode(&body.buffer[half], body.buffer.size() - half));
+  BOOST_CHECK(stream.finish());
+  BOOST_CHECK_EQUAL(callback->keys.size(), 100u);
+  BOOST_CHECK(callback->is_valid);
+}
+
+BOOST_AUTO_TEST_CASE(too_many_rows)
+{
+  StreamedRowsBody body(10, 1);
+
+  cass::ResultResponse::Ptr result(new cass::ResultResponse());
+  cass::RowStream stream(3, result.get(),
+                         cass::RequestCallback::Ptr(new RowStreamCallback()));
+  BOOST_CHECK(!stream.decode(&body.buffer[0], body.buffer.size()));
+}
+
+BOOST_AUTO_TEST_CASE(buffer_other_results)
+{
+  StreamedRowsBody body(0);
+  body.buffer.clear();
+  body.append_int32(CASS_RESULT_KIND_SET_KEYSPACE);
+  body.append_string("keyspace1");
+
+  cass::ResultResponse::Ptr result(new cass::ResultResponse());
+  RowStreamCallback* callback = new RowStreamCallback();
+  cass::RequestCallback::Ptr callback_ptr(callback);
+  cass::RowStream stream(3, result.get(), callback_ptr);
+
+  for (size_t pos = 0; pos < body.buffer.size(); ++pos) {
+    BOOST_REQUIRE(stream.decode(&body.buffer[pos], 1));
+  }
+  BOOST_REQUIRE(stream.finish());
+  BOOST_CHECK_EQUAL(callback->metadata_count, 0);
+  BOOST_CHECK_EQUAL(result->kind(), CASS_RESULT_KIND_SET_KEYSPACE);
+  BOOST_CHECK(result->keyspace() == "keyspace1");
+}
+
+BOOST_AUTO_TEST_CASE(response_message)
+{
+  StreamedRowsBody body(100);
+  std::string frame(streamed_rows_frame(body.buffer));
+
+  RowStreamCallback* callback = new RowStreamCallback();
+  cass::RequestCallback::Ptr callback_ptr(callback);
+
+  // The message stops after the header so the body can be streamed
+  cass::ResponseMessage response;
+  BOOST_REQUIRE_EQUAL(response.decode(&frame[0], frame.size()),
+                      static_cast<ssize_t>(CASS_HEADER_SIZE_V3));
+  BOOST_REQUIRE(response.is_row_stream_pending());
+  response.start_row_stream(callback_ptr);
+
+  for (size_t pos = CASS_HEADER_SIZE_V3; pos < frame.size(); ++pos) {
+    BOOST_REQUIRE_EQUAL(response.decode(&frame[pos], 1), 1);
+  }
+  BOOST_REQUIRE(response.is_body_ready());
+  BOOST_CHECK_EQUAL(callback->keys.size(), 100u);
+  BOOST_CHECK(callback->is_valid);
+
+  cass::ResultResponse* result
+      = static_cast<cass::ResultResponse*>(response.response_body().get());
+  BOOST_CHECK_EQUAL(result->row_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(response_message_buffered)
+{
+  StreamedRowsBody body(100);
+  std::string frame(streamed_rows_frame(body.buffer));
+
+  // The frame is followed by the start of another frame
+  frame.append(frame.substr(0, 4));
+
+  cass::ResponseMessage response;
+  BOOST_REQUIRE_EQUAL(response.decode(&frame[0], frame.size()),
+                      static_cast<ssize_t>(CASS_HEADER_SIZE_V3));
+  BOOST_REQUIRE(response.is_row_stream_pending());
+  response.start_row_stream(cass::RequestCallback::Ptr());
+
+  BOOST_REQUIRE_EQUAL(response.decode(&frame[CASS_HEADER_SIZE_V3],
+                                      frame.size() - CASS_HEADER_SIZE_V3),
+                      static_cast<ssize_t>(body.buffer.size()));
+  BOOST_REQUIRE(response.is_body_ready());
+
+  cass::ResultResponse* result
+      = static_cast<cass::ResultResponse*>(response.response_body().get());
+  BOOST_CHECK_EQUAL(result->row_count(), 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
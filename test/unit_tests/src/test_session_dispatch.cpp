@@ -0,0 +1,194 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cluster.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include <vector>
+
+static const size_t NUM_THREADS = 4;
+static const size_t NUM_REQUESTS = 250;
+
+// A session with several IO workers so that requests are enqueued directly
+// on the IO workers from many application threads at once
+struct DispatchSession {
+  DispatchSession(const mock::Cluster& mock_cluster)
+    : cluster(cass_cluster_new())
+    , session(cass_session_new()) {
+    cass_cluster_set_contact_points(cluster, mock_cluster.contact_points().c_str());
+    cass_cluster_set_port(cluster, mock_cluster.port());
+    cass_cluster_set_use_schema(cluster, cass_false);
+    cass_cluster_set_load_balance_round_robin(cluster);
+    cass_cluster_set_token_aware_routing(cluster, cass_false);
+    cass_cluster_set_num_threads_io(cluster, NUM_THREADS);
+  }
+
+  ~DispatchSession() {
+    close();
+    cass_session_free(session);
+    cass_cluster_free(cluster);
+  }
+
+  CassError connect() {
+    CassFuture* future = cass_session_connect(session, cluster);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    return rc;
+  }
+
+  CassError close() {
+    CassFuture* future = cass_session_close(session);
+    CassError rc = cass_future_error_code(future);
+    cass_future_free(future);
+    return rc;
+  }
+
+  CassCluster* cluster;
+  CassSession* session;
+};
+
+// Executes requests without waiting for them and records the result of
+// each one once they've all been started
+struct ExecuteRequests {
+  ExecuteRequests(CassSession* session, std::vector<CassError>* results)
+    : session(session)
+    , results(results) { }
+
+  void operator()() {
+    CassStatement* statement = cass_statement_new("SELECT * FROM table1", 0);
+    std::vector<CassFuture*> futures;
+    for (size_t i = 0; i < results->size(); ++i) {
+      futures.push_back(cass_session_execute(session, statement));
+    }
+    cass_statement_free(statement);
+
+    for (size_t i = 0; i < futures.size(); ++i) {
+      // Every request is finished, even if the session is closed first
+      if (cass_future_wait_timed(futures[i], 10 * 1000 * 1000)) {
+        (*results)[i] = cass_future_error_code(futures[i]);
+      } else {
+        (*results)[i] = CASS_ERROR_LIB_REQUEST_TIMED_OUT;
+      }
+      cass_future_free(futures[i]);
+    }
+  }
+
+  CassSession* session;
+  std::vector<CassError>* results;
+};
+
+BOOST_AUTO_TEST_SUITE(session_dispatch)
+
+BOOST_AUTO_TEST_CASE(concurrent_execute)
+{
+  mock::Cluster mock_cluster(3);
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  DispatchSession session(mock_cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  std::vector<CassError> results[NUM_THREADS];
+  boost::thread_group threads;
+  for (size_t i = 0; i < NUM_THREADS; ++i) {
+    results[i].resize(NUM_REQUESTS, CASS_OK);
+    threads.create_thread(ExecuteRequests(session.session, &results[i]));
+  }
+  threads.join_all();
+
+  for (size_t i = 0; i < NUM_THREADS; ++i) {
+    for (size_t j = 0; j < NUM_REQUESTS; ++j) {
+      BOOST_REQUIRE_EQUAL(results[i][j], CASS_OK);
+    }
+  }
+
+  // The requests are spread across all the nodes
+  size_t total = 0;
+  for (size_t i = 0; i < mock_cluster.num_nodes(); ++i) {
+    BOOST_CHECK_GT(mock_cluster.request_count(i), 0u);
+    total += mock_cluster.request_count(i);
+  }
+  BOOST_CHECK_GE(total, NUM_THREADS * NUM_REQUESTS);
+}
+
+BOOST_AUTO_TEST_CASE(close_with_requests_in_flight)
+{
+  mock::Cluster::Settings settings;
+  settings.latency_ms = 200;
+  mock::Cluster mock_cluster(3, settings);
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  DispatchSession session(mock_cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  CassStatement* statement = cass_statement_new("SELECT * FROM table1", 0);
+  std::vector<CassFuture*> futures;
+  for (size_t i = 0; i < NUM_REQUESTS; ++i) {
+    futures.push_back(cass_session_execute(session.session, statement));
+  }
+
+  // Closing the session waits for the requests that are still running
+  BOOST_CHECK_EQUAL(session.close(), CASS_OK);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    BOOST_CHECK(cass_future_ready(futures[i]));
+    BOOST_CHECK_EQUAL(cass_future_error_code(futures[i]), CASS_OK);
+    cass_future_free(futures[i]);
+  }
+
+  // Requests executed after the session is closed fail right away
+  CassFuture* future = cass_session_execute(session.session, statement);
+  BOOST_CHECK_EQUAL(cass_future_error_code(future), CASS_ERROR_LIB_NO_HOSTS_AVAILABLE);
+  cass_future_free(future);
+
+  cass_statement_free(statement);
+}
+
+BOOST_AUTO_TEST_CASE(close_during_concurrent_execute)
+{
+  mock::Cluster::Settings settings;
+  settings.latency_ms = 10;
+  mock::Cluster mock_cluster(3, settings);
+  BOOST_REQUIRE_EQUAL(mock_cluster.start(), 0);
+
+  DispatchSession session(mock_cluster);
+  BOOST_REQUIRE_EQUAL(session.connect(), CASS_OK);
+
+  std::vector<CassError> results[NUM_THREADS];
+  boost::thread_group threads;
+  for (size_t i = 0; i < NUM_THREADS; ++i) {
+    results[i].resize(NUM_REQUESTS, CASS_OK);
+    threads.create_thread(ExecuteRequests(session.session, &results[i]));
+  }
+
+  // The session is closed while the application threads are still
+  // enqueuing requests on the IO workers
+  BOOST_CHECK_EQUAL(session.close(), CASS_OK);
+  threads.join_all();
+
+  for (size_t i = 0; i < NUM_THREADS; ++i) {
+    for (size_t j = 0; j < NUM_REQUESTS; ++j) {
+      BOOST_CHECK_NE(results[i][j], CASS_ERROR_LIB_REQUEST_TIMED_OUT);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
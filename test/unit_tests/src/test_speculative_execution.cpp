@@ -0,0 +1,101 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "host.hpp"
+#include "scoped_ptr.hpp"
+#include "speculative_execution.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+static const uint64_t ONE_MS = 1000LL * 1000LL; // 1 ms in ns
+
+BOOST_AUTO_TEST_SUITE(speculative_execution)
+
+BOOST_AUTO_TEST_CASE(percentile_tracking)
+{
+  cass::Host host(cass::Address("127.0.0.1", 9042), false);
+  host.update_percentile_latency(ONE_MS); // Not tracked yet
+  BOOST_CHECK_EQUAL(host.latency_percentile(), -1);
+
+  host.enable_percentile_tracking(99.0, 0, 100);
+  for (uint64_t i = 1; i < 100; ++i) {
+    host.update_percentile_latency(i * ONE_MS);
+    BOOST_CHECK_EQUAL(host.latency_percentile(), -1);
+  }
+
+  // The window is complete after the minimum number of latencies
+  host.update_percentile_latency(100 * ONE_MS);
+  int64_t percentile_ms = host.latency_percentile() / static_cast<int64_t>(ONE_MS);
+  BOOST_CHECK_GE(percentile_ms, 98);
+  BOOST_CHECK_LE(percentile_ms, 100);
+
+  // The next window starts empty
+  for (uint64_t i = 0; i < 100; ++i) {
+    host.update_percentile_latency(ONE_MS);
+  }
+  BOOST_CHECK_EQUAL(host.latency_percentile() / static_cast<int64_t>(ONE_MS), 1);
+}
+
+BOOST_AUTO_TEST_CASE(percentile_delay)
+{
+  cass::Host::Ptr host(new cass::Host(cass::Address("127.0.0.1", 9042), false));
+
+  cass::PercentileSpeculativeExecutionPolicy::Settings settings;
+  settings.max_speculative_executions = 2;
+  settings.window_ns = 0;
+  settings.min_measured = 10;
+  cass::PercentileSpeculativeExecutionPolicy::Ptr policy(
+        new cass::PercentileSpeculativeExecutionPolicy(settings));
+
+  // No speculative executions until the host has a percentile
+  {
+    cass::ScopedPtr<cass::SpeculativeExecutionPlan> plan(policy->new_plan("", NULL));
+    BOOST_CHECK_EQUAL(plan->next_execution(host), -1);
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    host->update_percentile_latency(5 * ONE_MS);
+  }
+
+  cass::ScopedPtr<cass::SpeculativeExecutionPlan> plan(policy->new_plan("", NULL));
+  BOOST_CHECK_EQUAL(plan->next_execution(host), 5);
+  BOOST_CHECK_EQUAL(plan->next_execution(host), 5);
+  BOOST_CHECK_EQUAL(plan->next_execution(host), -1);
+}
+
+BOOST_AUTO_TEST_CASE(budget)
+{
+  cass::PercentileSpeculativeExecutionPolicy::Settings settings;
+  settings.budget_percent = 10.0;
+  settings.window_ns = CASS_UINT64_MAX;
+  cass::PercentileSpeculativeExecutionPolicy::Ptr policy(
+        new cass::PercentileSpeculativeExecutionPolicy(settings));
+
+  // 10% of 20 requests allows 2 speculative executions
+  for (int i = 0; i < 20; ++i) {
+    cass::ScopedPtr<cass::SpeculativeExecutionPlan> plan(policy->new_plan("", NULL));
+  }
+  cass::ScopedPtr<cass::SpeculativeExecutionPlan> plan(policy->new_plan("", NULL));
+  BOOST_CHECK(plan->can_execute());
+  BOOST_CHECK(plan->can_execute());
+  BOOST_CHECK(!plan->can_execute());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
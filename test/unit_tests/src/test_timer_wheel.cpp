@@ -0,0 +1,287 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "scoped_ptr.hpp"
+#include "timer.hpp"
+#include "timer_wheel.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <uv.h>
+
+const int NUM_BENCHMARK_TIMERS = 50000;
+const int NUM_BENCHMARK_ITERATIONS = 10;
+
+struct ExpiredTimer {
+  ExpiredTimer()
+    : count(0)
+    , time(0) { }
+
+  int count;
+  uint64_t time;
+};
+
+static uv_loop_t* create_loop(uv_loop_t* storage) {
+#if UV_VERSION_MAJOR == 0
+  return uv_loop_new();
+#else
+  uv_loop_init(storage);
+  return storage;
+#endif
+}
+
+static void destroy_loop(uv_loop_t* loop) {
+#if UV_VERSION_MAJOR == 0
+  uv_loop_delete(loop);
+#else
+  uv_loop_close(loop);
+#endif
+}
+
+struct WheelTest {
+  WheelTest()
+    : loop(create_loop(&loop_storage)) {
+    wheel.init(loop);
+    start = uv_now(loop);
+  }
+
+  ~WheelTest() {
+    wheel.close_handles();
+    uv_run(loop, UV_RUN_DEFAULT);
+    destroy_loop(loop);
+  }
+
+  uv_loop_t loop_storage;
+  uv_loop_t* loop;
+  cass::TimerWheel wheel;
+  uint64_t start;
+};
+
+static uint64_t expired_time = 0;
+
+static void on_wheel_timer(cass::WheelTimer* timer) {
+  ExpiredTimer* expired = static_cast<ExpiredTimer*>(timer->data());
+  expired->count++;
+  expired->time = expired_time;
+}
+
+static void check_expires_at(uint64_t timeout) {
+  WheelTest test;
+
+  ExpiredTimer expired;
+  cass::WheelTimer timer;
+  timer.start(&test.wheel, timeout, &expired, on_wheel_timer);
+
+  // Advance the wheel to just before the timeout in large steps and then
+  // one millisecond at a time
+  uint64_t now = test.start;
+  while (now + 64 < test.start + timeout) {
+    now += 63;
+    expired_time = now;
+    test.wheel.advance(now);
+  }
+  while (now < test.start + timeout - 1) {
+    ++now;
+    expired_time = now;
+    test.wheel.advance(now);
+  }
+  BOOST_CHECK_EQUAL(expired.count, 0);
+  BOOST_CHECK(timer.is_running());
+
+  expired_time = test.start + timeout;
+  test.wheel.advance(test.start + timeout);
+  BOOST_CHECK_EQUAL(expired.count, 1);
+  BOOST_CHECK_EQUAL(expired.time, test.start + timeout);
+  BOOST_CHECK(!timer.is_running());
+  BOOST_CHECK_EQUAL(test.wheel.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE(timer_wheel)
+
+BOOST_AUTO_TEST_CASE(expires)
+{
+  // Timeouts that land in each level of the wheel and on level boundaries
+  uint64_t timeouts[] = { 1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097,
+                          12345, 262143, 262144, 300000 };
+  for (size_t i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); ++i) {
+    BOOST_TEST_MESSAGE("Timeout " << timeouts[i]);
+    check_expires_at(timeouts[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(beyond_range)
+{
+  // Timeouts larger than the wheel's range are re-inserted as it turns
+  check_expires_at((1 << 24) + 1000);
+}
+
+BOOST_AUTO_TEST_CASE(zero_timeout)
+{
+  WheelTest test;
+
+  ExpiredTimer expired;
+  cass::WheelTimer timer;
+  timer.start(&test.wheel, 0, &expired, on_wheel_timer);
+
+  test.wheel.advance(test.start);
+  BOOST_CHECK_EQUAL(expired.count, 0);
+
+  test.wheel.advance(test.start + 1);
+  BOOST_CHECK_EQUAL(expired.count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(stop_and_restart)
+{
+  WheelTest test;
+
+  ExpiredTimer expired;
+  cass::WheelTimer timer;
+  timer.start(&test.wheel, 100, &expired, on_wheel_timer);
+  BOOST_CHECK_EQUAL(test.wheel.size(), 1u);
+
+  timer.stop();
+  BOOST_CHECK(!timer.is_running());
+  BOOST_CHECK_EQUAL(test.wheel.size(), 0u);
+
+  test.wheel.advance(test.start + 200);
+  BOOST_CHECK_EQUAL(expired.count, 0);
+
+  // Restarting a running timer replaces its timeout
+  timer.start(&test.wheel, 1000, &expired, on_wheel_timer);
+  timer.start(&test.wheel, 50, &expired, on_wheel_timer);
+  BOOST_CHECK_EQUAL(test.wheel.size(), 1u);
+
+  test.wheel.advance(test.start + 250);
+  BOOST_CHECK_EQUAL(expired.count, 1);
+  BOOST_CHECK_EQUAL(test.wheel.size(), 0u);
+}
+
+struct RestartTimer {
+  RestartTimer(cass::TimerWheel* wheel)
+    : wheel(wheel)
+    , count(0) { }
+
+  cass::TimerWheel* wheel;
+  int count;
+};
+
+static void on_restart_timer(cass::WheelTimer* timer) {
+  RestartTimer* restart = static_cast<RestartTimer*>(timer->data());
+  if (++restart->count < 3) {
+    timer->start(restart->wheel, 10, restart, on_restart_timer);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(restart_from_callback)
+{
+  WheelTest test;
+
+  RestartTimer restart(&test.wheel);
+  cass::WheelTimer timer;
+  timer.start(&test.wheel, 10, &restart, on_restart_timer);
+
+  // All the restarts happen within a single advance
+  test.wheel.advance(test.start + 1000);
+  BOOST_CHECK_EQUAL(restart.count, 3);
+  BOOST_CHECK(!timer.is_running());
+}
+
+static void on_loop_timer(cass::WheelTimer* timer) {
+  ExpiredTimer* expired = static_cast<ExpiredTimer*>(timer->data());
+  expired->count++;
+}
+
+BOOST_AUTO_TEST_CASE(run_loop)
+{
+  WheelTest test;
+
+  ExpiredTimer expired;
+  cass::WheelTimer timers[3];
+  timers[0].start(&test.wheel, 5, &expired, on_loop_timer);
+  timers[1].start(&test.wheel, 70, &expired, on_loop_timer);
+  timers[2].start(&test.wheel, 1, &expired, on_loop_timer);
+
+  uint64_t start = uv_hrtime();
+  while (expired.count < 3) {
+    uv_run(test.loop, UV_RUN_ONCE);
+  }
+  uint64_t elapsed_ms = (uv_hrtime() - start) / (1000 * 1000);
+
+  BOOST_CHECK(elapsed_ms >= 69);
+  BOOST_CHECK_EQUAL(test.wheel.size(), 0u);
+}
+
+static void on_benchmark_timer(cass::Timer* timer) { }
+static void on_benchmark_wheel_timer(cass::WheelTimer* timer) { }
+
+// Simulates requests that finish before their timeout. Each iteration
+// starts a timeout for every in-flight request and then stops them as the
+// requests complete.
+BOOST_AUTO_TEST_CASE(benchmark)
+{
+  uint64_t timer_ns;
+  {
+    uv_loop_t loop_storage;
+    uv_loop_t* loop = create_loop(&loop_storage);
+
+    cass::ScopedPtr<cass::Timer[]> timers(new cass::Timer[NUM_BENCHMARK_TIMERS]);
+    uint64_t start = uv_hrtime();
+    for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) {
+      for (int j = 0; j < NUM_BENCHMARK_TIMERS; ++j) {
+        timers[j].start(loop, 12000, NULL, on_benchmark_timer);
+      }
+      uv_run(loop, UV_RUN_NOWAIT);
+      for (int j = 0; j < NUM_BENCHMARK_TIMERS; ++j) {
+        timers[j].stop();
+      }
+      // Process the closed timer handles
+      uv_run(loop, UV_RUN_NOWAIT);
+    }
+    timer_ns = uv_hrtime() - start;
+
+    destroy_loop(loop);
+  }
+
+  uint64_t wheel_ns;
+  {
+    WheelTest test;
+
+    cass::ScopedPtr<cass::WheelTimer[]> timers(new cass::WheelTimer[NUM_BENCHMARK_TIMERS]);
+    uint64_t start = uv_hrtime();
+    for (int i = 0; i < NUM_BENCHMARK_ITERATIONS; ++i) {
+      for (int j = 0; j < NUM_BENCHMARK_TIMERS; ++j) {
+        timers[j].start(&test.wheel, 12000, NULL, on_benchmark_wheel_timer);
+      }
+      uv_run(test.loop, UV_RUN_NOWAIT);
+      for (int j = 0; j < NUM_BENCHMARK_TIMERS; ++j) {
+        timers[j].stop();
+      }
+      uv_run(test.loop, UV_RUN_NOWAIT);
+    }
+    wheel_ns = uv_hrtime() - start;
+  }
+
+  int total = NUM_BENCHMARK_TIMERS * NUM_BENCHMARK_ITERATIONS;
+  BOOST_TEST_MESSAGE("Request timeouts (" << NUM_BENCHMARK_TIMERS << " in flight): "
+                     << "libuv timers " << timer_ns / total << " ns/request, "
+                     << "timer wheel " << wheel_ns / total << " ns/request");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
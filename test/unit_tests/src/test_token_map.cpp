@@ -30,7 +30,7 @@ struct TestTokenMap {
   typedef std::map<Token, cass::Host::Ptr> TokenHostMap;
 
   TokenHostMap tokens;
-  cass::ScopedPtr<cass::TokenMap> token_map;
+  cass::TokenMap::Ptr token_map;
 
   TestTokenMap()
     : token_map(cass::TokenMap::from_partitioner(Partitioner::name())) { }
@@ -72,6 +72,168 @@ struct TestTokenMap {
   }
 };
 
+// A vnode cluster whose token map is updated one host at a time. The result
+// is compared to a token map that's built from scratch.
+class IncrementalCluster {
+public:
+  struct HostTokens {
+    cass::Host::Ptr host;
+    std::vector<int64_t> tokens;
+  };
+
+  typedef std::map<std::string, HostTokens> HostTokensMap;
+
+  IncrementalCluster(const cass::TokenMap::BuildSettings& settings = cass::TokenMap::BuildSettings())
+    : is_built_(false)
+    , token_map_(create_token_map(settings)) { }
+
+  static const size_t NUM_TOKENS = 16;
+
+  void add_or_update_host(const std::string& address, const std::string& rack, const std::string& dc) {
+    HostTokensMap::iterator it = hosts_.find(address);
+    if (it == hosts_.end()) {
+      HostTokens host_tokens;
+      host_tokens.host = create_host(address, rack, dc);
+      it = hosts_.insert(std::make_pair(address, host_tokens)).first;
+    }
+    it->second.tokens.clear();
+    for (size_t i = 0; i < NUM_TOKENS; ++i) {
+      it->second.tokens.push_back(static_cast<int64_t>(rng_()));
+    }
+    if (is_built_) {
+      token_map_->update_host_and_build(it->second.host, tokens_value(it->second.tokens));
+    } else {
+      token_map_->add_host(it->second.host, tokens_value(it->second.tokens));
+    }
+  }
+
+  void remove_host(const std::string& address) {
+    HostTokensMap::iterator it = hosts_.find(address);
+    BOOST_REQUIRE(it != hosts_.end());
+    token_map_->remove_host_and_build(it->second.host);
+    hosts_.erase(it);
+  }
+
+  void build() {
+    token_map_->build();
+    is_built_ = true;
+  }
+
+  // Keeps the current replicas so they can be compared after an update
+  void snapshot_replicas() {
+    snapshot_.clear();
+    for (int i = 0; i < 256; ++i) {
+      std::stringstream key;
+      key << "key" << i;
+      snapshot_.push_back(token_map_->get_replicas("network_topology", key.str()));
+    }
+  }
+
+  // The number of replicas from the snapshot that are still used. Only an
+  // incremental update keeps the replicas of the ranges it didn't change,
+  // a full rebuild replaces all of them.
+  size_t count_reused_replicas() const {
+    size_t count = 0;
+    for (int i = 0; i < 256; ++i) {
+      std::stringstream key;
+      key << "key" << i;
+      const cass::CopyOnWriteHostVec& replicas = token_map_->get_replicas("network_topology", key.str());
+      const cass::CopyOnWriteHostVec& previous = snapshot_[i];
+      if (replicas.operator->() == previous.operator->()) ++count;
+    }
+    return count;
+  }
+
+  // Compares the replicas with a token map built from copies of the hosts
+  void verify() {
+    cass::TokenMap::Ptr expected(create_token_map(cass::TokenMap::BuildSettings()));
+    for (HostTokensMap::const_iterator i = hosts_.begin(),
+         end = hosts_.end(); i != end; ++i) {
+      const cass::Host::Ptr& host = i->second.host;
+      expected->add_host(create_host(host->address().to_string(), host->rack(), host->dc()),
+                         tokens_value(i->second.tokens));
+    }
+    expected->build();
+
+    const char* keyspaces[] = { "simple", "network_topology" };
+    for (size_t i = 0; i < sizeof(keyspaces) / sizeof(keyspaces[0]); ++i) {
+      for (int j = 0; j < 256; ++j) {
+        std::stringstream key;
+        key << "key" << j;
+        const cass::CopyOnWriteHostVec& replicas = token_map_->get_replicas(keyspaces[i], key.str());
+        const cass::CopyOnWriteHostVec& expected_replicas = expected->get_replicas(keyspaces[i], key.str());
+        BOOST_REQUIRE(replicas && expected_replicas);
+        BOOST_REQUIRE_EQUAL(replicas->size(), expected_replicas->size());
+        for (size_t k = 0; k < replicas->size(); ++k) {
+          BOOST_CHECK_EQUAL((*replicas)[k]->address(), (*expected_replicas)[k]->address());
+        }
+      }
+    }
+  }
+
+private:
+  static cass::TokenMap* create_token_map(const cass::TokenMap::BuildSettings& settings) {
+    cass::TokenMap* token_map = cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name(),
+                                                                 settings);
+    add_keyspace_simple("simple", 3, token_map);
+    ReplicationMap replication;
+    replication["dc1"] = "3";
+    replication["dc2"] = "2";
+    add_keyspace_network_topology("network_topology", replication, token_map);
+    return token_map;
+  }
+
+  cass::Value* tokens_value(const std::vector<int64_t>& tokens) {
+    builder_ = TokenCollectionBuilder();
+    for (std::vector<int64_t>::const_iterator i = tokens.begin(),
+         end = tokens.end(); i != end; ++i) {
+      builder_.append_token(*i);
+    }
+    return builder_.finish();
+  }
+
+private:
+  MT19937_64 rng_;
+  HostTokensMap hosts_;
+  TokenCollectionBuilder builder_;
+  std::vector<cass::CopyOnWriteHostVec> snapshot_;
+  bool is_built_;
+  cass::TokenMap::Ptr token_map_;
+};
+
+void run_incremental_updates(IncrementalCluster& cluster) {
+  for (int i = 0; i < 24; ++i) {
+    std::stringstream address, rack;
+    address << "1.0.0." << (i + 1);
+    rack << "rack" << (i % 3);
+    cluster.add_or_update_host(address.str(), rack.str(), i % 2 == 0 ? "dc1" : "dc2");
+  }
+  cluster.build();
+  cluster.verify();
+
+  // Removed hosts
+  cluster.remove_host("1.0.0.1");
+  cluster.verify();
+  cluster.remove_host("1.0.0.8");
+  cluster.verify();
+
+  // Hosts with new tokens
+  cluster.add_or_update_host("1.0.0.3", "rack2", "dc1");
+  cluster.verify();
+  cluster.add_or_update_host("1.0.0.10", "rack0", "dc2");
+  cluster.verify();
+
+  // New hosts, including a new rack
+  cluster.add_or_update_host("1.0.1.1", "rack1", "dc1");
+  cluster.verify();
+  cluster.add_or_update_host("1.0.1.2", "rack3", "dc2");
+  cluster.verify();
+
+  // Removing the only host in a rack
+  cluster.remove_host("1.0.1.2");
+  cluster.verify();
+}
+
 } // namespace
 
 BOOST_AUTO_TEST_SUITE(token_map)
@@ -196,7 +358,7 @@ BOOST_AUTO_TEST_CASE(murmur3_large_number_of_vnodes)
 
 BOOST_AUTO_TEST_CASE(random)
 {
-  cass::ScopedPtr<cass::TokenMap> token_map(cass::TokenMap::from_partitioner(cass::RandomPartitioner::name()));
+  cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::RandomPartitioner::name()));
 
   TestTokenMap<cass::RandomPartitioner> test_random;
 
@@ -210,7 +372,7 @@ BOOST_AUTO_TEST_CASE(random)
 
 BOOST_AUTO_TEST_CASE(byte_ordered)
 {
-  cass::ScopedPtr<cass::TokenMap> token_map(cass::TokenMap::from_partitioner(cass::ByteOrderedPartitioner::name()));
+  cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::ByteOrderedPartitioner::name()));
 
   TestTokenMap<cass::ByteOrderedPartitioner> test_byte_ordered;
 
@@ -475,4 +637,152 @@ BOOST_AUTO_TEST_CASE(drop_keyspace)
   }
 }
 
+BOOST_AUTO_TEST_CASE(copy)
+{
+  TestTokenMap<cass::Murmur3Partitioner> test_copy;
+
+  test_copy.tokens[CASS_INT64_MIN / 2] = create_host("1.0.0.1");
+  test_copy.tokens[0]                  = create_host("1.0.0.2");
+  test_copy.tokens[CASS_INT64_MAX / 2] = create_host("1.0.0.3");
+
+  test_copy.build("ks", 2);
+
+  // A published snapshot isn't affected by updates to its copy
+  cass::TokenMap::ConstPtr snapshot(test_copy.token_map->copy());
+  test_copy.token_map->remove_host_and_build(test_copy.tokens.begin()->second);
+
+  {
+    const cass::CopyOnWriteHostVec& replicas = snapshot->get_replicas("ks", "abc");
+
+    BOOST_REQUIRE(replicas && replicas->size() == 2);
+    BOOST_CHECK_EQUAL((*replicas)[0]->address(), cass::Address("1.0.0.1", 9042));
+    BOOST_CHECK_EQUAL((*replicas)[1]->address(), cass::Address("1.0.0.2", 9042));
+  }
+
+  {
+    const cass::CopyOnWriteHostVec& replicas = test_copy.token_map->get_replicas("ks", "abc");
+
+    BOOST_REQUIRE(replicas && replicas->size() == 2);
+    BOOST_CHECK_EQUAL((*replicas)[0]->address(), cass::Address("1.0.0.2", 9042));
+    BOOST_CHECK_EQUAL((*replicas)[1]->address(), cass::Address("1.0.0.3", 9042));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ring)
+{
+  typedef cass::ReplicationStrategy<cass::Murmur3Partitioner> ReplicationStrategy;
+
+  cass::TokenRing<cass::Murmur3Partitioner> ring;
+
+  // An empty ring has no replicas
+  BOOST_CHECK(!ring.find(0));
+
+  cass::Host::Ptr host1(create_host("1.0.0.1"));
+  cass::Host::Ptr host2(create_host("1.0.0.2"));
+  cass::Host::Ptr host3(create_host("1.0.0.3"));
+
+  ReplicationStrategy::TokenReplicasVec replicas;
+  for (int i = 0; i < 10; ++i) {
+    cass::CopyOnWriteHostVec hosts(new cass::HostVec());
+    // Tokens 30 and 40 have the same replicas
+    if (i == 3 || i == 4) {
+      hosts->push_back(host1);
+      hosts->push_back(host2);
+    } else {
+      hosts->push_back(i % 2 == 0 ? host2 : host3);
+    }
+    replicas.push_back(ReplicationStrategy::TokenReplicas(i * 10, hosts));
+  }
+  ring.build(replicas);
+
+  // The ring references the replicas instead of copying them
+  const cass::CopyOnWriteHostVec& first = replicas[1].second;
+  BOOST_CHECK(ring.find(5).operator->() == first.operator->());
+
+  for (int64_t token = -5; token < 105; ++token) {
+    // The first token after the token and it wraps around the end of the ring
+    size_t index = token < 0 ? 0 : static_cast<size_t>(token / 10 + 1);
+    if (index >= replicas.size()) index = 0;
+    const cass::CopyOnWriteHostVec& hosts = ring.find(token);
+    BOOST_REQUIRE(hosts);
+    BOOST_CHECK(*hosts == *replicas[index].second);
+  }
+
+  // Consecutive tokens with the same replicas share them
+  BOOST_CHECK_EQUAL(&ring.find(25), &ring.find(35));
+  BOOST_CHECK_NE(&ring.find(15), &ring.find(25));
+}
+
+BOOST_AUTO_TEST_CASE(incremental_updates)
+{
+  IncrementalCluster cluster;
+  run_incremental_updates(cluster);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_new_host)
+{
+  IncrementalCluster cluster;
+  for (int i = 0; i < 24; ++i) {
+    std::stringstream address, rack;
+    address << "1.0.0." << (i + 1);
+    rack << "rack" << (i % 3);
+    cluster.add_or_update_host(address.str(), rack.str(), i % 2 == 0 ? "dc1" : "dc2");
+  }
+  cluster.build();
+
+  // A new host joining an existing rack doesn't rebuild the whole ring
+  cluster.snapshot_replicas();
+  cluster.add_or_update_host("1.0.1.1", "rack1", "dc1");
+  BOOST_CHECK_GT(cluster.count_reused_replicas(), 0u);
+  cluster.verify();
+
+  // Neither do new tokens for an existing host
+  cluster.snapshot_replicas();
+  cluster.add_or_update_host("1.0.0.5", "rack1", "dc1");
+  BOOST_CHECK_GT(cluster.count_reused_replicas(), 0u);
+  cluster.verify();
+}
+
+BOOST_AUTO_TEST_CASE(lazy_replicas)
+{
+  cass::TokenMap::BuildSettings settings;
+  settings.is_lazy = true;
+  IncrementalCluster cluster(settings);
+  run_incremental_updates(cluster);
+}
+
+BOOST_AUTO_TEST_CASE(shared_replicas)
+{
+  typedef cass::TokenMapImpl<cass::Murmur3Partitioner> TokenMapImpl;
+
+  cass::TokenMap::BuildSettings settings;
+  settings.is_lazy = true;
+  cass::TokenMap::Ptr token_map(cass::TokenMap::from_partitioner(cass::Murmur3Partitioner::name(),
+                                                                settings));
+  TokenMapImpl* token_map_impl = static_cast<TokenMapImpl*>(token_map.get());
+
+  MT19937_64 rng;
+  add_murmur3_host(create_host("1.0.0.1"), rng, 4, token_map.get());
+  add_murmur3_host(create_host("1.0.0.2"), rng, 4, token_map.get());
+  add_murmur3_host(create_host("1.0.0.3"), rng, 4, token_map.get());
+  add_keyspace_simple("ks1", 2, token_map.get());
+  add_keyspace_simple("ks2", 2, token_map.get());
+  add_keyspace_simple("ks3", 3, token_map.get());
+  token_map->build();
+
+  // Replicas aren't built until they're used
+  BOOST_CHECK(!token_map_impl->is_keyspace_built("ks1"));
+  BOOST_CHECK(!token_map_impl->is_keyspace_built("ks3"));
+
+  // Keyspaces with the same replication strategy share their replicas
+  const cass::CopyOnWriteHostVec& replicas1 = token_map->get_replicas("ks1", "abc");
+  BOOST_REQUIRE(replicas1 && replicas1->size() == 2);
+  BOOST_CHECK(token_map_impl->is_keyspace_built("ks2"));
+  BOOST_CHECK(!token_map_impl->is_keyspace_built("ks3"));
+  BOOST_CHECK_EQUAL(&replicas1, &token_map->get_replicas("ks2", "abc"));
+
+  const cass::CopyOnWriteHostVec& replicas3 = token_map->get_replicas("ks3", "abc");
+  BOOST_REQUIRE(replicas3 && replicas3->size() == 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -27,13 +27,37 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/thread.hpp>
 
+#include <algorithm>
 #include <string.h>
+#include <vector>
 
 inline bool operator!=(const CassUuid& u1, const CassUuid& u2) {
   return u1.clock_seq_and_node != u2.clock_seq_and_node ||
          u1.time_and_version != u2.time_and_version;
 }
 
+inline bool operator<(const CassUuid& u1, const CassUuid& u2) {
+  if (u1.time_and_version != u2.time_and_version) {
+    return u1.time_and_version < u2.time_and_version;
+  }
+  return u1.clock_seq_and_node < u2.clock_seq_and_node;
+}
+
+struct GenerateTime {
+  GenerateTime(CassUuidGen* uuid_gen, std::vector<CassUuid>* uuids)
+    : uuid_gen(uuid_gen)
+    , uuids(uuids) { }
+
+  void operator()() {
+    for (size_t i = 0; i < uuids->size(); ++i) {
+      cass_uuid_gen_time(uuid_gen, &(*uuids)[i]);
+    }
+  }
+
+  CassUuidGen* uuid_gen;
+  std::vector<CassUuid>* uuids;
+};
+
 BOOST_AUTO_TEST_SUITE(uuids)
 
 BOOST_AUTO_TEST_CASE(v1)
@@ -68,6 +92,41 @@ BOOST_AUTO_TEST_CASE(v1)
   cass_uuid_gen_free(uuid_gen);
 }
 
+BOOST_AUTO_TEST_CASE(v1_multiple_threads)
+{
+  const size_t num_threads = 4;
+  const size_t num_uuids = 20000;
+
+  CassUuidGen* uuid_gen = cass_uuid_gen_new();
+
+  std::vector<CassUuid> uuids[num_threads];
+  boost::thread_group threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    uuids[i].resize(num_uuids);
+    threads.create_thread(GenerateTime(uuid_gen, &uuids[i]));
+  }
+  threads.join_all();
+
+  std::vector<CassUuid> all;
+  for (size_t i = 0; i < num_threads; ++i) {
+    // The timestamps are increasing for each thread
+    for (size_t j = 1; j < num_uuids; ++j) {
+      BOOST_REQUIRE_GT(uuids[i][j].time_and_version, uuids[i][j - 1].time_and_version);
+    }
+    all.insert(all.end(), uuids[i].begin(), uuids[i].end());
+  }
+
+  // The UUIDs share the generator's clock sequence and node, and come from a
+  // single sequence of timestamps, so no two threads ever get the same one
+  std::sort(all.begin(), all.end());
+  for (size_t i = 1; i < all.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(all[i].clock_seq_and_node, all[0].clock_seq_and_node);
+    BOOST_REQUIRE_GT(all[i].time_and_version, all[i - 1].time_and_version);
+  }
+
+  cass_uuid_gen_free(uuid_gen);
+}
+
 BOOST_AUTO_TEST_CASE(v1_min_max)
 {
   cass_uint64_t founded_ts = 1270080000; // April 2010